@@ -0,0 +1,324 @@
+// CompactRoadMap.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A CompactRoadMap is a read-only copy of a RoadMap that uses much less
+// memory per road segment and can be searched faster.  Its structure is
+// stored in a CompactDigraph (which doesn't repeat the "from" vertex of
+// each edge), and the road segments are stored as a structure of arrays:
+// one array of distances, one of speeds, and one of driving times, which
+// are computed once when the CompactRoadMap is built rather than during
+// every search.
+//
+// The type of the values in those arrays is chosen by a Precision type:
+//
+// * DoublePrecision stores doubles, exactly like a RoadMap, and finds
+//   exactly the same routes
+// * FloatPrecision stores floats, halving the size of the arrays
+// * FixedPrecision<Scale> stores 32-bit integers counting units of
+//   1 / Scale (of a mile, a mile per hour, and an hour), and adds up
+//   path weights exactly, in 64-bit integers; a value that's negative,
+//   or too large to be counted in 32 bits, can't be stored, and building
+//   the CompactRoadMap throws a DigraphException instead
+//
+// With the latter two, values are rounded when they're stored, so routes
+// between places whose shortest routes are (nearly) tied can differ, and
+// distances and speeds are reported as their rounded values.
+//
+// A CompactRoadMap can also be built with its chains of pass-through
+// vertices collapsed (see ChainCompressedGraph.hpp), in which case its
+// searches visit only the remaining core vertices.  The routes found are
+// expanded back into every road segment, so they're described exactly as
+// before.
+//
+// A CompactRoadMap holds on to the RoadMap's LocationNames table, so the
+// RoadMap itself can be discarded once the CompactRoadMap is built.
+
+#ifndef COMPACTROADMAP_HPP
+#define COMPACTROADMAP_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "ChainCompressedGraph.hpp"
+#include "CompactDigraph.hpp"
+#include "RoadMap.hpp"
+#include "Route.hpp"
+#include "Trip.hpp"
+
+
+
+struct DoublePrecision
+{
+    typedef double Value;
+    typedef double Distance;
+
+    static Value encode(double x) { return x; }
+    static double decode(Value v) { return v; }
+};
+
+
+
+struct FloatPrecision
+{
+    typedef float Value;
+    typedef double Distance;
+
+    static Value encode(double x) { return static_cast<float>(x); }
+    static double decode(Value v) { return v; }
+};
+
+
+
+template <unsigned int Scale>
+struct FixedPrecision
+{
+    typedef std::uint32_t Value;
+    typedef std::uint64_t Distance;
+
+    static Value encode(double x);
+    static double decode(Value v) { return static_cast<double>(v) / Scale; }
+};
+
+
+
+template <typename Precision>
+class CompactRoadMap
+{
+public:
+    typedef typename Precision::Value Value;
+    typedef typename Precision::Distance Distance;
+
+    // Initializes a CompactRoadMap as a copy of the given RoadMap, with
+    // its vertices stored in the given order.  The order changes only
+    // how quickly routes are found, not which routes are found.  If
+    // compressChains is true, chains of pass-through vertices are
+    // collapsed, so that searches visit only core vertices.
+    explicit CompactRoadMap(
+        const RoadMap& roadMap, VertexOrder order = VertexOrder::Number,
+        bool compressChains = false);
+
+    // findRoute() finds the shortest route for the given trip, in the
+    // same form as RouteFinder::findRoute().  If either of the trip's
+    // vertices does not exist, a DigraphException is thrown.
+    Route findRoute(const Trip& trip) const;
+
+    // makeRoute() returns the route for the given trip that follows the
+    // given edge indexes, in order, or, if reachable is false, a route
+    // marking the trip's end vertex as unreachable.
+    Route makeRoute(const Trip& trip, bool reachable, const std::vector<int>& path) const;
+
+    // graph() returns the structure of the map, while miles(),
+    // milesPerHour(), and hours() return the road segment arrays,
+    // indexed by edge index.
+    const CompactDigraph& graph() const;
+
+    // chains() returns the map's chains of pass-through vertices, which
+    // are empty unless it was built with compressChains.
+    const ChainCompressedGraph& chains() const;
+
+    const std::vector<Value>& miles() const;
+    const std::vector<Value>& milesPerHour() const;
+    const std::vector<Value>& hours() const;
+
+    // memoryUsage() returns the memory allocated for the map, including
+    // the name table it shares with the RoadMap it was built from.  The
+    // driving times and the chains can be worked out from the rest, so
+    // they count as caches.
+    MemoryUsage memoryUsage() const;
+
+    // bytesPerEdge() returns the number of bytes stored for each edge.
+    static constexpr std::size_t bytesPerEdge()
+    {
+        return sizeof(int) + 3 * sizeof(Value);
+    }
+
+private:
+    CompactDigraph graph_;
+    std::shared_ptr<const LocationNames> nameTable_;
+    std::vector<std::string_view> names_;
+    std::vector<Value> miles_;
+    std::vector<Value> milesPerHour_;
+    std::vector<Value> hours_;
+
+    bool compressed_;
+    ChainCompressedGraph chains_;
+    std::vector<Distance> chainMiles_;
+    std::vector<Distance> chainHours_;
+};
+
+
+
+template <unsigned int Scale>
+typename FixedPrecision<Scale>::Value FixedPrecision<Scale>::encode(double x)
+{
+    // Written so that NaN is out of range, too.
+    double scaled = std::round(x * Scale);
+
+    if (!(scaled >= 0 && scaled <= std::numeric_limits<Value>::max()))
+    {
+        throw DigraphException("Value is out of range for fixed precision!\n");
+    }
+
+    return static_cast<Value>(scaled);
+}
+
+
+template <typename Precision>
+CompactRoadMap<Precision>::CompactRoadMap(
+    const RoadMap& roadMap, VertexOrder order, bool compressChains)
+    : nameTable_{roadMap.names()}, compressed_{compressChains}
+{
+    miles_.reserve(roadMap.edgeCount());
+    milesPerHour_.reserve(roadMap.edgeCount());
+    hours_.reserve(roadMap.edgeCount());
+
+    graph_ = CompactDigraph{
+        roadMap,
+        [this](int, const RoadSegment& segment)
+        {
+            miles_.push_back(Precision::encode(segment.miles));
+            milesPerHour_.push_back(Precision::encode(segment.milesPerHour));
+            hours_.push_back(Precision::encode(segment.miles / segment.milesPerHour));
+        },
+        order};
+
+    names_.reserve(graph_.vertexCount());
+
+    for (int i = 0; i < graph_.vertexCount(); ++i)
+    {
+        names_.push_back(roadMap.vertexInfo(graph_.vertexNumber(i)));
+    }
+
+    if (compressed_)
+    {
+        chains_ = ChainCompressedGraph{graph_};
+        chainMiles_ = chains_.template chainWeights<Distance>(miles_.data());
+        chainHours_ = chains_.template chainWeights<Distance>(hours_.data());
+    }
+}
+
+
+template <typename Precision>
+Route CompactRoadMap<Precision>::findRoute(const Trip& trip) const
+{
+    int start = graph_.indexOf(trip.startVertex);
+    int end = graph_.indexOf(trip.endVertex);
+    bool byDistance = trip.metric == TripMetric::Distance;
+
+    if (compressed_)
+    {
+        ChainPath path = chains_.template findShortestPath<Distance>(
+            start, end,
+            byDistance ? chainMiles_.data() : chainHours_.data(),
+            byDistance ? miles_.data() : hours_.data());
+
+        return makeRoute(trip, path.reached, path.edges);
+    }
+
+    CompactSearchResult<Distance> result =
+        graph_.template findShortestPaths<Distance>(
+            start, byDistance ? miles_.data() : hours_.data(), end);
+
+    return makeRoute(
+        trip, result.reached(end),
+        result.reached(end) ? CompactDigraph::pathEdges(result, end) : std::vector<int>{});
+}
+
+
+template <typename Precision>
+Route CompactRoadMap<Precision>::makeRoute(
+    const Trip& trip, bool reachable, const std::vector<int>& path) const
+{
+    Route route{
+        trip, names_[graph_.indexOf(trip.startVertex)],
+        names_[graph_.indexOf(trip.endVertex)], reachable, {}};
+
+    if (!reachable)
+    {
+        return route;
+    }
+
+    route.steps.reserve(path.size());
+
+    double totalMiles = 0;
+    double totalHours = 0;
+
+    for (int e : path)
+    {
+        RoadSegment segment{
+            Precision::decode(miles_[e]), Precision::decode(milesPerHour_[e])};
+
+        totalMiles += segment.miles;
+        totalHours += segment.miles / segment.milesPerHour;
+
+        int w = graph_.target(e);
+        route.steps.push_back(
+            RouteStep{graph_.vertexNumber(w), names_[w], segment, totalMiles, totalHours});
+    }
+
+    return route;
+}
+
+
+template <typename Precision>
+const CompactDigraph& CompactRoadMap<Precision>::graph() const
+{
+    return graph_;
+}
+
+
+template <typename Precision>
+const ChainCompressedGraph& CompactRoadMap<Precision>::chains() const
+{
+    return chains_;
+}
+
+
+template <typename Precision>
+const std::vector<typename CompactRoadMap<Precision>::Value>&
+CompactRoadMap<Precision>::miles() const
+{
+    return miles_;
+}
+
+
+template <typename Precision>
+const std::vector<typename CompactRoadMap<Precision>::Value>&
+CompactRoadMap<Precision>::milesPerHour() const
+{
+    return milesPerHour_;
+}
+
+
+template <typename Precision>
+const std::vector<typename CompactRoadMap<Precision>::Value>&
+CompactRoadMap<Precision>::hours() const
+{
+    return hours_;
+}
+
+
+template <typename Precision>
+MemoryUsage CompactRoadMap<Precision>::memoryUsage() const
+{
+    MemoryUsage usage = graph_.memoryUsage();
+    usage += chains_.memoryUsage();
+
+    usage.vertexInfo += nameTable_->bytesAllocated() + bytesAllocated(names_);
+    usage.edgeInfo += bytesAllocated(miles_) + bytesAllocated(milesPerHour_);
+    usage.caches +=
+        bytesAllocated(hours_) + bytesAllocated(chainMiles_) + bytesAllocated(chainHours_);
+
+    return usage;
+}
+
+
+
+#endif // COMPACTROADMAP_HPP
+
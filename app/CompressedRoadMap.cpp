@@ -0,0 +1,185 @@
+// CompressedRoadMap.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "CompressedRoadMap.hpp"
+
+
+namespace
+{
+    const double milesScale = 1000.0;
+    const double milesPerHourScale = 10.0;
+
+
+    // scaled() returns the given value in units of 1 / scale, rounded to
+    // the nearest, or throws a DigraphException if that's negative or too
+    // large to be stored in 32 bits.
+    std::uint32_t scaled(double value, double scale)
+    {
+        // Written so that NaN is out of range, too.
+        double units = std::round(value * scale);
+
+        if (!(units >= 0 && units <= std::numeric_limits<std::uint32_t>::max()))
+        {
+            throw DigraphException("Road segment is out of range for compression!\n");
+        }
+
+        return static_cast<std::uint32_t>(units);
+    }
+}
+
+
+CompressedRoadMap::CompressedRoadMap(const RoadMap& roadMap, VertexOrder order)
+    : nameTable_{roadMap.names()}
+{
+    // The road segments are needed by edge index while the graph is being
+    // encoded, so they're collected as the structure is first copied.
+    std::vector<Graph::Payload> payloads;
+    payloads.reserve(roadMap.edgeCount());
+
+    CompactDigraph compact{
+        roadMap,
+        [&](int, const RoadSegment& segment) { payloads.push_back(encode(segment)); },
+        order};
+
+    graph_ = Graph{compact, [&](int edge) { return payloads[edge]; }};
+
+    names_.reserve(graph_.vertexCount());
+
+    for (int i = 0; i < graph_.vertexCount(); ++i)
+    {
+        names_.push_back(roadMap.vertexInfo(graph_.vertexNumber(i)));
+    }
+}
+
+
+Route CompressedRoadMap::findRoute(const Trip& trip) const
+{
+    int start = graph_.indexOf(trip.startVertex);
+    int end = graph_.indexOf(trip.endVertex);
+
+    Route route{trip, names_[start], names_[end], true, {}};
+
+    CompactSearchResult<double> result = graph_.findShortestPaths<double>(
+        start,
+        [&trip](const Graph::Payload& payload)
+        {
+            RoadSegment segment = decode(payload);
+            return trip.metric == TripMetric::Distance
+                ? segment.miles : segment.miles / segment.milesPerHour;
+        },
+        end);
+
+    if (!result.reached(end))
+    {
+        route.reachable = false;
+        return route;
+    }
+
+    std::vector<int> path;
+
+    for (int v = end; v != start; v = result.previousVertex[v])
+    {
+        path.push_back(v);
+    }
+
+    double totalMiles = 0;
+    double totalHours = 0;
+    int v = start;
+
+    for (auto w = path.rbegin(); w != path.rend(); ++w)
+    {
+        // The road segment is found again by decoding the previous
+        // vertex's edges up to the one the search used.
+        Graph::EdgeReader reader = graph_.edges(v);
+        int target;
+        Graph::Payload payload;
+
+        for (int position = 0; position <= result.previousEdge[*w]; ++position)
+        {
+            reader.next(target, payload);
+        }
+
+        RoadSegment segment = decode(payload);
+        totalMiles += segment.miles;
+        totalHours += segment.miles / segment.milesPerHour;
+
+        route.steps.push_back(
+            RouteStep{graph_.vertexNumber(*w), names_[*w], segment, totalMiles, totalHours});
+        v = *w;
+    }
+
+    return route;
+}
+
+
+RoadMap CompressedRoadMap::decompress() const
+{
+    RoadMap roadMap;
+
+    std::size_t nameBytes = 0;
+
+    for (std::string_view name : names_)
+    {
+        nameBytes += name.size();
+    }
+
+    roadMap.reserveNames(nameBytes);
+
+    for (int i = 0; i < graph_.vertexCount(); ++i)
+    {
+        roadMap.addLocation(graph_.vertexNumber(i), names_[i]);
+    }
+
+    for (int i = 0; i < graph_.vertexCount(); ++i)
+    {
+        Graph::EdgeReader reader = graph_.edges(i);
+        int target;
+        Graph::Payload payload;
+
+        while (reader.next(target, payload))
+        {
+            roadMap.addEdge(graph_.vertexNumber(i), graph_.vertexNumber(target), decode(payload));
+        }
+    }
+
+    return roadMap;
+}
+
+
+const CompressedRoadMap::Graph& CompressedRoadMap::graph() const
+{
+    return graph_;
+}
+
+
+std::size_t CompressedRoadMap::bytes() const
+{
+    return graph_.bytes() + names_.capacity() * sizeof(std::string_view);
+}
+
+
+MemoryUsage CompressedRoadMap::memoryUsage() const
+{
+    MemoryUsage usage = graph_.memoryUsage();
+    usage.vertexInfo += nameTable_->bytesAllocated() + bytesAllocated(names_);
+    return usage;
+}
+
+
+CompressedRoadMap::Graph::Payload CompressedRoadMap::encode(const RoadSegment& segment)
+{
+    return Graph::Payload{
+        scaled(segment.miles, milesScale), scaled(segment.milesPerHour, milesPerHourScale)};
+}
+
+
+RoadSegment CompressedRoadMap::decode(const Graph::Payload& payload)
+{
+    return RoadSegment{payload[0] / milesScale, payload[1] / milesPerHourScale};
+}
+
@@ -0,0 +1,88 @@
+// CompressedRoadMap.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A CompressedRoadMap is a read-only copy of a RoadMap meant for maps that
+// are kept in memory but seldom searched.  Its structure is stored in a
+// VarintDigraph, and each road segment's distance and speed are rounded to
+// the nearest thousandth of a mile and tenth of a mile per hour and stored
+// as variable-length integers along with it, so a typical road segment
+// takes about five or six bytes rather than the dozens a RoadMap uses.
+// Road segments are decoded as they're searched.
+//
+// Since distances and speeds are rounded, routes between places whose
+// shortest routes are (nearly) tied can differ from a RoadMap's, and
+// distances and speeds are reported as their rounded values.  When a map
+// becomes busy, decompress() turns it back into a RoadMap, from which the
+// faster structures (such as a CompactRoadMap) can be built.
+//
+// Like a CompactRoadMap, a CompressedRoadMap holds on to the RoadMap's
+// LocationNames table, so the RoadMap itself can be discarded.
+
+#ifndef COMPRESSEDROADMAP_HPP
+#define COMPRESSEDROADMAP_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "RoadMap.hpp"
+#include "RoadSegment.hpp"
+#include "Route.hpp"
+#include "Trip.hpp"
+#include "VarintDigraph.hpp"
+
+
+
+class CompressedRoadMap
+{
+public:
+    // Each road segment is stored as two fields: miles and miles per hour.
+    typedef VarintDigraph<2> Graph;
+
+    // Initializes a CompressedRoadMap as a copy of the given RoadMap, with
+    // its vertices stored in the given order.  The breadth-first orders
+    // make the differences between neighboring indexes, and so the map,
+    // smallest.  If a road segment can't be stored (see encode()), a
+    // DigraphException is thrown.
+    explicit CompressedRoadMap(
+        const RoadMap& roadMap, VertexOrder order = VertexOrder::BreadthFirst);
+
+    // findRoute() finds the shortest route for the given trip, in the
+    // same form as RouteFinder::findRoute().  If either of the trip's
+    // vertices does not exist, a DigraphException is thrown.
+    Route findRoute(const Trip& trip) const;
+
+    // decompress() returns a RoadMap with the same locations and (rounded)
+    // road segments as this map.
+    RoadMap decompress() const;
+
+    // graph() returns the structure of the map.
+    const Graph& graph() const;
+
+    // bytes() returns the number of bytes used to store the map, not
+    // counting the name table it shares with the RoadMap.
+    std::size_t bytes() const;
+
+    // memoryUsage() returns the memory allocated for the map by category,
+    // including the name table.
+    MemoryUsage memoryUsage() const;
+
+    // encode() and decode() convert a road segment to and from the
+    // payload stored for it in the graph.  If the segment's distance or
+    // speed is negative, or too large to be stored, encode() throws a
+    // DigraphException.
+    static Graph::Payload encode(const RoadSegment& segment);
+    static RoadSegment decode(const Graph::Payload& payload);
+
+private:
+    Graph graph_;
+    std::shared_ptr<const LocationNames> nameTable_;
+    std::vector<std::string_view> names_;
+};
+
+
+
+#endif // COMPRESSEDROADMAP_HPP
+
@@ -0,0 +1,96 @@
+// FdStreamBuf.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "FdStreamBuf.hpp"
+
+
+FdStreamBuf::FdStreamBuf(int fd)
+    : fd_{fd}
+{
+    setg(input_, input_, input_);
+    setp(output_, output_ + bufferSize);
+}
+
+
+FdStreamBuf::~FdStreamBuf()
+{
+    sync();
+}
+
+
+FdStreamBuf::int_type FdStreamBuf::underflow()
+{
+    ssize_t count;
+
+    do
+    {
+        count = ::read(fd_, input_, bufferSize);
+    }
+    while (count < 0 && errno == EINTR);
+
+    if (count <= 0)
+    {
+        return traits_type::eof();
+    }
+
+    setg(input_, input_, input_ + count);
+    return traits_type::to_int_type(*gptr());
+}
+
+
+FdStreamBuf::int_type FdStreamBuf::overflow(int_type c)
+{
+    if (sync() != 0)
+    {
+        return traits_type::eof();
+    }
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+
+int FdStreamBuf::sync()
+{
+    bool written = writeAll(pbase(), pptr() - pbase());
+    setp(output_, output_ + bufferSize);
+    return written ? 0 : -1;
+}
+
+
+bool FdStreamBuf::writeAll(const char* bytes, std::size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t count = ::send(fd_, bytes, size, MSG_NOSIGNAL);
+
+        if (count < 0 && errno == ENOTSOCK)
+        {
+            count = ::write(fd_, bytes, size);
+        }
+
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (count <= 0)
+        {
+            return false;
+        }
+
+        bytes += count;
+        size -= count;
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+// FdStreamBuf.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// An FdStreamBuf is a stream buffer that reads from and writes to a POSIX
+// file descriptor, such as a connected socket, so that an istream and an
+// ostream can be used to talk over it.  Reading and writing are buffered
+// separately, so one thread can read while another writes.  Writing to a
+// socket whose other end has gone away fails, rather than raising SIGPIPE.
+// The FdStreamBuf doesn't close the file descriptor.
+
+#ifndef FDSTREAMBUF_HPP
+#define FDSTREAMBUF_HPP
+
+#include <cstddef>
+#include <streambuf>
+
+
+
+class FdStreamBuf : public std::streambuf
+{
+public:
+    explicit FdStreamBuf(int fd);
+
+    // The destructor writes any output that is still buffered.
+    ~FdStreamBuf() override;
+
+    FdStreamBuf(const FdStreamBuf&) = delete;
+    FdStreamBuf& operator=(const FdStreamBuf&) = delete;
+
+protected:
+    int_type underflow() override;
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+private:
+    // writeAll() writes the given bytes, returning false if it can't.
+    bool writeAll(const char* bytes, std::size_t size);
+
+    static constexpr std::size_t bufferSize = 4096;
+
+    int fd_;
+    char input_[bufferSize];
+    char output_[bufferSize];
+};
+
+
+
+#endif // FDSTREAMBUF_HPP
@@ -0,0 +1,53 @@
+// HubLabelRoadMap.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <limits>
+#include "HubLabelRoadMap.hpp"
+
+
+HubLabelRoadMap::HubLabelRoadMap(
+    const RoadMap& roadMap, VertexOrder order, unsigned int threads)
+    : map_{roadMap, order},
+      distance_{map_.graph(), map_.miles().data(), threads},
+      time_{map_.graph(), map_.hours().data(), threads}
+{
+}
+
+
+Route HubLabelRoadMap::findRoute(const Trip& trip) const
+{
+    const CompactDigraph& graph = map_.graph();
+
+    HubLabelPath<double> path = labelsFor(trip).findShortestPath(
+        graph.indexOf(trip.startVertex), graph.indexOf(trip.endVertex));
+
+    return map_.makeRoute(trip, path.reached, path.edges);
+}
+
+
+double HubLabelRoadMap::findWeight(const Trip& trip) const
+{
+    const CompactDigraph& graph = map_.graph();
+
+    double weight = labelsFor(trip).distance(
+        graph.indexOf(trip.startVertex), graph.indexOf(trip.endVertex));
+
+    return weight == std::numeric_limits<double>::max() ? -1.0 : weight;
+}
+
+
+MemoryUsage HubLabelRoadMap::memoryUsage() const
+{
+    MemoryUsage usage = map_.memoryUsage();
+    usage += distance_.memoryUsage();
+    usage += time_.memoryUsage();
+    return usage;
+}
+
+
+const HubLabels<double>& HubLabelRoadMap::labelsFor(const Trip& trip) const
+{
+    return trip.metric == TripMetric::Distance ? distance_ : time_;
+}
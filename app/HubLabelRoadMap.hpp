@@ -0,0 +1,72 @@
+// HubLabelRoadMap.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A HubLabelRoadMap is a read-only copy of a RoadMap that finds routes
+// using HubLabels (see HubLabels.hpp), one set for distance and one for
+// driving time.  Building the labels takes far longer than building an
+// OverlayRoadMap, but once they're built, finding the weight of a route
+// takes well under a microsecond, and finding the route itself only as
+// long as it takes to follow its road segments.  It's the best choice for
+// a long-running program, such as a TripServer, that answers many trips
+// on a map that doesn't change.
+//
+// The road segments are stored as in a CompactRoadMap<DoublePrecision>,
+// and routes are described in the same way, with the same weights.  Where
+// two routes are (almost exactly) tied, the route found can differ from
+// the one found by a RouteFinder.
+
+#ifndef HUBLABELROADMAP_HPP
+#define HUBLABELROADMAP_HPP
+
+#include <thread>
+#include "CompactRoadMap.hpp"
+#include "HubLabels.hpp"
+#include "RoadMap.hpp"
+#include "Route.hpp"
+#include "Trip.hpp"
+
+
+
+class HubLabelRoadMap
+{
+public:
+    // Initializes a HubLabelRoadMap as a copy of the given RoadMap, with
+    // its vertices stored in the given order, and builds its labels using
+    // the given number of threads.
+    explicit HubLabelRoadMap(
+        const RoadMap& roadMap, VertexOrder order = VertexOrder::Number,
+        unsigned int threads = std::thread::hardware_concurrency());
+
+    // A HubLabelRoadMap's labels refer to its own storage, so it can't be
+    // copied.
+    HubLabelRoadMap(const HubLabelRoadMap&) = delete;
+    HubLabelRoadMap& operator=(const HubLabelRoadMap&) = delete;
+
+    // findRoute() finds the shortest route for the given trip, in the
+    // same form as RouteFinder::findRoute().  If either of the trip's
+    // vertices does not exist, a DigraphException is thrown.
+    Route findRoute(const Trip& trip) const;
+
+    // findWeight() returns the weight of the shortest route for the given
+    // trip (in miles or hours, according to its metric) without finding
+    // the route, or a negative number if there is none.  If either of the
+    // trip's vertices does not exist, a DigraphException is thrown.
+    double findWeight(const Trip& trip) const;
+
+    // memoryUsage() returns the memory allocated for the map and both sets
+    // of labels, including the name table.
+    MemoryUsage memoryUsage() const;
+
+private:
+    const HubLabels<double>& labelsFor(const Trip& trip) const;
+
+    CompactRoadMap<DoublePrecision> map_;
+    HubLabels<double> distance_;
+    HubLabels<double> time_;
+};
+
+
+
+#endif // HUBLABELROADMAP_HPP
@@ -3,6 +3,7 @@
 // ICS 46 Spring 2018
 // Project #5: Rock and Roll Stops the Traffic
 
+#include <stdexcept>
 #include "InputReader.hpp"
 
 
@@ -31,16 +32,28 @@ std::string InputReader::readLine()
 {
     std::string line;
 
-    while (true)
+    if (!tryReadLine(line))
+    {
+        throw std::runtime_error{"Unexpected end of input"};
+    }
+
+    return line;
+}
+
+
+bool InputReader::tryReadLine(std::string& line)
+{
+    while (std::getline(in_, line))
     {
-        std::getline(in_, line);
         trimRight(line);
 
         if (line.length() > 0 && line[0] != '#')
         {
-            return line;
+            return true;
         }
     }
+
+    return false;
 }
 
 
@@ -25,9 +25,15 @@ public:
     InputReader(std::istream& in): in_{in} { }
 
     // readLine() reads a line of input from the input stream associated
-    // with this InputReader, skipping non-meaningful lines.
+    // with this InputReader, skipping non-meaningful lines.  If the input
+    // ends first, a std::runtime_error is thrown.
     std::string readLine();
 
+    // tryReadLine() is the same, except that it stores the line into the
+    // given string and returns true, or returns false if the input ends
+    // first, for callers that read until the end of the input.
+    bool tryReadLine(std::string& line);
+
     // readLineInt() reads a line of input from the input stream associated
     // with this InputReader, assuming that the line of input contains an
     // integer value (e.g., "7").
@@ -0,0 +1,220 @@
+// LocationNames.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include "LocationNames.hpp"
+
+
+namespace
+{
+    const std::size_t minimumBlockSize = 4096;
+    const std::size_t minimumIndexSize = 16;
+}
+
+
+LocationNames::LocationNames()
+    : bytesAllocated_{0}, bytesStored_{0}
+{
+}
+
+
+void LocationNames::reserve(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    if (!blocks_.empty() && blocks_.back().capacity - blocks_.back().used >= bytes)
+    {
+        return;
+    }
+
+    blocks_.push_back(Block{std::make_unique<char[]>(bytes), bytes, 0});
+    bytesAllocated_ += bytes;
+}
+
+
+std::string_view LocationNames::store(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    if (blocks_.empty() || blocks_.back().capacity - blocks_.back().used < name.size())
+    {
+        // Each new block is at least as big as everything stored so far,
+        // so the number of blocks grows only logarithmically.
+        std::size_t capacity = std::max({minimumBlockSize, bytesAllocated_, name.size()});
+        blocks_.push_back(Block{std::make_unique<char[]>(capacity), capacity, 0});
+        bytesAllocated_ += capacity;
+    }
+
+    Block& block = blocks_.back();
+    char* stored = block.chars.get() + block.used;
+
+    std::memcpy(stored, name.data(), name.size());
+    block.used += name.size();
+    bytesStored_ += name.size();
+
+    return std::string_view{stored, name.size()};
+}
+
+
+std::size_t LocationNames::bytesAllocated() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return bytesAllocated_;
+}
+
+
+std::size_t LocationNames::bytesStored() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return bytesStored_;
+}
+
+
+LocationIndex::LocationIndex()
+    : count_{0}
+{
+}
+
+
+void LocationIndex::insert(std::string_view name, int vertex)
+{
+    // A null pointer marks an empty slot, so an empty name must not be one.
+    if (name.data() == nullptr)
+    {
+        name = std::string_view{""};
+    }
+
+    // The table is kept at most half full, so probe sequences stay short.
+    if (2 * (count_ + 1) > slots_.size())
+    {
+        grow();
+    }
+
+    // A name is in the index once for each of its vertices, so the new
+    // one goes in the first empty slot, wherever the name is already.
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = home(name);
+
+    while (slots_[i].name != nullptr)
+    {
+        i = (i + 1) & mask;
+    }
+
+    slots_[i] = Slot{name.data(), name.size(), vertex};
+    ++count_;
+}
+
+
+void LocationIndex::erase(std::string_view name, int vertex)
+{
+    if (name.data() == nullptr)
+    {
+        name = std::string_view{""};
+    }
+
+    if (slots_.empty())
+    {
+        return;
+    }
+
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = findSlot(name, &vertex);
+
+    if (slots_[i].name == nullptr)
+    {
+        return;
+    }
+
+    // There are no markers for removed slots; instead, the slots after
+    // the one emptied are moved back into it wherever their probe
+    // sequences would otherwise pass over it.
+    for (std::size_t j = (i + 1) & mask; slots_[j].name != nullptr; j = (j + 1) & mask)
+    {
+        std::size_t k = home(std::string_view{slots_[j].name, slots_[j].length});
+
+        if (((j - k) & mask) >= ((j - i) & mask))
+        {
+            slots_[i] = slots_[j];
+            i = j;
+        }
+    }
+
+    slots_[i] = Slot{nullptr, 0, 0};
+    --count_;
+}
+
+
+std::optional<int> LocationIndex::find(std::string_view name) const
+{
+    if (slots_.empty())
+    {
+        return std::nullopt;
+    }
+
+    const Slot& slot = slots_[findSlot(name)];
+
+    if (slot.name == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    return slot.vertex;
+}
+
+
+std::size_t LocationIndex::bytesAllocated() const
+{
+    return slots_.capacity() * sizeof(Slot);
+}
+
+
+std::size_t LocationIndex::home(std::string_view name) const
+{
+    return std::hash<std::string_view>{}(name) & (slots_.size() - 1);
+}
+
+
+std::size_t LocationIndex::findSlot(std::string_view name, const int* vertex) const
+{
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = home(name);
+
+    while (slots_[i].name != nullptr
+           && (std::string_view{slots_[i].name, slots_[i].length} != name
+               || (vertex != nullptr && slots_[i].vertex != *vertex)))
+    {
+        i = (i + 1) & mask;
+    }
+
+    return i;
+}
+
+
+void LocationIndex::grow()
+{
+    std::vector<Slot> old = std::move(slots_);
+
+    slots_.assign(std::max(minimumIndexSize, 2 * old.size()), Slot{nullptr, 0, 0});
+
+    std::size_t mask = slots_.size() - 1;
+
+    for (const Slot& slot : old)
+    {
+        if (slot.name != nullptr)
+        {
+            std::size_t i = home(std::string_view{slot.name, slot.length});
+
+            while (slots_[i].name != nullptr)
+            {
+                i = (i + 1) & mask;
+            }
+
+            slots_[i] = slot;
+        }
+    }
+}
+
@@ -0,0 +1,114 @@
+// LocationNames.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header declares the two pieces a RoadMap uses to store the names
+// of its locations compactly.
+//
+// A LocationNames object stores the characters of every name in large
+// contiguous blocks (one block, when the number of bytes is known ahead of
+// time, as it is when a map is read) and hands out std::string_views of the
+// stored copies.  Names are never moved or removed once stored, so those
+// views remain valid for as long as the LocationNames object exists; the
+// names that are no longer needed can only be dropped by storing the rest
+// in a new LocationNames object.
+//
+// A LocationIndex is an open-addressing hash table from names to vertex
+// numbers, so that a location can be found by name without a search
+// through every vertex.  It holds every vertex with each name, so that it
+// stays exact as locations are added and removed.  The names it holds are
+// views, normally of names stored in a LocationNames object.
+
+#ifndef LOCATIONNAMES_HPP
+#define LOCATIONNAMES_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+
+
+class LocationNames
+{
+public:
+    // Initializes an empty LocationNames object.
+    LocationNames();
+
+    // reserve() makes sure that at least the given number of bytes of
+    // names can be stored without allocating another block.
+    void reserve(std::size_t bytes);
+
+    // store() stores a copy of the given name and returns a view of it.
+    // It is safe to call store() from several threads at once.
+    std::string_view store(std::string_view name);
+
+    // bytesAllocated() returns the total size of the blocks allocated
+    // to hold names, and bytesStored() the total size of the names stored
+    // in them.
+    std::size_t bytesAllocated() const;
+    std::size_t bytesStored() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<char[]> chars;
+        std::size_t capacity;
+        std::size_t used;
+    };
+
+    std::vector<Block> blocks_;
+    std::size_t bytesAllocated_;
+    std::size_t bytesStored_;
+    mutable std::mutex mutex_;
+};
+
+
+
+class LocationIndex
+{
+public:
+    // Initializes an empty LocationIndex.
+    LocationIndex();
+
+    // insert() associates the given name with the given vertex number,
+    // along with any other vertex numbers it's associated with already.
+    void insert(std::string_view name, int vertex);
+
+    // erase() removes the association between the given name and the
+    // given vertex number, if there is one.
+    void erase(std::string_view name, int vertex);
+
+    // find() returns a vertex number associated with the given name, or
+    // std::nullopt if there is none.
+    std::optional<int> find(std::string_view name) const;
+
+    // bytesAllocated() returns the size of the hash table.
+    std::size_t bytesAllocated() const;
+
+private:
+    struct Slot
+    {
+        const char* name;
+        std::size_t length;
+        int vertex;
+    };
+
+    // home() returns the slot where the probe sequence for the given name
+    // begins, and findSlot() the first slot in it that is either empty or
+    // holds the given name (and, if one is given, the given vertex).
+    std::size_t home(std::string_view name) const;
+    std::size_t findSlot(std::string_view name, const int* vertex = nullptr) const;
+    void grow();
+
+    std::vector<Slot> slots_;
+    std::size_t count_;
+};
+
+
+
+#endif // LOCATIONNAMES_HPP
+
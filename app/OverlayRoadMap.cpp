@@ -0,0 +1,211 @@
+// OverlayRoadMap.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <utility>
+#include <vector>
+#include "OverlayRoadMap.hpp"
+#include "RouteFinder.hpp"
+
+
+namespace
+{
+    // The largest number of vertices in a cell at each level of the
+    // overlay.  Changing them changes the ContentHash, so artifact files
+    // written with other sizes are stale.
+    const std::vector<int> cellSizes{256, 4096};
+
+
+    std::string levelSection(const std::string& prefix, int level)
+    {
+        return prefix + "." + std::to_string(level);
+    }
+}
+
+
+OverlayRoadMap::OverlayRoadMap(
+    const RoadMap& roadMap, VertexOrder order, const std::string& artifactPath)
+    : map_{roadMap, order},
+      artifacts_{openArtifacts(artifactPath)},
+      loadedArtifacts_{artifacts_ != nullptr},
+      overlay_{artifacts_ ? loadOverlay() : RouteOverlay{map_.graph(), cellSizes}}
+{
+    if (loadedArtifacts_)
+    {
+        distance_ = loadMetric("distance");
+        time_ = loadMetric("time");
+        artifacts_.reset();
+    }
+    else
+    {
+        distance_ = customize(DistFunc);
+        time_ = customize(TimeFunc);
+
+        if (!artifactPath.empty())
+        {
+            writeArtifacts(artifactPath);
+        }
+    }
+}
+
+
+OverlayMetric OverlayRoadMap::customize(
+    const std::function<double(const RoadSegment&)>& weight) const
+{
+    std::vector<double> weights;
+    weights.reserve(map_.graph().edgeCount());
+
+    for (int e = 0; e < map_.graph().edgeCount(); ++e)
+    {
+        weights.push_back(weight(RoadSegment{map_.miles()[e], map_.milesPerHour()[e]}));
+    }
+
+    return overlay_.customize(std::move(weights));
+}
+
+
+Route OverlayRoadMap::findRoute(const Trip& trip) const
+{
+    return findRoute(trip, trip.metric == TripMetric::Distance ? distance_ : time_);
+}
+
+
+Route OverlayRoadMap::findRoute(const Trip& trip, const OverlayMetric& metric) const
+{
+    OverlayPath path = overlay_.findShortestPath(
+        metric, map_.graph().indexOf(trip.startVertex), map_.graph().indexOf(trip.endVertex));
+
+    return map_.makeRoute(trip, path.reached, path.edges);
+}
+
+
+MemoryUsage OverlayRoadMap::memoryUsage() const
+{
+    MemoryUsage usage = map_.memoryUsage();
+    usage += overlay_.memoryUsage();
+    usage += RouteOverlay::memoryUsage(distance_);
+    usage += RouteOverlay::memoryUsage(time_);
+    return usage;
+}
+
+
+bool OverlayRoadMap::loadedArtifacts() const noexcept
+{
+    return loadedArtifacts_;
+}
+
+
+void OverlayRoadMap::writeArtifacts(const std::string& path) const
+{
+    ArtifactWriter writer;
+    writer.addSection("levels", std::vector<int>{overlay_.levelCount()});
+
+    for (int level = 0; level < overlay_.levelCount(); ++level)
+    {
+        writer.addSection(levelSection("partition", level), overlay_.partition(level));
+    }
+
+    for (auto [name, metric] :
+             {std::make_pair("distance", &distance_), std::make_pair("time", &time_)})
+    {
+        writer.addSection(std::string{name} + ".edges", metric->weights);
+
+        for (int level = 0; level < overlay_.levelCount(); ++level)
+        {
+            writer.addSection(levelSection(name, level), metric->cellWeights[level]);
+        }
+    }
+
+    writer.write(path, contentHash());
+}
+
+
+std::uint64_t OverlayRoadMap::contentHash() const
+{
+    const CompactDigraph& graph = map_.graph();
+    ContentHash hash;
+
+    hash.add(graph.vertexCount());
+
+    for (int v = 0; v < graph.vertexCount(); ++v)
+    {
+        hash.add(graph.vertexNumber(v));
+        hash.add(graph.edgeEnd(v));
+    }
+
+    for (int e = 0; e < graph.edgeCount(); ++e)
+    {
+        hash.add(graph.target(e));
+    }
+
+    hash.add(map_.miles());
+    hash.add(map_.milesPerHour());
+    hash.add(cellSizes);
+
+    return hash.value();
+}
+
+
+std::unique_ptr<ArtifactFile> OverlayRoadMap::openArtifacts(const std::string& path) const
+{
+    if (path.empty())
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        return std::make_unique<ArtifactFile>(path, contentHash());
+    }
+    catch (DigraphException&)
+    {
+        // Whatever is wrong with the file, the overlay is built instead,
+        // and the file is replaced.
+        return nullptr;
+    }
+}
+
+
+RouteOverlay OverlayRoadMap::loadOverlay() const
+{
+    ArtifactSection<int> levels = artifacts_->section<int>("levels");
+
+    if (levels.size != 1)
+    {
+        throw DigraphException("Artifact file does not match map!\n");
+    }
+
+    std::vector<std::vector<int>> partition;
+
+    for (int level = 0; level < levels[0]; ++level)
+    {
+        partition.push_back(artifacts_->copySection<int>(levelSection("partition", level)));
+    }
+
+    return RouteOverlay{map_.graph(), partition};
+}
+
+
+OverlayMetric OverlayRoadMap::loadMetric(const std::string& name) const
+{
+    OverlayMetric metric;
+    metric.weights = artifacts_->copySection<double>(name + ".edges");
+
+    if (static_cast<int>(metric.weights.size()) != map_.graph().edgeCount())
+    {
+        throw DigraphException("Artifact file does not match map!\n");
+    }
+
+    for (int level = 0; level < overlay_.levelCount(); ++level)
+    {
+        metric.cellWeights.push_back(artifacts_->copySection<double>(levelSection(name, level)));
+
+        if (static_cast<int>(metric.cellWeights.back().size()) != overlay_.weightCount(level))
+        {
+            throw DigraphException("Artifact file does not match map!\n");
+        }
+    }
+
+    return metric;
+}
@@ -0,0 +1,118 @@
+// OverlayRoadMap.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// An OverlayRoadMap is a read-only copy of a RoadMap that finds routes
+// using a RouteOverlay (see RouteOverlay.hpp).  The overlay is built once,
+// from the structure of the map alone, and then customized for each way of
+// weighing road segments: distance and driving time when the OverlayRoadMap
+// is built, and any other weight function (e.g., one giving the driving
+// time for a truck, or one adjusted for congestion) with customize().
+// Customizing takes far less time than building the overlay, and uses
+// every hardware thread.
+//
+// Building the overlay and customizing it still take far longer than
+// reading the map, so an OverlayRoadMap can save them in an artifact file
+// (see ArtifactFile.hpp) and load them from it the next time it's built
+// from the same map, in the same order.  The file's ContentHash covers
+// the structure of the map and its road segments, but not the names of
+// its locations, which the overlay doesn't depend on; if the map has
+// changed in any other way, the file is stale and the overlay is built
+// (and the file written) again.
+//
+// The road segments are stored as in a CompactRoadMap<DoublePrecision>,
+// and routes are described in the same way, with the same weights.  Where
+// two routes are (almost exactly) tied, the route found can differ from
+// the one found by a RouteFinder.
+
+#ifndef OVERLAYROADMAP_HPP
+#define OVERLAYROADMAP_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "ArtifactFile.hpp"
+#include "CompactRoadMap.hpp"
+#include "RoadMap.hpp"
+#include "RoadSegment.hpp"
+#include "Route.hpp"
+#include "RouteOverlay.hpp"
+#include "Trip.hpp"
+
+
+
+class OverlayRoadMap
+{
+public:
+    // Initializes an OverlayRoadMap as a copy of the given RoadMap, with
+    // its vertices stored in the given order, and customizes it for both
+    // kinds of TripMetric.  If the path of an artifact file is given, the
+    // overlay and both customizations are loaded from it if it holds them
+    // for this map, and otherwise they're built and then written to it.
+    explicit OverlayRoadMap(
+        const RoadMap& roadMap, VertexOrder order = VertexOrder::BreadthFirst,
+        const std::string& artifactPath = "");
+
+    // An OverlayRoadMap's overlay refers to its own storage, so it can't
+    // be copied.
+    OverlayRoadMap(const OverlayRoadMap&) = delete;
+    OverlayRoadMap& operator=(const OverlayRoadMap&) = delete;
+
+    // customize() returns the OverlayMetric in which the weight of each
+    // road segment is given by the given function.
+    OverlayMetric customize(const std::function<double(const RoadSegment&)>& weight) const;
+
+    // findRoute() finds the shortest route for the given trip, in the
+    // same form as RouteFinder::findRoute(), weighing road segments by
+    // the trip's metric.  The second form weighs them using the given
+    // OverlayMetric instead.  If either of the trip's vertices does not
+    // exist, a DigraphException is thrown.
+    Route findRoute(const Trip& trip) const;
+    Route findRoute(const Trip& trip, const OverlayMetric& metric) const;
+
+    // memoryUsage() returns the memory allocated for the map, the overlay,
+    // and both customizations, including the name table.
+    MemoryUsage memoryUsage() const;
+
+    // loadedArtifacts() returns true if the overlay was loaded from an
+    // artifact file rather than built.
+    bool loadedArtifacts() const noexcept;
+
+    // writeArtifacts() writes the overlay and both customizations to an
+    // artifact file with the given path.  If the file can't be written, a
+    // DigraphException is thrown.
+    void writeArtifacts(const std::string& path) const;
+
+private:
+    // contentHash() returns the ContentHash of everything the overlay and
+    // its customizations depend on.
+    std::uint64_t contentHash() const;
+
+    // openArtifacts() opens the artifact file with the given path, or
+    // returns null if there is none or it doesn't hold artifacts for this
+    // map.
+    std::unique_ptr<ArtifactFile> openArtifacts(const std::string& path) const;
+
+    // loadOverlay() and loadMetric() load the overlay and the named
+    // customization from the open artifact file.
+    RouteOverlay loadOverlay() const;
+    OverlayMetric loadMetric(const std::string& name) const;
+
+    CompactRoadMap<DoublePrecision> map_;
+
+    // The artifact file, which is only open while the OverlayRoadMap is
+    // being built.
+    std::unique_ptr<ArtifactFile> artifacts_;
+    bool loadedArtifacts_;
+
+    RouteOverlay overlay_;
+    OverlayMetric distance_;
+    OverlayMetric time_;
+};
+
+
+
+#endif // OVERLAYROADMAP_HPP
+
@@ -0,0 +1,118 @@
+// QueryStats.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include <cmath>
+#include "QueryStats.hpp"
+
+
+namespace
+{
+    const char* const phaseNames[] = {"parse", "build", "search", "render"};
+
+
+    double toSeconds(std::chrono::nanoseconds elapsed)
+    {
+        return std::chrono::duration<double>(elapsed).count();
+    }
+}
+
+
+QueryStats::Timer::Timer(QueryStats* stats, Phase phase, bool isSearch)
+    : stats_{stats}, phase_{phase}, isSearch_{isSearch}
+{
+    if (stats_ != nullptr)
+    {
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+
+QueryStats::Timer::~Timer()
+{
+    if (stats_ == nullptr)
+    {
+        return;
+    }
+
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start_;
+
+    stats_->add(phase_, elapsed);
+
+    if (isSearch_)
+    {
+        stats_->addSearch(elapsed);
+    }
+}
+
+
+QueryStats::QueryStats()
+    : searches_{0}, searchSeconds_{0}, searchSquaredSeconds_{0},
+      minSearchSeconds_{0}, maxSearchSeconds_{0}
+{
+    for (std::atomic<std::int64_t>& nanoseconds : phaseNanoseconds_)
+    {
+        nanoseconds = 0;
+    }
+}
+
+
+void QueryStats::add(Phase phase, std::chrono::nanoseconds elapsed)
+{
+    phaseNanoseconds_[static_cast<int>(phase)] += elapsed.count();
+}
+
+
+void QueryStats::addSearch(std::chrono::nanoseconds elapsed)
+{
+    double seconds = toSeconds(elapsed);
+
+    std::lock_guard<std::mutex> lock{searchMutex_};
+
+    minSearchSeconds_ = searches_ == 0 ? seconds : std::min(minSearchSeconds_, seconds);
+    maxSearchSeconds_ = std::max(maxSearchSeconds_, seconds);
+    searchSeconds_ += seconds;
+    searchSquaredSeconds_ += seconds * seconds;
+    ++searches_;
+}
+
+
+void QueryStats::writeJson(std::ostream& out, const DigraphStats& counters) const
+{
+    out << "{\n  \"phaseSeconds\": {";
+
+    for (int i = 0; i < phases; ++i)
+    {
+        out << (i > 0 ? ", " : "") << '"' << phaseNames[i] << "\": "
+            << toSeconds(std::chrono::nanoseconds{phaseNanoseconds_[i].load()});
+    }
+
+    std::lock_guard<std::mutex> lock{searchMutex_};
+
+    double mean = searches_ > 0 ? searchSeconds_ / searches_ : 0.0;
+    double variance = searches_ > 0 ? searchSquaredSeconds_ / searches_ - mean * mean : 0.0;
+
+    out << "},\n  \"searches\": {"
+        << "\"count\": " << searches_
+        << ", \"meanSeconds\": " << mean
+        << ", \"stddevSeconds\": " << std::sqrt(std::max(variance, 0.0))
+        << ", \"minSeconds\": " << minSearchSeconds_
+        << ", \"maxSeconds\": " << maxSearchSeconds_
+        << "},\n  \"counters\": {"
+#ifdef DIGRAPH_STATS
+        << "\"enabled\": true"
+#else
+        << "\"enabled\": false"
+#endif
+        << ", \"verticesSettled\": " << counters.verticesSettled
+        << ", \"edgesRelaxed\": " << counters.edgesRelaxed
+        << ", \"heapPushes\": " << counters.heapPushes
+        << ", \"heapPops\": " << counters.heapPops
+        << ", \"stalePops\": " << counters.stalePops
+        << ", \"allocations\": " << counters.allocations
+        << ", \"bytesTouched\": " << counters.bytesTouched
+        << "}\n}" << std::endl;
+}
+
@@ -0,0 +1,87 @@
+// QueryStats.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A QueryStats object measures where the trip application spends its time:
+// the total time spent in each phase of the work (parsing input, building
+// derived structures such as a CompactRoadMap, searching, and rendering
+// routes), and the distribution of the time taken by individual searches.
+// It can be written out as JSON, along with the DigraphStats counters.
+//
+// Time is measured with QueryStats::Timer objects, which measure the time
+// from their construction to their destruction.  A Timer given a null
+// QueryStats pointer does nothing, so code can be timed unconditionally
+// and pay almost nothing when statistics aren't wanted.  All of the
+// member functions are safe to call from several threads at once.
+
+#ifndef QUERYSTATS_HPP
+#define QUERYSTATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include "DigraphStats.hpp"
+
+
+
+class QueryStats
+{
+public:
+    enum class Phase
+    {
+        Parse,
+        Build,
+        Search,
+        Render
+    };
+
+    class Timer
+    {
+    public:
+        // Starts timing the given phase, unless stats is null.  If
+        // isSearch is true, the time is also counted as one search.
+        Timer(QueryStats* stats, Phase phase, bool isSearch = false);
+
+        // Adds the time since construction to the QueryStats.
+        ~Timer();
+
+    private:
+        QueryStats* stats_;
+        Phase phase_;
+        bool isSearch_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // Initializes a QueryStats with nothing measured yet.
+    QueryStats();
+
+    // add() adds the given time to the total for the given phase.
+    void add(Phase phase, std::chrono::nanoseconds elapsed);
+
+    // addSearch() records the time taken by one search.
+    void addSearch(std::chrono::nanoseconds elapsed);
+
+    // writeJson() writes the measurements and the given counters to the
+    // given output stream as a JSON object.
+    void writeJson(std::ostream& out, const DigraphStats& counters) const;
+
+private:
+    static const int phases = 4;
+
+    std::atomic<std::int64_t> phaseNanoseconds_[phases];
+
+    mutable std::mutex searchMutex_;
+    std::uint64_t searches_;
+    double searchSeconds_;
+    double searchSquaredSeconds_;
+    double minSearchSeconds_;
+    double maxSearchSeconds_;
+};
+
+
+
+#endif // QUERYSTATS_HPP
+
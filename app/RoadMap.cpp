@@ -0,0 +1,156 @@
+// RoadMap.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include "RoadMap.hpp"
+
+
+RoadMap::RoadMap()
+    : names_{std::make_shared<LocationNames>()},
+      nameBytes_{0},
+      index_{std::make_shared<LocationIndex>()}
+{
+}
+
+
+void RoadMap::addLocation(int vertex, std::string_view name)
+{
+    if (vertexExists(vertex))
+    {
+        throw DigraphException("Vertex already exists in the graph!\n");
+    }
+
+    std::string_view stored = storeName(name);
+
+    addVertex(vertex, stored);
+    mutableIndex().insert(stored, vertex);
+}
+
+
+void RoadMap::removeVertex(int vertex)
+{
+    std::string_view name = vertexInfo(vertex);
+
+    Digraph::removeVertex(vertex);
+    mutableIndex().erase(name, vertex);
+
+    if (!index_->find(name))
+    {
+        nameBytes_ -= name.size();
+    }
+}
+
+
+void RoadMap::reserveNames(std::size_t bytes)
+{
+    names_->reserve(bytes);
+}
+
+
+int RoadMap::findLocation(std::string_view name) const
+{
+    std::optional<int> vertex = index_->find(name);
+
+    if (!vertex)
+    {
+        throw DigraphException("Location does not exist!\n");
+    }
+
+    return *vertex;
+}
+
+
+std::shared_ptr<const LocationNames> RoadMap::names() const
+{
+    return names_;
+}
+
+
+const LocationIndex& RoadMap::index() const
+{
+    return *index_;
+}
+
+
+MemoryUsage RoadMap::memoryUsage() const
+{
+    MemoryUsage usage = Digraph::memoryUsage();
+    usage.vertexInfo += names_->bytesAllocated();
+    usage.indexes += index_->bytesAllocated();
+    return usage;
+}
+
+
+MemoryUsage RoadMap::ownedMemoryUsage() const
+{
+    MemoryUsage usage = Digraph::ownedMemoryUsage();
+
+    if (names_.use_count() == 1)
+    {
+        usage.vertexInfo += names_->bytesAllocated();
+    }
+
+    if (index_.use_count() == 1)
+    {
+        usage.indexes += index_->bytesAllocated();
+    }
+
+    return usage;
+}
+
+
+LocationIndex& RoadMap::mutableIndex()
+{
+    if (index_.use_count() > 1)
+    {
+        index_ = std::make_shared<LocationIndex>(*index_);
+    }
+
+    return *index_;
+}
+
+
+std::string_view RoadMap::storeName(std::string_view name)
+{
+    std::optional<int> existing = index_->find(name);
+
+    // A name that is already in the table is stored only once.
+    if (existing)
+    {
+        return vertexInfo(*existing);
+    }
+
+    const std::size_t minimumRebuildBytes = 4096;
+    std::size_t deadBytes = names_->bytesStored() - nameBytes_;
+
+    if (deadBytes > std::max(nameBytes_, minimumRebuildBytes))
+    {
+        rebuildNames();
+    }
+
+    nameBytes_ += name.size();
+    return names_->store(name);
+}
+
+
+void RoadMap::rebuildNames()
+{
+    auto names = std::make_shared<LocationNames>();
+    auto index = std::make_shared<LocationIndex>();
+    names->reserve(nameBytes_);
+
+    for (int vertex : vertices())
+    {
+        std::string_view name = vertexInfo(vertex);
+        std::optional<int> existing = index->find(name);
+        std::string_view stored = existing ? vertexInfo(*existing) : names->store(name);
+
+        setVertexInfo(vertex, stored);
+        index->insert(stored, vertex);
+    }
+
+    names_ = std::move(names);
+    index_ = std::move(index);
+}
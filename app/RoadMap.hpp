@@ -3,20 +3,115 @@
 // ICS 46 Spring 2018
 // Project #5: Rock and Roll Stops the Traffic
 //
-// This header defines a type RoadMap, which is simply a typedef to a particular
-// instantiation of the Digraph template, where each vertex has a string for its
-// information and each edge has a RoadSegment for its information.
+// This header defines a type RoadMap, which is a particular instantiation
+// of the Digraph template, where each vertex has the name of a location for
+// its information and each edge has a RoadSegment for its information.
+//
+// The names are not stored in the vertices themselves.  A RoadMap keeps
+// every name in a LocationNames table and each vertex holds a string_view
+// of its name, so vertexInfo() returns a name without copying it.  The
+// table is shared by copies of a RoadMap (it only ever grows, so sharing
+// it is safe) and lives for as long as any of them does.  The names of
+// locations that are removed stay in the table, so once they make up more
+// than half of it, the next location added gets a new table holding only
+// the names in use; the copies still using the old one keep it.  Building
+// the new table touches every vertex, but happens rarely enough that it
+// takes constant time per location added, on average.  A RoadMap also
+// keeps a LocationIndex of every location, so that locations can be found
+// by name.  Since a vertex's name must be in the table, vertices can only
+// be added with addLocation(); addVertex() isn't available on a RoadMap.
 
 #ifndef ROADMAP_HPP
 #define ROADMAP_HPP
 
-#include <string>
+#include <memory>
+#include <string_view>
 #include "Digraph.hpp"
+#include "LocationNames.hpp"
 #include "RoadSegment.hpp"
 
 
 
-typedef Digraph<std::string, RoadSegment> RoadMap;
+class RoadMap : public Digraph<std::string_view, RoadSegment>
+{
+public:
+    // Initializes an empty RoadMap.
+    RoadMap();
+
+    // Copying a RoadMap takes constant time, since it shares storage
+    // with the original.  There are deliberately no move operations, so
+    // that "moving" a RoadMap copies it and the RoadMap moved from is
+    // left intact, rather than without a name table.
+    RoadMap(const RoadMap& roadMap) = default;
+    RoadMap& operator=(const RoadMap& roadMap) = default;
+
+    // addLocation() adds a vertex with the given vertex number, storing
+    // a copy of the given name in the RoadMap's name table.  If there is
+    // already a vertex with the given vertex number, a DigraphException is
+    // thrown.
+    void addLocation(int vertex, std::string_view name);
+
+    // removeVertex() removes a location as Digraph::removeVertex() does,
+    // and removes it from the name index, too.
+    void removeVertex(int vertex);
+
+    // reserveNames() makes room in the name table for the given number
+    // of bytes of names, so that names added afterward are stored
+    // contiguously.
+    void reserveNames(std::size_t bytes);
+
+    // findLocation() returns the vertex number of a location with the
+    // given name, in constant time on average.  If there are several, any
+    // one of them is returned.  If there are none, a DigraphException is
+    // thrown.
+    int findLocation(std::string_view name) const;
+
+    // names() returns the name table.  Structures derived from a RoadMap
+    // that keep views of its names can hold on to the table, so that the
+    // names stay valid even if the RoadMap itself is destroyed.
+    std::shared_ptr<const LocationNames> names() const;
+
+    // index() returns the name index.
+    const LocationIndex& index() const;
+
+    // memoryUsage() returns the memory allocated for the graph, as
+    // Digraph::memoryUsage() does, plus the name table (counted as
+    // VertexInfo) and the name index.
+    MemoryUsage memoryUsage() const;
+
+    // ownedMemoryUsage() returns the part of memoryUsage() that only this
+    // RoadMap is using, as Digraph::ownedMemoryUsage() does, counting the
+    // name table and the name index only if no copy shares them.
+    MemoryUsage ownedMemoryUsage() const;
+
+private:
+    // The vertices' names are views, which would dangle once a caller's
+    // string was gone, so they're only stored by addLocation().
+    using Digraph<std::string_view, RoadSegment>::addVertex;
+
+    // mutableIndex() returns the name index for writing, first making a
+    // private copy of it if it is shared with another RoadMap.
+    LocationIndex& mutableIndex();
+
+    // storeName() stores the given name, unless it's already stored, and
+    // returns a view of the stored copy.
+    std::string_view storeName(std::string_view name);
+
+    // rebuildNames() replaces the name table and index with new ones
+    // holding only the names of the RoadMap's own locations.
+    void rebuildNames();
+
+    std::shared_ptr<LocationNames> names_;
+
+    // The total size of the distinct names of the RoadMap's locations,
+    // which is the part of the name table still in use.
+    std::size_t nameBytes_;
+
+    // Like the vertex table in Digraph, the index is shared between
+    // copies and copied the first time a sharing copy adds or removes a
+    // location.
+    std::shared_ptr<LocationIndex> index_;
+};
 
 
 
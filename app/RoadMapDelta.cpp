@@ -0,0 +1,179 @@
+// RoadMapDelta.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include <unordered_set>
+#include "RoadMapDelta.hpp"
+
+
+namespace
+{
+    // outgoingSegments() returns the segments leading out of the given
+    // vertex, sorted by the vertex they lead to.
+    std::vector<std::pair<int, RoadSegment>> outgoingSegments(const RoadMap& roadMap, int vertex)
+    {
+        std::vector<std::pair<int, RoadSegment>> segments;
+
+        roadMap.forEachEdge(
+            vertex,
+            [&segments](const DigraphEdge<RoadSegment>& edge)
+            {
+                segments.emplace_back(edge.toVertex, edge.einfo);
+            });
+
+        std::sort(
+            segments.begin(), segments.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        return segments;
+    }
+}
+
+
+RoadMapDelta RoadMapDelta::between(const RoadMap& before, const RoadMap& after)
+{
+    RoadMapDelta delta;
+
+    // A location that is added, or removed and added again because its
+    // name changed, has all of its segments added, in both directions.
+    std::unordered_set<int> replaced;
+
+    for (int vertex : before.vertices())
+    {
+        if (!after.vertexExists(vertex))
+        {
+            delta.removedLocations.push_back(vertex);
+        }
+        else if (before.vertexInfo(vertex) != after.vertexInfo(vertex))
+        {
+            delta.removedLocations.push_back(vertex);
+            replaced.insert(vertex);
+        }
+    }
+
+    for (int vertex : after.vertices())
+    {
+        if (!before.vertexExists(vertex) || replaced.count(vertex) != 0)
+        {
+            delta.addedLocations.push_back(
+                Location{vertex, std::string{after.vertexInfo(vertex)}});
+            replaced.insert(vertex);
+        }
+    }
+
+    // Segments to or from a location that is removed go with it, so
+    // they're never listed as removed.
+    auto goesWithLocation =
+        [&after, &replaced](int vertex)
+        {
+            return !after.vertexExists(vertex) || replaced.count(vertex) != 0;
+        };
+
+    for (int vertex : after.vertices())
+    {
+        std::vector<std::pair<int, RoadSegment>> newSegments = outgoingSegments(after, vertex);
+
+        if (replaced.count(vertex) != 0)
+        {
+            for (const auto& [toVertex, segment] : newSegments)
+            {
+                delta.addedSegments.push_back(Segment{vertex, toVertex, segment});
+            }
+
+            continue;
+        }
+
+        // The old and new segments are both sorted by the vertex they lead
+        // to, so they're compared by merging them.
+        std::vector<std::pair<int, RoadSegment>> oldSegments = outgoingSegments(before, vertex);
+        auto oldSegment = oldSegments.begin();
+        auto newSegment = newSegments.begin();
+
+        while (oldSegment != oldSegments.end() || newSegment != newSegments.end())
+        {
+            if (newSegment == newSegments.end()
+                || (oldSegment != oldSegments.end() && oldSegment->first < newSegment->first))
+            {
+                if (!goesWithLocation(oldSegment->first))
+                {
+                    delta.removedSegments.emplace_back(vertex, oldSegment->first);
+                }
+
+                ++oldSegment;
+                continue;
+            }
+
+            int toVertex = newSegment->first;
+            const RoadSegment& segment = newSegment->second;
+            bool existed = oldSegment != oldSegments.end() && oldSegment->first == toVertex;
+
+            if (!existed || replaced.count(toVertex) != 0)
+            {
+                delta.addedSegments.push_back(Segment{vertex, toVertex, segment});
+            }
+            else if (oldSegment->second.miles != segment.miles
+                     || oldSegment->second.milesPerHour != segment.milesPerHour)
+            {
+                delta.changedSegments.push_back(Segment{vertex, toVertex, segment});
+            }
+
+            if (existed)
+            {
+                ++oldSegment;
+            }
+
+            ++newSegment;
+        }
+    }
+
+    return delta;
+}
+
+
+void RoadMapDelta::apply(RoadMap& roadMap) const
+{
+    RoadMap updated = roadMap;
+
+    for (const auto& [fromVertex, toVertex] : removedSegments)
+    {
+        updated.removeEdge(fromVertex, toVertex);
+    }
+
+    for (int vertex : removedLocations)
+    {
+        updated.removeVertex(vertex);
+    }
+
+    for (const Location& location : addedLocations)
+    {
+        updated.addLocation(location.vertex, location.name);
+    }
+
+    for (const Segment& added : addedSegments)
+    {
+        updated.addEdge(added.fromVertex, added.toVertex, added.segment);
+    }
+
+    for (const Segment& changed : changedSegments)
+    {
+        updated.setEdgeInfo(changed.fromVertex, changed.toVertex, changed.segment);
+    }
+
+    roadMap = updated;
+}
+
+
+bool RoadMapDelta::changesStructure() const noexcept
+{
+    return !removedSegments.empty() || !removedLocations.empty()
+        || !addedLocations.empty() || !addedSegments.empty();
+}
+
+
+std::size_t RoadMapDelta::changeCount() const noexcept
+{
+    return removedSegments.size() + removedLocations.size() + addedLocations.size()
+        + addedSegments.size() + changedSegments.size();
+}
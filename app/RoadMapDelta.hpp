@@ -0,0 +1,84 @@
+// RoadMapDelta.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A RoadMapDelta describes the changes that turn one version of a road map
+// into the next: the locations removed and added, and the road segments
+// removed, added, and changed (i.e., given a new distance or speed limit).
+// A map that changes a little at a time can be kept up to date by applying
+// deltas, without reading all of it again.  Applying one still costs time
+// proportional to the number of locations, since the first change copies
+// the map's vertex table (see Digraph.hpp), but only the locations whose
+// segments change are copied along with it, and no text is read or parsed
+// but the delta's.
+//
+// Changing a segment leaves the RoadMap's version (see Digraph::version())
+// as it was, since the locations and segments are still the same ones, so
+// anything that depends only on which segments there are (such as a
+// ReachabilityIndex) is still current afterward.  Only the other kinds of
+// changes make such things stale.
+//
+// The changes are applied in this order, whatever order they're listed
+// in: segments removed, locations removed, locations added, segments
+// added, and segments changed.  Removing a location removes its segments,
+// too, so the delta doesn't list them.  A location whose name changes is
+// removed and added again, with all of its segments.
+
+#ifndef ROADMAPDELTA_HPP
+#define ROADMAPDELTA_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "RoadMap.hpp"
+#include "RoadSegment.hpp"
+
+
+
+struct RoadMapDelta
+{
+    struct Location
+    {
+        int vertex;
+        std::string name;
+    };
+
+    struct Segment
+    {
+        int fromVertex;
+        int toVertex;
+        RoadSegment segment;
+    };
+
+    std::vector<std::pair<int, int>> removedSegments;
+    std::vector<int> removedLocations;
+    std::vector<Location> addedLocations;
+    std::vector<Segment> addedSegments;
+    std::vector<Segment> changedSegments;
+
+    // between() returns the delta that turns the first given RoadMap into
+    // the second.
+    static RoadMapDelta between(const RoadMap& before, const RoadMap& after);
+
+    // apply() makes the delta's changes to the given RoadMap, all at once.
+    // They're made to a copy of it (which shares its storage, so only the
+    // vertex table and what changes are copied), which replaces it only
+    // once they have all been made, so if any of them can't be made (e.g., a segment removed
+    // from a location that doesn't exist), a DigraphException is thrown
+    // and the RoadMap is left as it was.
+    void apply(RoadMap& roadMap) const;
+
+    // changesStructure() returns true if applying the delta changes which
+    // locations and segments there are, i.e., if it does anything other
+    // than change segments.
+    bool changesStructure() const noexcept;
+
+    // changeCount() returns the number of changes in the delta.
+    std::size_t changeCount() const noexcept;
+};
+
+
+
+#endif // ROADMAPDELTA_HPP
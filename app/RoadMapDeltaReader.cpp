@@ -0,0 +1,106 @@
+// RoadMapDeltaReader.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <sstream>
+#include <stdexcept>
+#include "RoadMapDeltaReader.hpp"
+
+
+RoadMapDelta RoadMapDeltaReader::readDelta(InputReader& in)
+{
+    RoadMapDelta delta;
+
+    int numberOfChanges = in.readIntLine();
+
+    for (int i = 0; i < numberOfChanges; ++i)
+    {
+        std::string line = in.readLine();
+
+        if (!parseChange(line, delta))
+        {
+            throw std::runtime_error{"Invalid map delta change: " + line};
+        }
+    }
+
+    return delta;
+}
+
+
+bool RoadMapDeltaReader::parseChange(const std::string& line, RoadMapDelta& delta)
+{
+    std::istringstream changeLine{line};
+
+    std::string action;
+    std::string what;
+
+    changeLine >> action >> what;
+
+    if (what == "location")
+    {
+        int vertex;
+
+        if (!(changeLine >> vertex))
+        {
+            return false;
+        }
+        else if (action == "remove")
+        {
+            delta.removedLocations.push_back(vertex);
+            return true;
+        }
+        else if (action == "add")
+        {
+            // The name is the rest of the line, after the space that
+            // separates it from the vertex number.
+            std::string name;
+            changeLine.get();
+            std::getline(changeLine, name);
+
+            delta.addedLocations.push_back(RoadMapDelta::Location{vertex, name});
+            return true;
+        }
+
+        return false;
+    }
+    else if (what != "segment")
+    {
+        return false;
+    }
+
+    int fromVertex;
+    int toVertex;
+
+    if (!(changeLine >> fromVertex >> toVertex))
+    {
+        return false;
+    }
+    else if (action == "remove")
+    {
+        delta.removedSegments.emplace_back(fromVertex, toVertex);
+        return true;
+    }
+
+    double miles;
+    double milesPerHour;
+
+    if (!(changeLine >> miles >> milesPerHour))
+    {
+        return false;
+    }
+    else if (action == "add")
+    {
+        delta.addedSegments.push_back(
+            RoadMapDelta::Segment{fromVertex, toVertex, RoadSegment{miles, milesPerHour}});
+        return true;
+    }
+    else if (action == "change")
+    {
+        delta.changedSegments.push_back(
+            RoadMapDelta::Segment{fromVertex, toVertex, RoadSegment{miles, milesPerHour}});
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,45 @@
+// RoadMapDeltaReader.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// The RoadMapDeltaReader class provides an object that knows how to read a
+// RoadMapDelta (see RoadMapDelta.hpp).  A delta is written like a road
+// map: a line with the number of changes, followed by one line for each
+// change, which is one of these:
+//
+//   remove segment FROM TO
+//   remove location VERTEX
+//   add location VERTEX NAME
+//   add segment FROM TO MILES MPH
+//   change segment FROM TO MILES MPH
+//
+// where the NAME is the rest of the line.  As in a road map, blank lines
+// and lines beginning with '#' are skipped.
+
+#ifndef ROADMAPDELTAREADER_HPP
+#define ROADMAPDELTAREADER_HPP
+
+#include <string>
+#include "InputReader.hpp"
+#include "RoadMapDelta.hpp"
+
+
+
+class RoadMapDeltaReader
+{
+public:
+    // readDelta() reads a RoadMapDelta from the given InputReader.  If a
+    // line isn't a change in the format above, a std::runtime_error is
+    // thrown.
+    RoadMapDelta readDelta(InputReader& in);
+
+    // parseChange() parses one line describing a change, adding it to the
+    // given RoadMapDelta.  It returns false if the line isn't a valid
+    // change, in which case the delta is left unchanged.
+    bool parseChange(const std::string& line, RoadMapDelta& delta);
+};
+
+
+
+#endif // ROADMAPDELTAREADER_HPP
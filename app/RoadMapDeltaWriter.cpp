@@ -0,0 +1,68 @@
+// RoadMapDeltaWriter.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <charconv>
+#include <string>
+#include "RoadMapDeltaWriter.hpp"
+
+
+namespace
+{
+    // exactly() returns the shortest text that reads back as the given
+    // number.
+    std::string exactly(double value)
+    {
+        char buffer[32];
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::string(buffer, result.ptr);
+    }
+
+
+    void writeSegment(std::ostream& out, const char* action, const RoadMapDelta::Segment& s)
+    {
+        out << action << " segment " << s.fromVertex << " " << s.toVertex << " "
+            << exactly(s.segment.miles) << " " << exactly(s.segment.milesPerHour) << "\n";
+    }
+}
+
+
+void RoadMapDeltaWriter::writeDelta(std::ostream& out, const RoadMapDelta& delta)
+{
+    out << delta.changeCount() << "\n";
+
+    for (const auto& [fromVertex, toVertex] : delta.removedSegments)
+    {
+        out << "remove segment " << fromVertex << " " << toVertex << "\n";
+    }
+
+    for (int vertex : delta.removedLocations)
+    {
+        out << "remove location " << vertex << "\n";
+    }
+
+    for (const RoadMapDelta::Location& location : delta.addedLocations)
+    {
+        out << "add location " << location.vertex << " " << location.name << "\n";
+    }
+
+    for (const RoadMapDelta::Segment& segment : delta.addedSegments)
+    {
+        writeSegment(out, "add", segment);
+    }
+
+    for (const RoadMapDelta::Segment& segment : delta.changedSegments)
+    {
+        writeSegment(out, "change", segment);
+    }
+
+    out.flush();
+}
+
+
+void RoadMapDeltaWriter::writeDelta(
+    std::ostream& out, const RoadMap& before, const RoadMap& after)
+{
+    writeDelta(out, RoadMapDelta::between(before, after));
+}
@@ -0,0 +1,34 @@
+// RoadMapDeltaWriter.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// The RoadMapDeltaWriter class writes a RoadMapDelta in the format that a
+// RoadMapDeltaReader reads (see RoadMapDeltaReader.hpp), with the changes
+// in the order they're applied.  Distances and speeds are written with as
+// many digits as it takes to read back exactly the same numbers.
+
+#ifndef ROADMAPDELTAWRITER_HPP
+#define ROADMAPDELTAWRITER_HPP
+
+#include <ostream>
+#include "RoadMap.hpp"
+#include "RoadMapDelta.hpp"
+
+
+
+class RoadMapDeltaWriter
+{
+public:
+    // writeDelta() writes the given RoadMapDelta to the given output
+    // stream.
+    void writeDelta(std::ostream& out, const RoadMapDelta& delta);
+
+    // This overload writes the delta that turns the first given RoadMap
+    // into the second.
+    void writeDelta(std::ostream& out, const RoadMap& before, const RoadMap& after);
+};
+
+
+
+#endif // ROADMAPDELTAWRITER_HPP
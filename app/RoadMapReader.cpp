@@ -14,9 +14,24 @@ RoadMap RoadMapReader::readRoadMap(InputReader& in)
 
     int numberOfLocations = in.readIntLine();
 
+    // The names are read into one buffer first, so that the RoadMap knows
+    // how much room they need and can store all of them contiguously.
+    std::string names;
+    std::vector<std::size_t> nameEnds;
+    nameEnds.reserve(numberOfLocations);
+
     for (int i = 0; i < numberOfLocations; ++i)
     {
-        roadMap.addVertex(i, in.readLine());
+        names += in.readLine();
+        nameEnds.push_back(names.size());
+    }
+
+    roadMap.reserveNames(names.size());
+
+    for (int i = 0; i < numberOfLocations; ++i)
+    {
+        std::size_t begin = i > 0 ? nameEnds[i - 1] : 0;
+        roadMap.addLocation(i, std::string_view{names}.substr(begin, nameEnds[i] - begin));
     }
 
     int numberOfRoadSegments = in.readIntLine();
@@ -37,4 +52,3 @@ RoadMap RoadMapReader::readRoadMap(InputReader& in)
 
     return roadMap;
 }
-
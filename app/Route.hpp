@@ -0,0 +1,52 @@
+// Route.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A Route is the result of evaluating one Trip: the sequence of road
+// segments the trip follows.  Each step carries the location it reaches,
+// the road segment used to get there, and the total distance and driving
+// time so far, so that writing the route out requires no further lookups
+// in the map it was found in.  The location names are views of the names
+// stored in the map's LocationNames table, which must outlive the Route,
+// unless the map doesn't keep its names in memory, in which case the
+// Route holds a share of whatever they're stored in.
+
+#ifndef ROUTE_HPP
+#define ROUTE_HPP
+
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "RoadSegment.hpp"
+#include "Trip.hpp"
+
+
+
+struct RouteStep
+{
+    int vertex;
+    std::string_view location;
+    RoadSegment segment;
+    double totalMiles;
+    double totalHours;
+};
+
+
+
+struct Route
+{
+    Trip trip;
+    std::string_view startLocation;
+    std::string_view endLocation;
+    bool reachable;
+    std::vector<RouteStep> steps;
+
+    // What the location names are views of, if the map doesn't keep it.
+    std::vector<std::shared_ptr<const void>> nameStorage{};
+};
+
+
+
+#endif // ROUTE_HPP
+
@@ -0,0 +1,137 @@
+// RouteFinder.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <optional>
+#include <utility>
+#include "RouteFinder.hpp"
+
+
+double DistFunc(const RoadSegment& rs)
+{
+    return rs.miles;
+}
+
+
+double TimeFunc(const RoadSegment& rs)
+{
+    return rs.miles / rs.milesPerHour;
+}
+
+
+RouteFinder::RouteFinder()
+    : reachability_{nullptr}
+{
+}
+
+
+RouteFinder::RouteFinder(const ReachabilityIndex* reachability)
+    : reachability_{reachability}
+{
+}
+
+
+Route RouteFinder::findRoute(const RoadMap& roadMap, const Trip& trip) const
+{
+    return findRoutes(roadMap, std::vector<Trip>{trip}).front();
+}
+
+
+std::vector<Route> RouteFinder::findRoutes(
+    const RoadMap& roadMap, const std::vector<Trip>& trips) const
+{
+    std::vector<Route> routes(trips.size());
+
+    // The trips are grouped by start and end vertex, and each group is
+    // evaluated with one search per metric it asks for, all at once.
+    std::map<std::pair<int, int>, std::vector<std::size_t>> groups;
+
+    for (std::size_t i = 0; i < trips.size(); ++i)
+    {
+        groups[std::make_pair(trips[i].startVertex, trips[i].endVertex)].push_back(i);
+    }
+
+    for (const auto& group : groups)
+    {
+        std::vector<TripMetric> metrics;
+        std::vector<std::function<double(const RoadSegment&)>> weightFuncs;
+
+        for (std::size_t i : group.second)
+        {
+            TripMetric metric = trips[i].metric;
+
+            if (std::find(metrics.begin(), metrics.end(), metric) == metrics.end())
+            {
+                metrics.push_back(metric);
+                weightFuncs.push_back(metric == TripMetric::Distance ? DistFunc : TimeFunc);
+            }
+        }
+
+        std::vector<std::optional<std::vector<DigraphPathStep<RoadSegment>>>> paths;
+
+        // The names of the start and end locations are looked up first, so
+        // that a trip with a nonexistent vertex fails with that exception
+        // rather than being reported as unreachable.
+        roadMap.vertexInfo(group.first.first);
+        roadMap.vertexInfo(group.first.second);
+
+        // A search only finds that the end vertex is unreachable once it
+        // has run out of vertices to reach, so the index is asked first.
+        // Otherwise, whether there's a route is decided for each metric on
+        // its own, since a road that can't be driven (e.g., one with a
+        // speed limit of zero) may still count toward the distance.
+        bool skip =
+            reachability_ != nullptr && reachability_->isCurrent(roadMap)
+            && !reachability_->reachable(group.first.first, group.first.second);
+
+        if (!skip)
+        {
+            paths = roadMap.findShortestPath(group.first.first, group.first.second, weightFuncs);
+        }
+
+        for (std::size_t i : group.second)
+        {
+            std::size_t m = std::find(metrics.begin(), metrics.end(), trips[i].metric) - metrics.begin();
+            routes[i] = makeRoute(
+                roadMap, trips[i], paths.empty() || !paths[m] ? nullptr : &*paths[m]);
+        }
+    }
+
+    return routes;
+}
+
+
+Route RouteFinder::makeRoute(
+    const RoadMap& roadMap, const Trip& trip,
+    const std::vector<DigraphPathStep<RoadSegment>>* path) const
+{
+    Route route{
+        trip, roadMap.vertexInfo(trip.startVertex), roadMap.vertexInfo(trip.endVertex),
+        path != nullptr, {}};
+
+    if (path == nullptr)
+    {
+        return route;
+    }
+
+    route.steps.reserve(path->size());
+
+    double totalMiles = 0;
+    double totalHours = 0;
+
+    for (const DigraphPathStep<RoadSegment>& step : *path)
+    {
+        totalMiles += step.einfo->miles;
+        totalHours += step.einfo->miles / step.einfo->milesPerHour;
+        route.steps.push_back(
+            RouteStep{step.toVertex, roadMap.vertexInfo(step.toVertex), *step.einfo,
+                      totalMiles, totalHours});
+    }
+
+    return route;
+}
+
@@ -0,0 +1,64 @@
+// RouteFinder.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A RouteFinder evaluates Trips against a RoadMap, finding the route that
+// minimizes the trip's metric (distance or driving time).  Given a
+// ReachabilityIndex that is current for the RoadMap, it reports trips
+// with no route as unreachable without searching for one.
+
+#ifndef ROUTEFINDER_HPP
+#define ROUTEFINDER_HPP
+
+#include <vector>
+#include "ReachabilityIndex.hpp"
+#include "RoadMap.hpp"
+#include "Route.hpp"
+#include "Trip.hpp"
+
+
+
+// DistFunc() and TimeFunc() are the edge weight functions for the two
+// kinds of TripMetric, giving the length of a RoadSegment in miles and
+// the time it takes to drive it in hours, respectively.
+double DistFunc(const RoadSegment& rs);
+double TimeFunc(const RoadSegment& rs);
+
+
+
+class RouteFinder
+{
+public:
+    // Initializes a RouteFinder that searches for every route.
+    RouteFinder();
+
+    // Initializes a RouteFinder that first looks up, in the given index,
+    // whether there is a route at all, if the index is current for the
+    // RoadMap being searched.  The index must outlive the RouteFinder.
+    explicit RouteFinder(const ReachabilityIndex* reachability);
+
+    // findRoute() finds the shortest route for the given trip.  If the
+    // trip's end vertex cannot be reached from its start vertex, the
+    // route is marked as not reachable and has no steps.
+    Route findRoute(const RoadMap& roadMap, const Trip& trip) const;
+
+    // findRoutes() finds the shortest routes for a batch of trips,
+    // returning them in the same order as the trips.  Trips with the same
+    // start and end vertex but different metrics (e.g., a customer asking
+    // for both the shortest and the fastest way between two places) are
+    // evaluated in a single search that minimizes both metrics at once.
+    std::vector<Route> findRoutes(const RoadMap& roadMap, const std::vector<Trip>& trips) const;
+
+private:
+    Route makeRoute(
+        const RoadMap& roadMap, const Trip& trip,
+        const std::vector<DigraphPathStep<RoadSegment>>* path) const;
+
+    const ReachabilityIndex* reachability_;
+};
+
+
+
+#endif // ROUTEFINDER_HPP
+
@@ -0,0 +1,103 @@
+// RouteWriter.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <iomanip>
+#include "RouteWriter.hpp"
+
+
+namespace
+{
+    const std::streamoff flushThreshold = 64 * 1024;
+}
+
+
+RouteWriter::RouteWriter(std::ostream& out)
+    : out_{out}
+{
+}
+
+
+RouteWriter::~RouteWriter()
+{
+    flush();
+}
+
+
+void RouteWriter::writeRoute(const Route& route)
+{
+    bool distance = route.trip.metric == TripMetric::Distance;
+
+    buffer_ << (distance ? "Shortest distance from " : "Shortest time from ")
+            << route.startLocation << " to " << route.endLocation << '\n'
+            << "  Begin at " << route.startLocation << '\n';
+
+    if (!route.reachable)
+    {
+        buffer_ << "  No route found\n\n";
+    }
+    else if (distance)
+    {
+        for (const RouteStep& step : route.steps)
+        {
+            buffer_ << std::fixed << "  Continue to " << step.location
+                    << " (" << std::setprecision(1) << step.segment.miles << " miles)\n";
+        }
+
+        buffer_ << "Total distance: "
+                << (route.steps.empty() ? 0.0 : route.steps.back().totalMiles)
+                << " miles\n\n";
+    }
+    else
+    {
+        for (const RouteStep& step : route.steps)
+        {
+            buffer_ << std::fixed << "  Continue to " << step.location
+                    << " (" << std::setprecision(1) << step.segment.miles << " @ "
+                    << step.segment.milesPerHour << "mph = ";
+            writeDuration(step.segment.miles / step.segment.milesPerHour);
+            buffer_ << " secs)\n";
+        }
+
+        buffer_ << "Total time: ";
+        writeDuration(route.steps.empty() ? 0.0 : route.steps.back().totalHours);
+        buffer_ << " secs\n\n";
+    }
+
+    if (buffer_.tellp() >= flushThreshold)
+    {
+        flush();
+    }
+}
+
+
+void RouteWriter::flush()
+{
+    std::string text = buffer_.str();
+    out_.write(text.data(), text.size());
+    out_.flush();
+
+    buffer_.str(std::string{});
+}
+
+
+void RouteWriter::writeDuration(double hours)
+{
+    double temp = hours * 3600;
+    int hrs = temp / 3600;
+    int mins = (temp - 3600 * hrs) / 60;
+    double secs = temp - hrs * 3600 - mins * 60;
+
+    if (hrs)
+    {
+        buffer_ << hrs << " hours " << mins << " mins ";
+    }
+    else if (mins)
+    {
+        buffer_ << mins << " mins ";
+    }
+
+    buffer_ << secs;
+}
+
@@ -0,0 +1,51 @@
+// RouteWriter.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A RouteWriter writes Routes to an output stream as turn-by-turn
+// directions.  Output is collected in a buffer and written to the stream
+// in large pieces, rather than a line (or a flush) at a time; call flush()
+// when the output must be visible, or let the destructor do it.
+
+#ifndef ROUTEWRITER_HPP
+#define ROUTEWRITER_HPP
+
+#include <ostream>
+#include <sstream>
+#include "Route.hpp"
+
+
+
+class RouteWriter
+{
+public:
+    // Initializes a RouteWriter so that it writes to the given output
+    // stream.
+    explicit RouteWriter(std::ostream& out);
+
+    // The destructor writes any output that is still buffered.
+    ~RouteWriter();
+
+    // writeRoute() writes one route, as directions from the trip's start
+    // location to its end location.
+    void writeRoute(const Route& route);
+
+    // flush() writes any buffered output to the output stream.
+    void flush();
+
+private:
+    void writeDuration(double hours);
+
+    std::ostream& out_;
+
+    // The buffer keeps its formatting state (fixed notation and the
+    // precision) from one route to the next, just as a stream would,
+    // so that the text written never depends on how it was buffered.
+    std::ostringstream buffer_;
+};
+
+
+
+#endif // ROUTEWRITER_HPP
+
@@ -0,0 +1,454 @@
+// TiledRoadMap.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include "CompactDigraph.hpp"
+#include "TiledRoadMap.hpp"
+
+
+namespace
+{
+    // The version of the sections a tile file holds, which is changed
+    // whenever they change, so that older files are rejected as stale.
+    const int tileFormatVersion = 1;
+
+
+    // Every tile file is written for the same ContentHash, which only
+    // says that it's a tile file; the hash of the map it holds is kept in
+    // its "map" section, so that it can be opened without the map.
+    std::uint64_t tileFileHash()
+    {
+        ContentHash hash;
+        hash.add(std::string_view{"TiledRoadMap"});
+        hash.add(tileFormatVersion);
+        return hash.value();
+    }
+
+
+    // The contents of a tile file, indexed by location index in
+    // breadth-first order.
+    struct TileArrays
+    {
+        std::vector<int> vertexNumbers;
+        std::vector<int> offsets;
+        std::vector<int> targets;
+        std::vector<double> miles;
+        std::vector<double> milesPerHour;
+        std::vector<char> names;
+        std::vector<std::uint64_t> nameEnds;
+    };
+
+
+    TileArrays collectArrays(const RoadMap& roadMap)
+    {
+        TileArrays arrays;
+        arrays.miles.reserve(roadMap.edgeCount());
+        arrays.milesPerHour.reserve(roadMap.edgeCount());
+
+        CompactDigraph graph{
+            roadMap,
+            [&arrays](int, const RoadSegment& segment)
+            {
+                arrays.miles.push_back(segment.miles);
+                arrays.milesPerHour.push_back(segment.milesPerHour);
+            },
+            VertexOrder::BreadthFirst};
+
+        arrays.offsets.push_back(0);
+        arrays.nameEnds.push_back(0);
+
+        for (int v = 0; v < graph.vertexCount(); ++v)
+        {
+            arrays.vertexNumbers.push_back(graph.vertexNumber(v));
+            arrays.offsets.push_back(graph.edgeEnd(v));
+
+            for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+            {
+                arrays.targets.push_back(graph.target(e));
+            }
+
+            std::string_view name = roadMap.vertexInfo(graph.vertexNumber(v));
+            arrays.names.insert(arrays.names.end(), name.begin(), name.end());
+            arrays.nameEnds.push_back(arrays.names.size());
+        }
+
+        return arrays;
+    }
+
+
+    std::uint64_t mapHash(const TileArrays& arrays)
+    {
+        ContentHash hash;
+        hash.add(arrays.vertexNumbers);
+        hash.add(arrays.offsets);
+        hash.add(arrays.targets);
+        hash.add(arrays.miles);
+        hash.add(arrays.milesPerHour);
+        hash.add(arrays.names);
+        return hash.value();
+    }
+
+
+    void writeArrays(const TileArrays& arrays, const std::string& path, int tileSize)
+    {
+        if (tileSize <= 0)
+        {
+            throw DigraphException("Tiles must hold at least one location!\n");
+        }
+
+        std::vector<std::pair<int, int>> byNumber;
+        byNumber.reserve(arrays.vertexNumbers.size());
+
+        for (std::size_t i = 0; i < arrays.vertexNumbers.size(); ++i)
+        {
+            byNumber.emplace_back(arrays.vertexNumbers[i], static_cast<int>(i));
+        }
+
+        std::sort(byNumber.begin(), byNumber.end());
+
+        std::vector<int> numbers;
+        std::vector<int> indexes;
+
+        for (const auto& pair : byNumber)
+        {
+            numbers.push_back(pair.first);
+            indexes.push_back(pair.second);
+        }
+
+        ArtifactWriter writer;
+        writer.addSection("map", std::vector<std::uint64_t>{mapHash(arrays)});
+        writer.addSection("tileSize", std::vector<int>{tileSize});
+        writer.addSection("numbers", numbers);
+        writer.addSection("indexes", indexes);
+        writer.addSection("vertices", arrays.vertexNumbers);
+        writer.addSection("offsets", arrays.offsets);
+        writer.addSection("targets", arrays.targets);
+        writer.addSection("miles", arrays.miles);
+        writer.addSection("speeds", arrays.milesPerHour);
+        writer.addSection("nameEnds", arrays.nameEnds);
+        writer.addSection("names", arrays.names);
+        writer.write(path, tileFileHash());
+    }
+
+
+    // prepareTileFile() writes the given RoadMap to the tile file with
+    // the given path, unless it already holds it, and returns the path.
+    const std::string& prepareTileFile(const RoadMap& roadMap, const std::string& path)
+    {
+        TileArrays arrays = collectArrays(roadMap);
+
+        try
+        {
+            ArtifactFile file{path, tileFileHash()};
+            ArtifactSection<std::uint64_t> map = file.section<std::uint64_t>("map");
+
+            if (map.size == 1 && map[0] == mapHash(arrays))
+            {
+                return path;
+            }
+        }
+        catch (DigraphException&)
+        {
+            // Whatever is wrong with the file, it's replaced.
+        }
+
+        writeArrays(arrays, path, TiledRoadMap::defaultTileSize);
+        return path;
+    }
+}
+
+
+std::string_view RoadMapTile::name(int index) const
+{
+    std::size_t local = index - firstIndex;
+    std::size_t begin = nameEnds[local] - nameEnds.front();
+    std::size_t end = nameEnds[local + 1] - nameEnds.front();
+
+    return std::string_view{names.data() + begin, end - begin};
+}
+
+
+MemoryUsage RoadMapTile::memoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.vertexTable = bytesAllocated(vertexNumbers) + bytesAllocated(offsets);
+    usage.adjacency = bytesAllocated(targets);
+    usage.edgeInfo = bytesAllocated(miles) + bytesAllocated(milesPerHour);
+    usage.vertexInfo = bytesAllocated(names) + bytesAllocated(nameEnds);
+    usage.caches = bytesAllocated(hours);
+    return usage;
+}
+
+
+
+void TiledRoadMap::write(const RoadMap& roadMap, const std::string& path, int tileSize)
+{
+    writeArrays(collectArrays(roadMap), path, tileSize);
+}
+
+
+TiledRoadMap::TiledRoadMap(const std::string& path, std::size_t budget)
+    : file_{std::make_unique<ArtifactFile>(path, tileFileHash())},
+      tiles_{budget, [this](int tile) { return load(tile); }}
+{
+    ArtifactSection<int> tileSize = file_->section<int>("tileSize");
+    numbers_ = file_->copySection<int>("numbers");
+    indexes_ = file_->copySection<int>("indexes");
+    vertexCount_ = static_cast<int>(numbers_.size());
+
+    if (tileSize.size != 1 || tileSize[0] <= 0
+        || indexes_.size() != numbers_.size()
+        || file_->section<int>("vertices").size != numbers_.size()
+        || file_->section<int>("offsets").size != numbers_.size() + 1
+        || file_->section<std::uint64_t>("nameEnds").size != numbers_.size() + 1)
+    {
+        throw DigraphException("Tile file " + path + " is damaged!\n");
+    }
+
+    tileSize_ = tileSize[0];
+}
+
+
+TiledRoadMap::TiledRoadMap(const RoadMap& roadMap, const std::string& path, std::size_t budget)
+    : TiledRoadMap{prepareTileFile(roadMap, path), budget}
+{
+}
+
+
+Route TiledRoadMap::findRoute(const Trip& trip) const
+{
+    int start = indexOf(trip.startVertex);
+    int end = indexOf(trip.endVertex);
+    bool byDistance = trip.metric == TripMetric::Distance;
+
+    // Labels are kept only for the locations the search reaches, so that
+    // its memory, like the tiles it reads, depends only on how far it
+    // goes.  The heap is ordered exactly as in CompactDigraph, so ties are
+    // broken the same way.
+    struct Label
+    {
+        double distance;
+        int previousVertex;
+        int previousEdge;
+        bool known;
+    };
+
+    std::unordered_map<int, Label> labels;
+
+    typedef std::pair<double, int> Entry;
+
+    struct EntryCompare
+    {
+        bool operator()(const Entry& lhs, const Entry& rhs) const
+        {
+            return rhs.first < lhs.first;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, EntryCompare> pq;
+    std::shared_ptr<const RoadMapTile> held;
+
+    labels.emplace(start, Label{0, -1, -1, false});
+    pq.push(Entry{0, start});
+
+    while (!pq.empty())
+    {
+        int v = pq.top().second;
+        pq.pop();
+
+        Label& label = labels.at(v);
+
+        if (label.known)
+        {
+            continue;
+        }
+
+        label.known = true;
+
+        if (v == end)
+        {
+            break;
+        }
+
+        const RoadMapTile& tile = tileOf(v, held);
+        int local = v - tile.firstIndex;
+        int firstEdge = tile.offsets.front();
+        const std::vector<double>& weights = byDistance ? tile.miles : tile.hours;
+        double base = label.distance;
+
+        for (int e = tile.offsets[local], last = tile.offsets[local + 1]; e < last; ++e)
+        {
+            double weight = base + weights[e - firstEdge];
+            int w = tile.targets[e - firstEdge];
+
+            auto found = labels.try_emplace(
+                w, Label{std::numeric_limits<double>::max(), -1, -1, false});
+
+            if (found.first->second.distance > weight)
+            {
+                found.first->second = Label{weight, v, e, false};
+                pq.push(Entry{weight, w});
+            }
+        }
+    }
+
+    auto reachedEnd = labels.find(end);
+    bool reachable = reachedEnd != labels.end() && reachedEnd->second.known;
+
+    std::shared_ptr<const RoadMapTile> heldFrom;
+    std::shared_ptr<const RoadMapTile> heldTo;
+
+    // The route's names are views of its tiles' names, so it holds a
+    // share of each tile it names a location in.
+    Route route{trip, {}, {}, reachable, {}, {}};
+
+    auto nameOf =
+        [&route](
+            const RoadMapTile& tile, int index,
+            const std::shared_ptr<const RoadMapTile>& held)
+        {
+            if (std::find(route.nameStorage.begin(), route.nameStorage.end(), held)
+                == route.nameStorage.end())
+            {
+                route.nameStorage.push_back(held);
+            }
+
+            return tile.name(index);
+        };
+
+    route.startLocation = nameOf(tileOf(start, heldFrom), start, heldFrom);
+    route.endLocation = nameOf(tileOf(end, heldTo), end, heldTo);
+
+    if (!reachable)
+    {
+        return route;
+    }
+
+    std::vector<int> path;
+
+    for (int v = end; v != start; v = labels.at(v).previousVertex)
+    {
+        path.push_back(v);
+    }
+
+    std::reverse(path.begin(), path.end());
+    route.steps.reserve(path.size());
+
+    double totalMiles = 0;
+    double totalHours = 0;
+
+    for (int w : path)
+    {
+        const Label& label = labels.at(w);
+        const RoadMapTile& from = tileOf(label.previousVertex, heldFrom);
+        const RoadMapTile& to = tileOf(w, heldTo);
+        int e = label.previousEdge - from.offsets.front();
+
+        RoadSegment segment{from.miles[e], from.milesPerHour[e]};
+
+        totalMiles += segment.miles;
+        totalHours += segment.miles / segment.milesPerHour;
+
+        route.steps.push_back(RouteStep{
+            to.vertexNumbers[w - to.firstIndex], nameOf(to, w, heldTo), segment,
+            totalMiles, totalHours});
+    }
+
+    return route;
+}
+
+
+int TiledRoadMap::vertexCount() const noexcept
+{
+    return vertexCount_;
+}
+
+
+int TiledRoadMap::tileCount() const noexcept
+{
+    return (vertexCount_ + tileSize_ - 1) / tileSize_;
+}
+
+
+const TileCache<RoadMapTile>& TiledRoadMap::tiles() const noexcept
+{
+    return tiles_;
+}
+
+
+MemoryUsage TiledRoadMap::memoryUsage() const
+{
+    MemoryUsage usage = tiles_.memoryUsage();
+    usage.indexes += bytesAllocated(numbers_) + bytesAllocated(indexes_);
+    return usage;
+}
+
+
+std::shared_ptr<const RoadMapTile> TiledRoadMap::load(int tile) const
+{
+    if (tile < 0 || tile >= tileCount())
+    {
+        throw DigraphException("Tile does not exist!\n");
+    }
+
+    int first = tile * tileSize_;
+    int count = std::min(tileSize_, vertexCount_ - first);
+
+    auto loaded = std::make_shared<RoadMapTile>();
+    loaded->firstIndex = first;
+    loaded->vertexNumbers = file_->copySection<int>("vertices", first, count);
+    loaded->offsets = file_->copySection<int>("offsets", first, count + 1);
+
+    std::size_t firstEdge = loaded->offsets.front();
+    std::size_t edgeCount = loaded->offsets.back() - loaded->offsets.front();
+
+    loaded->targets = file_->copySection<int>("targets", firstEdge, edgeCount);
+    loaded->miles = file_->copySection<double>("miles", firstEdge, edgeCount);
+    loaded->milesPerHour = file_->copySection<double>("speeds", firstEdge, edgeCount);
+
+    loaded->hours.reserve(edgeCount);
+
+    for (std::size_t e = 0; e < edgeCount; ++e)
+    {
+        loaded->hours.push_back(loaded->miles[e] / loaded->milesPerHour[e]);
+    }
+
+    loaded->nameEnds = file_->copySection<std::uint64_t>("nameEnds", first, count + 1);
+    loaded->names = file_->copySection<char>(
+        "names", loaded->nameEnds.front(), loaded->nameEnds.back() - loaded->nameEnds.front());
+
+    return loaded;
+}
+
+
+int TiledRoadMap::indexOf(int vertex) const
+{
+    auto found = std::lower_bound(numbers_.begin(), numbers_.end(), vertex);
+
+    if (found == numbers_.end() || *found != vertex)
+    {
+        throw DigraphException("Vertex does not exist!\n");
+    }
+
+    return indexes_[found - numbers_.begin()];
+}
+
+
+const RoadMapTile& TiledRoadMap::tileOf(
+    int index, std::shared_ptr<const RoadMapTile>& held) const
+{
+    if (held == nullptr || index < held->firstIndex
+        || index >= held->firstIndex + static_cast<int>(held->vertexNumbers.size()))
+    {
+        held = tiles_.get(index / tileSize_);
+    }
+
+    return *held;
+}
+
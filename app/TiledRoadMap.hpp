@@ -0,0 +1,143 @@
+// TiledRoadMap.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A TiledRoadMap is a read-only copy of a RoadMap that is stored in a
+// "tile file" and kept in memory only in part.  The file is an artifact
+// file (see ArtifactFile.hpp) holding the map in breadth-first order, so
+// that locations near one another are stored near one another, divided
+// into tiles of consecutive locations, each with its locations' names and
+// outgoing road segments.  Only a small index from vertex numbers to
+// positions is read when the map is opened; each tile is read the first
+// time a search reaches it and kept in a TileCache (see TileCache.hpp),
+// which evicts the tiles used least recently once they add up to more
+// than its budget.  Memory use therefore grows with the part of the map
+// that trips actually use, rather than with the whole map.
+//
+// Routes are found and described exactly as by a
+// CompactRoadMap<DoublePrecision> built in breadth-first order.  A Route
+// holds views of location names, which must outlive it even if their
+// tiles are evicted, so each Route also holds a share of the tiles its
+// names are in.  A tile evicted while a Route still holds it stays in
+// memory, outside the budget, until the Route is destroyed.
+
+#ifndef TILEDROADMAP_HPP
+#define TILEDROADMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ArtifactFile.hpp"
+#include "MemoryUsage.hpp"
+#include "RoadMap.hpp"
+#include "Route.hpp"
+#include "TileCache.hpp"
+#include "Trip.hpp"
+
+
+
+// A RoadMapTile is one tile of a TiledRoadMap: the locations with indexes
+// firstIndex up to (but not including) firstIndex + vertexNumbers.size(),
+// and the road segments leading out of them, which are those with edge
+// indexes offsets.front() up to (but not including) offsets.back().
+
+struct RoadMapTile
+{
+    int firstIndex;
+    std::vector<int> vertexNumbers;
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    std::vector<double> miles;
+    std::vector<double> milesPerHour;
+    std::vector<double> hours;
+    std::vector<char> names;
+    std::vector<std::uint64_t> nameEnds;
+
+    // name() returns the name of the location with the given index, which
+    // is valid for as long as the tile is.
+    std::string_view name(int index) const;
+
+    MemoryUsage memoryUsage() const noexcept;
+};
+
+
+
+class TiledRoadMap
+{
+public:
+    // The number of locations in each tile, unless another is given.
+    static constexpr int defaultTileSize = 1024;
+
+    // write() writes the given RoadMap to a tile file with the given path,
+    // with the given number of locations in each tile.  If the file can't
+    // be written, a DigraphException is thrown.
+    static void write(
+        const RoadMap& roadMap, const std::string& path, int tileSize = defaultTileSize);
+
+    // Opens the tile file with the given path, keeping at most the given
+    // number of bytes of tiles in memory.  If the file can't be opened or
+    // isn't a tile file, a DigraphException is thrown.
+    TiledRoadMap(const std::string& path, std::size_t budget);
+
+    // Opens the tile file with the given path if it holds the given
+    // RoadMap, or otherwise writes it first, so that the RoadMap can be
+    // discarded as soon as the TiledRoadMap is built.
+    TiledRoadMap(const RoadMap& roadMap, const std::string& path, std::size_t budget);
+
+    // A TiledRoadMap's tiles are read from its own open file, so it can't
+    // be copied.
+    TiledRoadMap(const TiledRoadMap&) = delete;
+    TiledRoadMap& operator=(const TiledRoadMap&) = delete;
+
+    // findRoute() finds the shortest route for the given trip, in the
+    // same form as RouteFinder::findRoute(), reading whichever tiles the
+    // search reaches.  If either of the trip's vertices does not exist, a
+    // DigraphException is thrown.
+    Route findRoute(const Trip& trip) const;
+
+    // vertexCount() returns the number of locations, and tileCount() the
+    // number of tiles they're divided into.
+    int vertexCount() const noexcept;
+    int tileCount() const noexcept;
+
+    // tiles() returns the cache of tiles, which says how many are in
+    // memory and how often they've been loaded and evicted.
+    const TileCache<RoadMapTile>& tiles() const noexcept;
+
+    // memoryUsage() returns the memory allocated for the index and the
+    // tiles in the cache.
+    MemoryUsage memoryUsage() const;
+
+private:
+    // load() reads the tile with the given number from the file.
+    std::shared_ptr<const RoadMapTile> load(int tile) const;
+
+    // indexOf() returns the index of the location with the given vertex
+    // number, or throws a DigraphException if there is none.
+    int indexOf(int vertex) const;
+
+    // tileOf() returns the tile holding the location with the given
+    // index, which is the one in held if it's there, and otherwise is
+    // fetched from the cache and left in held, so that it stays valid for
+    // as long as the caller needs it.
+    const RoadMapTile& tileOf(int index, std::shared_ptr<const RoadMapTile>& held) const;
+
+    std::unique_ptr<ArtifactFile> file_;
+    int tileSize_;
+    int vertexCount_;
+
+    // The vertex numbers of every location, in increasing order, and the
+    // index of each.
+    std::vector<int> numbers_;
+    std::vector<int> indexes_;
+
+    mutable TileCache<RoadMapTile> tiles_;
+};
+
+
+
+#endif // TILEDROADMAP_HPP
@@ -0,0 +1,152 @@
+// TraceRecorder.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <utility>
+#include "TraceRecorder.hpp"
+
+
+namespace
+{
+    // writeJsonString() writes s as a quoted JSON string.
+    void writeJsonString(std::ostream& out, const std::string& s)
+    {
+        static const char hexDigits[] = "0123456789abcdef";
+
+        out << '"';
+
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out << "\\u00" << hexDigits[(c >> 4) & 0xf] << hexDigits[c & 0xf];
+            }
+            else
+            {
+                out << c;
+            }
+        }
+
+        out << '"';
+    }
+
+
+    double microsecondsBetween(
+        std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end)
+    {
+        return std::chrono::duration<double, std::micro>(end - start).count();
+    }
+}
+
+
+TraceRecorder::TraceRecorder()
+    : origin_{std::chrono::steady_clock::now()}
+{
+}
+
+
+void TraceRecorder::record(
+    const char* name, const char* category,
+    std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point end,
+    const std::string& detail)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    events_.push_back(Event{
+        name, category, threadNumber(),
+        microsecondsBetween(origin_, start),
+        microsecondsBetween(start, end),
+        detail});
+}
+
+
+void TraceRecorder::nameThread(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    threadNames_[threadNumber()] = name;
+}
+
+
+void TraceRecorder::writeJson(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    bool first = true;
+
+    for (const auto& threadName : threadNames_)
+    {
+        out << (first ? "" : ",\n")
+            << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+            << threadName.first << ", \"args\": {\"name\": ";
+        writeJsonString(out, threadName.second);
+        out << "}}";
+
+        first = false;
+    }
+
+    out.setf(std::ios::fixed);
+    out.precision(3);
+
+    for (const Event& event : events_)
+    {
+        out << (first ? "" : ",\n") << "{\"name\": ";
+        writeJsonString(out, event.name);
+        out << ", \"cat\": ";
+        writeJsonString(out, event.category);
+        out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+            << ", \"ts\": " << event.startMicroseconds
+            << ", \"dur\": " << event.durationMicroseconds;
+
+        if (!event.detail.empty())
+        {
+            out << ", \"args\": {\"detail\": ";
+            writeJsonString(out, event.detail);
+            out << "}";
+        }
+
+        out << "}";
+
+        first = false;
+    }
+
+    out << "\n]}" << std::endl;
+}
+
+
+// threadNumber() returns a small number identifying the calling thread,
+// in the order the threads were first seen.  The mutex must be locked.
+int TraceRecorder::threadNumber()
+{
+    return threads_.emplace(std::this_thread::get_id(), threads_.size() + 1).first->second;
+}
+
+
+TraceSpan::TraceSpan(
+    TraceRecorder* trace, const char* name, const char* category,
+    std::string detail)
+    : trace_{trace}, name_{name}, category_{category}, detail_{std::move(detail)}
+{
+    if (trace_ != nullptr)
+    {
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+
+TraceSpan::~TraceSpan()
+{
+    if (trace_ != nullptr)
+    {
+        trace_->record(name_, category_, start_, std::chrono::steady_clock::now(), detail_);
+    }
+}
+
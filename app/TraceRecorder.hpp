@@ -0,0 +1,104 @@
+// TraceRecorder.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A TraceRecorder records a timeline of what each thread of the program
+// was doing, as a sequence of named spans of time, and writes it out in
+// the JSON "trace event" format understood by Chrome's about:tracing page
+// and by Perfetto (ui.perfetto.dev), both of which can open the file
+// offline.  Where QueryStats only says how much time was spent in total,
+// a trace shows which particular trips were slow and how evenly the work
+// was spread across the threads.
+//
+// Spans are recorded with TraceSpan objects, which cover the time from
+// their construction to their destruction.  Like QueryStats::Timer, a
+// TraceSpan given a null TraceRecorder pointer does nothing.  All of the
+// member functions are safe to call from several threads at once.
+
+#ifndef TRACERECORDER_HPP
+#define TRACERECORDER_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+
+class TraceRecorder
+{
+public:
+    // Initializes a TraceRecorder, whose timeline begins now.
+    TraceRecorder();
+
+    // record() records a span with the given name and category, covering
+    // the given time on the calling thread.  If detail is not empty, it is
+    // shown along with the span.
+    void record(
+        const char* name, const char* category,
+        std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end,
+        const std::string& detail = "");
+
+    // nameThread() gives the calling thread a name to show in the trace.
+    void nameThread(const std::string& name);
+
+    // writeJson() writes every span recorded so far to the given output
+    // stream in the trace event format.
+    void writeJson(std::ostream& out) const;
+
+private:
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        int thread;
+        double startMicroseconds;
+        double durationMicroseconds;
+        std::string detail;
+    };
+
+    int threadNumber();
+
+    std::chrono::steady_clock::time_point origin_;
+
+    mutable std::mutex mutex_;
+    std::vector<Event> events_;
+    std::map<std::thread::id, int> threads_;
+    std::map<int, std::string> threadNames_;
+};
+
+
+
+class TraceSpan
+{
+public:
+    // Starts a span with the given name and category, unless trace is
+    // null.  The name and category must be string literals (or otherwise
+    // outlive the TraceRecorder).
+    TraceSpan(
+        TraceRecorder* trace, const char* name, const char* category,
+        std::string detail = "");
+
+    // Records the span in the TraceRecorder.
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceRecorder* trace_;
+    const char* name_;
+    const char* category_;
+    std::string detail_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+
+
+#endif // TRACERECORDER_HPP
+
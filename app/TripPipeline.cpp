@@ -0,0 +1,246 @@
+// TripPipeline.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.hpp"
+#include "TripPipeline.hpp"
+#include "TripReader.hpp"
+
+
+namespace
+{
+    struct Job
+    {
+        long long sequence;
+        Trip trip;
+    };
+
+
+    struct Result
+    {
+        long long sequence;
+        Route route;
+    };
+
+
+    // The Window keeps the reader from getting more than a fixed number of
+    // trips ahead of the writer, which bounds not only the queues but also
+    // the routes the writer holds back while it waits for an earlier one.
+    // It also records the first failure from any thread, which stops
+    // every stage of the pipeline.
+    class Window
+    {
+    public:
+        explicit Window(std::size_t size)
+            : size_{static_cast<long long>(size)}, written_{0}, stopped_{false}
+        {
+        }
+
+        bool waitForRoom(long long sequence)
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            changed_.wait(lock, [&] { return stopped_ || sequence - written_ < size_; });
+            return !stopped_;
+        }
+
+        void markWritten()
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            ++written_;
+            changed_.notify_all();
+        }
+
+        void fail(std::exception_ptr error)
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+
+            if (!error_)
+            {
+                error_ = error;
+            }
+
+            stopped_ = true;
+            changed_.notify_all();
+        }
+
+        std::exception_ptr error()
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            return error_;
+        }
+
+    private:
+        long long size_;
+        long long written_;
+        bool stopped_;
+        std::exception_ptr error_;
+        std::mutex mutex_;
+        std::condition_variable changed_;
+    };
+}
+
+
+TripPipeline::TripPipeline(
+    unsigned int workers, std::size_t window, const NumaTopology* numa)
+    : workers_{workers > 0 ? workers : 1}, window_{window > 0 ? window : 1},
+      numa_{numa}
+{
+}
+
+
+void TripPipeline::run(
+    std::function<Route(const Trip&)> findRoute,
+    InputReader& in, RouteWriter& writer,
+    QueryStats* stats, TraceRecorder* trace)
+{
+    BoundedQueue<Job> jobs{window_};
+    BoundedQueue<Result> results{window_};
+    Window window{window_};
+
+    std::thread reader{
+        [&]
+        {
+            if (trace != nullptr)
+            {
+                trace->nameThread("reader");
+            }
+
+            try
+            {
+                TripReader tripReader;
+                long long numberOfTrips;
+
+                {
+                    QueryStats::Timer timer{stats, QueryStats::Phase::Parse};
+                    TraceSpan span{trace, "readTripCount", "parse"};
+                    numberOfTrips = tripReader.readTripCount(in);
+                }
+
+                for (long long i = 0; i < numberOfTrips; ++i)
+                {
+                    Trip trip;
+
+                    {
+                        QueryStats::Timer timer{stats, QueryStats::Phase::Parse};
+                        TraceSpan span{trace, "readTrip", "parse"};
+                        trip = tripReader.readTrip(in);
+                    }
+
+                    if (!window.waitForRoom(i) || !jobs.push(Job{i, trip}))
+                    {
+                        break;
+                    }
+                }
+            }
+            catch (...)
+            {
+                window.fail(std::current_exception());
+                results.close();
+            }
+
+            jobs.close();
+        }};
+
+    std::atomic<unsigned int> runningWorkers{workers_};
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 0; i < workers_; ++i)
+    {
+        workers.emplace_back(
+            [&, i]
+            {
+                if (trace != nullptr)
+                {
+                    trace->nameThread("worker " + std::to_string(i + 1));
+                }
+
+                if (numa_ != nullptr)
+                {
+                    numa_->pinCurrentThread(i % numa_->nodeCount());
+                }
+
+                try
+                {
+                    Job job;
+
+                    while (jobs.pop(job))
+                    {
+                        Route route = findRoute(job.trip);
+
+                        if (!results.push(Result{job.sequence, std::move(route)}))
+                        {
+                            break;
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    window.fail(std::current_exception());
+                    jobs.close();
+                }
+
+                if (--runningWorkers == 0)
+                {
+                    results.close();
+                }
+            });
+    }
+
+    if (trace != nullptr)
+    {
+        trace->nameThread("writer");
+    }
+
+    try
+    {
+        std::map<long long, Route> pending;
+        long long next = 0;
+        Result result;
+
+        while (results.pop(result))
+        {
+            pending.emplace(result.sequence, std::move(result.route));
+
+            for (auto i = pending.find(next); i != pending.end(); i = pending.find(next))
+            {
+                {
+                    QueryStats::Timer timer{stats, QueryStats::Phase::Render};
+                    TraceSpan span{trace, "writeRoute", "render"};
+                    writer.writeRoute(i->second);
+                }
+
+                pending.erase(i);
+                ++next;
+                window.markWritten();
+            }
+        }
+    }
+    catch (...)
+    {
+        window.fail(std::current_exception());
+        jobs.close();
+        results.close();
+    }
+
+    reader.join();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    if (std::exception_ptr error = window.error())
+    {
+        std::rethrow_exception(error);
+    }
+}
+
@@ -0,0 +1,63 @@
+// TripPipeline.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A TripPipeline evaluates a stream of trips without ever holding all of
+// them in memory.  One thread reads trips from the input, a pool of worker
+// threads finds their routes, and the calling thread writes the routes out
+// in the same order the trips were read.  At most a fixed number of trips
+// (the "window") are in flight at any one time, so memory use does not
+// depend on how many trips there are, and the output is exactly what
+// evaluating the trips one at a time would produce.
+
+#ifndef TRIPPIPELINE_HPP
+#define TRIPPIPELINE_HPP
+
+#include <cstddef>
+#include <functional>
+#include "InputReader.hpp"
+#include "NumaTopology.hpp"
+#include "QueryStats.hpp"
+#include "Route.hpp"
+#include "RouteWriter.hpp"
+#include "TraceRecorder.hpp"
+#include "Trip.hpp"
+
+
+
+class TripPipeline
+{
+public:
+    // Initializes a TripPipeline that uses the given number of worker
+    // threads and allows the given number of trips to be in flight.  If
+    // a NumaTopology is given (which must outlive the TripPipeline), the
+    // workers are pinned to its nodes in turn.
+    TripPipeline(
+        unsigned int workers, std::size_t window, const NumaTopology* numa = nullptr);
+
+    // run() reads trips from the given input (in the format read by
+    // TripReader), evaluates each one by calling the given function
+    // (from the worker threads, so it must be safe to call concurrently),
+    // and writes the routes using the given RouteWriter.  It returns once
+    // every route has been written.  If reading or evaluating a trip
+    // throws an exception, the pipeline is stopped and the exception is
+    // rethrown from run().  If stats is not null, the time spent reading
+    // trips and writing routes is added to it; timing the searches is
+    // left to the given function.  If trace is not null, the reading and
+    // writing are recorded in it, and its threads are named.
+    void run(
+        std::function<Route(const Trip&)> findRoute,
+        InputReader& in, RouteWriter& writer,
+        QueryStats* stats = nullptr, TraceRecorder* trace = nullptr);
+
+private:
+    unsigned int workers_;
+    std::size_t window_;
+    const NumaTopology* numa_;
+};
+
+
+
+#endif // TRIPPIPELINE_HPP
+
@@ -4,7 +4,6 @@
 // Project #5: Rock and Roll Stops the Traffic
 
 #include <sstream>
-#include <string>
 #include "TripReader.hpp"
 
 
@@ -12,23 +11,44 @@ std::vector<Trip> TripReader::readTrips(InputReader& in)
 {
     std::vector<Trip> trips;
 
-    int numberOfTrips = in.readIntLine();
+    int numberOfTrips = readTripCount(in);
 
     for (int i = 0; i < numberOfTrips; ++i)
     {
-        std::istringstream tripLine{in.readLine()};
+        trips.push_back(readTrip(in));
+    }
 
-        int fromVertex;
-        int toVertex;
-        std::string metricType;
+    return trips;
+}
 
-        tripLine >> fromVertex >> toVertex >> metricType;
 
-        trips.push_back(
-            {fromVertex, toVertex,
-             metricType == "D" ? TripMetric::Distance : TripMetric::Time});
-    }
+int TripReader::readTripCount(InputReader& in)
+{
+    return in.readIntLine();
+}
 
-    return trips;
+
+Trip TripReader::readTrip(InputReader& in)
+{
+    Trip trip;
+    parseTrip(in.readLine(), trip);
+    return trip;
 }
 
+
+bool TripReader::parseTrip(const std::string& line, Trip& trip)
+{
+    std::istringstream tripLine{line};
+
+    int fromVertex;
+    int toVertex;
+    std::string metricType;
+
+    tripLine >> fromVertex >> toVertex >> metricType;
+
+    trip = Trip{
+        fromVertex, toVertex,
+        metricType == "D" ? TripMetric::Distance : TripMetric::Time};
+
+    return tripLine && (metricType == "D" || metricType == "T");
+}
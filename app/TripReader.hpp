@@ -9,6 +9,7 @@
 #ifndef TRIPREADER_HPP
 #define TRIPREADER_HPP
 
+#include <string>
 #include <vector>
 #include "Trip.hpp"
 #include "InputReader.hpp"
@@ -20,7 +21,18 @@ class TripReader
 public:
     // readTrips() reads a sequence of trips from the given input,
     // returning them as a vector of Trip structs.
-    std::vector<Trip> readTrips(InputReader& in);    
+    std::vector<Trip> readTrips(InputReader& in);
+
+    // readTripCount() and readTrip() read the same input one piece at a
+    // time, for callers that process trips as they arrive rather than
+    // holding all of them in memory: first the number of trips, then
+    // each trip in turn.
+    int readTripCount(InputReader& in);
+    Trip readTrip(InputReader& in);
+
+    // parseTrip() parses one line describing a trip, storing it into the
+    // given Trip.  It returns false if the line isn't a valid trip.
+    bool parseTrip(const std::string& line, Trip& trip);
 };
 
 
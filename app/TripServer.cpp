@@ -0,0 +1,437 @@
+// TripServer.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "FdStreamBuf.hpp"
+#include "InputReader.hpp"
+#include "RoadMapDeltaReader.hpp"
+#include "RoadMapReader.hpp"
+#include "RouteWriter.hpp"
+#include "TripReader.hpp"
+#include "TripServer.hpp"
+
+
+namespace
+{
+    // A Session writes one client's responses in the order its requests
+    // were read, whichever order they're finished in, and keeps the
+    // client from getting more than a window's worth of requests ahead of
+    // its responses.  The worker threads only hand finished responses
+    // over; they're written by a thread of the session's own, so a client
+    // that's slow to read its responses holds up only its own requests.
+    // Since a request's response is only handed over once there's room
+    // for it in the window, at most a window's worth of responses are
+    // ever waiting to be written.
+    class Session
+    {
+    public:
+        Session(std::ostream& out, std::size_t window)
+            : out_{out}, window_{static_cast<long long>(window)},
+              reserved_{0}, written_{0}, finished_{false},
+              writer_{[this] { writeResponses(); }}
+        {
+        }
+
+        ~Session()
+        {
+            finish();
+        }
+
+        // reserve() waits until there is room in the window, and then
+        // returns the sequence number of the next response.
+        long long reserve()
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            changed_.wait(lock, [&] { return reserved_ - written_ < window_; });
+            return reserved_++;
+        }
+
+        // deliver() hands over the response with the given sequence
+        // number, to be written once every earlier response has been.
+        void deliver(long long sequence, std::string response)
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            pending_.emplace(sequence, std::move(response));
+            changed_.notify_all();
+        }
+
+        // finish() waits until every response has been written.
+        void finish()
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex_};
+                finished_ = true;
+                changed_.notify_all();
+            }
+
+            if (writer_.joinable())
+            {
+                writer_.join();
+            }
+        }
+
+    private:
+        // writeResponses() runs on the session's writer thread, writing
+        // each response once it and every earlier one have been handed
+        // over, without holding the lock while it writes.  It returns once
+        // the session is finished and every response has been written.
+        void writeResponses()
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+
+            while (true)
+            {
+                changed_.wait(
+                    lock,
+                    [&]
+                    {
+                        return pending_.count(written_) != 0
+                            || (finished_ && written_ == reserved_);
+                    });
+
+                auto next = pending_.find(written_);
+
+                if (next == pending_.end())
+                {
+                    return;
+                }
+
+                std::string response = std::move(next->second);
+                pending_.erase(next);
+                bool more = pending_.count(written_ + 1) != 0;
+
+                lock.unlock();
+                out_ << response;
+
+                // The output is flushed whenever the responses that are
+                // ready have all been written.
+                if (!more)
+                {
+                    out_.flush();
+                }
+
+                lock.lock();
+                ++written_;
+                changed_.notify_all();
+            }
+        }
+
+        std::ostream& out_;
+        long long window_;
+        long long reserved_;
+        long long written_;
+        bool finished_;
+        std::map<long long, std::string> pending_;
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        std::thread writer_;
+    };
+
+
+    std::string errorResponse(const std::string& message)
+    {
+        std::string response = "Error: " + message;
+
+        // DigraphExceptions end their messages with a newline already.
+        if (response.back() != '\n')
+        {
+            response += '\n';
+        }
+
+        return response + '\n';
+    }
+
+
+    std::string routeResponse(const Route& route)
+    {
+        std::ostringstream out;
+
+        {
+            RouteWriter writer{out};
+            writer.writeRoute(route);
+        }
+
+        return out.str();
+    }
+
+
+    void throwSystemError(const std::string& what)
+    {
+        throw std::runtime_error{what + ": " + std::strerror(errno)};
+    }
+}
+
+
+TripServer::TripServer(
+    BuildFunc build, unsigned int workers, std::size_t window,
+    const NumaTopology* numa)
+    : build_{std::move(build)}, window_{window > 0 ? window : 1},
+      tasks_{window_}, sessions_{0}
+{
+    for (unsigned int i = 0; i < (workers > 0 ? workers : 1); ++i)
+    {
+        workers_.emplace_back(
+            [this, i, numa]
+            {
+                if (numa != nullptr)
+                {
+                    numa->pinCurrentThread(i % numa->nodeCount());
+                }
+
+                Task task;
+
+                while (tasks_.pop(task))
+                {
+                    task();
+                }
+            });
+    }
+}
+
+
+TripServer::~TripServer()
+{
+    tasks_.close();
+
+    for (std::thread& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+
+void TripServer::load(std::shared_ptr<const RoadMap> roadMap)
+{
+    std::lock_guard<std::mutex> lock{reloadMutex_};
+    install(std::move(roadMap));
+}
+
+
+int TripServer::reload(const std::string& path)
+{
+    std::ifstream file{path};
+
+    if (!file)
+    {
+        throw std::runtime_error{"Cannot open " + path};
+    }
+
+    InputReader in{file};
+    auto roadMap = std::make_shared<const RoadMap>(RoadMapReader{}.readRoadMap(in));
+    int locations = roadMap->vertexCount();
+
+    load(std::move(roadMap));
+    return locations;
+}
+
+
+int TripServer::update(const std::string& path)
+{
+    std::ifstream file{path};
+
+    if (!file)
+    {
+        throw std::runtime_error{"Cannot open " + path};
+    }
+
+    InputReader in{file};
+    RoadMapDelta delta = RoadMapDeltaReader{}.readDelta(in);
+
+    // The map is updated with the lock held, so that two updates at once
+    // are applied one after the other rather than to the same map.
+    std::lock_guard<std::mutex> lock{reloadMutex_};
+
+    if (!roadMap_)
+    {
+        throw std::runtime_error{"No road map is loaded"};
+    }
+
+    auto roadMap = std::make_shared<RoadMap>(*roadMap_);
+    delta.apply(*roadMap);
+
+    int locations = roadMap->vertexCount();
+    install(std::move(roadMap));
+    return locations;
+}
+
+
+void TripServer::serve(std::istream& in, std::ostream& out)
+{
+    Session session{out, window_};
+    InputReader reader{in};
+    TripReader tripReader;
+    std::string line;
+
+    while (reader.tryReadLine(line) && line != "quit")
+    {
+        long long sequence = session.reserve();
+
+        if (line.compare(0, 7, "reload ") == 0)
+        {
+            // The session's later requests wait for the new map, but the
+            // ones before it (and every other session's) carry on.
+            std::string path = line.substr(7);
+
+            try
+            {
+                int locations = reload(path);
+                session.deliver(
+                    sequence,
+                    "Reloaded " + path + ": " + std::to_string(locations) + " locations\n\n");
+            }
+            catch (std::exception& e)
+            {
+                session.deliver(sequence, errorResponse(e.what()));
+            }
+
+            continue;
+        }
+        else if (line.compare(0, 7, "update ") == 0)
+        {
+            std::string path = line.substr(7);
+
+            try
+            {
+                int locations = update(path);
+                session.deliver(
+                    sequence,
+                    "Updated " + path + ": " + std::to_string(locations) + " locations\n\n");
+            }
+            catch (std::exception& e)
+            {
+                session.deliver(sequence, errorResponse(e.what()));
+            }
+
+            continue;
+        }
+
+        Trip trip;
+
+        if (!tripReader.parseTrip(line, trip))
+        {
+            session.deliver(sequence, errorResponse("Unknown request: " + line));
+            continue;
+        }
+
+        std::shared_ptr<const FindRouteFunc> findRoute = std::atomic_load(&findRoute_);
+
+        if (!findRoute)
+        {
+            session.deliver(sequence, errorResponse("No road map is loaded"));
+            continue;
+        }
+
+        tasks_.push(
+            [findRoute, trip, sequence, &session]
+            {
+                std::string response;
+
+                try
+                {
+                    response = routeResponse((*findRoute)(trip));
+                }
+                catch (std::exception& e)
+                {
+                    response = errorResponse(e.what());
+                }
+
+                session.deliver(sequence, std::move(response));
+            });
+    }
+
+    session.finish();
+}
+
+
+void TripServer::serveUnixSocket(const std::string& path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error{"Socket path is too long: " + path};
+    }
+
+    std::strcpy(address.sun_path, path.c_str());
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listener < 0)
+    {
+        throwSystemError("socket");
+    }
+
+    ::unlink(path.c_str());
+
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || ::listen(listener, SOMAXCONN) < 0)
+    {
+        int error = errno;
+        ::close(listener);
+        errno = error;
+        throwSystemError(path);
+    }
+
+    int connection;
+
+    while ((connection = ::accept(listener, nullptr, nullptr)) >= 0 || errno == EINTR)
+    {
+        if (connection < 0)
+        {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{sessionsMutex_};
+            ++sessions_;
+        }
+
+        std::thread{
+            [this, connection]
+            {
+                {
+                    FdStreamBuf buffer{connection};
+                    std::istream in{&buffer};
+                    std::ostream out{&buffer};
+
+                    serve(in, out);
+                }
+
+                ::close(connection);
+
+                std::lock_guard<std::mutex> lock{sessionsMutex_};
+                --sessions_;
+                sessionsChanged_.notify_all();
+            }}.detach();
+    }
+
+    int error = errno;
+    ::close(listener);
+
+    std::unique_lock<std::mutex> lock{sessionsMutex_};
+    sessionsChanged_.wait(lock, [this] { return sessions_ == 0; });
+
+    errno = error;
+    throwSystemError("accept");
+}
+
+
+void TripServer::install(std::shared_ptr<const RoadMap> roadMap)
+{
+    auto findRoute = std::make_shared<const FindRouteFunc>(build_(roadMap));
+    std::atomic_store(&findRoute_, std::shared_ptr<const FindRouteFunc>{findRoute});
+    roadMap_ = std::move(roadMap);
+}
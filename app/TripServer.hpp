@@ -0,0 +1,152 @@
+// TripServer.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// A TripServer keeps a road map loaded and answers trips as they're asked
+// for, so that the map is read and searched structures are built only once
+// rather than once per run of the program.  It talks to any number of
+// clients ("sessions") at once, over the standard input and output or over
+// the connections to a Unix socket, using a simple line protocol.  Each
+// line a client sends is one request:
+//
+//   START END D|T   find the route of the trip from vertex START to vertex
+//                   END by distance (D) or driving time (T); the response
+//                   is the route, written as the program writes any route
+//   reload FILE     read a new road map from FILE (in the format described
+//                   in the project write-up) and use it for every trip
+//                   asked for afterward; the response is a line saying how
+//                   many locations the map has
+//   update FILE     read a map delta (see RoadMapDeltaReader.hpp) from FILE
+//                   and apply it to the map in use, then use the result as
+//                   with reload; the response is a line saying how many
+//                   locations the map has
+//   quit            end the session
+//
+// A response that is an error is a line beginning with "Error:".  Every
+// response ends with a blank line.  A client can send any number of
+// requests without waiting for their responses ("pipelining"); they're
+// evaluated by a pool of worker threads shared by all the sessions, and
+// each session's responses are written in the order its requests were
+// sent.  At most a fixed number of each session's requests (the "window")
+// are in flight at once.  Each session writes its own responses, so a
+// client that's slow to read them holds up only its own requests, not the
+// workers.
+//
+// Reloading doesn't disturb the trips already being evaluated: the new map
+// is built while the old one is still in use, and trips asked for before
+// the reload finish with the old one, which is discarded once they have.
+// Updating works the same way; the delta is applied to a copy of the map
+// in use, which shares everything the delta doesn't change other than the
+// vertex table.
+
+#ifndef TRIPSERVER_HPP
+#define TRIPSERVER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.hpp"
+#include "NumaTopology.hpp"
+#include "RoadMap.hpp"
+#include "Route.hpp"
+#include "Trip.hpp"
+
+
+
+class TripServer
+{
+public:
+    // A FindRouteFunc finds the route of one trip.  It is called from the
+    // worker threads, so it must be safe to call concurrently.
+    typedef std::function<Route(const Trip&)> FindRouteFunc;
+
+    // A BuildFunc builds whatever is needed to find routes in the given
+    // road map, returning the FindRouteFunc that uses it.
+    typedef std::function<FindRouteFunc(std::shared_ptr<const RoadMap>)> BuildFunc;
+
+    // Initializes a TripServer that builds its maps with the given
+    // function, evaluates trips with the given number of worker threads,
+    // and allows each session the given number of requests in flight.
+    // If a NumaTopology is given (which must outlive the TripServer), the
+    // workers are pinned to its nodes in turn.  Until a map is loaded,
+    // every trip's response is an error.
+    TripServer(
+        BuildFunc build, unsigned int workers, std::size_t window,
+        const NumaTopology* numa = nullptr);
+
+    // The destructor waits for the worker threads to finish what they're
+    // doing.  No session may still be running.
+    ~TripServer();
+
+    TripServer(const TripServer&) = delete;
+    TripServer& operator=(const TripServer&) = delete;
+
+    // load() builds the given road map and then starts using it for every
+    // trip asked for afterward.
+    void load(std::shared_ptr<const RoadMap> roadMap);
+
+    // reload() reads a road map from the named file and loads it,
+    // returning its number of locations.  If the file can't be read, an
+    // exception is thrown and the map in use stays in use.
+    int reload(const std::string& path);
+
+    // update() reads a map delta from the named file, applies it to the
+    // map in use, and loads the result, returning its number of
+    // locations.  If the file can't be read, or the delta can't be
+    // applied, an exception is thrown and the map in use stays in use.
+    int update(const std::string& path);
+
+    // serve() runs one session, reading requests from the given input and
+    // writing responses to the given output.  It returns once the input
+    // ends (or the client quits) and every response has been written.
+    // Sessions can be run on any number of threads at once.
+    void serve(std::istream& in, std::ostream& out);
+
+    // serveUnixSocket() listens on a Unix socket at the given path
+    // (replacing any file that's there), running a session on its own
+    // thread for each connection.  It only returns if the socket can't be
+    // set up or stops accepting connections, in which case it waits for
+    // the sessions to end and throws a std::runtime_error.
+    void serveUnixSocket(const std::string& path);
+
+private:
+    typedef std::function<void()> Task;
+
+    // install() builds the given road map and starts using it.  It must be
+    // called with reloadMutex_ locked.
+    void install(std::shared_ptr<const RoadMap> roadMap);
+
+    BuildFunc build_;
+    std::size_t window_;
+
+    // The FindRouteFunc in use, which is only accessed with std::atomic_load
+    // and std::atomic_store, so sessions can pick it up while it's being
+    // replaced.  Every request holds on to the one it started with.
+    std::shared_ptr<const FindRouteFunc> findRoute_;
+
+    // The road map in use, which updates are applied to.  Only one map is
+    // built at a time.
+    std::shared_ptr<const RoadMap> roadMap_;
+    std::mutex reloadMutex_;
+
+    BoundedQueue<Task> tasks_;
+    std::vector<std::thread> workers_;
+
+    // The number of sessions running on threads of their own, so that
+    // serveUnixSocket() can wait for them.
+    std::size_t sessions_;
+    std::mutex sessionsMutex_;
+    std::condition_variable sessionsChanged_;
+};
+
+
+
+#endif // TRIPSERVER_HPP
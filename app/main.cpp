@@ -5,140 +5,779 @@
 //
 // This is the program's main() function, which is the entry point for your
 // console user interface.
+//
+// By default, the program reads the road map and then every trip before
+// evaluating any of them, in batches, so that pairs of trips between the
+// same two places can be evaluated together.  These command-line options
+// change that:
+//
+//   --stream        evaluate trips as they are read, using a TripPipeline,
+//                   so that memory use doesn't grow with the number of trips
+//   --workers N     use N worker threads in the pipeline (by default, one
+//                   per hardware thread)
+//   --window N      allow at most N trips in flight in the pipeline
+//   --compact P     find routes in a CompactRoadMap storing road segments
+//                   with precision P, which is "double", "float", or
+//                   "fixed", or, if P is "varint", in a CompressedRoadMap
+//                   (which is smallest with "--order bfs"), and discard the
+//                   RoadMap once it's built
+//   --chains        collapse chains of pass-through vertices (places where a
+//                   road only passes through) in the CompactRoadMap, so
+//                   that searches skip them; implies "--compact double"
+//                   unless another precision is given
+//   --overlay       find routes in an OverlayRoadMap, which builds a
+//                   RouteOverlay of the map and customizes it for distance
+//                   and driving time, and discard the RoadMap once it's
+//                   built
+//   --artifacts F   load the OverlayRoadMap's overlay and customizations
+//                   from the artifact file F, if it was written for the
+//                   same map in the same order, or otherwise build them and
+//                   write them to F; implies --overlay
+//   --labels        find routes in a HubLabelRoadMap, which builds hub
+//                   labels for distance and driving time (using the
+//                   --workers threads), and discard the RoadMap once it's
+//                   built
+//   --tiles F       find routes in a TiledRoadMap, which is read from the
+//                   tile file F a tile at a time as searches reach each
+//                   part of the map (F is written from the road map first
+//                   if it doesn't already hold it), and discard the RoadMap
+//                   once it's built
+//   --tile-budget N keep at most N megabytes of tiles in memory with
+//                   --tiles, evicting the tiles used least recently (by
+//                   default, 64)
+//   --order O       store the vertices of the CompactRoadMap (or any other
+//                   map built from the RoadMap) in order O, which is
+//                   "number", "bfs", "rcm", or "degree"
+//   --numa          on a machine with several NUMA nodes, build the map
+//                   searched for routes (with --compact, --overlay, or
+//                   --labels) once in each node's memory, and pin the
+//                   worker threads (with --stream or --serve) to the nodes
+//                   in turn, so that each finds routes in its own node's
+//                   map; without those options, only the workers are
+//                   pinned.  Where the nodes can't be found, this does
+//                   nothing
+//   --stats FILE    write statistics about where the time went to FILE (or
+//                   to the standard error if FILE is "-") as JSON; search
+//                   counters are included if built with -DDIGRAPH_STATS
+//   --memory        report how much memory the road map, and the map built
+//                   from it for finding routes (if any), are using, by
+//                   category, on the standard error
+//   --components    find the strongly connected components of the road map
+//                   (using the --workers threads) and report how many there
+//                   are and how many locations the largest one has, on the
+//                   standard error, before finding any routes
+//   --serve         after reading the road map, keep it loaded and answer
+//                   trips (and reload requests) as they're read, one per
+//                   line, until the input ends; see TripServer.hpp
+//   --socket PATH   the same, but answer the clients that connect to a Unix
+//                   socket at PATH instead
+//   --delta F       after reading the road map, apply the map delta file F
+//                   to it (see RoadMapDeltaReader.hpp); may be given more
+//                   than once, in which case the deltas are applied in
+//                   turn
+//   --make-delta OLD NEW
+//                   instead of finding routes, read the road maps in the
+//                   files OLD and NEW and write the map delta that turns
+//                   the first into the second to the standard output
+//   --trace FILE    write a timeline of the parsing, building, searching,
+//                   and rendering done by each thread to FILE, in the trace
+//                   event format read by Chrome's about:tracing and Perfetto
+//
+// With --serve or --socket, an "update FILE" request applies a map delta
+// to the map in use.  Where the delta only changes road segments' distances
+// and speed limits, the ReachabilityIndex built for the map before it is
+// still current, and is used again rather than built again.
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <iostream>
-#include <iomanip>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
+#include "CompactRoadMap.hpp"
+#include "CompressedRoadMap.hpp"
+#include "HubLabelRoadMap.hpp"
+#include "NumaTopology.hpp"
+#include "OverlayRoadMap.hpp"
+#include "QueryStats.hpp"
+#include "ReachabilityIndex.hpp"
+#include "TiledRoadMap.hpp"
+#include "TraceRecorder.hpp"
+#include "TripPipeline.hpp"
+#include "TripServer.hpp"
 #include "TripReader.hpp"
+#include "RoadMapDeltaReader.hpp"
+#include "RoadMapDeltaWriter.hpp"
 #include "RoadMapReader.hpp"
-#include "RoadMapWriter.hpp"
+#include "RouteFinder.hpp"
+#include "StronglyConnectedComponents.hpp"
+#include "RouteWriter.hpp"
 
-double DistFunc (const RoadSegment& rs) 
-{
-  return rs.miles;
-}
-  
-double TimeFunc (const RoadSegment& rs)
-{
-  return rs.miles/rs.milesPerHour;
-}
 
-void formatIt(double t)
+namespace
 {
-  double temp = t*3600;
-  int hrs = temp/3600;
-  int mins = (temp - 3600*hrs) / 60;
-  double secs = temp - hrs*3600 - mins*60;
-  
-  if(hrs)
+    struct Options
     {
-      std::cout << hrs << " hours " << mins << " mins "; 
+        bool stream = false;
+        unsigned int workers = std::thread::hardware_concurrency();
+        std::size_t window = 1024;
+        std::string compact;
+        bool chains = false;
+        bool overlay = false;
+        std::string artifacts;
+        bool labels = false;
+        std::string tiles;
+        std::size_t tileBudget = 64;
+        bool memory = false;
+        bool numa = false;
+        bool components = false;
+        bool serve = false;
+        std::string socket;
+        VertexOrder order = VertexOrder::Number;
+        std::string stats;
+        std::string trace;
+        std::vector<std::string> deltas;
+        std::string makeDeltaFrom;
+        std::string makeDeltaTo;
+    };
+
+
+    VertexOrder parseVertexOrder(const std::string& name)
+    {
+        if (name == "bfs")
+        {
+            return VertexOrder::BreadthFirst;
+        }
+        else if (name == "rcm")
+        {
+            return VertexOrder::ReverseCuthillMcKee;
+        }
+        else if (name == "degree")
+        {
+            return VertexOrder::Degree;
+        }
+        else if (name != "number")
+        {
+            std::cerr << "Unknown vertex order: " << name << std::endl;
+        }
+
+        return VertexOrder::Number;
     }
-  else if(mins)
+
+
+    Options parseOptions(int argc, char** argv)
     {
-      std::cout << mins << " mins ";
+        Options options;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "--stream")
+            {
+                options.stream = true;
+            }
+            else if (arg == "--workers" && i + 1 < argc)
+            {
+                options.workers = std::stoul(argv[++i]);
+            }
+            else if (arg == "--window" && i + 1 < argc)
+            {
+                options.window = std::stoul(argv[++i]);
+            }
+            else if (arg == "--compact" && i + 1 < argc)
+            {
+                options.compact = argv[++i];
+            }
+            else if (arg == "--chains")
+            {
+                options.chains = true;
+            }
+            else if (arg == "--overlay")
+            {
+                options.overlay = true;
+            }
+            else if (arg == "--artifacts" && i + 1 < argc)
+            {
+                options.overlay = true;
+                options.artifacts = argv[++i];
+            }
+            else if (arg == "--labels")
+            {
+                options.labels = true;
+            }
+            else if (arg == "--tiles" && i + 1 < argc)
+            {
+                options.tiles = argv[++i];
+            }
+            else if (arg == "--tile-budget" && i + 1 < argc)
+            {
+                options.tileBudget = std::stoul(argv[++i]);
+            }
+            else if (arg == "--numa")
+            {
+                options.numa = true;
+            }
+            else if (arg == "--memory")
+            {
+                options.memory = true;
+            }
+            else if (arg == "--components")
+            {
+                options.components = true;
+            }
+            else if (arg == "--serve")
+            {
+                options.serve = true;
+            }
+            else if (arg == "--socket" && i + 1 < argc)
+            {
+                options.socket = argv[++i];
+            }
+            else if (arg == "--order" && i + 1 < argc)
+            {
+                options.order = parseVertexOrder(argv[++i]);
+            }
+            else if (arg == "--stats" && i + 1 < argc)
+            {
+                options.stats = argv[++i];
+            }
+            else if (arg == "--trace" && i + 1 < argc)
+            {
+                options.trace = argv[++i];
+            }
+            else if (arg == "--delta" && i + 1 < argc)
+            {
+                options.deltas.push_back(argv[++i]);
+            }
+            else if (arg == "--make-delta" && i + 2 < argc)
+            {
+                options.makeDeltaFrom = argv[++i];
+                options.makeDeltaTo = argv[++i];
+            }
+            else
+            {
+                std::cerr << "Unknown option: " << arg << std::endl;
+            }
+        }
+
+        if (options.chains && options.compact.empty())
+        {
+            options.compact = "double";
+        }
+
+        return options;
     }
-  std::cout << secs;
-}
 
-std::vector<int> coord(std::map<int, int> pv, Trip tp)
-{
-  int x = tp.startVertex;
-  int y = tp.endVertex;
-  std::vector<int> num;
-  while(x != y)
+
+    const std::size_t batchSize = 1024;
+
+
+    // A RoutesFunc evaluates a batch of trips, returning their routes in
+    // the same order.
+    typedef std::function<std::vector<Route>(const std::vector<Trip>&)> RoutesFunc;
+
+
+    // The Instruments measure the program as it runs; any may be null.
+    // The memory used by each map that's built is reported to memory.
+    struct Instruments
+    {
+        QueryStats* stats;
+        TraceRecorder* trace;
+        std::ostream* memory;
+    };
+
+
+    void writeMemoryUsage(std::ostream& out, const std::string& what, const MemoryUsage& usage)
     {
-      num.emplace(num.begin(), y);
-      y = pv[y];
+        out << "Memory used by " << what << ": " << usage.total() << " bytes\n"
+            << "  vertex table: " << usage.vertexTable << "\n"
+            << "  adjacency:    " << usage.adjacency << "\n"
+            << "  EdgeInfo:     " << usage.edgeInfo << "\n"
+            << "  VertexInfo:   " << usage.vertexInfo << "\n"
+            << "  indexes:      " << usage.indexes << "\n"
+            << "  caches:       " << usage.caches << std::endl;
     }
-  num.emplace(num.begin(), x);
-  return num;
-}
 
-void calcdist(int i, std::vector<int> num, double& tot, RoadMap rm)
-{
-  RoadSegment rs = rm.edgeInfo(num[i-1], num[i]);
-  tot += rs.miles;
-  std::cout << std::fixed << "  Continue to " << rm.vertexInfo(num[i])
-            << " (" << std::setprecision(1) << rs.miles << " miles)\n";
-}
 
-void distance(std::map<int, int> pv, Trip tp, RoadMap rm)
-{
-  std::vector<int> num = coord(pv, tp);
-  double tot = 0;
-  for(int i = 1; i < num.size(); ++i)
-     {
-       calcdist(i, num, tot, rm);
-     }
-  std::cout << "Total distance: " << tot << " miles\n\n";
-}
+    std::string describeTrip(const Trip& trip)
+    {
+        return std::to_string(trip.startVertex) + " -> " + std::to_string(trip.endVertex)
+            + (trip.metric == TripMetric::Distance ? " (distance)" : " (time)");
+    }
 
-double calctime(int i, std::vector<int> num, double& tot, RoadMap rm)
-{
-  double pathtime = 0;
-  RoadSegment rs = rm.edgeInfo(num[i-1], num[i]);
-  tot += rs.miles/rs.milesPerHour;
-  pathtime += rs.miles/rs.milesPerHour;
-  std::cout << std::fixed << "  Continue to " << rm.vertexInfo(num[i])
-            << " (" << std::setprecision(1) << rs.miles << " @ "
-            << rs.milesPerHour << "mph = ";
-  return pathtime;
-}
 
-void time(std::map<int, int> pv, Trip tp, RoadMap rm)
-{
-  std::vector<int> num = coord(pv, tp);
-  double tot = 0;
-  for(int i = 1; i < num.size(); ++i)
-     {
-       double pv = calctime(i, num, tot, rm);
-       formatIt(pv);
-       std::cout << " secs)\n";
-     }
-  std::cout << "Total time: ";
-  formatIt(tot);
-  std::cout << " secs\n\n";
+    // mapRouteFinder() builds a map of type Map from the given RoadMap and
+    // the other given arguments, and returns a function that finds each
+    // trip's route in it.  If a NumaTopology is given, the map is built
+    // once on each of its nodes, and each trip's route is found in the one
+    // on the node that's looking for it.  The name is used in the trace.
+    template <typename Map, typename... Args>
+    RoutesFunc mapRouteFinder(
+        const char* name, Instruments instruments, const NumaTopology* numa,
+        const RoadMap& roadMap, Args... args)
+    {
+        std::shared_ptr<const NumaReplicas<Map>> maps;
+
+        {
+            QueryStats::Timer timer{instruments.stats, QueryStats::Phase::Build};
+            TraceSpan span{instruments.trace, name, "build"};
+            maps = std::make_shared<const NumaReplicas<Map>>(
+                numa, [&] { return std::make_unique<Map>(roadMap, args...); });
+        }
+
+        if (instruments.memory != nullptr)
+        {
+            writeMemoryUsage(
+                *instruments.memory,
+                maps->replicaCount() == 1 ? "the map searched for routes"
+                    : "each of the " + std::to_string(maps->replicaCount())
+                        + " replicas of the map searched for routes",
+                maps->replica(0).memoryUsage());
+        }
+
+        return [maps, instruments](const std::vector<Trip>& trips)
+        {
+            const Map& map = maps->local();
+            std::vector<Route> routes;
+
+            for (const Trip& trip : trips)
+            {
+                QueryStats::Timer timer{instruments.stats, QueryStats::Phase::Search, true};
+                TraceSpan span{
+                    instruments.trace, "findRoute", "search",
+                    instruments.trace != nullptr ? describeTrip(trip) : ""};
+                routes.push_back(map.findRoute(trip));
+            }
+
+            return routes;
+        };
+    }
+
+
+    template <typename Precision>
+    RoutesFunc compactRouteFinder(
+        const RoadMap& roadMap, VertexOrder order, bool chains, Instruments instruments,
+        const NumaTopology* numa)
+    {
+        return mapRouteFinder<CompactRoadMap<Precision>>(
+            "buildCompactRoadMap", instruments, numa, roadMap, order, chains);
+    }
+
+
+    // reportComponents() finds the strongly connected components of the
+    // road map and writes a summary of them to the given stream.  Only
+    // trips within the largest component are sure to have routes.
+    void reportComponents(
+        const RoadMap& roadMap, unsigned int threads, TraceRecorder* trace,
+        std::ostream& out)
+    {
+        TraceSpan span{trace, "findComponents", "build"};
+
+        CompactDigraph graph{roadMap, [](int, const RoadSegment&) { }};
+        StronglyConnectedComponents components{graph, threads};
+
+        int largest = components.largestComponent();
+
+        out << "Strongly connected components: " << components.componentCount()
+            << "; the largest has "
+            << (largest == -1 ? 0 : components.componentSize(largest))
+            << " of " << graph.vertexCount() << " locations" << std::endl;
+    }
+
+
+    // makeRouteFinder() returns the function used to evaluate trips,
+    // which may (as with --compact, --overlay, --labels, or --tiles) no
+    // longer need the RoadMap.  The time spent building and searching is
+    // measured by the given Instruments.  If a NumaTopology is given, the
+    // map built from the RoadMap (if any) is replicated on each of its
+    // nodes.  Without such a map, routes are found in the RoadMap itself,
+    // with the help of a ReachabilityIndex: the given one, if it's still
+    // current for the RoadMap, or otherwise a new one, which replaces it.
+    RoutesFunc makeRouteFinder(
+        const Options& options, const std::shared_ptr<const RoadMap>& roadMap,
+        Instruments instruments, const NumaTopology* numa,
+        std::shared_ptr<const ReachabilityIndex>& reachability)
+    {
+        if (!options.tiles.empty())
+        {
+            return mapRouteFinder<TiledRoadMap>(
+                "buildTiledRoadMap", instruments, numa, *roadMap, options.tiles,
+                options.tileBudget << 20);
+        }
+        else if (options.labels)
+        {
+            return mapRouteFinder<HubLabelRoadMap>(
+                "buildHubLabelRoadMap", instruments, numa, *roadMap, options.order,
+                options.workers);
+        }
+        else if (options.overlay)
+        {
+            return mapRouteFinder<OverlayRoadMap>(
+                "buildOverlayRoadMap", instruments, numa, *roadMap, options.order,
+                options.artifacts);
+        }
+        else if (options.compact == "double")
+        {
+            return compactRouteFinder<DoublePrecision>(
+                *roadMap, options.order, options.chains, instruments, numa);
+        }
+        else if (options.compact == "float")
+        {
+            return compactRouteFinder<FloatPrecision>(
+                *roadMap, options.order, options.chains, instruments, numa);
+        }
+        else if (options.compact == "fixed")
+        {
+            return compactRouteFinder<FixedPrecision<100000>>(
+                *roadMap, options.order, options.chains, instruments, numa);
+        }
+        else if (options.compact == "varint")
+        {
+            return mapRouteFinder<CompressedRoadMap>(
+                "buildCompressedRoadMap", instruments, numa, *roadMap, options.order);
+        }
+        else if (!options.compact.empty())
+        {
+            std::cerr << "Unknown precision: " << options.compact << std::endl;
+        }
+
+        // The RoadMap won't change while it's being searched, so trips
+        // with no route can be answered by a ReachabilityIndex.
+        if (!reachability || !reachability->isCurrent(*roadMap))
+        {
+            QueryStats::Timer timer{instruments.stats, QueryStats::Phase::Build};
+            TraceSpan span{instruments.trace, "buildReachabilityIndex", "build"};
+            reachability = std::make_shared<const ReachabilityIndex>(*roadMap, options.workers);
+        }
+
+        if (instruments.memory != nullptr)
+        {
+            writeMemoryUsage(
+                *instruments.memory, "the reachability index", reachability->memoryUsage());
+        }
+
+        return [roadMap, reachability, instruments](const std::vector<Trip>& trips)
+        {
+            // Trips between the same two places are found in a single
+            // search (see RouteFinder::findRoutes()), so each such group
+            // is counted and traced as one search.
+            std::map<std::pair<int, int>, std::vector<std::size_t>> groups;
+
+            for (std::size_t i = 0; i < trips.size(); ++i)
+            {
+                groups[std::make_pair(trips[i].startVertex, trips[i].endVertex)].push_back(i);
+            }
+
+            RouteFinder finder{reachability.get()};
+            std::vector<Route> routes(trips.size());
+
+            for (const auto& group : groups)
+            {
+                std::vector<Trip> groupTrips;
+
+                for (std::size_t i : group.second)
+                {
+                    groupTrips.push_back(trips[i]);
+                }
+
+                QueryStats::Timer timer{instruments.stats, QueryStats::Phase::Search, true};
+                TraceSpan span{
+                    instruments.trace, "findRoutes", "search",
+                    instruments.trace != nullptr ? describeTrip(groupTrips.front()) : ""};
+                std::vector<Route> groupRoutes = finder.findRoutes(*roadMap, groupTrips);
+
+                for (std::size_t j = 0; j < group.second.size(); ++j)
+                {
+                    routes[group.second[j]] = std::move(groupRoutes[j]);
+                }
+            }
+
+            return routes;
+        };
+    }
+
+
+    // readRoadMapFile() reads a road map from the file with the given
+    // path, throwing a std::runtime_error if it can't be opened.
+    RoadMap readRoadMapFile(const std::string& path)
+    {
+        std::ifstream file{path};
+
+        if (!file)
+        {
+            throw std::runtime_error{"Cannot open " + path};
+        }
+
+        InputReader in{file};
+        return RoadMapReader{}.readRoadMap(in);
+    }
+
+
+    // applyDeltas() applies the map delta files with the given paths to
+    // the given road map, in turn.  If any of them can't be read or
+    // applied, the program ends with a message saying why.
+    void applyDeltas(
+        const std::vector<std::string>& paths, RoadMap& roadMap, TraceRecorder* trace)
+    {
+        for (const std::string& path : paths)
+        {
+            TraceSpan span{trace, "applyDelta", "parse", path};
+
+            try
+            {
+                std::ifstream file{path};
+
+                if (!file)
+                {
+                    throw std::runtime_error{"Cannot open " + path};
+                }
+
+                InputReader in{file};
+                RoadMapDeltaReader{}.readDelta(in).apply(roadMap);
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "Cannot apply map delta " << path << ": " << e.what() << std::endl;
+                std::exit(1);
+            }
+        }
+    }
+
+
+    // writeMapDelta() writes the map delta that turns the road map in the
+    // file with the first given path into the one in the second, and
+    // returns the program's exit status.
+    int writeMapDelta(const std::string& fromPath, const std::string& toPath, std::ostream& out)
+    {
+        try
+        {
+            RoadMap before = readRoadMapFile(fromPath);
+            RoadMap after = readRoadMapFile(toPath);
+            RoadMapDeltaWriter{}.writeDelta(out, before, after);
+            return 0;
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+
+    // writeInstruments() writes out whatever the Instruments measured, as
+    // the options ask.
+    void writeInstruments(const Options& options, Instruments instruments)
+    {
+        if (instruments.trace != nullptr)
+        {
+            std::ofstream traceFile{options.trace};
+            instruments.trace->writeJson(traceFile);
+        }
+
+        if (instruments.stats != nullptr)
+        {
+            if (options.stats == "-")
+            {
+                instruments.stats->writeJson(std::cerr, collectDigraphStats());
+            }
+            else
+            {
+                std::ofstream statsFile{options.stats};
+                instruments.stats->writeJson(statsFile, collectDigraphStats());
+            }
+        }
+    }
+
+
+    // runServer() answers trips with a TripServer until the standard input
+    // ends (or, with --socket, until the socket fails), and returns the
+    // program's exit status.  Whenever a map is loaded, routes are found
+    // the same way as without --serve.
+    int runServer(
+        const Options& options, std::shared_ptr<const RoadMap> roadMap,
+        Instruments instruments, const NumaTopology* numa)
+    {
+        // Each map's ReachabilityIndex is kept for the next one, which can
+        // use it again if an update changed only road segments.  Maps are
+        // built one at a time, so it's never used by two builds at once.
+        std::shared_ptr<const ReachabilityIndex> reachability;
+        int status = 0;
+
+        // The server's workers are joined when it's destroyed, so it's
+        // destroyed before the instruments they use are written.
+        {
+            TripServer server{
+                [&options, instruments, numa, &reachability](std::shared_ptr<const RoadMap> map)
+                {
+                    RoutesFunc findRoutes =
+                        makeRouteFinder(options, map, instruments, numa, reachability);
+
+                    return [findRoutes](const Trip& trip)
+                    {
+                        return findRoutes(std::vector<Trip>{trip}).front();
+                    };
+                },
+                options.workers, options.window, numa};
+
+            server.load(std::move(roadMap));
+
+            if (options.socket.empty())
+            {
+                server.serve(std::cin, std::cout);
+            }
+            else
+            {
+                try
+                {
+                    server.serveUnixSocket(options.socket);
+                }
+                catch (std::exception& e)
+                {
+                    std::cerr << e.what() << std::endl;
+                    status = 1;
+                }
+            }
+        }
+
+        writeInstruments(options, instruments);
+        return status;
+    }
 }
 
-int main()
+
+int main(int argc, char** argv)
 {
-  InputReader inp = InputReader(std::cin);
-  RoadMapReader rmdrk;
-  RoadMap rm = rmdrk.readRoadMap(inp);
-  TripReader tp;
-  std::vector<Trip> tpvec = tp.readTrips(inp);
-  std::map<int, int> dijk;
-  struct v
-  {
-    std::string strt;
-    std::string end;
-  };
-  
-  for(auto& ent: tpvec)
-    {
-      if(ent.metric == TripMetric::Distance)
-        {
-          v d;
-          d.strt = rm.vertexInfo(ent.startVertex);
-          d.end = rm.vertexInfo(ent.endVertex);
-          std::cout << "Shortest distance from " << d.strt << " to " << d.end
-                    << std::endl << "  Begin at " << d.strt << std::endl;
-          dijk = rm.findShortestPaths(ent.startVertex, DistFunc);
-          distance(dijk, ent, rm);
-        }
-      else
-        {
-           v t;
-           t.strt = rm.vertexInfo(ent.startVertex);
-           t.end = rm.vertexInfo(ent.endVertex);  
-           std::cout << "Shortest time from " << t.strt << " to " << t.end
-                     << std::endl << "  Begin at " << t.strt << std::endl;
-          dijk = rm.findShortestPaths(ent.startVertex, TimeFunc);
-          time(dijk, ent, rm);
-        }
-    }
-
-  return 0;
-}
+    Options options = parseOptions(argc, argv);
+
+    if (!options.makeDeltaFrom.empty())
+    {
+        return writeMapDelta(options.makeDeltaFrom, options.makeDeltaTo, std::cout);
+    }
+
+    std::unique_ptr<QueryStats> queryStats;
+
+    if (!options.stats.empty())
+    {
+        queryStats = std::make_unique<QueryStats>();
+    }
+
+    std::unique_ptr<TraceRecorder> traceRecorder;
+
+    if (!options.trace.empty())
+    {
+        traceRecorder = std::make_unique<TraceRecorder>();
+        traceRecorder->nameThread("main");
+    }
+
+    QueryStats* stats = queryStats.get();
+    TraceRecorder* trace = traceRecorder.get();
+
+    InputReader in{std::cin};
+
+    std::shared_ptr<const RoadMap> roadMap;
+
+    {
+        QueryStats::Timer timer{stats, QueryStats::Phase::Parse};
+        TraceSpan span{trace, "readRoadMap", "parse"};
+        RoadMapReader roadMapReader;
+        RoadMap readMap = roadMapReader.readRoadMap(in);
+        applyDeltas(options.deltas, readMap, trace);
+        roadMap = std::make_shared<const RoadMap>(readMap);
+    }
+
+    std::ostream* memory = options.memory ? &std::cerr : nullptr;
+
+    NumaTopology topology = options.numa ? NumaTopology::detect() : NumaTopology{};
+    const NumaTopology* numa = options.numa ? &topology : nullptr;
+
+    if (memory != nullptr)
+    {
+        writeMemoryUsage(*memory, "the road map", roadMap->memoryUsage());
+    }
+
+    if (options.components)
+    {
+        reportComponents(*roadMap, options.workers, trace, std::cerr);
+    }
+
+    if (options.serve || !options.socket.empty())
+    {
+        return runServer(
+            options, std::move(roadMap), Instruments{stats, trace, memory}, numa);
+    }
 
+    std::shared_ptr<const ReachabilityIndex> reachability;
+    RoutesFunc findRoutes;
+
+    // The map can be one that the chosen structure can't store (e.g., one
+    // whose values are out of range for fixed precision).
+    try
+    {
+        findRoutes = makeRouteFinder(
+            options, roadMap, Instruments{stats, trace, memory}, numa, reachability);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    roadMap.reset();
+
+    RouteWriter routeWriter{std::cout};
+
+    if (options.stream)
+    {
+        TripPipeline pipeline{options.workers, options.window, numa};
+        pipeline.run(
+            [&findRoutes](const Trip& trip)
+            {
+                return findRoutes(std::vector<Trip>{trip}).front();
+            },
+            in, routeWriter, stats, trace);
+    }
+    else
+    {
+        std::vector<Trip> trips;
+
+        {
+            QueryStats::Timer timer{stats, QueryStats::Phase::Parse};
+            TraceSpan span{trace, "readTrips", "parse"};
+            TripReader tripReader;
+            trips = tripReader.readTrips(in);
+        }
+
+        for (std::size_t first = 0; first < trips.size(); first += batchSize)
+        {
+            std::vector<Trip> batch{
+                trips.begin() + first,
+                trips.begin() + std::min(first + batchSize, trips.size())};
+
+            std::vector<Route> routes = findRoutes(batch);
+
+            QueryStats::Timer timer{stats, QueryStats::Phase::Render};
+            TraceSpan span{trace, "writeRoutes", "render"};
+
+            for (const Route& route : routes)
+            {
+                routeWriter.writeRoute(route);
+            }
+        }
+    }
+
+    {
+        QueryStats::Timer timer{stats, QueryStats::Phase::Render};
+        TraceSpan span{trace, "flush", "render"};
+        routeWriter.flush();
+    }
+
+    writeInstruments(options, Instruments{stats, trace, memory});
+    return 0;
+}
@@ -0,0 +1,517 @@
+// ArtifactFile.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares classes for saving the results of preprocessing
+// a graph (orderings, partitions, customized weights, and so on, called
+// "artifacts") to a file, so that later runs of a program can load them
+// instead of doing the preprocessing again.
+//
+// * A ContentHash hashes whatever the artifacts were computed from (the
+//   graph, its edge weights, and the parameters of the preprocessing) into
+//   a 64-bit value.
+//
+// * An ArtifactWriter collects named "sections", each an array of numbers,
+//   and writes them to a file along with the ContentHash of what they were
+//   computed from.
+//
+// * An ArtifactFile maps such a file into memory, so that loading it costs
+//   almost nothing until its sections are used, and gives access to its
+//   sections without copying them.  It checks that the file is one it
+//   understands and that it was written for the ContentHash it expects; a
+//   file written for anything else is "stale" and is rejected.
+//
+// A file consists of a header, a table of sections, and then the sections'
+// contents, each aligned to 8 bytes.  Numbers are stored as they are in
+// memory, so a file can only be read on the kind of machine that wrote it
+// (which the header's magic number detects).
+
+#ifndef ARTIFACTFILE_HPP
+#define ARTIFACTFILE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Digraph.hpp"
+
+
+
+// A ContentHash is a 64-bit FNV-1a hash of everything added to it.  It is
+// meant to tell whether two things are the same, not to resist tampering.
+
+class ContentHash
+{
+public:
+    ContentHash() noexcept;
+
+    // add() adds the given bytes, number, array of numbers, or string to
+    // the hash.
+    void add(const void* bytes, std::size_t size) noexcept;
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type
+    add(T value) noexcept;
+
+    template <typename T>
+    void add(const std::vector<T>& values) noexcept;
+
+    void add(std::string_view s) noexcept;
+
+    std::uint64_t value() const noexcept;
+
+private:
+    std::uint64_t value_;
+};
+
+
+
+// An ArtifactSection is a read-only view of one section of an ArtifactFile,
+// which is valid for as long as the ArtifactFile is.
+
+template <typename T>
+struct ArtifactSection
+{
+    const T* data;
+    std::size_t size;
+
+    const T* begin() const noexcept { return data; }
+    const T* end() const noexcept { return data + size; }
+    const T& operator[](std::size_t i) const noexcept { return data[i]; }
+};
+
+
+
+class ArtifactWriter
+{
+public:
+    // addSection() adds a section with the given name (of at most 23
+    // characters) and contents.  If there is already a section with that
+    // name, a DigraphException is thrown.
+    template <typename T>
+    void addSection(const std::string& name, const std::vector<T>& values);
+
+    // write() writes the sections to the file with the given path, along
+    // with the given ContentHash.  The file is written under another name
+    // and then renamed, so that a program reading it never sees part of
+    // one.  If it can't be written, a DigraphException is thrown.
+    void write(const std::string& path, std::uint64_t contentHash) const;
+
+private:
+    struct Section
+    {
+        std::string name;
+        std::uint32_t elementSize;
+        std::vector<char> bytes;
+    };
+
+    std::vector<Section> sections_;
+};
+
+
+
+class ArtifactFile
+{
+public:
+    // The version of the file format, which is changed whenever the
+    // format (or the meaning of the sections any program writes) changes.
+    static constexpr std::uint32_t formatVersion = 1;
+
+    // Maps the file with the given path into memory and checks that it
+    // was written for the given ContentHash.  If the file doesn't exist,
+    // isn't an artifact file of this version, is damaged, or is stale, a
+    // DigraphException saying why is thrown.
+    ArtifactFile(const std::string& path, std::uint64_t contentHash);
+
+    ~ArtifactFile();
+
+    ArtifactFile(const ArtifactFile&) = delete;
+    ArtifactFile& operator=(const ArtifactFile&) = delete;
+
+    // hasSection() returns true if there is a section with the given name.
+    bool hasSection(const std::string& name) const;
+
+    // section() returns a view of the section with the given name, whose
+    // elements are of type T.  If there is no such section, or its
+    // elements aren't the size of a T, a DigraphException is thrown.
+    template <typename T>
+    ArtifactSection<T> section(const std::string& name) const;
+
+    // copySection() returns a copy of the section with the given name.
+    template <typename T>
+    std::vector<T> copySection(const std::string& name) const;
+
+    // This overload copies only the given number of elements of the
+    // section, starting at the element with the given index, and then lets
+    // the operating system drop the pages they were read from, so that
+    // reading a large file a piece at a time doesn't leave all of it in
+    // memory.  If the elements aren't all in the section, a
+    // DigraphException is thrown.
+    template <typename T>
+    std::vector<T> copySection(
+        const std::string& name, std::size_t first, std::size_t count) const;
+
+private:
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t sectionCount;
+        std::uint64_t contentHash;
+        std::uint64_t fileSize;
+    };
+
+    struct TableEntry
+    {
+        char name[24];
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint64_t elementSize;
+    };
+
+    // The magic number, which includes a number whose bytes are in a
+    // different order on machines that store numbers differently.
+    static void writeMagic(char* magic) noexcept;
+
+    static constexpr std::size_t alignment = 8;
+
+    static std::size_t aligned(std::size_t offset) noexcept;
+
+    friend class ArtifactWriter;
+
+    const char* data_;
+    std::size_t size_;
+    std::unordered_map<std::string, const TableEntry*> sections_;
+};
+
+
+
+inline ContentHash::ContentHash() noexcept
+    : value_{14695981039346656037ull}
+{
+}
+
+
+inline void ContentHash::add(const void* bytes, std::size_t size) noexcept
+{
+    const unsigned char* p = static_cast<const unsigned char*>(bytes);
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        value_ = (value_ ^ p[i]) * 1099511628211ull;
+    }
+}
+
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type
+ContentHash::add(T value) noexcept
+{
+    add(&value, sizeof(value));
+}
+
+
+template <typename T>
+void ContentHash::add(const std::vector<T>& values) noexcept
+{
+    static_assert(std::is_arithmetic<T>::value, "Only numbers can be added to a ContentHash");
+
+    add(values.size());
+    add(values.data(), values.size() * sizeof(T));
+}
+
+
+inline void ContentHash::add(std::string_view s) noexcept
+{
+    add(s.size());
+    add(s.data(), s.size());
+}
+
+
+inline std::uint64_t ContentHash::value() const noexcept
+{
+    return value_;
+}
+
+
+
+template <typename T>
+void ArtifactWriter::addSection(const std::string& name, const std::vector<T>& values)
+{
+    static_assert(std::is_arithmetic<T>::value, "Sections can only hold numbers");
+
+    if (name.empty() || name.size() >= sizeof(ArtifactFile::TableEntry::name))
+    {
+        throw DigraphException("Invalid section name!\n");
+    }
+
+    for (const Section& section : sections_)
+    {
+        if (section.name == name)
+        {
+            throw DigraphException("Section already exists!\n");
+        }
+    }
+
+    const char* bytes = reinterpret_cast<const char*>(values.data());
+    sections_.push_back(Section{
+        name, static_cast<std::uint32_t>(sizeof(T)),
+        std::vector<char>(bytes, bytes + values.size() * sizeof(T))});
+}
+
+
+inline void ArtifactWriter::write(const std::string& path, std::uint64_t contentHash) const
+{
+    typedef ArtifactFile::Header Header;
+    typedef ArtifactFile::TableEntry TableEntry;
+
+    std::vector<TableEntry> table(sections_.size());
+    std::size_t offset = ArtifactFile::aligned(
+        sizeof(Header) + sections_.size() * sizeof(TableEntry));
+
+    for (std::size_t i = 0; i < sections_.size(); ++i)
+    {
+        std::memset(table[i].name, 0, sizeof(table[i].name));
+        sections_[i].name.copy(table[i].name, sizeof(table[i].name) - 1);
+        table[i].offset = offset;
+        table[i].size = sections_[i].bytes.size();
+        table[i].elementSize = sections_[i].elementSize;
+
+        offset = ArtifactFile::aligned(offset + sections_[i].bytes.size());
+    }
+
+    Header header;
+    ArtifactFile::writeMagic(header.magic);
+    header.version = ArtifactFile::formatVersion;
+    header.sectionCount = static_cast<std::uint32_t>(sections_.size());
+    header.contentHash = contentHash;
+    header.fileSize = offset;
+
+    std::string temporaryPath = path + ".tmp";
+
+    {
+        std::ofstream out{temporaryPath, std::ios::binary | std::ios::trunc};
+        const char padding[ArtifactFile::alignment] = {};
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(
+            reinterpret_cast<const char*>(table.data()), table.size() * sizeof(TableEntry));
+
+        std::size_t written = sizeof(header) + table.size() * sizeof(TableEntry);
+
+        for (std::size_t i = 0; i < sections_.size(); ++i)
+        {
+            out.write(padding, table[i].offset - written);
+            out.write(sections_[i].bytes.data(), sections_[i].bytes.size());
+            written = table[i].offset + sections_[i].bytes.size();
+        }
+
+        out.write(padding, offset - written);
+
+        if (!out.flush())
+        {
+            std::remove(temporaryPath.c_str());
+            throw DigraphException("Cannot write artifact file " + path + "!\n");
+        }
+    }
+
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        throw DigraphException("Cannot write artifact file " + path + "!\n");
+    }
+}
+
+
+
+inline ArtifactFile::ArtifactFile(const std::string& path, std::uint64_t contentHash)
+    : data_{nullptr}, size_{0}
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        throw DigraphException("Cannot open artifact file " + path + "!\n");
+    }
+
+    struct stat status;
+
+    if (::fstat(fd, &status) < 0 || status.st_size < static_cast<off_t>(sizeof(Header)))
+    {
+        ::close(fd);
+        throw DigraphException("Not an artifact file: " + path + "!\n");
+    }
+
+    size_ = static_cast<std::size_t>(status.st_size);
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        throw DigraphException("Cannot map artifact file " + path + "!\n");
+    }
+
+    data_ = static_cast<const char*>(mapped);
+
+    // From here on, a failed check has to unmap the file, since the
+    // destructor won't run.
+    auto reject =
+        [this](const std::string& reason)
+        {
+            ::munmap(const_cast<char*>(data_), size_);
+            throw DigraphException(reason);
+        };
+
+    Header header;
+    std::memcpy(&header, data_, sizeof(header));
+
+    char magic[sizeof(header.magic)];
+    writeMagic(magic);
+
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+    {
+        reject("Not an artifact file: " + path + "!\n");
+    }
+
+    if (header.version != formatVersion)
+    {
+        reject(
+            "Artifact file " + path + " is version " + std::to_string(header.version)
+            + ", not " + std::to_string(formatVersion) + "!\n");
+    }
+
+    if (header.contentHash != contentHash)
+    {
+        reject("Artifact file " + path + " is stale!\n");
+    }
+
+    if (header.fileSize != size_
+        || (size_ - sizeof(Header)) / sizeof(TableEntry) < header.sectionCount)
+    {
+        reject("Artifact file " + path + " is damaged!\n");
+    }
+
+    const TableEntry* table = reinterpret_cast<const TableEntry*>(data_ + sizeof(Header));
+
+    for (std::uint32_t i = 0; i < header.sectionCount; ++i)
+    {
+        const TableEntry& entry = table[i];
+
+        if (entry.name[sizeof(entry.name) - 1] != '\0'
+            || entry.offset % alignment != 0 || entry.offset > size_
+            || entry.size > size_ - entry.offset
+            || entry.elementSize == 0 || entry.size % entry.elementSize != 0)
+        {
+            reject("Artifact file " + path + " is damaged!\n");
+        }
+
+        sections_.emplace(std::string{entry.name}, &entry);
+    }
+}
+
+
+inline ArtifactFile::~ArtifactFile()
+{
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+
+inline bool ArtifactFile::hasSection(const std::string& name) const
+{
+    return sections_.count(name) != 0;
+}
+
+
+template <typename T>
+ArtifactSection<T> ArtifactFile::section(const std::string& name) const
+{
+    static_assert(std::is_arithmetic<T>::value, "Sections can only hold numbers");
+
+    auto found = sections_.find(name);
+
+    if (found == sections_.end())
+    {
+        throw DigraphException("Section " + name + " does not exist!\n");
+    }
+
+    const TableEntry& entry = *found->second;
+
+    if (entry.elementSize != sizeof(T))
+    {
+        throw DigraphException("Section " + name + " has the wrong element size!\n");
+    }
+
+    return ArtifactSection<T>{
+        reinterpret_cast<const T*>(data_ + entry.offset), entry.size / sizeof(T)};
+}
+
+
+template <typename T>
+std::vector<T> ArtifactFile::copySection(const std::string& name) const
+{
+    ArtifactSection<T> view = section<T>(name);
+    return std::vector<T>(view.begin(), view.end());
+}
+
+
+template <typename T>
+std::vector<T> ArtifactFile::copySection(
+    const std::string& name, std::size_t first, std::size_t count) const
+{
+    ArtifactSection<T> view = section<T>(name);
+
+    if (first > view.size || count > view.size - first)
+    {
+        throw DigraphException("Section " + name + " is too short!\n");
+    }
+
+    std::vector<T> copy(view.begin() + first, view.begin() + first + count);
+
+    // The file is mapped privately and never written, so dropped pages
+    // are simply read from the file again if they're used again.  The
+    // mapping starts on a page boundary, so the pages can be found from
+    // offsets within it.
+    std::size_t pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t begin = reinterpret_cast<const char*>(view.data + first) - data_;
+    std::size_t end = begin + count * sizeof(T);
+    begin = begin / pageSize * pageSize;
+    end = std::min((end + pageSize - 1) / pageSize * pageSize, size_);
+
+    if (count > 0)
+    {
+        ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+
+    return copy;
+}
+
+
+inline void ArtifactFile::writeMagic(char* magic) noexcept
+{
+    const std::uint32_t byteOrder = 0x01020304;
+
+    std::memcpy(magic, "RTDG", 4);
+    std::memcpy(magic + 4, &byteOrder, sizeof(byteOrder));
+}
+
+
+inline std::size_t ArtifactFile::aligned(std::size_t offset) noexcept
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+
+
+#endif // ARTIFACTFILE_HPP
@@ -0,0 +1,370 @@
+// AsyncSearch.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares classes for searching a CompactDigraph without
+// waiting for the search to finish, for programs (such as event-driven
+// servers) that can't tie up a thread for every search they start.
+//
+// * A SearchExecutor runs searches, and anything else it's given, on a
+//   pool of threads of its own.
+//
+// * An AsyncSearch submits searches of one CompactDigraph to a
+//   SearchExecutor, returning a std::future for each search's result
+//   right away.  A function can also be given, which is called (on the
+//   executor's thread) as soon as the result is ready, so that the caller
+//   can be woken up rather than waiting on the future.
+//
+// * A SearchControl, if one is given, can cancel a search or set a
+//   deadline for it.  A search that is cancelled, or whose deadline
+//   passes, is abandoned wherever it has got to (or isn't started at all,
+//   if it's still waiting for a thread), and its future holds a
+//   DigraphSearchStopped exception instead of a result.
+//
+// The searches submitted by an AsyncSearch refer to its CompactDigraph and
+// to the edge weights they were given, which must outlive them, but not
+// to the AsyncSearch itself.
+
+#ifndef ASYNCSEARCH_HPP
+#define ASYNCSEARCH_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "CompactDigraph.hpp"
+
+
+
+// A SearchControl is shared between the code that starts a search and the
+// search itself, which checks it every so often.
+
+class SearchControl
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Initializes a SearchControl with the given deadline (by default,
+    // none).
+    explicit SearchControl(Clock::time_point deadline = Clock::time_point::max());
+
+    // cancel() asks the searches using this SearchControl to stop.  It can
+    // be called from any thread.
+    void cancel() noexcept;
+
+    // cancelled() returns true if cancel() has been called, and expired()
+    // returns true if the deadline has passed.  shouldStop() returns true
+    // if either is.
+    bool cancelled() const noexcept;
+    bool expired() const;
+    bool shouldStop() const;
+
+    Clock::time_point deadline() const noexcept;
+
+private:
+    std::atomic<bool> cancelled_;
+    Clock::time_point deadline_;
+};
+
+
+
+// A SearchPath is the result of a search for the shortest path from one
+// vertex to another: whether there is one, its weight, and the edge
+// indexes along it, in order.
+
+template <typename Distance>
+struct SearchPath
+{
+    bool reached;
+    Distance distance;
+    std::vector<int> edges;
+};
+
+
+
+class SearchExecutor
+{
+public:
+    // Initializes a SearchExecutor with the given number of threads (by
+    // default, one per hardware thread).
+    explicit SearchExecutor(unsigned int threads = std::thread::hardware_concurrency());
+
+    // The destructor finishes running everything already submitted, and
+    // then stops the threads.
+    ~SearchExecutor();
+
+    SearchExecutor(const SearchExecutor&) = delete;
+    SearchExecutor& operator=(const SearchExecutor&) = delete;
+
+    // submit() arranges for func() to be called on one of the executor's
+    // threads, returning a future for whatever it returns (or throws).
+    // Then, if onReady is given, onReady() is called on the same thread.
+    // Anything onReady() throws is discarded, since by then the future
+    // already holds the result.
+    template <typename Func>
+    std::future<decltype(std::declval<Func&>()())> submit(
+        Func func, std::function<void()> onReady = nullptr);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_;
+    std::vector<std::thread> threads_;
+};
+
+
+
+class AsyncSearch
+{
+public:
+    AsyncSearch(const CompactDigraph& graph, SearchExecutor& executor);
+
+    // findShortestPaths() submits a search for the shortest paths from the
+    // vertex with the given start index to every other vertex, as
+    // CompactDigraph::findShortestPaths() would find them.  If there is
+    // no vertex with the start index, the future holds a DigraphException.
+    template <typename Distance, typename Weight>
+    std::future<CompactSearchResult<Distance>> findShortestPaths(
+        int startIndex, const Weight* weights,
+        std::shared_ptr<const SearchControl> control = nullptr,
+        std::function<void()> onReady = nullptr) const;
+
+    // findShortestPath() submits a search for the shortest path from the
+    // vertex with the given start index to the one with the given end
+    // index, which stops as soon as that path is known.  If there is no
+    // vertex with either index, the future holds a DigraphException.
+    template <typename Distance, typename Weight>
+    std::future<SearchPath<Distance>> findShortestPath(
+        int startIndex, int endIndex, const Weight* weights,
+        std::shared_ptr<const SearchControl> control = nullptr,
+        std::function<void()> onReady = nullptr) const;
+
+private:
+    // checkIndex() throws a DigraphException if the given graph has no
+    // vertex with the given index.
+    static void checkIndex(const CompactDigraph& graph, int index);
+
+    // search() runs a search of the given graph, checking the given
+    // control (if any).
+    template <typename Distance, typename Weight>
+    static CompactSearchResult<Distance> search(
+        const CompactDigraph& graph, int startIndex, const Weight* weights,
+        int endIndex, const SearchControl* control);
+
+    const CompactDigraph* graph_;
+    SearchExecutor* executor_;
+};
+
+
+
+inline SearchControl::SearchControl(Clock::time_point deadline)
+    : cancelled_{false}, deadline_{deadline}
+{
+}
+
+
+inline void SearchControl::cancel() noexcept
+{
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+
+inline bool SearchControl::cancelled() const noexcept
+{
+    return cancelled_.load(std::memory_order_relaxed);
+}
+
+
+inline bool SearchControl::expired() const
+{
+    return deadline_ != Clock::time_point::max() && Clock::now() >= deadline_;
+}
+
+
+inline bool SearchControl::shouldStop() const
+{
+    return cancelled() || expired();
+}
+
+
+inline SearchControl::Clock::time_point SearchControl::deadline() const noexcept
+{
+    return deadline_;
+}
+
+
+
+inline SearchExecutor::SearchExecutor(unsigned int threads)
+    : stopping_{false}
+{
+    for (unsigned int i = 0; i < (threads > 0 ? threads : 1); ++i)
+    {
+        threads_.emplace_back(
+            [this]
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+
+                while (true)
+                {
+                    changed_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+
+                    if (tasks_.empty())
+                    {
+                        return;
+                    }
+
+                    std::function<void()> task = std::move(tasks_.front());
+                    tasks_.pop_front();
+
+                    lock.unlock();
+                    task();
+                    lock.lock();
+                }
+            });
+    }
+}
+
+
+inline SearchExecutor::~SearchExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stopping_ = true;
+        changed_.notify_all();
+    }
+
+    for (std::thread& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+
+template <typename Func>
+std::future<decltype(std::declval<Func&>()())> SearchExecutor::submit(
+    Func func, std::function<void()> onReady)
+{
+    typedef decltype(std::declval<Func&>()()) Result;
+
+    // A std::function must be copyable, and a std::packaged_task isn't,
+    // so the task is held by a shared_ptr.
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::move(func));
+    std::future<Result> future = task->get_future();
+
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        tasks_.push_back(
+            [task, onReady]
+            {
+                (*task)();
+
+                // An exception escaping a thread would end the program.
+                if (onReady)
+                {
+                    try
+                    {
+                        onReady();
+                    }
+                    catch (...)
+                    {
+                    }
+                }
+            });
+
+        changed_.notify_one();
+    }
+
+    return future;
+}
+
+
+
+inline AsyncSearch::AsyncSearch(const CompactDigraph& graph, SearchExecutor& executor)
+    : graph_{&graph}, executor_{&executor}
+{
+}
+
+
+template <typename Distance, typename Weight>
+std::future<CompactSearchResult<Distance>> AsyncSearch::findShortestPaths(
+    int startIndex, const Weight* weights,
+    std::shared_ptr<const SearchControl> control,
+    std::function<void()> onReady) const
+{
+    return executor_->submit(
+        [graph = graph_, startIndex, weights, control]
+        {
+            checkIndex(*graph, startIndex);
+            return search<Distance>(*graph, startIndex, weights, -1, control.get());
+        },
+        std::move(onReady));
+}
+
+
+template <typename Distance, typename Weight>
+std::future<SearchPath<Distance>> AsyncSearch::findShortestPath(
+    int startIndex, int endIndex, const Weight* weights,
+    std::shared_ptr<const SearchControl> control,
+    std::function<void()> onReady) const
+{
+    return executor_->submit(
+        [graph = graph_, startIndex, endIndex, weights, control]
+        {
+            checkIndex(*graph, startIndex);
+            checkIndex(*graph, endIndex);
+
+            CompactSearchResult<Distance> result =
+                search<Distance>(*graph, startIndex, weights, endIndex, control.get());
+
+            return SearchPath<Distance>{
+                result.reached(endIndex), result.distance[endIndex],
+                CompactDigraph::pathEdges(result, endIndex)};
+        },
+        std::move(onReady));
+}
+
+
+inline void AsyncSearch::checkIndex(const CompactDigraph& graph, int index)
+{
+    if (index < 0 || index >= graph.vertexCount())
+    {
+        throw DigraphException("Vertex does not exist!\n");
+    }
+}
+
+
+template <typename Distance, typename Weight>
+CompactSearchResult<Distance> AsyncSearch::search(
+    const CompactDigraph& graph, int startIndex, const Weight* weights,
+    int endIndex, const SearchControl* control)
+{
+    if (control == nullptr)
+    {
+        return graph.findShortestPaths<Distance>(startIndex, weights, endIndex);
+    }
+
+    // A search that waited past its deadline (or was cancelled while it
+    // waited) isn't started at all.
+    if (control->shouldStop())
+    {
+        throw DigraphSearchStopped{};
+    }
+
+    return graph.findShortestPaths<Distance>(
+        startIndex, weights, endIndex, [control] { return control->shouldStop(); });
+}
+
+
+
+#endif // ASYNCSEARCH_HPP
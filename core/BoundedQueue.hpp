@@ -0,0 +1,118 @@
+// BoundedQueue.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class template called BoundedQueue, which is
+// a first-in, first-out queue that can be shared between threads.  It holds
+// at most a fixed number of elements; push() waits while the queue is full
+// and pop() waits while it is empty, so a fast producer can never get more
+// than a queue's worth of work ahead of a slow consumer.
+//
+// A BoundedQueue can be closed, after which push() refuses new elements
+// and pop() returns the elements that remain and then reports that the
+// queue is exhausted.  This is how producers tell consumers that there is
+// no more work coming.
+
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+
+
+template <typename T>
+class BoundedQueue
+{
+public:
+    // Initializes an empty queue that holds at most the given number of
+    // elements (which must be at least one).
+    explicit BoundedQueue(std::size_t capacity);
+
+    // push() adds an element to the back of the queue, first waiting until
+    // there is room for it.  It returns false (and does not add the
+    // element) if the queue has been closed.
+    bool push(T element);
+
+    // pop() removes the element at the front of the queue and stores it
+    // into the given object, first waiting until there is one.  It returns
+    // false if the queue has been closed and no elements remain.
+    bool pop(T& element);
+
+    // close() closes the queue, waking any threads waiting in push() or
+    // pop().
+    void close();
+
+private:
+    std::size_t capacity_;
+    bool closed_;
+    std::deque<T> elements_;
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+};
+
+
+
+template <typename T>
+BoundedQueue<T>::BoundedQueue(std::size_t capacity)
+    : capacity_{capacity > 0 ? capacity : 1}, closed_{false}
+{
+}
+
+
+template <typename T>
+bool BoundedQueue<T>::push(T element)
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    notFull_.wait(lock, [this] { return closed_ || elements_.size() < capacity_; });
+
+    if (closed_)
+    {
+        return false;
+    }
+
+    elements_.push_back(std::move(element));
+    notEmpty_.notify_one();
+    return true;
+}
+
+
+template <typename T>
+bool BoundedQueue<T>::pop(T& element)
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    notEmpty_.wait(lock, [this] { return closed_ || !elements_.empty(); });
+
+    if (elements_.empty())
+    {
+        return false;
+    }
+
+    element = std::move(elements_.front());
+    elements_.pop_front();
+    notFull_.notify_one();
+    return true;
+}
+
+
+template <typename T>
+void BoundedQueue<T>::close()
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    closed_ = true;
+    notFull_.notify_all();
+    notEmpty_.notify_all();
+}
+
+
+
+#endif // BOUNDEDQUEUE_HPP
+
@@ -0,0 +1,579 @@
+// ChainCompressedGraph.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class called ChainCompressedGraph, which
+// speeds up searches of a CompactDigraph by removing the vertices that
+// paths can only pass straight through.  Road maps are full of them: points
+// that only record the shape of a road, and junctions with minor roads
+// that aren't in the map.  A vertex is "pass-through" if it has exactly
+// two neighbors and every path through it goes in from one and out to the
+// other: either a one-way road goes in from one neighbor and out to the
+// other, or two-way roads join it to both.
+//
+// The vertices that aren't pass-through are "core" vertices, and every
+// path from a core vertex through pass-through vertices to the next core
+// vertex is collapsed into a single "chain".  Searches only visit core
+// vertices, following chains, whose weights are the sums of the weights
+// of their edges.  The paths they find are expanded back into edges, and
+// searches may start or end at pass-through vertices, so the paths are the
+// same as a search of the CompactDigraph finds, except that (since chain
+// weights are added up separately from the paths that use them) where two
+// paths are (almost exactly) tied, a different one can be found.
+//
+// A ChainCompressedGraph copies everything it needs from the CompactDigraph,
+// so it doesn't need the CompactDigraph once it's built.
+
+#ifndef CHAINCOMPRESSEDGRAPH_HPP
+#define CHAINCOMPRESSEDGRAPH_HPP
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "CompactDigraph.hpp"
+#include "DigraphStats.hpp"
+#include "MemoryUsage.hpp"
+
+
+
+// A ChainPath is a path found by ChainCompressedGraph::findShortestPath():
+// the edge indexes along it, in order.  If there is no path, reached is
+// false.
+
+struct ChainPath
+{
+    bool reached;
+    std::vector<int> edges;
+};
+
+
+
+class ChainCompressedGraph
+{
+public:
+    // The default constructor initializes an empty ChainCompressedGraph.
+    ChainCompressedGraph();
+
+    // Finds the pass-through vertices of the given graph and collapses the
+    // paths through them into chains.
+    explicit ChainCompressedGraph(const CompactDigraph& graph);
+
+    // coreVertexCount() returns the number of core vertices, chainCount()
+    // the number of chains, and isCore() whether the vertex with the given
+    // index is a core vertex.
+    int coreVertexCount() const noexcept;
+    int chainCount() const noexcept;
+    bool isCore(int index) const;
+
+    // memoryUsage() returns the memory allocated for the chains, all of
+    // which could be found again from the graph, so it counts as caches.
+    MemoryUsage memoryUsage() const noexcept;
+
+    // chainWeights() returns the weight of every chain, indexed by chain,
+    // given the weight of each edge, indexed by edge index.  Weights are
+    // added up as Distance values.
+    template <typename Distance, typename Weight>
+    std::vector<Distance> chainWeights(const Weight* weights) const;
+
+    // findShortestPath() runs Dijkstra's algorithm from the vertex with
+    // the given start index to the one with the given end index, visiting
+    // only core vertices.  It takes the weights of the chains from the
+    // given array, which must have been returned by chainWeights() for the
+    // given edge weights.
+    template <typename Distance, typename Weight>
+    ChainPath findShortestPath(
+        int startIndex, int endIndex, const Distance* chainWeights,
+        const Weight* weights) const;
+
+private:
+    // A Position is where a pass-through vertex lies on a chain: the
+    // index, within the chain, of the edge leading to it.
+    struct Position
+    {
+        int chain;
+        int edge;
+    };
+
+    // followChain() follows edges from the given edge, which leaves the
+    // given core vertex, through pass-through vertices until it reaches a
+    // core vertex again, calling edgeFunc(edge) for each edge on the way.
+    // It returns the index of the core vertex reached.
+    template <typename EdgeFunc>
+    static int followChain(
+        const CompactDigraph& graph, const std::vector<bool>& core,
+        int source, int edge, EdgeFunc edgeFunc);
+
+    // The edges of the chains leaving the core vertex with index v are
+    // firstChain_[v] through firstChain_[v + 1] - 1 (and pass-through
+    // vertices have none).  The edges of chain c are the edge indexes
+    // stored in chainEdges_ from chainOffsets_[c] up to (but not
+    // including) chainOffsets_[c + 1].
+    std::vector<bool> core_;
+    std::vector<int> firstChain_;
+    std::vector<int> chainSources_;
+    std::vector<int> chainTargets_;
+    std::vector<int> chainOffsets_;
+    std::vector<int> chainEdges_;
+
+    // The (one or two) Positions of each pass-through vertex, with a chain
+    // of -1 where there is none.
+    std::vector<Position> positions_;
+
+    int coreVertexCount_;
+};
+
+
+
+inline ChainCompressedGraph::ChainCompressedGraph()
+    : firstChain_{0}, chainOffsets_{0}, coreVertexCount_{0}
+{
+}
+
+
+inline ChainCompressedGraph::ChainCompressedGraph(const CompactDigraph& graph)
+    : coreVertexCount_{0}
+{
+    int n = graph.vertexCount();
+
+    std::vector<std::vector<int>> sources(n);
+
+    for (int v = 0; v < n; ++v)
+    {
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            sources[graph.target(e)].push_back(v);
+        }
+    }
+
+    core_.assign(n, true);
+
+    for (int v = 0; v < n; ++v)
+    {
+        std::vector<int> targets;
+
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            targets.push_back(graph.target(e));
+        }
+
+        std::vector<int> in = sources[v];
+        std::sort(targets.begin(), targets.end());
+        std::sort(in.begin(), in.end());
+
+        std::vector<int> neighbors;
+        std::set_union(
+            targets.begin(), targets.end(), in.begin(), in.end(),
+            std::back_inserter(neighbors));
+
+        if (neighbors.size() != 2
+            || std::adjacent_find(targets.begin(), targets.end()) != targets.end()
+            || std::adjacent_find(in.begin(), in.end()) != in.end()
+            || std::binary_search(neighbors.begin(), neighbors.end(), v))
+        {
+            continue;
+        }
+
+        // With two neighbors and no parallel edges, paths can only go
+        // straight through if the roads are either one-way in the same
+        // direction or two-way to both neighbors.
+        bool oneWay = targets.size() == 1 && in.size() == 1 && targets != in;
+        bool twoWay = targets == neighbors && in == neighbors;
+
+        if (oneWay || twoWay)
+        {
+            core_[v] = false;
+        }
+    }
+
+    // A cycle made up entirely of pass-through vertices has no core vertex
+    // for its chains to start from, so one of its vertices is made a core
+    // vertex instead.
+    std::vector<bool> covered{core_};
+
+    auto cover = [&](int v)
+    {
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            followChain(
+                graph, core_, v, e, [&](int edge) { covered[graph.target(edge)] = true; });
+        }
+    };
+
+    for (int v = 0; v < n; ++v)
+    {
+        if (core_[v])
+        {
+            cover(v);
+        }
+    }
+
+    for (int v = 0; v < n; ++v)
+    {
+        if (!covered[v])
+        {
+            core_[v] = true;
+            covered[v] = true;
+            cover(v);
+        }
+    }
+
+    positions_.assign(2 * n, Position{-1, -1});
+    firstChain_.reserve(n + 1);
+    chainOffsets_.push_back(0);
+
+    for (int v = 0; v < n; ++v)
+    {
+        firstChain_.push_back(static_cast<int>(chainSources_.size()));
+
+        if (!core_[v])
+        {
+            continue;
+        }
+
+        ++coreVertexCount_;
+
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            int chain = static_cast<int>(chainSources_.size());
+            int length = 0;
+
+            int target = followChain(
+                graph, core_, v, e,
+                [&](int edge)
+                {
+                    int w = graph.target(edge);
+
+                    if (!core_[w])
+                    {
+                        Position& position =
+                            positions_[2 * w + (positions_[2 * w].chain != -1 ? 1 : 0)];
+                        position = Position{chain, length};
+                    }
+
+                    chainEdges_.push_back(edge);
+                    ++length;
+                });
+
+            chainSources_.push_back(v);
+            chainTargets_.push_back(target);
+            chainOffsets_.push_back(static_cast<int>(chainEdges_.size()));
+        }
+    }
+
+    firstChain_.push_back(static_cast<int>(chainSources_.size()));
+}
+
+
+inline MemoryUsage ChainCompressedGraph::memoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.caches =
+        bytesAllocated(core_) + bytesAllocated(firstChain_) + bytesAllocated(chainSources_)
+        + bytesAllocated(chainTargets_) + bytesAllocated(chainOffsets_)
+        + bytesAllocated(chainEdges_) + bytesAllocated(positions_);
+    return usage;
+}
+
+
+inline int ChainCompressedGraph::coreVertexCount() const noexcept
+{
+    return coreVertexCount_;
+}
+
+
+inline int ChainCompressedGraph::chainCount() const noexcept
+{
+    return static_cast<int>(chainSources_.size());
+}
+
+
+inline bool ChainCompressedGraph::isCore(int index) const
+{
+    return core_.at(index);
+}
+
+
+template <typename Distance, typename Weight>
+std::vector<Distance> ChainCompressedGraph::chainWeights(const Weight* weights) const
+{
+    std::vector<Distance> result;
+    result.reserve(chainCount());
+
+    for (int c = 0; c < chainCount(); ++c)
+    {
+        Distance weight{0};
+
+        for (int i = chainOffsets_[c]; i < chainOffsets_[c + 1]; ++i)
+        {
+            weight += weights[chainEdges_[i]];
+        }
+
+        result.push_back(weight);
+    }
+
+    return result;
+}
+
+
+template <typename Distance, typename Weight>
+ChainPath ChainCompressedGraph::findShortestPath(
+    int startIndex, int endIndex, const Distance* chainWeights,
+    const Weight* weights) const
+{
+    const Distance infinity = std::numeric_limits<Distance>::max();
+    int n = static_cast<int>(core_.size());
+
+    // partialWeight() adds up the weights of the edges of a chain with
+    // the given indexes (within the chain) from first to last.
+    auto partialWeight = [&](int chain, int first, int last)
+    {
+        Distance weight{0};
+
+        for (int i = first; i <= last; ++i)
+        {
+            weight += weights[chainEdges_[chainOffsets_[chain] + i]];
+        }
+
+        return weight;
+    };
+
+    auto appendEdges = [&](std::vector<int>& edges, int chain, int first, int last)
+    {
+        for (int i = first; i <= last; ++i)
+        {
+            edges.push_back(chainEdges_[chainOffsets_[chain] + i]);
+        }
+    };
+
+    ChainPath path{true, {}};
+
+    if (startIndex == endIndex)
+    {
+        return path;
+    }
+
+    // The search's labels record, for each core vertex reached, the chain
+    // used to reach it, or -2 - that chain if the search started partway
+    // along it, at the (pass-through) start vertex.
+    std::vector<Distance> distance(n, infinity);
+    std::vector<int> previousChain(n, -1);
+    std::vector<bool> known(n, false);
+    DIGRAPH_COUNT(allocations, 3);
+
+    typedef std::pair<Distance, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+
+    auto relax = [&](int w, Distance weight, int chain)
+    {
+        if (!known[w] && weight < distance[w])
+        {
+            distance[w] = weight;
+            previousChain[w] = chain;
+            pq.push(Entry{weight, w});
+            DIGRAPH_COUNT(heapPushes, 1);
+        }
+    };
+
+    const Position* startPositions = core_[startIndex] ? nullptr : &positions_[2 * startIndex];
+    const Position* endPositions = core_[endIndex] ? nullptr : &positions_[2 * endIndex];
+
+    if (startPositions == nullptr)
+    {
+        relax(startIndex, Distance{0}, -1);
+    }
+    else
+    {
+        for (int i = 0; i < 2 && startPositions[i].chain != -1; ++i)
+        {
+            const Position& p = startPositions[i];
+            int length = chainOffsets_[p.chain + 1] - chainOffsets_[p.chain];
+
+            relax(
+                chainTargets_[p.chain], partialWeight(p.chain, p.edge + 1, length - 1),
+                -2 - p.chain);
+        }
+    }
+
+    // When the end vertex is a pass-through vertex, the best path found so
+    // far ends partway along bestChain, having reached it from the chain's
+    // source or, if bestFromStart is true, directly from the start vertex
+    // on the same chain.
+    Distance best = infinity;
+    int bestChain = -1;
+    bool bestFromStart = false;
+
+    if (startPositions != nullptr && endPositions != nullptr)
+    {
+        for (int i = 0; i < 2 && startPositions[i].chain != -1; ++i)
+        {
+            for (int j = 0; j < 2 && endPositions[j].chain != -1; ++j)
+            {
+                const Position& s = startPositions[i];
+                const Position& t = endPositions[j];
+
+                if (s.chain == t.chain && s.edge < t.edge)
+                {
+                    best = partialWeight(s.chain, s.edge + 1, t.edge);
+                    bestChain = s.chain;
+                    bestFromStart = true;
+                }
+            }
+        }
+    }
+
+    while (!pq.empty())
+    {
+        Entry entry = pq.top();
+        pq.pop();
+        DIGRAPH_COUNT(heapPops, 1);
+
+        int v = entry.second;
+
+        if (known[v])
+        {
+            DIGRAPH_COUNT(stalePops, 1);
+            continue;
+        }
+
+        if (v == endIndex || (endPositions != nullptr && entry.first >= best))
+        {
+            break;
+        }
+
+        known[v] = true;
+        DIGRAPH_COUNT(verticesSettled, 1);
+        DIGRAPH_COUNT(edgesRelaxed, firstChain_[v + 1] - firstChain_[v]);
+
+        for (int c = firstChain_[v]; c < firstChain_[v + 1]; ++c)
+        {
+            relax(chainTargets_[c], entry.first + chainWeights[c], c);
+        }
+
+        for (int j = 0; endPositions != nullptr && j < 2 && endPositions[j].chain != -1; ++j)
+        {
+            const Position& t = endPositions[j];
+
+            if (chainSources_[t.chain] == v)
+            {
+                Distance weight = entry.first + partialWeight(t.chain, 0, t.edge);
+
+                if (weight < best)
+                {
+                    best = weight;
+                    bestChain = t.chain;
+                    bestFromStart = false;
+                }
+            }
+        }
+    }
+
+    // The path is followed back from the end to the start, one chain (or
+    // part of a chain, given by the indexes of its first and last edges
+    // within the chain) at a time, and then put in order.
+    struct Piece
+    {
+        int chain;
+        int first;
+        int last;
+    };
+
+    std::vector<Piece> pieces;
+    int v;
+
+    if (endPositions == nullptr)
+    {
+        if (distance[endIndex] == infinity)
+        {
+            path.reached = false;
+            return path;
+        }
+
+        v = endIndex;
+    }
+    else
+    {
+        if (best == infinity)
+        {
+            path.reached = false;
+            return path;
+        }
+
+        int endEdge = endPositions[endPositions[0].chain == bestChain ? 0 : 1].edge;
+
+        if (bestFromStart)
+        {
+            int startEdge = startPositions[startPositions[0].chain == bestChain ? 0 : 1].edge;
+            appendEdges(path.edges, bestChain, startEdge + 1, endEdge);
+            return path;
+        }
+
+        pieces.push_back(Piece{bestChain, 0, endEdge});
+        v = chainSources_[bestChain];
+    }
+
+    while (v != startIndex && previousChain[v] != -1)
+    {
+        int chain = previousChain[v];
+
+        if (chain >= 0)
+        {
+            int length = chainOffsets_[chain + 1] - chainOffsets_[chain];
+            pieces.push_back(Piece{chain, 0, length - 1});
+            v = chainSources_[chain];
+        }
+        else
+        {
+            chain = -2 - chain;
+            int length = chainOffsets_[chain + 1] - chainOffsets_[chain];
+            int startEdge = startPositions[startPositions[0].chain == chain ? 0 : 1].edge;
+            pieces.push_back(Piece{chain, startEdge + 1, length - 1});
+            break;
+        }
+    }
+
+    for (auto piece = pieces.rbegin(); piece != pieces.rend(); ++piece)
+    {
+        appendEdges(path.edges, piece->chain, piece->first, piece->last);
+    }
+
+    return path;
+}
+
+
+template <typename EdgeFunc>
+int ChainCompressedGraph::followChain(
+    const CompactDigraph& graph, const std::vector<bool>& core,
+    int source, int edge, EdgeFunc edgeFunc)
+{
+    int previous = source;
+    int v = graph.target(edge);
+
+    edgeFunc(edge);
+
+    while (!core[v])
+    {
+        // A pass-through vertex's way onward is its one edge that doesn't
+        // go back where the path came from.
+        int next = graph.edgeBegin(v);
+
+        if (graph.target(next) == previous && graph.edgeEnd(v) - next > 1)
+        {
+            ++next;
+        }
+
+        previous = v;
+        v = graph.target(next);
+        edgeFunc(next);
+    }
+
+    return v;
+}
+
+
+
+#endif // CHAINCOMPRESSEDGRAPH_HPP
@@ -0,0 +1,763 @@
+// CompactDigraph.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class called CompactDigraph, which is a
+// read-only copy of the structure of a Digraph, stored compactly for fast
+// searching.  Vertices are given dense "indexes" from 0 to vertexCount() - 1
+// and the outgoing edges of all vertices are stored back to back in one
+// array (the "compressed sparse row" layout), so the edges of the vertex
+// with index i are the ones with edge indexes edgeBegin(i) through
+// edgeEnd(i) - 1.  Only the "to" vertex of each edge is stored; its "from"
+// vertex is implied by where the edge is stored.
+//
+// A CompactDigraph stores no VertexInfo or EdgeInfo objects.  Instead, the
+// code that builds one is given the edge index of every edge as it is
+// copied, so it can store whatever it needs about the edges in arrays of
+// its own, indexed by edge index (a "structure of arrays").  The searches
+// take edge weights from such an array.
+//
+// The original vertex numbers are kept in a mapping table, so they can be
+// converted to and from indexes with vertexNumber() and indexOf().  That
+// means the indexes can be assigned in any order, and a CompactDigraph can
+// be built with its vertices reordered so that vertices that are near one
+// another in the graph are also near one another in memory; see
+// VertexOrder below.
+
+#ifndef COMPACTDIGRAPH_HPP
+#define COMPACTDIGRAPH_HPP
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "Digraph.hpp"
+#include "DigraphStats.hpp"
+#include "MemoryUsage.hpp"
+
+
+
+// A CompactSearchResult is the result of a search of a CompactDigraph.
+// For each vertex index, it stores the weight of the shortest path found
+// from the start vertex, along with the index of the previous vertex and
+// of the edge used to reach it (-1 for the start vertex and any vertex not
+// reached).  Distance is the type in which path weights are added up.
+
+template <typename Distance>
+struct CompactSearchResult
+{
+    std::vector<Distance> distance;
+    std::vector<int> previousVertex;
+    std::vector<int> previousEdge;
+
+    // reached() returns true if the search reached the vertex with the
+    // given index.
+    bool reached(int index) const
+    {
+        return distance[index] != std::numeric_limits<Distance>::max();
+    }
+};
+
+
+
+// A DigraphSearchStopped is thrown by a search that was stopped before it
+// finished.
+
+class DigraphSearchStopped : public DigraphException
+{
+public:
+    DigraphSearchStopped()
+        : DigraphException{"Search was stopped!\n"}
+    {
+    }
+};
+
+
+
+// A VertexOrder specifies the order in which a CompactDigraph assigns
+// indexes to vertices.
+//
+// * Number assigns them in ascending order of vertex number.
+// * BreadthFirst assigns them in the order a breadth-first search visits
+//   them, following edges in either direction and starting each connected
+//   part of the graph from its lowest-numbered vertex.
+// * ReverseCuthillMcKee is the reverse of a breadth-first order that starts
+//   each part from a vertex of least degree and visits neighbors in order of
+//   increasing degree, which keeps the edges of the graph as close as
+//   possible to the "diagonal" of the index space.
+// * Degree assigns them in order of decreasing degree, so that the most
+//   heavily connected vertices, which searches visit most often, share
+//   cache lines.
+//
+// Graphs such as road networks, whose vertex numbers often say nothing
+// about where vertices are, are typically searched noticeably faster in
+// either of the breadth-first orders.
+
+enum class VertexOrder
+{
+    Number,
+    BreadthFirst,
+    ReverseCuthillMcKee,
+    Degree
+};
+
+
+
+class CompactDigraph
+{
+public:
+    // The default constructor initializes an empty CompactDigraph.
+    CompactDigraph();
+
+    // This constructor copies the structure of the given Digraph.  The
+    // vertices are given indexes in ascending order of vertex number, and
+    // the edges of each vertex are kept in the order the Digraph stores
+    // them.  For each edge, edgeFunc(edgeIndex, einfo) is called, in
+    // ascending order of edge index.
+    template <typename VertexInfo, typename EdgeInfo, typename EdgeFunc>
+    CompactDigraph(const Digraph<VertexInfo, EdgeInfo>& d, EdgeFunc edgeFunc);
+
+    // This constructor is the same, except that vertices are given indexes
+    // in the given order.  The edges of each vertex are still kept in the
+    // order the Digraph stores them, and edgeFunc is still called in
+    // ascending order of edge index.
+    template <typename VertexInfo, typename EdgeInfo, typename EdgeFunc>
+    CompactDigraph(
+        const Digraph<VertexInfo, EdgeInfo>& d, EdgeFunc edgeFunc, VertexOrder order);
+
+    // vertexCount() and edgeCount() return the number of vertices and
+    // edges, respectively.
+    int vertexCount() const noexcept;
+    int edgeCount() const noexcept;
+
+    // vertexNumber() returns the vertex number of the vertex with the given
+    // index, while indexOf() returns the index of the vertex with the given
+    // vertex number.  If there is no such vertex, indexOf() throws a
+    // DigraphException.
+    int vertexNumber(int index) const;
+    int indexOf(int vertex) const;
+
+    // edgeBegin() and edgeEnd() return the range of edge indexes of the
+    // edges outgoing from the vertex with the given index, and target()
+    // returns the index of the vertex an edge points to.
+    int edgeBegin(int index) const;
+    int edgeEnd(int index) const;
+    int target(int edge) const;
+
+    // memoryUsage() returns the memory allocated for the graph's arrays.
+    // It stores no VertexInfo or EdgeInfo.
+    MemoryUsage memoryUsage() const noexcept;
+
+    // findShortestPaths() runs Dijkstra's algorithm from the vertex with
+    // the given start index, taking the weight of each edge from the
+    // given array (indexed by edge index) and adding up path weights as
+    // Distance values.  If an end index is given, the search stops once
+    // the shortest path to that vertex is known.  Ties are broken exactly
+    // as Digraph::findShortestPaths() breaks them.
+    template <typename Distance, typename Weight>
+    CompactSearchResult<Distance> findShortestPaths(
+        int startIndex, const Weight* weights, int endIndex = -1) const;
+
+    // This overload also calls shouldStop() every so often as it goes, and
+    // if it returns true, the search is abandoned and a
+    // DigraphSearchStopped exception is thrown, so that a search that is
+    // no longer wanted doesn't run to the end.
+    template <typename Distance, typename Weight, typename StopFunc>
+    CompactSearchResult<Distance> findShortestPaths(
+        int startIndex, const Weight* weights, int endIndex, StopFunc shouldStop) const;
+
+    // findEarliestArrivals() runs the time-dependent form of Dijkstra's
+    // algorithm from the vertex with the given start index, setting out at
+    // the given time.  Each edge's weight depends on when it's reached:
+    // arrivalTime(e, t) returns the time at which a trip that sets out
+    // along edge e at time t arrives (see TimeDependentWeights in
+    // SpeedProfiles.hpp).  The result's distances are the earliest times
+    // each vertex can be reached, which are found correctly as long as
+    // setting out later along an edge never means arriving earlier.  If an
+    // end index is given, the search stops once its earliest arrival time
+    // is known.
+    template <typename ArrivalFunc>
+    CompactSearchResult<double> findEarliestArrivals(
+        int startIndex, double departure, ArrivalFunc arrivalTime, int endIndex = -1) const;
+
+    // findReachableWithin() finds every vertex that can be reached from
+    // any of the vertices with the given start indexes by a path whose
+    // weight is no more than the given budget.  It returns pairs of
+    // (vertex index, weight of the shortest such path), in order of
+    // increasing weight.  Unlike findShortestPaths(), its cost depends
+    // only on the part of the graph within the budget, since it keeps no
+    // per-vertex arrays.
+    template <typename Distance, typename Weight>
+    std::vector<std::pair<int, Distance>> findReachableWithin(
+        const std::vector<int>& startIndexes, const Weight* weights,
+        Distance budget) const;
+
+    // pathEdges() returns the edge indexes of the path to the given end
+    // index recorded in a search result, in order from the start.
+    template <typename Distance>
+    static std::vector<int> pathEdges(
+        const CompactSearchResult<Distance>& result, int endIndex);
+
+private:
+    // build() fills in the graph from the given Digraph, giving the vertex
+    // with the given vertex numbers[i] index i.
+    template <typename VertexInfo, typename EdgeInfo, typename EdgeFunc>
+    void build(
+        const Digraph<VertexInfo, EdgeInfo>& d, EdgeFunc edgeFunc,
+        std::vector<int> vertexNumbers);
+
+    // order() returns the indexes of this graph's vertices in the given
+    // order.
+    std::vector<int> order(VertexOrder order) const;
+
+    // breadthFirstOrder() returns the indexes of this graph's vertices in
+    // breadth-first order, following edges in either direction.  Each
+    // connected part is started from the first unvisited vertex in the
+    // given order of start candidates, and if byDegree is true, the
+    // neighbors of each vertex are visited in order of increasing degree.
+    std::vector<int> breadthFirstOrder(
+        const std::vector<int>& starts, bool byDegree) const;
+
+    std::vector<int> edgeOffsets_;
+    std::vector<int> targets_;
+    std::vector<int> vertexNumbers_;
+
+    // Pairs of (vertex number, index), sorted by vertex number, used to
+    // look up indexes by vertex number.
+    std::vector<std::pair<int, int>> indexes_;
+};
+
+
+
+inline CompactDigraph::CompactDigraph()
+    : edgeOffsets_{0}
+{
+}
+
+
+template <typename VertexInfo, typename EdgeInfo, typename EdgeFunc>
+CompactDigraph::CompactDigraph(const Digraph<VertexInfo, EdgeInfo>& d, EdgeFunc edgeFunc)
+{
+    build(d, edgeFunc, d.vertices());
+}
+
+
+template <typename VertexInfo, typename EdgeInfo, typename EdgeFunc>
+CompactDigraph::CompactDigraph(
+    const Digraph<VertexInfo, EdgeInfo>& d, EdgeFunc edgeFunc, VertexOrder order)
+{
+    if (order == VertexOrder::Number)
+    {
+        build(d, edgeFunc, d.vertices());
+        return;
+    }
+
+    // The order is worked out on a copy of the structure in vertex number
+    // order, since a CompactDigraph is much quicker to traverse than the
+    // Digraph, and the real thing is built afterward.
+    CompactDigraph byNumber{d, [](int, const EdgeInfo&) { }};
+
+    std::vector<int> vertexNumbers;
+    vertexNumbers.reserve(byNumber.vertexCount());
+
+    for (int index : byNumber.order(order))
+    {
+        vertexNumbers.push_back(byNumber.vertexNumber(index));
+    }
+
+    build(d, edgeFunc, std::move(vertexNumbers));
+}
+
+
+template <typename VertexInfo, typename EdgeInfo, typename EdgeFunc>
+void CompactDigraph::build(
+    const Digraph<VertexInfo, EdgeInfo>& d, EdgeFunc edgeFunc,
+    std::vector<int> vertexNumbers)
+{
+    vertexNumbers_ = std::move(vertexNumbers);
+    indexes_.reserve(vertexNumbers_.size());
+
+    for (int i = 0; i < static_cast<int>(vertexNumbers_.size()); ++i)
+    {
+        indexes_.emplace_back(vertexNumbers_[i], i);
+    }
+
+    std::sort(indexes_.begin(), indexes_.end());
+
+    edgeOffsets_.reserve(vertexNumbers_.size() + 1);
+    edgeOffsets_.push_back(0);
+    targets_.reserve(d.edgeCount());
+
+    for (int vertex : vertexNumbers_)
+    {
+        d.forEachEdge(
+            vertex,
+            [&](const DigraphEdge<EdgeInfo>& edge)
+            {
+                edgeFunc(static_cast<int>(targets_.size()), edge.einfo);
+                targets_.push_back(indexOf(edge.toVertex));
+            });
+
+        edgeOffsets_.push_back(static_cast<int>(targets_.size()));
+    }
+}
+
+
+inline int CompactDigraph::vertexCount() const noexcept
+{
+    return static_cast<int>(vertexNumbers_.size());
+}
+
+
+inline int CompactDigraph::edgeCount() const noexcept
+{
+    return static_cast<int>(targets_.size());
+}
+
+
+inline int CompactDigraph::vertexNumber(int index) const
+{
+    return vertexNumbers_.at(index);
+}
+
+
+inline int CompactDigraph::indexOf(int vertex) const
+{
+    auto found = std::lower_bound(
+        indexes_.begin(), indexes_.end(), std::make_pair(vertex, 0));
+
+    if (found == indexes_.end() || found->first != vertex)
+    {
+        throw DigraphException("Vertex does not exist!\n");
+    }
+
+    return found->second;
+}
+
+
+inline int CompactDigraph::edgeBegin(int index) const
+{
+    return edgeOffsets_[index];
+}
+
+
+inline int CompactDigraph::edgeEnd(int index) const
+{
+    return edgeOffsets_[index + 1];
+}
+
+
+inline int CompactDigraph::target(int edge) const
+{
+    return targets_[edge];
+}
+
+
+inline MemoryUsage CompactDigraph::memoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.vertexTable = bytesAllocated(vertexNumbers_);
+    usage.adjacency = bytesAllocated(edgeOffsets_) + bytesAllocated(targets_);
+    usage.indexes = bytesAllocated(indexes_);
+    return usage;
+}
+
+
+inline std::vector<int> CompactDigraph::order(VertexOrder order) const
+{
+    std::vector<int> degree(vertexCount(), 0);
+
+    for (int v = 0; v < vertexCount(); ++v)
+    {
+        degree[v] += edgeEnd(v) - edgeBegin(v);
+
+        for (int e = edgeBegin(v); e < edgeEnd(v); ++e)
+        {
+            ++degree[targets_[e]];
+        }
+    }
+
+    std::vector<int> indexes(vertexCount());
+
+    for (int v = 0; v < vertexCount(); ++v)
+    {
+        indexes[v] = v;
+    }
+
+    switch (order)
+    {
+    case VertexOrder::BreadthFirst:
+        return breadthFirstOrder(indexes, false);
+
+    case VertexOrder::ReverseCuthillMcKee:
+        {
+            std::stable_sort(
+                indexes.begin(), indexes.end(),
+                [&](int a, int b) { return degree[a] < degree[b]; });
+
+            std::vector<int> result = breadthFirstOrder(indexes, true);
+            std::reverse(result.begin(), result.end());
+            return result;
+        }
+
+    case VertexOrder::Degree:
+        std::stable_sort(
+            indexes.begin(), indexes.end(),
+            [&](int a, int b) { return degree[a] > degree[b]; });
+        return indexes;
+
+    default:
+        return indexes;
+    }
+}
+
+
+inline std::vector<int> CompactDigraph::breadthFirstOrder(
+    const std::vector<int>& starts, bool byDegree) const
+{
+    // Breadth-first search has to follow edges in both directions, so the
+    // incoming edges are gathered into the same layout as the outgoing
+    // ones, and each vertex's neighbors are the union of the two.
+    std::vector<int> inOffsets(vertexCount() + 1, 0);
+
+    for (int w : targets_)
+    {
+        ++inOffsets[w + 1];
+    }
+
+    for (int v = 0; v < vertexCount(); ++v)
+    {
+        inOffsets[v + 1] += inOffsets[v];
+    }
+
+    std::vector<int> sources(targets_.size());
+    std::vector<int> next{inOffsets.begin(), inOffsets.end() - 1};
+
+    for (int v = 0; v < vertexCount(); ++v)
+    {
+        for (int e = edgeBegin(v); e < edgeEnd(v); ++e)
+        {
+            sources[next[targets_[e]]++] = v;
+        }
+    }
+
+    std::vector<int> degree(vertexCount());
+
+    for (int v = 0; v < vertexCount(); ++v)
+    {
+        degree[v] = (edgeEnd(v) - edgeBegin(v)) + (inOffsets[v + 1] - inOffsets[v]);
+    }
+
+    std::vector<bool> visited(vertexCount(), false);
+    std::vector<int> result;
+    result.reserve(vertexCount());
+
+    std::vector<int> neighbors;
+
+    for (int start : starts)
+    {
+        if (visited[start])
+        {
+            continue;
+        }
+
+        visited[start] = true;
+        result.push_back(start);
+
+        // The result vector doubles as the queue: the vertices not yet
+        // expanded are the ones after "head".
+        for (std::size_t head = result.size() - 1; head < result.size(); ++head)
+        {
+            int v = result[head];
+
+            neighbors.assign(targets_.begin() + edgeBegin(v), targets_.begin() + edgeEnd(v));
+            neighbors.insert(
+                neighbors.end(), sources.begin() + inOffsets[v], sources.begin() + inOffsets[v + 1]);
+
+            if (byDegree)
+            {
+                std::stable_sort(
+                    neighbors.begin(), neighbors.end(),
+                    [&](int a, int b) { return degree[a] < degree[b]; });
+            }
+
+            for (int w : neighbors)
+            {
+                if (!visited[w])
+                {
+                    visited[w] = true;
+                    result.push_back(w);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+
+template <typename Distance, typename Weight>
+CompactSearchResult<Distance> CompactDigraph::findShortestPaths(
+    int startIndex, const Weight* weights, int endIndex) const
+{
+    return findShortestPaths<Distance>(startIndex, weights, endIndex, [] { return false; });
+}
+
+
+template <typename Distance, typename Weight, typename StopFunc>
+CompactSearchResult<Distance> CompactDigraph::findShortestPaths(
+    int startIndex, const Weight* weights, int endIndex, StopFunc shouldStop) const
+{
+    // shouldStop() is called once per this many vertices settled, which
+    // keeps its cost out of sight while still stopping promptly.
+    const int stopInterval = 256;
+    int settled = 0;
+
+    const Distance unreached = std::numeric_limits<Distance>::max();
+
+    CompactSearchResult<Distance> result{
+        std::vector<Distance>(vertexCount(), unreached),
+        std::vector<int>(vertexCount(), -1),
+        std::vector<int>(vertexCount(), -1)};
+
+    std::vector<bool> known(vertexCount(), false);
+    DIGRAPH_COUNT(allocations, 4);
+
+    typedef std::pair<Distance, int> Entry;
+
+    struct EntryCompare
+    {
+        bool operator()(const Entry& lhs, const Entry& rhs) const
+        {
+            return rhs.first < lhs.first;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, EntryCompare> pq;
+
+    result.distance[startIndex] = 0;
+    pq.push(Entry{0, startIndex});
+    DIGRAPH_COUNT(heapPushes, 1);
+
+    while (!pq.empty())
+    {
+        int v = pq.top().second;
+        pq.pop();
+        DIGRAPH_COUNT(heapPops, 1);
+
+        if (known[v])
+        {
+            DIGRAPH_COUNT(stalePops, 1);
+            continue;
+        }
+
+        if (++settled == stopInterval)
+        {
+            if (shouldStop())
+            {
+                throw DigraphSearchStopped{};
+            }
+
+            settled = 0;
+        }
+
+        known[v] = true;
+        DIGRAPH_COUNT(verticesSettled, 1);
+        DIGRAPH_COUNT(edgesRelaxed, edgeOffsets_[v + 1] - edgeOffsets_[v]);
+        DIGRAPH_COUNT(
+            bytesTouched,
+            (edgeOffsets_[v + 1] - edgeOffsets_[v])
+                * (sizeof(int) + sizeof(Weight) + sizeof(Distance)));
+
+        if (v == endIndex)
+        {
+            break;
+        }
+
+        Distance base = result.distance[v];
+
+        for (int e = edgeOffsets_[v], end = edgeOffsets_[v + 1]; e < end; ++e)
+        {
+            Distance weight = base + weights[e];
+            int w = targets_[e];
+
+            if (result.distance[w] > weight)
+            {
+                result.distance[w] = weight;
+                result.previousVertex[w] = v;
+                result.previousEdge[w] = e;
+                pq.push(Entry{weight, w});
+                DIGRAPH_COUNT(heapPushes, 1);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+template <typename ArrivalFunc>
+CompactSearchResult<double> CompactDigraph::findEarliestArrivals(
+    int startIndex, double departure, ArrivalFunc arrivalTime, int endIndex) const
+{
+    const double unreached = std::numeric_limits<double>::max();
+
+    CompactSearchResult<double> result{
+        std::vector<double>(vertexCount(), unreached),
+        std::vector<int>(vertexCount(), -1),
+        std::vector<int>(vertexCount(), -1)};
+
+    std::vector<bool> known(vertexCount(), false);
+    DIGRAPH_COUNT(allocations, 4);
+
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+
+    result.distance[startIndex] = departure;
+    pq.push(Entry{departure, startIndex});
+    DIGRAPH_COUNT(heapPushes, 1);
+
+    while (!pq.empty())
+    {
+        int v = pq.top().second;
+        pq.pop();
+        DIGRAPH_COUNT(heapPops, 1);
+
+        if (known[v])
+        {
+            DIGRAPH_COUNT(stalePops, 1);
+            continue;
+        }
+
+        known[v] = true;
+        DIGRAPH_COUNT(verticesSettled, 1);
+        DIGRAPH_COUNT(edgesRelaxed, edgeOffsets_[v + 1] - edgeOffsets_[v]);
+
+        if (v == endIndex)
+        {
+            break;
+        }
+
+        // The weight of each edge is found at the time the edge is
+        // reached, which is the (earliest) time its source is reached.
+        double reachedAt = result.distance[v];
+
+        for (int e = edgeOffsets_[v], end = edgeOffsets_[v + 1]; e < end; ++e)
+        {
+            double arrival = arrivalTime(e, reachedAt);
+            int w = targets_[e];
+
+            if (result.distance[w] > arrival)
+            {
+                result.distance[w] = arrival;
+                result.previousVertex[w] = v;
+                result.previousEdge[w] = e;
+                pq.push(Entry{arrival, w});
+                DIGRAPH_COUNT(heapPushes, 1);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+template <typename Distance, typename Weight>
+std::vector<std::pair<int, Distance>> CompactDigraph::findReachableWithin(
+    const std::vector<int>& startIndexes, const Weight* weights,
+    Distance budget) const
+{
+    typedef std::pair<Distance, int> Entry;
+
+    struct EntryCompare
+    {
+        bool operator()(const Entry& lhs, const Entry& rhs) const
+        {
+            return rhs.first < lhs.first;
+        }
+    };
+
+    std::unordered_map<int, Distance> best;
+    std::unordered_set<int> known;
+    std::priority_queue<Entry, std::vector<Entry>, EntryCompare> pq;
+
+    for (int start : startIndexes)
+    {
+        if (budget >= Distance{0} && best.emplace(start, Distance{0}).second)
+        {
+            pq.push(Entry{Distance{0}, start});
+            DIGRAPH_COUNT(heapPushes, 1);
+        }
+    }
+
+    std::vector<std::pair<int, Distance>> reached;
+
+    while (!pq.empty())
+    {
+        Entry entry = pq.top();
+        pq.pop();
+        DIGRAPH_COUNT(heapPops, 1);
+
+        if (!known.insert(entry.second).second)
+        {
+            DIGRAPH_COUNT(stalePops, 1);
+            continue;
+        }
+
+        DIGRAPH_COUNT(verticesSettled, 1);
+        DIGRAPH_COUNT(edgesRelaxed, edgeOffsets_[entry.second + 1] - edgeOffsets_[entry.second]);
+        DIGRAPH_COUNT(
+            bytesTouched,
+            (edgeOffsets_[entry.second + 1] - edgeOffsets_[entry.second])
+                * (sizeof(int) + sizeof(Weight)));
+
+        reached.emplace_back(entry.second, entry.first);
+
+        for (int e = edgeOffsets_[entry.second], end = edgeOffsets_[entry.second + 1]; e < end; ++e)
+        {
+            Distance weight = entry.first + weights[e];
+
+            if (weight > budget)
+            {
+                continue;
+            }
+
+            auto found = best.emplace(targets_[e], weight);
+
+            if (found.second || found.first->second > weight)
+            {
+                found.first->second = weight;
+                pq.push(Entry{weight, targets_[e]});
+                DIGRAPH_COUNT(heapPushes, 1);
+            }
+        }
+    }
+
+    return reached;
+}
+
+
+template <typename Distance>
+std::vector<int> CompactDigraph::pathEdges(
+    const CompactSearchResult<Distance>& result, int endIndex)
+{
+    std::vector<int> path;
+
+    for (int v = endIndex; result.previousEdge[v] != -1; v = result.previousVertex[v])
+    {
+        path.push_back(result.previousEdge[v]);
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+
+
+#endif // COMPACTDIGRAPH_HPP
+
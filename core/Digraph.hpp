@@ -20,17 +20,26 @@
 #ifndef DIGRAPH_HPP
 #define DIGRAPH_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <list>
 #include <map>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 #include <queue>
 #include <iterator>
+#include <limits>
 #include <string>
 #include <iostream>
-#define INF 0x3f3f3f3f
+#include <unordered_set>
+#include "DigraphStats.hpp"
+#include "MemoryUsage.hpp"
 
 
 
@@ -68,14 +77,49 @@ struct DigraphEdge
 
 
 // A DigraphVertex includes two things: a VertexInfo object and a list of
-// its outgoing edges.  Because different kinds of Digraphs store different
+// its outgoing edges (a DigraphEdgeList, which counts the memory it
+// allocates; see MemoryUsage.hpp).  Because different kinds of Digraphs store different
 // kinds of vertex and edge information, DigraphVertex is a struct template.
 
+template <typename EdgeInfo>
+using DigraphEdgeList =
+    std::list<DigraphEdge<EdgeInfo>, CountingAllocator<DigraphEdge<EdgeInfo>>>;
+
+
 template <typename VertexInfo, typename EdgeInfo>
 struct DigraphVertex
 {
     VertexInfo vinfo;
-    std::list<DigraphEdge<EdgeInfo>> edges;
+    DigraphEdgeList<EdgeInfo> edges;
+};
+
+
+
+// A DigraphPathStep describes one edge along a path found by a Digraph's
+// findShortestPath() member function: the "from" and "to" vertex numbers
+// of the edge, a pointer to its EdgeInfo object (which remains valid until
+// the Digraph is next modified or destroyed), and the total weight of the
+// path up to and including this edge.
+
+template <typename EdgeInfo>
+struct DigraphPathStep
+{
+    int fromVertex;
+    int toVertex;
+    const EdgeInfo* einfo;
+    double pathWeight;
+};
+
+
+
+// A DigraphReachedVertex is one entry of the result of a Digraph's
+// findReachableWithin() member function: a vertex number and the weight of
+// the shortest path by which it can be reached.
+
+struct DigraphReachedVertex
+{
+    int vertex;
+    double weight;
 };
 
 
@@ -92,6 +136,31 @@ struct DigraphVertex
 // Each vertex in a Digraph is identified uniquely by a "vertex number".
 // Vertex numbers are not necessarily sequential and they are not necessarily
 // zero- or one-based.
+//
+// Copies of a Digraph share their storage.  The vertex table and each
+// vertex (along with its edge list) are reference-counted blocks, and a
+// block is only duplicated the first time a copy that shares it is
+// modified, so copying a Digraph is O(1) and modifying a copy only pays
+// for the parts it changes.  Those parts always include the whole vertex
+// table, so the first change to a copy takes O(V) time and memory, and
+// every change after that takes only as long as it would have anyway.
+// Sharing is otherwise invisible to callers: a copy still behaves exactly
+// like a deep copy.
+//
+// Whether a block is still shared is decided by its reference count,
+// which can't be relied on while another thread is changing a copy that
+// shares it.  So any number of threads may read copies that share
+// storage at once, and one thread may change a copy while others read
+// the rest, but changes to copies that share storage must be serialised
+// with one another.  As with the standard containers, a Digraph must not
+// be read by one thread while another is changing that same object.
+//
+// Removing a vertex doesn't search the other vertices for the edges that
+// point to it.  Instead, its vertex number is recorded as a "tombstone",
+// and those edges are left where they are, "dangling", and skipped by
+// everything that looks at edges.  compact() removes the dangling edges
+// and the tombstones, which is done automatically once there are enough
+// tombstones that skipping them costs more than removing them would.
 
 template <typename VertexInfo, typename EdgeInfo>
 class Digraph
@@ -101,9 +170,11 @@ public:
     // contains no vertices and no edges.
     Digraph();
 
-    // The copy constructor initializes a new Digraph to be a deep copy
-    // of another one (i.e., any change to the copy will not affect the
-    // original).
+    // The copy constructor initializes a new Digraph to be a copy of
+    // another one (i.e., any change to the copy will not affect the
+    // original).  The copy shares storage with the original until one
+    // of them is modified, so it takes constant time, but the first
+    // modification of either copies the O(V) vertex table.
     Digraph(const Digraph& d);
 
     // The move constructor initializes a new Digraph from an expiring one.
@@ -113,9 +184,10 @@ public:
     ~Digraph() noexcept;
 
     // The assignment operator assigns the contents of the given Digraph
-    // into "this" Digraph, with "this" Digraph becoming a separate, deep
-    // copy of the contents of the given one (i.e., any change made to
-    // "this" Digraph afterward will not affect the other).
+    // into "this" Digraph, with "this" Digraph becoming a separate copy
+    // of the contents of the given one (i.e., any change made to "this"
+    // Digraph afterward will not affect the other).  Like the copy
+    // constructor, it shares storage until one of them is modified.
     Digraph& operator=(const Digraph& d);
 
     // The move assignment operator assigns the contents of an expiring
@@ -138,6 +210,18 @@ public:
     // not exist, a DigraphException is thrown instead.
     std::vector<std::pair<int, int>> edges(int vertex) const;
 
+    // forEachEdge() calls the given function once for each edge outgoing
+    // from the given vertex, passing it the edge as a (const) DigraphEdge,
+    // in the order the edges are stored.  Unlike edges() and edgeInfo(),
+    // this copies nothing.  If the given vertex does not exist, a
+    // DigraphException is thrown instead.
+    template <typename EdgeFunc>
+    void forEachEdge(int vertex, EdgeFunc edgeFunc) const;
+
+    // vertexExists() returns true if there is a vertex with the given
+    // vertex number in this Digraph, false otherwise.
+    bool vertexExists(int vertex) const;
+
     // vertexInfo() returns the VertexInfo object belonging to the vertex
     // with the given vertex number.  If that vertex does not exist, a
     // DigraphException is thrown instead.
@@ -165,7 +249,8 @@ public:
     // removeVertex() removes the vertex (and all of its incoming
     // and outgoing edges) with the given vertex number from the
     // Digraph.  If the vertex does not exist already, a DigraphException
-    // is thrown instead.
+    // is thrown instead.  The incoming edges are left dangling, so this
+    // takes O(log v) time, plus the occasional compact().
     void removeVertex(int vertex);
 
     // removeEdge() removes the edge pointing from the given "from"
@@ -175,6 +260,55 @@ public:
     // thrown instead.
     void removeEdge(int fromVertex, int toVertex);
 
+    // setEdgeInfo() replaces the EdgeInfo object of the edge pointing from
+    // the given "from" vertex number to the given "to" vertex number,
+    // leaving the edge where it is among the "from" vertex's edges.  The
+    // Digraph's version doesn't change, since its vertices and edges
+    // don't.  If either of these vertices does not exist *or* if the edge
+    // is not present in the graph, a DigraphException is thrown instead.
+    void setEdgeInfo(int fromVertex, int toVertex, const EdgeInfo& einfo);
+
+    // setVertexInfo() replaces the VertexInfo object of the given vertex.
+    // As with setEdgeInfo(), the Digraph's version doesn't change.  If the
+    // vertex does not exist, a DigraphException is thrown instead.
+    void setVertexInfo(int vertex, const VertexInfo& vinfo);
+
+    // compact() removes the edges left dangling by removeVertex(), along
+    // with the tombstones of the vertices removed, in one pass over the
+    // graph.  Only the vertices that have dangling edges are written to.
+    void compact();
+
+    // tombstoneCount() returns the number of vertices removed since the
+    // last compact().
+    int tombstoneCount() const noexcept;
+
+    // version() returns a number identifying the Digraph's vertices and
+    // edges as they are now (but not their VertexInfo and EdgeInfo
+    // objects, which setEdgeInfo() changes without changing the version,
+    // so that structures depending only on which vertices and edges there
+    // are needn't be rebuilt).  Adding or removing a vertex or an edge gives
+    // the Digraph a new version, never used before by any Digraph of the
+    // same type; copies share their version until one of them is changed.
+    // Structures built from a Digraph can keep its version and compare it
+    // later to find out whether they are stale.  A Digraph that has never
+    // been changed has version 0.
+    std::uint64_t version() const noexcept;
+
+    // memoryUsage() returns the memory allocated for the graph's vertex
+    // table, vertices, edges, and tombstones.  Since copies share storage,
+    // this counts everything allocated by this Digraph and every copy it
+    // shares storage with (or has shared it with), and is the same for
+    // each of them: it's the total for the whole family of copies.
+    MemoryUsage memoryUsage() const;
+
+    // ownedMemoryUsage() returns the part of memoryUsage() that only this
+    // Digraph is using, i.e., what destroying it would free: its vertex
+    // table and the vertices in it, with their edges, if no copy shares
+    // them.  The tombstones are only counted if they're the only ones in
+    // the family and no copy shares them.  A Digraph that shares nothing
+    // owns everything memoryUsage() counts.
+    MemoryUsage ownedMemoryUsage() const;
+
     // vertexCount() returns the number of vertices in the graph.
     int vertexCount() const noexcept;
 
@@ -207,12 +341,198 @@ public:
         int startVertex,
         std::function<double(const EdgeInfo&)> edgeWeightFunc) const;
 
+    // findShortestPath() uses the same algorithm as findShortestPaths()
+    // (and makes the same choices between paths of equal weight), but
+    // stops as soon as the shortest path to the end vertex is known.
+    // The path is returned as a std::vector of the edges along it, in
+    // order, which is empty if the start and end vertex are the same.
+    // If either vertex does not exist, or if the end vertex cannot be
+    // reached from the start vertex, a DigraphException is thrown.
+    std::vector<DigraphPathStep<EdgeInfo>> findShortestPath(
+        int startVertex, int endVertex,
+        std::function<double(const EdgeInfo&)> edgeWeightFunc) const;
+
+    // These overloads of findShortestPaths() and findShortestPath() take
+    // several edge weight functions and find shortest paths under each of
+    // them, returning one result per function, in the same order.  The
+    // results are exactly what calling the single-function versions once
+    // per function would return, but the searches are run together in one
+    // traversal of the graph: each vertex's edges are walked, and each
+    // weight function called on each edge, at most once, no matter how
+    // many of the searches reach that vertex.  Since the end vertex may be
+    // reachable under some of the functions and not others, each path that
+    // findShortestPath() returns is empty (std::nullopt) if the end vertex
+    // can't be reached under its function; only a vertex that doesn't
+    // exist makes it throw a DigraphException.
+    std::vector<std::map<int, int>> findShortestPaths(
+        int startVertex,
+        const std::vector<std::function<double(const EdgeInfo&)>>& edgeWeightFuncs) const;
+
+    std::vector<std::optional<std::vector<DigraphPathStep<EdgeInfo>>>> findShortestPath(
+        int startVertex, int endVertex,
+        const std::vector<std::function<double(const EdgeInfo&)>>& edgeWeightFuncs) const;
+
+    // findReachableWithin() finds every vertex that can be reached from
+    // the start vertex by a path whose weight is no more than the given
+    // budget (an "isochrone", when the weights are driving times).  The
+    // result holds each such vertex, including the start vertex, and the
+    // weight of its shortest path, in order of increasing weight.  The
+    // search stops at the budget, so it costs time proportional to the
+    // part of the graph within the budget, not to the whole graph.  If
+    // the start vertex does not exist, a DigraphException is thrown.
+    std::vector<DigraphReachedVertex> findReachableWithin(
+        int startVertex,
+        std::function<double(const EdgeInfo&)> edgeWeightFunc,
+        double budget) const;
+
+    // This overload of findReachableWithin() does the same from several
+    // start vertices at once (e.g., several depots), in one search.  Each
+    // vertex's weight is that of its shortest path from the nearest of
+    // the start vertices.
+    std::vector<DigraphReachedVertex> findReachableWithin(
+        const std::vector<int>& startVertices,
+        std::function<double(const EdgeInfo&)> edgeWeightFunc,
+        double budget) const;
+
 
 private:
     // Add whatever member variables you think you need here.  One
     // possibility is a std::map where the keys are vertex numbers
     // and the values are DigraphVertex<VertexInfo, EdgeInfo> objects.
-  std::map<int, DigraphVertex<VertexInfo, EdgeInfo>> obj;
+    typedef DigraphVertex<VertexInfo, EdgeInfo> Vertex;
+    typedef std::map<
+        int, std::shared_ptr<Vertex>, std::less<int>,
+        CountingAllocator<std::pair<const int, std::shared_ptr<Vertex>>>> VertexTable;
+
+    // A MemoryLedger counts the memory allocated for the vertex tables
+    // (the tables themselves, and their nodes), the vertices, their edges,
+    // and the tombstones (the sets themselves, what's in them, and their
+    // bitmaps).  It is shared between copies, along with what it counts,
+    // and is declared before everything it counts so that it is destroyed
+    // after them.
+    // Each counter other than tombstones counts allocations of a single
+    // size, so ownedMemoryUsage() can work out what any one of them takes.
+    struct MemoryLedger
+    {
+        MemoryCounter tables;
+        MemoryCounter table;
+        MemoryCounter vertices;
+        MemoryCounter edges;
+        MemoryCounter tombstoneSets;
+        MemoryCounter tombstones;
+    };
+
+    std::shared_ptr<MemoryLedger> ledger;
+
+    // The vertex table is shared between copies of a Digraph, as is each
+    // vertex it points to.  A null table is treated as an empty one, which
+    // is what a moved-from Digraph is left holding.
+    std::shared_ptr<VertexTable> obj;
+
+    // The vertex numbers of the vertices removed since the last compact(),
+    // which some edges may still point to.  Like the vertex table, they're
+    // shared between copies, and null is treated as empty.  Alongside the
+    // set of them is a bitmap with at least eight bits per tombstone, in
+    // which the bit each tombstone hashes to is set.  Nearly every edge
+    // points to a vertex whose bit is clear, so isDangling() can rule it
+    // out by reading one bit, only looking in the set when the bit is set.
+    struct Tombstones
+    {
+        explicit Tombstones(MemoryCounter* counter);
+
+        std::unordered_set<
+            int, std::hash<int>, std::equal_to<int>, CountingAllocator<int>> numbers;
+        std::vector<std::uint64_t, CountingAllocator<std::uint64_t>> bits;
+
+        // The bit a vertex number hashes to is its hash shifted right by
+        // this many bits.
+        int shift;
+    };
+
+    std::shared_ptr<Tombstones> tombstones;
+
+    // The version of the vertices and edges; see version().
+    std::uint64_t currentVersion = 0;
+
+    // nextVersion() returns a version that no Digraph of this type has had.
+    static std::uint64_t nextVersion() noexcept;
+
+    // Once there are more tombstones than this, or than an eighth of the
+    // vertices if that is more, removeVertex() calls compact().
+    static constexpr std::size_t minimumCompactionTombstones = 1024;
+
+    // isDangling() returns true if the given edge points to a vertex that
+    // has been removed.
+    bool isDangling(const DigraphEdge<EdgeInfo>& edge) const;
+
+    // isTombstone() returns true if the vertex with the given vertex
+    // number has been removed since the last compact().
+    bool isTombstone(int vertex) const;
+
+    // tombstoneBit() returns the bit of the given tombstones' bitmap that
+    // the given vertex number hashes to.
+    static std::size_t tombstoneBit(const Tombstones& removed, int vertex) noexcept;
+
+    // liveEdgeCount() returns the number of the given edges that aren't
+    // dangling.
+    int liveEdgeCount(const DigraphEdgeList<EdgeInfo>& edges) const noexcept;
+
+    // table() returns the vertex table for reading.
+    const VertexTable& table() const noexcept;
+
+    // memoryLedger() returns the MemoryLedger, first creating one if this
+    // Digraph has none.
+    MemoryLedger& memoryLedger();
+
+    // mutableTable() returns the vertex table for writing, first making
+    // a private copy of it if it is shared with another Digraph.
+    VertexTable& mutableTable();
+
+    // mutableVertex() returns the given vertex for writing, first making
+    // private copies of the table and the vertex if either is shared.
+    // The vertex is assumed to exist.
+    Vertex& mutableVertex(int vertex);
+
+    // A SearchLabel records what a search knows about one vertex: the
+    // weight of the shortest path found so far, whether that weight is
+    // known to be final, and the edge the path arrives by.
+    struct SearchLabel
+    {
+        double weight;
+        bool known;
+        const DigraphEdge<EdgeInfo>* edge;
+    };
+
+    // A SearchState records what a set of searches run together know.
+    // Each vertex reached by any of them is given a slot, and the label
+    // of the vertex in slot i for search s is labels[i * searches + s].
+    struct SearchState
+    {
+        std::size_t searches;
+        std::map<int, std::size_t> slots;
+        std::vector<SearchLabel> labels;
+
+        const SearchLabel* find(int vertex, std::size_t s) const
+        {
+            auto found = slots.find(vertex);
+            return found == slots.end() ? nullptr : &labels[found->second * searches + s];
+        }
+    };
+
+    // search() runs one Dijkstra search per weight function, from the
+    // given start vertex, together in one traversal.  If endVertex is a
+    // vertex number, each search stops once its shortest path to that
+    // vertex is known.
+    SearchState search(
+        int startVertex, const int* endVertex,
+        const std::vector<std::function<double(const EdgeInfo&)>>& edgeWeightFuncs) const;
+
+    // pathTo() follows the labels of the given search back from the given
+    // end vertex to the start vertex, returning the path found, or
+    // std::nullopt if the end vertex was never reached.
+    static std::optional<std::vector<DigraphPathStep<EdgeInfo>>> pathTo(
+        const SearchState& state, std::size_t s, int startVertex, int endVertex);
+
   void connect(int v, std::map<int, bool>& visited, std::vector<int>& visit) const;
     // You can also feel free to add any additional member functions
     // you'd like (public or private), so long as you don't remove or
@@ -233,19 +553,18 @@ Digraph<VertexInfo, EdgeInfo>::Digraph()
 
 template <typename VertexInfo, typename EdgeInfo>
 Digraph<VertexInfo, EdgeInfo>::Digraph(const Digraph& d)
+  : ledger{d.ledger}, obj{d.obj}, tombstones{d.tombstones}, currentVersion{d.currentVersion}
 {
-  //for(typename std::map<int, DigraphVertex<VertexInfo, EdgeInfo>>::iterator iter = d.obj.begin(); iter != d.obj.end(); ++iter)
-  for(auto& ent: d.obj)
-    {
-      obj[ent.first] = ent.second;
-    }
 }
 
 
 template <typename VertexInfo, typename EdgeInfo>
 Digraph<VertexInfo, EdgeInfo>::Digraph(Digraph&& d) noexcept
 {
+  std::swap(ledger, d.ledger);
   std::swap(obj, d.obj);
+  std::swap(tombstones, d.tombstones);
+  std::swap(currentVersion, d.currentVersion);
 }
 
 
@@ -256,21 +575,18 @@ Digraph<VertexInfo, EdgeInfo>::~Digraph() noexcept
   // {
   //   ent->second.edges.clear();
   // }
-  obj.clear();
 }
 
 
 template <typename VertexInfo, typename EdgeInfo>
 Digraph<VertexInfo, EdgeInfo>& Digraph<VertexInfo, EdgeInfo>::operator=(const Digraph& d)
 {
-    obj.clear();
-    //this->obj = d.obj;
-    //return *this;
-    //for(typename std::map<int, DigraphVertex<VertexInfo, EdgeInfo>>::iterator iter = d.obj.begin(); iter != d.obj.end(); ++iter)
-    for(auto& ent: d.obj)
-    {
-      obj[ent.first] = ent.second;
-    }
+    // The ledger is replaced last, since it counts the storage that
+    // replacing the others may free.
+    obj = d.obj;
+    tombstones = d.tombstones;
+    ledger = d.ledger;
+    currentVersion = d.currentVersion;
     return *this;
 }
 
@@ -278,17 +594,123 @@ Digraph<VertexInfo, EdgeInfo>& Digraph<VertexInfo, EdgeInfo>::operator=(const Di
 template <typename VertexInfo, typename EdgeInfo>
 Digraph<VertexInfo, EdgeInfo>& Digraph<VertexInfo, EdgeInfo>::operator=(Digraph&& d) noexcept
 {
+    std::swap(ledger, d.ledger);
     std::swap(obj, d.obj);
+    std::swap(tombstones, d.tombstones);
+    std::swap(currentVersion, d.currentVersion);
     return *this;
 }
 
 
+template <typename VertexInfo, typename EdgeInfo>
+const typename Digraph<VertexInfo, EdgeInfo>::VertexTable&
+Digraph<VertexInfo, EdgeInfo>::table() const noexcept
+{
+    static const VertexTable empty;
+    return obj ? *obj : empty;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+typename Digraph<VertexInfo, EdgeInfo>::MemoryLedger&
+Digraph<VertexInfo, EdgeInfo>::memoryLedger()
+{
+    if (!ledger)
+    {
+        ledger = std::make_shared<MemoryLedger>();
+    }
+
+    return *ledger;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+typename Digraph<VertexInfo, EdgeInfo>::VertexTable&
+Digraph<VertexInfo, EdgeInfo>::mutableTable()
+{
+    MemoryLedger& counted = memoryLedger();
+    CountingAllocator<VertexTable> allocator{&counted.tables};
+
+    if (!obj)
+    {
+        obj = std::allocate_shared<VertexTable>(
+            allocator, CountingAllocator<VertexTable>{&counted.table});
+    }
+    else if (obj.use_count() > 1)
+    {
+        obj = std::allocate_shared<VertexTable>(allocator, *obj);
+    }
+
+    return *obj;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+typename Digraph<VertexInfo, EdgeInfo>::Vertex&
+Digraph<VertexInfo, EdgeInfo>::mutableVertex(int vertex)
+{
+    std::shared_ptr<Vertex>& v = mutableTable().at(vertex);
+
+    if (v.use_count() > 1)
+    {
+        v = std::allocate_shared<Vertex>(
+            CountingAllocator<Vertex>{&memoryLedger().vertices}, *v);
+    }
+
+    return *v;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+bool Digraph<VertexInfo, EdgeInfo>::isDangling(const DigraphEdge<EdgeInfo>& edge) const
+{
+    return isTombstone(edge.toVertex);
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+bool Digraph<VertexInfo, EdgeInfo>::isTombstone(int vertex) const
+{
+    if (!tombstones)
+    {
+        return false;
+    }
+
+    std::size_t bit = tombstoneBit(*tombstones, vertex);
+
+    return (tombstones->bits[bit / 64] >> (bit % 64) & 1) != 0
+        && tombstones->numbers.count(vertex) != 0;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::size_t Digraph<VertexInfo, EdgeInfo>::tombstoneBit(
+    const Tombstones& removed, int vertex) noexcept
+{
+    // Fibonacci hashing, which spreads out vertex numbers that differ
+    // only in their high bits, or that are all multiples of some number.
+    std::uint64_t hash =
+        static_cast<std::uint64_t>(static_cast<std::uint32_t>(vertex)) * 0x9E3779B97F4A7C15u;
+
+    return static_cast<std::size_t>(hash >> removed.shift);
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+Digraph<VertexInfo, EdgeInfo>::Tombstones::Tombstones(MemoryCounter* counter)
+    : numbers{CountingAllocator<int>{counter}},
+      bits(1, 0, CountingAllocator<std::uint64_t>{counter}),
+      shift{64 - 6}
+{
+}
+
+
 template <typename VertexInfo, typename EdgeInfo>
 std::vector<int> Digraph<VertexInfo, EdgeInfo>::vertices() const
 {
   //return std::vector<int>{};
   std::vector<int> vtex;
-  for(auto& ent: obj)
+  for(auto& ent: table())
     {
       vtex.push_back(ent.first);
     }
@@ -301,11 +723,14 @@ std::vector<std::pair<int, int>> Digraph<VertexInfo, EdgeInfo>::edges() const
 {
   //return std::vector<std::pair<int, int>>{};
   std::vector<std::pair<int, int>> pts;
-  for(auto& outer: obj)
+  for(auto& outer: table())
     {
-      for(auto& inner: outer.second.edges)
+      for(auto& inner: outer.second->edges)
         {
-          pts.push_back(std::make_pair(inner.fromVertex, inner.toVertex));
+          if(!isDangling(inner))
+            {
+              pts.push_back(std::make_pair(inner.fromVertex, inner.toVertex));
+            }
         }
     }
   return pts;
@@ -317,11 +742,14 @@ std::vector<std::pair<int, int>> Digraph<VertexInfo, EdgeInfo>::edges(int vertex
 {
   //return std::vector<std::pair<int, int>>{};
   std::vector<std::pair<int, int>> pts;
-  if(obj.count(vertex))
+  if(table().count(vertex))
     {
-      for(auto& ent: obj.at(vertex).edges)
+      for(auto& ent: table().at(vertex)->edges)
         {
-          pts.push_back(std::make_pair(ent.fromVertex, ent.toVertex));
+          if(!isDangling(ent))
+            {
+              pts.push_back(std::make_pair(ent.fromVertex, ent.toVertex));
+            }
           //pts.push_back(std::make_pair(vertex, ent.toVertex));
         }
       return pts;
@@ -333,6 +761,34 @@ std::vector<std::pair<int, int>> Digraph<VertexInfo, EdgeInfo>::edges(int vertex
 }
 
 
+template <typename VertexInfo, typename EdgeInfo>
+template <typename EdgeFunc>
+void Digraph<VertexInfo, EdgeInfo>::forEachEdge(int vertex, EdgeFunc edgeFunc) const
+{
+    auto found = table().find(vertex);
+
+    if (found == table().end())
+    {
+        throw DigraphException("Vertex does not exist!\n");
+    }
+
+    for (const DigraphEdge<EdgeInfo>& edge : found->second->edges)
+    {
+        if (!isDangling(edge))
+        {
+            edgeFunc(edge);
+        }
+    }
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+bool Digraph<VertexInfo, EdgeInfo>::vertexExists(int vertex) const
+{
+    return table().count(vertex) != 0;
+}
+
+
 template <typename VertexInfo, typename EdgeInfo>
 VertexInfo Digraph<VertexInfo, EdgeInfo>::vertexInfo(int vertex) const
 {
@@ -345,7 +801,7 @@ VertexInfo Digraph<VertexInfo, EdgeInfo>::vertexInfo(int vertex) const
     {
       throw DigraphException("Vertex does not exist!\n");
     }*/
-  return obj.count(vertex)? obj.at(vertex).vinfo: throw DigraphException("Vertex does not exist!!!!!!\n");
+  return table().count(vertex)? table().at(vertex)->vinfo: throw DigraphException("Vertex does not exist!!!!!!\n");
 }
 
 
@@ -356,7 +812,7 @@ EdgeInfo Digraph<VertexInfo, EdgeInfo>::edgeInfo(int fromVertex, int toVertex) c
   // EdgeInfo einf;
   std::vector<std::pair<int, int>> from = edges(fromVertex);
   std::pair<int, int> coord = std::make_pair(fromVertex, toVertex);
-  if(obj.count(fromVertex) && obj.count(toVertex))
+  if(table().count(fromVertex) && table().count(toVertex))
     {  
        if(std::find(from.begin(), from.end(), coord) == from.end())
        {
@@ -367,7 +823,7 @@ EdgeInfo Digraph<VertexInfo, EdgeInfo>::edgeInfo(int fromVertex, int toVertex) c
     {
       throw DigraphException("Edge does not exist!\n");
     }
-  for(auto& ent: obj.at(fromVertex).edges)
+  for(auto& ent: table().at(fromVertex)->edges)
     {
       if(ent.toVertex == toVertex)
         {
@@ -381,11 +837,25 @@ EdgeInfo Digraph<VertexInfo, EdgeInfo>::edgeInfo(int fromVertex, int toVertex) c
 template <typename VertexInfo, typename EdgeInfo>
 void Digraph<VertexInfo, EdgeInfo>::addVertex(int vertex, const VertexInfo& vinfo)
 {
-  if(!(obj.count(vertex)))
+  if(!(table().count(vertex)))
     {
+      // The edges left dangling when a vertex with this number was
+      // removed must not come back to life along with the number.
+      if(isTombstone(vertex))
+        {
+          compact();
+        }
+
       //DigraphVertex<VertexInfo, EdgeInfo> vtex = DigraphVertex<VertexInfo, EdgeInfo>{vinfo};
-      DigraphVertex<VertexInfo, EdgeInfo> vtex{vinfo};
-      obj.insert(std::pair<int, DigraphVertex<VertexInfo, EdgeInfo>>(vertex, vtex));
+      MemoryLedger& counted = memoryLedger();
+      DigraphVertex<VertexInfo, EdgeInfo> vtex{
+          vinfo,
+          DigraphEdgeList<EdgeInfo>(CountingAllocator<DigraphEdge<EdgeInfo>>{&counted.edges})};
+      mutableTable().emplace(
+          vertex,
+          std::allocate_shared<Vertex>(
+              CountingAllocator<Vertex>{&counted.vertices}, std::move(vtex)));
+      currentVersion = nextVersion();
     }
   else
     {
@@ -399,7 +869,7 @@ void Digraph<VertexInfo, EdgeInfo>::addEdge(int fromVertex, int toVertex, const
 {
    std::vector<std::pair<int, int>> from = edges(fromVertex);
    std::pair<int, int> coord = std::make_pair(fromVertex, toVertex);
-   if(obj.count(fromVertex) && obj.count(toVertex))
+   if(table().count(fromVertex) && table().count(toVertex))
     {
       if(std::find(from.begin(), from.end(), coord) != from.end())
        {
@@ -411,65 +881,289 @@ void Digraph<VertexInfo, EdgeInfo>::addEdge(int fromVertex, int toVertex, const
       throw DigraphException("Invalid edge!\n");
     }
    DigraphEdge<EdgeInfo> newEdge{fromVertex, toVertex, einfo};
-   obj.at(fromVertex).edges.push_back(newEdge);
+   mutableVertex(fromVertex).edges.push_back(newEdge);
+   currentVersion = nextVersion();
 }
 
 
 template <typename VertexInfo, typename EdgeInfo>
 void Digraph<VertexInfo, EdgeInfo>::removeVertex(int vertex)
 {
-   if(obj.count(vertex))
+   if(table().count(vertex))
     {
-      obj.erase(vertex);
+      mutableTable().erase(vertex);
     }
   else
     {
       throw DigraphException("Vertex does not exist!\n");
     }
-   for(auto& outer: obj)
+
+   // The edges into the removed vertex are left dangling, until there are
+   // enough tombstones to make removing them worthwhile.
+   MemoryLedger& counted = memoryLedger();
+   CountingAllocator<Tombstones> allocator{&counted.tombstoneSets};
+
+   if(!tombstones)
      {
-       for(typename std::list<DigraphEdge<EdgeInfo>>::iterator iter = outer.second.edges.begin(); iter != outer.second.edges.end(); ++iter)
+       tombstones = std::allocate_shared<Tombstones>(allocator, &counted.tombstones);
+     }
+   else if(tombstones.use_count() > 1)
+     {
+       tombstones = std::allocate_shared<Tombstones>(allocator, *tombstones);
+     }
+
+   tombstones->numbers.insert(vertex);
+
+   // The bitmap is doubled whenever it would have fewer than eight bits
+   // per tombstone, so that setting a bit costs O(1) time amortized.
+   std::vector<std::uint64_t, CountingAllocator<std::uint64_t>>& bits = tombstones->bits;
+
+   if(tombstones->numbers.size() * 8 > bits.size() * 64)
+     {
+       bits.assign(bits.size() * 2, 0);
+       --tombstones->shift;
+
+       for(int removed: tombstones->numbers)
          {
-           if(iter->toVertex == vertex)
-             {
-               outer.second.edges.erase(iter);   
-             }
+           std::size_t bit = tombstoneBit(*tombstones, removed);
+           bits[bit / 64] |= std::uint64_t{1} << (bit % 64);
          }
-       //obj.erase(vertex);
-    }
+     }
+   else
+     {
+       std::size_t bit = tombstoneBit(*tombstones, vertex);
+       bits[bit / 64] |= std::uint64_t{1} << (bit % 64);
+     }
+
+   currentVersion = nextVersion();
+
+   if(tombstones->numbers.size() > std::max(minimumCompactionTombstones, table().size() / 8))
+     {
+       compact();
+     }
 }
 
 
 template <typename VertexInfo, typename EdgeInfo>
 void Digraph<VertexInfo, EdgeInfo>::removeEdge(int fromVertex, int toVertex)
 {
-  std::pair<int, int> coord = std::make_pair(fromVertex, toVertex);
-  std::vector<std::pair<int, int>> from = edges(fromVertex);
-  if(obj.count(fromVertex) && obj.count(toVertex))
+  if(!table().count(fromVertex) || !table().count(toVertex))
     {
-      if(std::find(from.begin(), from.end(), coord) == from.end())
+      throw DigraphException("Vertices entered do not exist!\n");
+    }
+
+  // The edge is found before anything is written, so that a vertex shared
+  // with another copy isn't copied just to find that it has no such edge.
+  const DigraphEdgeList<EdgeInfo>& edges = table().at(fromVertex)->edges;
+  auto found = std::find_if(
+      edges.begin(), edges.end(),
+      [toVertex](const DigraphEdge<EdgeInfo>& e)
       {
-        throw DigraphException("Edge already exists in the graph!\n");
-      }
+          return e.toVertex == toVertex;
+      });
+
+  if(found == edges.end())
+    {
+      throw DigraphException("Edge does not exist!\n");
     }
-  else
+
+  auto position = std::distance(edges.begin(), found);
+  DigraphEdgeList<EdgeInfo>& fromEdges = mutableVertex(fromVertex).edges;
+  fromEdges.erase(std::next(fromEdges.begin(), position));
+  currentVersion = nextVersion();
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+void Digraph<VertexInfo, EdgeInfo>::setEdgeInfo(
+    int fromVertex, int toVertex, const EdgeInfo& einfo)
+{
+  if(!table().count(fromVertex) || !table().count(toVertex))
     {
       throw DigraphException("Vertices entered do not exist!\n");
     }
-  /* for(auto& ent: obj.at(fromVertex).edges)
+
+  // As in removeEdge(), the edge is found before anything is written.
+  const DigraphEdgeList<EdgeInfo>& edges = table().at(fromVertex)->edges;
+  auto found = std::find_if(
+      edges.begin(), edges.end(),
+      [toVertex](const DigraphEdge<EdgeInfo>& e)
+      {
+          return e.toVertex == toVertex;
+      });
+
+  if(found == edges.end())
     {
-      if(ent.toVertex == toVertex)
+      throw DigraphException("Edge does not exist!\n");
+    }
+
+  auto position = std::distance(edges.begin(), found);
+  std::next(mutableVertex(fromVertex).edges.begin(), position)->einfo = einfo;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+void Digraph<VertexInfo, EdgeInfo>::setVertexInfo(int vertex, const VertexInfo& vinfo)
+{
+  if(!table().count(vertex))
+    {
+      throw DigraphException("Vertex does not exist!\n");
+    }
+
+  mutableVertex(vertex).vinfo = vinfo;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+void Digraph<VertexInfo, EdgeInfo>::compact()
+{
+   if(!tombstones || tombstones->numbers.empty())
+     {
+       return;
+     }
+
+   // Only the vertices that actually have a dangling edge are written to,
+   // so that vertices shared with other copies stay shared.
+   std::vector<int> affected;
+   for(auto& outer: table())
+     {
+       for(auto& inner: outer.second->edges)
+         {
+           if(isDangling(inner))
+             {
+               affected.push_back(outer.first);
+               break;
+             }
+         }
+     }
+
+   // The tombstones are still needed to recognize the dangling edges, so
+   // they're dropped only once the edges are gone.
+   std::shared_ptr<Tombstones> removed = std::move(tombstones);
+   for(int from: affected)
+     {
+       mutableVertex(from).edges.remove_if(
+           [&removed](const DigraphEdge<EdgeInfo>& e)
+           {
+               return removed->numbers.count(e.toVertex) != 0;
+           });
+     }
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+int Digraph<VertexInfo, EdgeInfo>::tombstoneCount() const noexcept
+{
+    return tombstones ? static_cast<int>(tombstones->numbers.size()) : 0;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::uint64_t Digraph<VertexInfo, EdgeInfo>::version() const noexcept
+{
+    return currentVersion;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::uint64_t Digraph<VertexInfo, EdgeInfo>::nextVersion() noexcept
+{
+    static std::atomic<std::uint64_t> last{0};
+    return ++last;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+MemoryUsage Digraph<VertexInfo, EdgeInfo>::memoryUsage() const
+{
+    MemoryUsage usage;
+
+    if (!ledger)
+    {
+        return usage;
+    }
+
+    // Each vertex and each edge is a separate allocation, which holds its
+    // VertexInfo or EdgeInfo object.
+    usage.vertexInfo = ledger->vertices.allocations() * sizeof(VertexInfo);
+    usage.vertexTable =
+        ledger->tables.bytes() + ledger->table.bytes() + ledger->vertices.bytes()
+        - usage.vertexInfo;
+    usage.edgeInfo = ledger->edges.allocations() * sizeof(EdgeInfo);
+    usage.adjacency = ledger->edges.bytes() - usage.edgeInfo;
+    usage.indexes = ledger->tombstoneSets.bytes() + ledger->tombstones.bytes();
+
+    return usage;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+MemoryUsage Digraph<VertexInfo, EdgeInfo>::ownedMemoryUsage() const
+{
+    if (ledger.use_count() <= 1)
+    {
+        return memoryUsage();
+    }
+
+    // The size of one allocation counted by the given counter, all of
+    // which are the same size.
+    auto unit =
+        [](const MemoryCounter& counter) -> std::size_t
         {
-          ent.toVertex = obj.erase(toVertex);
-        }
-    }*/
-  for(typename std::list<DigraphEdge<EdgeInfo>>::iterator iter = obj.at(fromVertex).edges.begin(); iter != obj.at(fromVertex).edges.end(); ++iter)
+            std::size_t allocations = counter.allocations();
+            return allocations != 0 ? counter.bytes() / allocations : 0;
+        };
+
+    MemoryUsage usage;
+
+    // A vertex in a table that's shared is shared, too, even if nothing
+    // else points to it.
+    if (obj && obj.use_count() == 1)
     {
-      if(iter->toVertex == toVertex)
+        std::size_t vertices = 0;
+        std::size_t edges = 0;
+
+        for (const auto& entry : *obj)
         {
-          obj.at(fromVertex).edges.erase(iter);   
+            if (entry.second.use_count() == 1)
+            {
+                ++vertices;
+                edges += entry.second->edges.size();
+            }
         }
+
+        usage.vertexInfo = vertices * sizeof(VertexInfo);
+        usage.vertexTable =
+            unit(ledger->tables) + obj->size() * unit(ledger->table)
+            + vertices * unit(ledger->vertices) - usage.vertexInfo;
+        usage.edgeInfo = edges * sizeof(EdgeInfo);
+        usage.adjacency = edges * unit(ledger->edges) - usage.edgeInfo;
+    }
+
+    if (tombstones && tombstones.use_count() == 1 && ledger->tombstoneSets.allocations() == 1)
+    {
+        usage.indexes = ledger->tombstoneSets.bytes() + ledger->tombstones.bytes();
+    }
+
+    return usage;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+int Digraph<VertexInfo, EdgeInfo>::liveEdgeCount(
+    const DigraphEdgeList<EdgeInfo>& edges) const noexcept
+{
+    if (tombstoneCount() == 0)
+    {
+        return edges.size();
     }
+
+    return std::count_if(
+        edges.begin(), edges.end(),
+        [this](const DigraphEdge<EdgeInfo>& e)
+        {
+            return !isDangling(e);
+        });
 }
 
 
@@ -477,7 +1171,7 @@ template <typename VertexInfo, typename EdgeInfo>
 int Digraph<VertexInfo, EdgeInfo>::vertexCount() const noexcept
 {
   //return 0;
-  return obj.size();
+  return table().size();
 }
 
 
@@ -486,9 +1180,9 @@ int Digraph<VertexInfo, EdgeInfo>::edgeCount() const noexcept
 {
   //return 0;
   int count = 0;
-  for(auto& ent: obj)
+  for(auto& ent: table())
     {
-      count += ent.second.edges.size();
+      count += liveEdgeCount(ent.second->edges);
     }
   return count;
 }
@@ -498,7 +1192,7 @@ template <typename VertexInfo, typename EdgeInfo>
 int Digraph<VertexInfo, EdgeInfo>::edgeCount(int vertex) const
 {
   //return 0;
-  if(obj.count(vertex) == 0)
+  if(table().count(vertex) == 0)
     {
       throw DigraphException("Vertex does not exist!\n");
     }
@@ -508,7 +1202,7 @@ int Digraph<VertexInfo, EdgeInfo>::edgeCount(int vertex) const
   //  count++;
   //}
   //  return count;
-  return obj.at(vertex).edges.size();
+  return liveEdgeCount(table().at(vertex)->edges);
 }
 
 
@@ -517,9 +1211,12 @@ void Digraph<VertexInfo, EdgeInfo>::connect(int v, std::map<int, bool>& visited,
 {
   visited[v] = true;
   visit.push_back(v);
-  for (auto& ent: obj.at(v).edges)
+  DIGRAPH_COUNT(verticesSettled, 1);
+  for (auto& ent: table().at(v)->edges)
     {
-      if (!visited[ent.toVertex])
+      DIGRAPH_COUNT(edgesRelaxed, 1);
+      DIGRAPH_COUNT(bytesTouched, sizeof(ent));
+      if (!isDangling(ent) && !visited[ent.toVertex])
         connect(ent.toVertex, visited, visit);
     }
 }
@@ -530,15 +1227,15 @@ bool Digraph<VertexInfo, EdgeInfo>::isStronglyConnected() const
 {
   //return false;
   
-  for(auto& outer: obj)
+  for(auto& outer: table())
     {
       std::vector<int> visit;
       std::map<int, bool> visited;
-      for(auto& inner: obj)
+      for(auto& inner: table())
         visited[inner.first] = false;
       
       connect(outer.first, visited, visit);
-      if (visit.size() != obj.size())
+      if (visit.size() != table().size())
         return false;
     }
   return true;
@@ -550,72 +1247,402 @@ std::map<int, int> Digraph<VertexInfo, EdgeInfo>::findShortestPaths(
     int startVertex,
     std::function<double(const EdgeInfo&)> edgeWeightFunc) const
 {
-  //return std::map<int, int>{};
-    std::map<int,bool> kv;
-    std::map<int,int> pv;
-    std::map<int,double> dv;
-    
-    class V
+    return findShortestPaths(
+        startVertex,
+        std::vector<std::function<double(const EdgeInfo&)>>{edgeWeightFunc}).front();
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::vector<DigraphPathStep<EdgeInfo>> Digraph<VertexInfo, EdgeInfo>::findShortestPath(
+    int startVertex, int endVertex,
+    std::function<double(const EdgeInfo&)> edgeWeightFunc) const
+{
+    std::optional<std::vector<DigraphPathStep<EdgeInfo>>> path = findShortestPath(
+        startVertex, endVertex,
+        std::vector<std::function<double(const EdgeInfo&)>>{edgeWeightFunc}).front();
+
+    if (!path)
+    {
+        throw DigraphException("End vertex is not reachable!\n");
+    }
+
+    return std::move(*path);
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::vector<std::map<int, int>> Digraph<VertexInfo, EdgeInfo>::findShortestPaths(
+    int startVertex,
+    const std::vector<std::function<double(const EdgeInfo&)>>& edgeWeightFuncs) const
+{
+    if (table().count(startVertex) == 0)
+    {
+        throw DigraphException("Vertex does not exist!\n");
+    }
+
+    std::vector<std::map<int, int>> result;
+
+    SearchState state = search(startVertex, nullptr, edgeWeightFuncs);
+
+    for (std::size_t s = 0; s < edgeWeightFuncs.size(); ++s)
+    {
+        std::map<int, int> pv;
+
+        for (auto& ent: table())
+        {
+            const SearchLabel* label = state.find(ent.first, s);
+
+            if (label == nullptr || label->edge == nullptr)
+            {
+                pv.emplace_hint(pv.end(), ent.first, ent.first);
+            }
+            else
+            {
+                pv.emplace_hint(pv.end(), ent.first, label->edge->fromVertex);
+            }
+        }
+
+        result.push_back(std::move(pv));
+    }
+
+    return result;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::vector<std::optional<std::vector<DigraphPathStep<EdgeInfo>>>>
+Digraph<VertexInfo, EdgeInfo>::findShortestPath(
+    int startVertex, int endVertex,
+    const std::vector<std::function<double(const EdgeInfo&)>>& edgeWeightFuncs) const
+{
+    if (table().count(startVertex) == 0 || table().count(endVertex) == 0)
+    {
+        throw DigraphException("Vertex does not exist!\n");
+    }
+
+    std::vector<std::optional<std::vector<DigraphPathStep<EdgeInfo>>>> result;
+
+    SearchState state = search(startVertex, &endVertex, edgeWeightFuncs);
+
+    for (std::size_t s = 0; s < edgeWeightFuncs.size(); ++s)
+    {
+        result.push_back(pathTo(state, s, startVertex, endVertex));
+    }
+
+    return result;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+typename Digraph<VertexInfo, EdgeInfo>::SearchState
+Digraph<VertexInfo, EdgeInfo>::search(
+    int startVertex, const int* endVertex,
+    const std::vector<std::function<double(const EdgeInfo&)>>& edgeWeightFuncs) const
+{
+    std::size_t searches = edgeWeightFuncs.size();
+
+    // Only vertices a search actually reaches get a slot, so a short
+    // trip costs time proportional to the part of the graph it explores
+    // rather than to the size of the whole graph.
+    struct Entry
     {
-      public:
         double weight;
-        int v;
-        V(){};
-        V(double weigh, int vtex):
-          weight(weigh), v(vtex) {}
+        std::size_t slot;
     };
 
-    class compare
+    struct EntryCompare
     {
-    public:
-      bool operator()(V& lhs, V& rhs)
-      {
-        return rhs.weight < lhs.weight;
-      }
+        bool operator()(const Entry& lhs, const Entry& rhs) const
+        {
+            return rhs.weight < lhs.weight;
+        }
     };
-    
-    for(auto& ent: obj)
+
+    SearchState state{searches, {}, {}};
+
+    // For each slot, the vertex's edges, and the position of the record
+    // made of them the first time a search settled the vertex (if any).
+    // Later searches reuse the record, which holds each edge and its
+    // weight under every function, the weights of the edge at position i
+    // being weights[i * searches + s].
+    const std::size_t notScanned = static_cast<std::size_t>(-1);
+
+    std::vector<const DigraphEdgeList<EdgeInfo>*> slotEdges;
+    std::vector<std::size_t> scans;
+    std::vector<const DigraphEdge<EdgeInfo>*> scannedEdges;
+    std::vector<double> weights;
+
+    auto slotOf = [&](int vertex, const DigraphEdgeList<EdgeInfo>* edges)
     {
-      kv.emplace(ent.first, 0);
-      pv.emplace(ent.first, ent.first);
-      if(startVertex != ent.first)
+        auto inserted = state.slots.emplace(vertex, slotEdges.size());
+
+        if (inserted.second)
         {
-          dv.emplace(ent.first, INF);
+            slotEdges.push_back(edges);
+            DIGRAPH_COUNT(allocations, 1);
+            scans.push_back(notScanned);
+            state.labels.resize(
+                state.labels.size() + searches,
+                SearchLabel{std::numeric_limits<double>::infinity(), false, nullptr});
         }
-      else
+
+        return inserted.first->second;
+    };
+
+    std::vector<std::priority_queue<Entry, std::vector<Entry>, EntryCompare>> pqs(searches);
+    std::vector<bool> finished(searches, false);
+    std::size_t running = searches;
+
+    std::size_t startSlot = slotOf(startVertex, &table().at(startVertex)->edges);
+
+    for (std::size_t s = 0; s < searches; ++s)
+    {
+        state.labels[startSlot * searches + s].weight = 0;
+        pqs[s].push(Entry{0, startSlot});
+        DIGRAPH_COUNT(heapPushes, 1);
+    }
+
+    // The searches take turns settling one vertex each.  Each search's
+    // own sequence of steps is exactly what it would be if it ran alone.
+    while (running > 0)
+    {
+        for (std::size_t s = 0; s < searches; ++s)
+        {
+            if (finished[s])
+            {
+                continue;
+            }
+
+            if (pqs[s].empty())
+            {
+                finished[s] = true;
+                --running;
+                continue;
+            }
+
+            std::size_t slot = pqs[s].top().slot;
+            pqs[s].pop();
+            DIGRAPH_COUNT(heapPops, 1);
+
+            SearchLabel* label = &state.labels[slot * searches + s];
+
+            if (label->known)
+            {
+                DIGRAPH_COUNT(stalePops, 1);
+                continue;
+            }
+
+            label->known = true;
+            DIGRAPH_COUNT(verticesSettled, 1);
+
+            const DigraphEdgeList<EdgeInfo>& edges = *slotEdges[slot];
+
+            if (endVertex != nullptr
+                && (label->edge != nullptr ? label->edge->toVertex : startVertex) == *endVertex)
+            {
+                finished[s] = true;
+                --running;
+                continue;
+            }
+
+            double base = label->weight;
+
+            auto relax = [&](const DigraphEdge<EdgeInfo>& edge, double weight)
+            {
+                if (isDangling(edge))
+                {
+                    return;
+                }
+
+                std::size_t to = slotOf(edge.toVertex, nullptr);
+                SearchLabel& toLabel = state.labels[to * searches + s];
+
+                DIGRAPH_COUNT(edgesRelaxed, 1);
+                DIGRAPH_COUNT(bytesTouched, sizeof(edge) + sizeof(toLabel));
+
+                if (slotEdges[to] == nullptr)
+                {
+                    slotEdges[to] = &table().at(edge.toVertex)->edges;
+                }
+
+                if (toLabel.weight > weight)
+                {
+                    toLabel.weight = weight;
+                    toLabel.edge = &edge;
+                    pqs[s].push(Entry{weight, to});
+                    DIGRAPH_COUNT(heapPushes, 1);
+                }
+            };
+
+            // A lone search has no one to share its scans with.
+            if (searches == 1)
+            {
+                for (const DigraphEdge<EdgeInfo>& edge : edges)
+                {
+                    relax(edge, base + edgeWeightFuncs[s](edge.einfo));
+                }
+
+                continue;
+            }
+
+            if (scans[slot] == notScanned)
+            {
+                scans[slot] = scannedEdges.size();
+
+                for (const DigraphEdge<EdgeInfo>& edge : edges)
+                {
+                    scannedEdges.push_back(&edge);
+
+                    for (const auto& edgeWeightFunc : edgeWeightFuncs)
+                    {
+                        weights.push_back(edgeWeightFunc(edge.einfo));
+                    }
+                }
+            }
+
+            for (std::size_t i = scans[slot], n = 0; n < edges.size(); ++i, ++n)
+            {
+                relax(*scannedEdges[i], base + weights[i * searches + s]);
+            }
+        }
+    }
+
+    return state;
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::optional<std::vector<DigraphPathStep<EdgeInfo>>> Digraph<VertexInfo, EdgeInfo>::pathTo(
+    const SearchState& state, std::size_t s, int startVertex, int endVertex)
+{
+    const SearchLabel* end = state.find(endVertex, s);
+
+    if (end == nullptr || !end->known)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<DigraphPathStep<EdgeInfo>> path;
+
+    for (int v = endVertex; v != startVertex; )
+    {
+        const SearchLabel* label = state.find(v, s);
+        const DigraphEdge<EdgeInfo>* edge = label->edge;
+        path.push_back(DigraphPathStep<EdgeInfo>{
+            edge->fromVertex, edge->toVertex, &edge->einfo, label->weight});
+        v = edge->fromVertex;
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::vector<DigraphReachedVertex> Digraph<VertexInfo, EdgeInfo>::findReachableWithin(
+    int startVertex,
+    std::function<double(const EdgeInfo&)> edgeWeightFunc,
+    double budget) const
+{
+    return findReachableWithin(std::vector<int>{startVertex}, edgeWeightFunc, budget);
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+std::vector<DigraphReachedVertex> Digraph<VertexInfo, EdgeInfo>::findReachableWithin(
+    const std::vector<int>& startVertices,
+    std::function<double(const EdgeInfo&)> edgeWeightFunc,
+    double budget) const
+{
+    struct Entry
+    {
+        double weight;
+        int vertex;
+    };
+
+    struct EntryCompare
+    {
+        bool operator()(const Entry& lhs, const Entry& rhs) const
         {
-          dv.emplace(ent.first, 0);
+            return rhs.weight < lhs.weight;
+        }
+    };
+
+    // Each vertex reached maps to the best weight found so far, or to NaN
+    // once the vertex is settled and has been added to the result.
+    std::map<int, double> weights;
+    std::priority_queue<Entry, std::vector<Entry>, EntryCompare> pq;
+
+    for (int start : startVertices)
+    {
+        if (table().count(start) == 0)
+        {
+            throw DigraphException("Vertex does not exist!\n");
+        }
+
+        if (budget >= 0 && weights.emplace(start, 0.0).second)
+        {
+            pq.push(Entry{0, start});
+            DIGRAPH_COUNT(heapPushes, 1);
+            DIGRAPH_COUNT(allocations, 1);
         }
     }
-    
-    std::priority_queue<V, std::vector<V>, compare> pq;
-    pq.push(V{0, startVertex});
-    while(pq.size() != 0)
+
+    std::vector<DigraphReachedVertex> reached;
+
+    while (!pq.empty())
     {
-        V ver = pq.top();
+        Entry entry = pq.top();
         pq.pop();
-        if(!kv.at(ver.v))
+        DIGRAPH_COUNT(heapPops, 1);
+
+        double& weight = weights.at(entry.vertex);
+
+        if (weight != weight || entry.weight > weight)
+        {
+            DIGRAPH_COUNT(stalePops, 1);
+            continue;
+        }
+
+        DIGRAPH_COUNT(verticesSettled, 1);
+
+        weight = std::numeric_limits<double>::quiet_NaN();
+        reached.push_back(DigraphReachedVertex{entry.vertex, entry.weight});
+
+        for (const DigraphEdge<EdgeInfo>& edge : table().at(entry.vertex)->edges)
         {
-            kv.at(ver.v) = 1;
-            std::vector<std::pair<int, int>> eg = edges(ver.v);
-            for(auto& e: eg)
+            if (isDangling(edge))
             {
-                EdgeInfo einf = edgeInfo(e.first, e.second);
-                double tot = dv[ver.v] + edgeWeightFunc(einf);
-                double& tidis = dv.at(e.second);
-                if(tidis > tot)
-                {
-                    tidis = tot;
-                    pv.at(e.second) = ver.v;
-                    pq.push(V{tot, e.second});
-                }
+                continue;
+            }
+
+            double total = entry.weight + edgeWeightFunc(edge.einfo);
+
+            DIGRAPH_COUNT(edgesRelaxed, 1);
+            DIGRAPH_COUNT(bytesTouched, sizeof(edge));
+
+            if (total > budget)
+            {
+                continue;
+            }
+
+            auto found = weights.emplace(edge.toVertex, total);
+
+            if (found.second || found.first->second > total)
+            {
+                DIGRAPH_COUNT(allocations, found.second ? 1 : 0);
+                found.first->second = total;
+                pq.push(Entry{total, edge.toVertex});
+                DIGRAPH_COUNT(heapPushes, 1);
             }
         }
     }
-    return pv;
+
+    return reached;
 }
 
 
 
 #endif // DIGRAPH_HPP
-
@@ -0,0 +1,139 @@
+// DigraphStats.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares DigraphStats, a set of counters describing the
+// work done by the searches and traversals in Digraph and CompactDigraph,
+// and the DIGRAPH_COUNT macro they use to update them.
+//
+// Counting is opt-in and costs nothing unless it's enabled: unless the
+// program is compiled with DIGRAPH_STATS defined (e.g., -DDIGRAPH_STATS),
+// DIGRAPH_COUNT expands to nothing, so the counters stay at zero and the
+// code that would update them isn't even compiled.
+//
+// Each thread counts into its own DigraphStats, so counting never makes
+// threads contend with one another.  When a thread ends, its counts are
+// added to a process-wide total; collectDigraphStats() returns that total
+// plus the calling thread's own counts, and resetDigraphStats() sets them
+// back to zero.
+
+#ifndef DIGRAPHSTATS_HPP
+#define DIGRAPHSTATS_HPP
+
+#include <cstdint>
+#include <mutex>
+
+
+
+struct DigraphStats
+{
+    // Vertices whose shortest path became known (or, in traversals that
+    // don't weigh edges, vertices visited).
+    std::uint64_t verticesSettled = 0;
+
+    // Edges examined from a settled or visited vertex.
+    std::uint64_t edgesRelaxed = 0;
+
+    // Priority queue operations, and the pops that found a vertex that
+    // was already settled (i.e., stale entries left by lazy deletion).
+    std::uint64_t heapPushes = 0;
+    std::uint64_t heapPops = 0;
+    std::uint64_t stalePops = 0;
+
+    // Per-vertex search state created (each a separate allocation in the
+    // map-based searches in Digraph, none in CompactDigraph's arrays).
+    std::uint64_t allocations = 0;
+
+    // An estimate of the bytes of graph and search state read, counting
+    // the size of each edge and label examined.
+    std::uint64_t bytesTouched = 0;
+
+    DigraphStats& operator+=(const DigraphStats& other)
+    {
+        verticesSettled += other.verticesSettled;
+        edgesRelaxed += other.edgesRelaxed;
+        heapPushes += other.heapPushes;
+        heapPops += other.heapPops;
+        stalePops += other.stalePops;
+        allocations += other.allocations;
+        bytesTouched += other.bytesTouched;
+        return *this;
+    }
+};
+
+
+
+namespace DigraphStatsDetail
+{
+    inline std::mutex& totalMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+
+    inline DigraphStats& total()
+    {
+        static DigraphStats stats;
+        return stats;
+    }
+
+
+    struct ThreadStats
+    {
+        DigraphStats stats;
+
+        ~ThreadStats()
+        {
+            std::lock_guard<std::mutex> lock{totalMutex()};
+            total() += stats;
+        }
+    };
+}
+
+
+
+// threadDigraphStats() returns the calling thread's counters.
+inline DigraphStats& threadDigraphStats()
+{
+    thread_local DigraphStatsDetail::ThreadStats threadStats;
+    return threadStats.stats;
+}
+
+
+// collectDigraphStats() returns the counts of every thread that has ended,
+// plus those of the calling thread.
+inline DigraphStats collectDigraphStats()
+{
+    DigraphStats result = threadDigraphStats();
+
+    std::lock_guard<std::mutex> lock{DigraphStatsDetail::totalMutex()};
+    result += DigraphStatsDetail::total();
+    return result;
+}
+
+
+// resetDigraphStats() sets the counts of every thread that has ended, and
+// those of the calling thread, back to zero.  Threads still running keep
+// their own counts, which are added to the total when they end.
+inline void resetDigraphStats()
+{
+    threadDigraphStats() = DigraphStats{};
+
+    std::lock_guard<std::mutex> lock{DigraphStatsDetail::totalMutex()};
+    DigraphStatsDetail::total() = DigraphStats{};
+}
+
+
+
+#ifdef DIGRAPH_STATS
+#define DIGRAPH_COUNT(counter, n) (threadDigraphStats().counter += (n))
+#else
+#define DIGRAPH_COUNT(counter, n) ((void)0)
+#endif
+
+
+
+#endif // DIGRAPHSTATS_HPP
+
@@ -0,0 +1,750 @@
+// HubLabels.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class template called HubLabels, which
+// answers questions about the weight of the shortest path between two
+// vertices of a CompactDigraph without searching the graph ("hub
+// labeling").  Each vertex is given two "labels": an out-label, listing
+// some of the vertices its shortest paths lead through (its "hubs") and
+// the weight of the path to each, and an in-label, listing hubs and the
+// weight of the path from each.  The labels are built so that, for any two
+// vertices, some vertex on a shortest path between them is in the first
+// one's out-label and the second one's in-label (a "2-hop cover"), so the
+// weight of that path is found by walking the two labels, which are sorted
+// by hub, side by side, like merging two sorted arrays.  That takes well
+// under a microsecond on a road network, whose labels are short.
+//
+// The labels are built by "pruned landmark labeling".  The vertices are
+// ranked from most to least important, and from each in turn, forward
+// and backward searches add it as a hub to the labels of the vertices they
+// reach, except that a search doesn't go past a vertex whose path is
+// already covered by the labels of more important hubs.  The earliest
+// searches cover most paths, so later ones stop almost at once.  The
+// vertices are ranked by how many shortest paths, from a sample of start
+// vertices, pass through them.
+//
+// Searches from the vertices of one batch run in parallel, each pruned
+// only by the labels of earlier batches, so they share nothing while they
+// run.  That makes the labels a little longer than building them one
+// search at a time, but they cover the same paths, so the answers are the
+// same.
+//
+// Along with each label entry is the edge by which the path to (or from)
+// its hub arrives at (or leaves) the vertex, so the paths themselves can
+// be found too, by following those edges back to the hub.  HubLabels
+// refers to its CompactDigraph, which must outlive it, only to do that.
+
+#ifndef HUBLABELS_HPP
+#define HUBLABELS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "CompactDigraph.hpp"
+#include "MemoryUsage.hpp"
+
+
+
+// A HubLabelPath is the result of HubLabels::findShortestPath(): whether
+// there is a path, its weight, and the edge indexes along it, in order.
+
+template <typename Distance>
+struct HubLabelPath
+{
+    bool reached;
+    Distance distance;
+    std::vector<int> edges;
+};
+
+
+
+template <typename Distance>
+class HubLabels
+{
+public:
+    // Builds the labels for the given graph, taking the weight of each
+    // edge from the given array (indexed by edge index, and not negative)
+    // and adding up path weights as Distance values, using the given
+    // number of threads (by default, one per hardware thread).
+    template <typename Weight>
+    HubLabels(
+        const CompactDigraph& graph, const Weight* weights,
+        unsigned int threads = std::thread::hardware_concurrency());
+
+    // distance() returns the weight of the shortest path from the vertex
+    // with the given start index to the one with the given end index, or
+    // std::numeric_limits<Distance>::max() if there is no path.
+    Distance distance(int startIndex, int endIndex) const;
+
+    // findShortestPath() finds the shortest path itself.
+    HubLabelPath<Distance> findShortestPath(int startIndex, int endIndex) const;
+
+    // entryCount() returns the total number of entries in every label.
+    std::size_t entryCount() const noexcept;
+
+    // memoryUsage() returns the memory allocated for the labels, all of
+    // which can be built again from the graph, so it counts as caches.
+    MemoryUsage memoryUsage() const noexcept;
+
+private:
+    // An Entry is one hub in a label.  Hubs are stored as their ranks, in
+    // increasing order.
+    struct Entry
+    {
+        int hub;
+        Distance distance;
+    };
+
+    // A Labels is one label for every vertex: the entries of the label of
+    // the vertex with index v are entries[offsets[v]] up to (but not
+    // including) entries[offsets[v + 1]], and edges[i] is the edge that
+    // goes with entries[i] (or -1 for a vertex's entry for itself).
+    struct Labels
+    {
+        std::vector<int> offsets;
+        std::vector<Entry> entries;
+        std::vector<int> edges;
+    };
+
+    // A Found is a vertex reached by one search from a hub, which is to
+    // get an entry for that hub.
+    struct Found
+    {
+        int vertex;
+        Distance distance;
+        int edge;
+    };
+
+    // A Scratch holds one thread's per-vertex arrays, which are reused
+    // from one search to the next.
+    struct Scratch
+    {
+        explicit Scratch(int vertexCount);
+
+        std::vector<Distance> distance;
+        std::vector<int> edge;
+        std::vector<int> visited;
+
+        // The distance to (or from) each hub in the searching hub's own
+        // label, indexed by hub rank.
+        std::vector<Distance> hubDistance;
+    };
+
+    // rankVertices() returns the vertex indexes from most important to
+    // least.
+    template <typename Weight>
+    static std::vector<int> rankVertices(
+        const CompactDigraph& graph, const Weight* weights, unsigned int threads);
+
+    // search() runs the pruned search from the vertex with the given rank,
+    // forward (along edges, adding to in-labels) or backward, pruned by
+    // the given labels built so far, and returns what it reached.
+    template <typename Weight>
+    std::vector<Found> search(
+        int rank, bool forward, const Weight* weights,
+        const std::vector<std::vector<Entry>>& sameLabels,
+        const std::vector<std::vector<Entry>>& otherLabels,
+        Scratch& scratch) const;
+
+    // flatten() stores labels built as separate vectors as a Labels.
+    static Labels flatten(
+        std::vector<std::vector<Entry>>& entries, std::vector<std::vector<int>>& edges);
+
+    // findEntry() returns the position in the given labels of the given
+    // vertex's entry for the hub with the given rank.
+    static std::size_t findEntry(const Labels& labels, int index, int hub);
+
+    const CompactDigraph* graph_;
+
+    // The vertex index of each rank, the source vertex of each edge, and
+    // the edges leading into each vertex (the edges into the vertex with
+    // index v are reverseEdges_[reverseOffsets_[v]] up to, but not
+    // including, reverseEdges_[reverseOffsets_[v + 1]]).
+    std::vector<int> vertexOfRank_;
+    std::vector<int> sources_;
+    std::vector<int> reverseOffsets_;
+    std::vector<int> reverseEdges_;
+
+    Labels out_;
+    Labels in_;
+};
+
+
+
+template <typename Distance>
+HubLabels<Distance>::Scratch::Scratch(int vertexCount)
+    : distance(vertexCount, std::numeric_limits<Distance>::max()),
+      edge(vertexCount, -1),
+      hubDistance(vertexCount, std::numeric_limits<Distance>::max())
+{
+}
+
+
+template <typename Distance>
+template <typename Weight>
+HubLabels<Distance>::HubLabels(
+    const CompactDigraph& graph, const Weight* weights, unsigned int threads)
+    : graph_{&graph}
+{
+    int n = graph.vertexCount();
+    threads = std::max(threads, 1u);
+
+    sources_.resize(graph.edgeCount());
+    reverseOffsets_.assign(n + 1, 0);
+
+    for (int v = 0; v < n; ++v)
+    {
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            sources_[e] = v;
+            ++reverseOffsets_[graph.target(e) + 1];
+        }
+    }
+
+    for (int v = 0; v < n; ++v)
+    {
+        reverseOffsets_[v + 1] += reverseOffsets_[v];
+    }
+
+    reverseEdges_.resize(graph.edgeCount());
+    std::vector<int> next{reverseOffsets_.begin(), reverseOffsets_.end() - 1};
+
+    for (int e = 0; e < graph.edgeCount(); ++e)
+    {
+        reverseEdges_[next[graph.target(e)]++] = e;
+    }
+
+    vertexOfRank_ = rankVertices(graph, weights, threads);
+
+    std::vector<std::vector<Entry>> outEntries(n), inEntries(n);
+    std::vector<std::vector<int>> outEdges(n), inEdges(n);
+    std::vector<Scratch> scratches(threads, Scratch{n});
+
+    // With one thread, each search is pruned by every search before it.
+    // With more, a batch gives each thread several searches to run.
+    const int batchSize = threads == 1 ? 1 : 4 * static_cast<int>(threads);
+    std::vector<std::vector<Found>> forward(batchSize), backward(batchSize);
+
+    // The workers wait for each batch to start, take its searches one at
+    // a time, and then wait for the next, so that threads aren't started
+    // for every batch.
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    int batchBegin = 0;
+    int batchEnd = 0;
+    std::atomic<int> nextSearch{0};
+    unsigned long long generation = 0;
+    unsigned int busy = 0;
+    bool done = false;
+
+    auto runSearches = [&](Scratch& scratch)
+    {
+        for (int i = nextSearch++; i < 2 * (batchEnd - batchBegin); i = nextSearch++)
+        {
+            int rank = batchBegin + i / 2;
+
+            if (i % 2 == 0)
+            {
+                forward[i / 2] = search(rank, true, weights, inEntries, outEntries, scratch);
+            }
+            else
+            {
+                backward[i / 2] = search(rank, false, weights, outEntries, inEntries, scratch);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int t = 1; t < threads; ++t)
+    {
+        workers.emplace_back(
+            [&, t]
+            {
+                unsigned long long seen = 0;
+                std::unique_lock<std::mutex> lock{mutex};
+
+                while (true)
+                {
+                    started.wait(lock, [&] { return done || generation != seen; });
+
+                    if (done)
+                    {
+                        return;
+                    }
+
+                    seen = generation;
+                    lock.unlock();
+                    runSearches(scratches[t]);
+                    lock.lock();
+
+                    if (--busy == 0)
+                    {
+                        finished.notify_one();
+                    }
+                }
+            });
+    }
+
+    for (batchBegin = 0; batchBegin < n; batchBegin = batchEnd)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            batchEnd = std::min(n, batchBegin + batchSize);
+            nextSearch = 0;
+            busy = threads - 1;
+            ++generation;
+        }
+
+        started.notify_all();
+        runSearches(scratches[0]);
+
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            finished.wait(lock, [&] { return busy == 0; });
+        }
+
+        // The batch's hubs are added in order of rank, which keeps every
+        // label sorted by hub.
+        for (int i = 0; i < batchEnd - batchBegin; ++i)
+        {
+            for (const Found& found : forward[i])
+            {
+                inEntries[found.vertex].push_back(Entry{batchBegin + i, found.distance});
+                inEdges[found.vertex].push_back(found.edge);
+            }
+
+            for (const Found& found : backward[i])
+            {
+                outEntries[found.vertex].push_back(Entry{batchBegin + i, found.distance});
+                outEdges[found.vertex].push_back(found.edge);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        done = true;
+    }
+
+    started.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    out_ = flatten(outEntries, outEdges);
+    in_ = flatten(inEntries, inEdges);
+}
+
+
+template <typename Distance>
+Distance HubLabels<Distance>::distance(int startIndex, int endIndex) const
+{
+    const Entry* out = out_.entries.data() + out_.offsets.at(startIndex);
+    const Entry* outEnd = out_.entries.data() + out_.offsets[startIndex + 1];
+    const Entry* in = in_.entries.data() + in_.offsets.at(endIndex);
+    const Entry* inEnd = in_.entries.data() + in_.offsets[endIndex + 1];
+
+    Distance best = std::numeric_limits<Distance>::max();
+
+    while (out != outEnd && in != inEnd)
+    {
+        if (out->hub < in->hub)
+        {
+            ++out;
+        }
+        else if (in->hub < out->hub)
+        {
+            ++in;
+        }
+        else
+        {
+            best = std::min<Distance>(best, out->distance + in->distance);
+            ++out;
+            ++in;
+        }
+    }
+
+    return best;
+}
+
+
+template <typename Distance>
+HubLabelPath<Distance> HubLabels<Distance>::findShortestPath(
+    int startIndex, int endIndex) const
+{
+    HubLabelPath<Distance> path{false, std::numeric_limits<Distance>::max(), {}};
+    int bestHub = -1;
+
+    std::size_t i = out_.offsets.at(startIndex);
+    std::size_t outEnd = out_.offsets[startIndex + 1];
+    std::size_t j = in_.offsets.at(endIndex);
+    std::size_t inEnd = in_.offsets[endIndex + 1];
+
+    while (i < outEnd && j < inEnd)
+    {
+        const Entry& out = out_.entries[i];
+        const Entry& in = in_.entries[j];
+
+        if (out.hub < in.hub)
+        {
+            ++i;
+        }
+        else if (in.hub < out.hub)
+        {
+            ++j;
+        }
+        else
+        {
+            if (out.distance + in.distance < path.distance)
+            {
+                path.distance = out.distance + in.distance;
+                bestHub = out.hub;
+            }
+
+            ++i;
+            ++j;
+        }
+    }
+
+    if (bestHub == -1)
+    {
+        return path;
+    }
+
+    path.reached = true;
+
+    // Every vertex on the path to a hub has an entry for it, since the
+    // search that added the hub only went on from vertices it labeled.
+    for (int v = startIndex;;)
+    {
+        int edge = out_.edges[findEntry(out_, v, bestHub)];
+
+        if (edge == -1)
+        {
+            break;
+        }
+
+        path.edges.push_back(edge);
+        v = graph_->target(edge);
+    }
+
+    std::vector<int> fromHub;
+
+    for (int v = endIndex;;)
+    {
+        int edge = in_.edges[findEntry(in_, v, bestHub)];
+
+        if (edge == -1)
+        {
+            break;
+        }
+
+        fromHub.push_back(edge);
+        v = sources_[edge];
+    }
+
+    path.edges.insert(path.edges.end(), fromHub.rbegin(), fromHub.rend());
+    return path;
+}
+
+
+template <typename Distance>
+std::size_t HubLabels<Distance>::entryCount() const noexcept
+{
+    return out_.entries.size() + in_.entries.size();
+}
+
+
+template <typename Distance>
+MemoryUsage HubLabels<Distance>::memoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.caches =
+        bytesAllocated(vertexOfRank_) + bytesAllocated(sources_)
+        + bytesAllocated(reverseOffsets_) + bytesAllocated(reverseEdges_);
+
+    for (const Labels* labels : {&out_, &in_})
+    {
+        usage.caches +=
+            bytesAllocated(labels->offsets) + bytesAllocated(labels->entries)
+            + bytesAllocated(labels->edges);
+    }
+
+    return usage;
+}
+
+
+template <typename Distance>
+template <typename Weight>
+std::vector<int> HubLabels<Distance>::rankVertices(
+    const CompactDigraph& graph, const Weight* weights, unsigned int threads)
+{
+    int n = graph.vertexCount();
+
+    // A vertex's score is the number of vertices below it in the shortest
+    // path trees grown from the sample vertices, i.e., the number of
+    // shortest paths from them that pass through it.
+    const int samples = std::min(n, 32);
+    std::vector<int> starts(samples);
+    std::mt19937 random{46};
+
+    for (int& start : starts)
+    {
+        start = std::uniform_int_distribution<int>{0, n - 1}(random);
+    }
+
+    std::vector<long long> score(n, 0);
+    std::mutex scoreMutex;
+    std::atomic<int> nextSample{0};
+
+    auto worker = [&]
+    {
+        std::vector<long long> below(n);
+
+        for (int s = nextSample++; s < samples; s = nextSample++)
+        {
+            CompactSearchResult<Distance> tree =
+                graph.findShortestPaths<Distance>(starts[s], weights);
+
+            std::vector<int> reached;
+
+            for (int v = 0; v < n; ++v)
+            {
+                if (tree.reached(v))
+                {
+                    reached.push_back(v);
+                    below[v] = 1;
+                }
+            }
+
+            // Vertices further from the start are added to the ones before
+            // them first.
+            std::sort(
+                reached.begin(), reached.end(),
+                [&tree](int v, int w) { return tree.distance[w] < tree.distance[v]; });
+
+            for (int v : reached)
+            {
+                if (tree.previousVertex[v] != -1)
+                {
+                    below[tree.previousVertex[v]] += below[v];
+                }
+            }
+
+            std::lock_guard<std::mutex> lock{scoreMutex};
+
+            for (int v : reached)
+            {
+                score[v] += below[v];
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int t = 1; t < std::min<unsigned int>(threads, samples); ++t)
+    {
+        workers.emplace_back(worker);
+    }
+
+    worker();
+
+    for (std::thread& t : workers)
+    {
+        t.join();
+    }
+
+    // Ties (including the vertices no sample reached) go to the vertex
+    // with more edges.
+    std::vector<int> order(n);
+
+    for (int v = 0; v < n; ++v)
+    {
+        order[v] = v;
+    }
+
+    auto degree = [&graph](int v) { return graph.edgeEnd(v) - graph.edgeBegin(v); };
+
+    std::sort(
+        order.begin(), order.end(),
+        [&](int v, int w)
+        {
+            if (score[v] != score[w])
+            {
+                return score[v] > score[w];
+            }
+            else if (degree(v) != degree(w))
+            {
+                return degree(v) > degree(w);
+            }
+            else
+            {
+                return v < w;
+            }
+        });
+
+    return order;
+}
+
+
+template <typename Distance>
+template <typename Weight>
+std::vector<typename HubLabels<Distance>::Found> HubLabels<Distance>::search(
+    int rank, bool forward, const Weight* weights,
+    const std::vector<std::vector<Entry>>& sameLabels,
+    const std::vector<std::vector<Entry>>& otherLabels,
+    Scratch& scratch) const
+{
+    const Distance unreached = std::numeric_limits<Distance>::max();
+    const CompactDigraph& graph = *graph_;
+    int hub = vertexOfRank_[rank];
+
+    // A forward search from the hub is pruned at any vertex w whose
+    // in-label and the hub's out-label already give a path at least as
+    // short (and a backward search the other way around).
+    const std::vector<Entry>& hubLabel = otherLabels[hub];
+
+    for (const Entry& entry : hubLabel)
+    {
+        scratch.hubDistance[entry.hub] = entry.distance;
+    }
+
+    typedef std::pair<Distance, int> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> pq;
+    std::vector<Found> found;
+
+    scratch.distance[hub] = 0;
+    scratch.edge[hub] = -1;
+    scratch.visited.push_back(hub);
+    pq.push(QueueEntry{0, hub});
+
+    while (!pq.empty())
+    {
+        auto [d, v] = pq.top();
+        pq.pop();
+
+        if (d > scratch.distance[v])
+        {
+            continue;
+        }
+
+        bool covered = false;
+
+        for (const Entry& entry : sameLabels[v])
+        {
+            Distance viaHub = scratch.hubDistance[entry.hub];
+
+            if (viaHub != unreached && viaHub + entry.distance <= d)
+            {
+                covered = true;
+                break;
+            }
+        }
+
+        if (covered)
+        {
+            continue;
+        }
+
+        found.push_back(Found{v, d, scratch.edge[v]});
+
+        int begin = forward ? graph.edgeBegin(v) : reverseOffsets_[v];
+        int end = forward ? graph.edgeEnd(v) : reverseOffsets_[v + 1];
+
+        for (int i = begin; i < end; ++i)
+        {
+            int e = forward ? i : reverseEdges_[i];
+            int w = forward ? graph.target(e) : sources_[e];
+            Distance weight = d + weights[e];
+
+            if (weight < scratch.distance[w])
+            {
+                if (scratch.distance[w] == unreached)
+                {
+                    scratch.visited.push_back(w);
+                }
+
+                scratch.distance[w] = weight;
+                scratch.edge[w] = e;
+                pq.push(QueueEntry{weight, w});
+            }
+        }
+    }
+
+    for (int v : scratch.visited)
+    {
+        scratch.distance[v] = unreached;
+        scratch.edge[v] = -1;
+    }
+
+    scratch.visited.clear();
+
+    for (const Entry& entry : hubLabel)
+    {
+        scratch.hubDistance[entry.hub] = unreached;
+    }
+
+    return found;
+}
+
+
+template <typename Distance>
+typename HubLabels<Distance>::Labels HubLabels<Distance>::flatten(
+    std::vector<std::vector<Entry>>& entries, std::vector<std::vector<int>>& edges)
+{
+    Labels labels;
+    labels.offsets.reserve(entries.size() + 1);
+    labels.offsets.push_back(0);
+
+    for (std::size_t v = 0; v < entries.size(); ++v)
+    {
+        labels.offsets.push_back(labels.offsets.back() + static_cast<int>(entries[v].size()));
+    }
+
+    labels.entries.reserve(labels.offsets.back());
+    labels.edges.reserve(labels.offsets.back());
+
+    // Each vertex's vectors are freed as soon as they're copied, so that
+    // the labels are never stored twice over.
+    for (std::size_t v = 0; v < entries.size(); ++v)
+    {
+        labels.entries.insert(labels.entries.end(), entries[v].begin(), entries[v].end());
+        labels.edges.insert(labels.edges.end(), edges[v].begin(), edges[v].end());
+        std::vector<Entry>{}.swap(entries[v]);
+        std::vector<int>{}.swap(edges[v]);
+    }
+
+    return labels;
+}
+
+
+template <typename Distance>
+std::size_t HubLabels<Distance>::findEntry(const Labels& labels, int index, int hub)
+{
+    auto begin = labels.entries.begin() + labels.offsets[index];
+    auto end = labels.entries.begin() + labels.offsets[index + 1];
+
+    auto found = std::lower_bound(
+        begin, end, hub, [](const Entry& entry, int h) { return entry.hub < h; });
+
+    return found - labels.entries.begin();
+}
+
+
+
+#endif // HUBLABELS_HPP
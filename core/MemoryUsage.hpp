@@ -0,0 +1,248 @@
+// MemoryUsage.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares MemoryUsage, which describes the heap memory a
+// graph (or a structure built from one) is using, in bytes, by category,
+// and the pieces used to measure it.
+//
+// The node-based containers in a Digraph (std::map, std::list, and so on)
+// allocate their nodes one at a time, in sizes that depend on the library,
+// so their memory can't be worked out from the number of elements without
+// guessing.  Instead, they allocate through a CountingAllocator, which
+// adds the size of every allocation it makes to a MemoryCounter (and
+// subtracts it again when it's freed).  Structures stored in std::vectors
+// report the capacity of each, which is exactly what was allocated for it.
+//
+// Memory that VertexInfo and EdgeInfo objects allocate for themselves
+// (e.g., the characters of a long std::string) can't be seen this way, so
+// it isn't counted; only their own size is.
+
+#ifndef MEMORYUSAGE_HPP
+#define MEMORYUSAGE_HPP
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+
+
+struct MemoryUsage
+{
+    // The table of vertices: the nodes of a map from vertex numbers to
+    // vertices, and the vertices themselves, not including their
+    // VertexInfo objects.
+    std::size_t vertexTable = 0;
+
+    // The edges, not including their EdgeInfo objects: list nodes, or
+    // arrays of offsets and targets.
+    std::size_t adjacency = 0;
+
+    // The EdgeInfo objects, or the arrays holding their contents.
+    std::size_t edgeInfo = 0;
+
+    // The VertexInfo objects, and anything they refer to that's stored
+    // separately (e.g., a table of names).
+    std::size_t vertexInfo = 0;
+
+    // Anything kept only to find things more quickly, such as a mapping
+    // from names or vertex numbers to vertices.
+    std::size_t indexes = 0;
+
+    // Anything that could be recomputed from the rest, such as the
+    // results of preprocessing.
+    std::size_t caches = 0;
+
+    std::size_t total() const noexcept
+    {
+        return vertexTable + adjacency + edgeInfo + vertexInfo + indexes + caches;
+    }
+
+    MemoryUsage& operator+=(const MemoryUsage& other) noexcept
+    {
+        vertexTable += other.vertexTable;
+        adjacency += other.adjacency;
+        edgeInfo += other.edgeInfo;
+        vertexInfo += other.vertexInfo;
+        indexes += other.indexes;
+        caches += other.caches;
+        return *this;
+    }
+};
+
+
+
+// A MemoryCounter keeps track of the bytes, and the number of separate
+// allocations, made through the CountingAllocators that refer to it and
+// not yet freed.  It can be updated from any number of threads at once.
+
+class MemoryCounter
+{
+public:
+    MemoryCounter() noexcept;
+
+    MemoryCounter(const MemoryCounter&) = delete;
+    MemoryCounter& operator=(const MemoryCounter&) = delete;
+
+    void allocated(std::size_t bytes) noexcept;
+    void freed(std::size_t bytes) noexcept;
+
+    std::size_t bytes() const noexcept;
+    std::size_t allocations() const noexcept;
+
+private:
+    std::atomic<std::size_t> bytes_;
+    std::atomic<std::size_t> allocations_;
+};
+
+
+
+// A CountingAllocator allocates memory as std::allocator does, counting
+// it in a MemoryCounter, which must outlive everything allocated through
+// it.  A CountingAllocator with no counter (as a default-constructed one
+// has) counts nothing.  Containers copied from one another share the same
+// counter.
+
+template <typename T>
+class CountingAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    CountingAllocator(MemoryCounter* counter = nullptr) noexcept;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept;
+
+    T* allocate(std::size_t n);
+    void deallocate(T* p, std::size_t n) noexcept;
+
+    MemoryCounter* counter() const noexcept;
+
+private:
+    MemoryCounter* counter_;
+};
+
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T>& a, const CountingAllocator<U>& b) noexcept
+{
+    return a.counter() == b.counter();
+}
+
+
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T>& a, const CountingAllocator<U>& b) noexcept
+{
+    return !(a == b);
+}
+
+
+
+// bytesAllocated() returns the number of bytes a std::vector has
+// allocated, which depends on its capacity rather than its size.
+
+template <typename T>
+std::size_t bytesAllocated(const std::vector<T>& v) noexcept
+{
+    return v.capacity() * sizeof(T);
+}
+
+
+inline std::size_t bytesAllocated(const std::vector<bool>& v) noexcept
+{
+    return (v.capacity() + CHAR_BIT - 1) / CHAR_BIT;
+}
+
+
+
+inline MemoryCounter::MemoryCounter() noexcept
+    : bytes_{0}, allocations_{0}
+{
+}
+
+
+inline void MemoryCounter::allocated(std::size_t bytes) noexcept
+{
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+inline void MemoryCounter::freed(std::size_t bytes) noexcept
+{
+    bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+    allocations_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+
+inline std::size_t MemoryCounter::bytes() const noexcept
+{
+    return bytes_.load(std::memory_order_relaxed);
+}
+
+
+inline std::size_t MemoryCounter::allocations() const noexcept
+{
+    return allocations_.load(std::memory_order_relaxed);
+}
+
+
+
+template <typename T>
+CountingAllocator<T>::CountingAllocator(MemoryCounter* counter) noexcept
+    : counter_{counter}
+{
+}
+
+
+template <typename T>
+template <typename U>
+CountingAllocator<T>::CountingAllocator(const CountingAllocator<U>& other) noexcept
+    : counter_{other.counter()}
+{
+}
+
+
+template <typename T>
+T* CountingAllocator<T>::allocate(std::size_t n)
+{
+    T* p = std::allocator<T>{}.allocate(n);
+
+    if (counter_ != nullptr)
+    {
+        counter_->allocated(n * sizeof(T));
+    }
+
+    return p;
+}
+
+
+template <typename T>
+void CountingAllocator<T>::deallocate(T* p, std::size_t n) noexcept
+{
+    if (counter_ != nullptr)
+    {
+        counter_->freed(n * sizeof(T));
+    }
+
+    std::allocator<T>{}.deallocate(p, n);
+}
+
+
+template <typename T>
+MemoryCounter* CountingAllocator<T>::counter() const noexcept
+{
+    return counter_;
+}
+
+
+
+#endif // MEMORYUSAGE_HPP
@@ -0,0 +1,389 @@
+// NumaTopology.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class called NumaTopology, which describes
+// how a machine's processors are divided into NUMA nodes (each with its
+// own memory, which the others can reach only more slowly), and a class
+// template called NumaReplicas, which keeps a copy of a read-only
+// structure in each node's memory.
+//
+// On Linux, the nodes are found in /sys/devices/system/node, where each
+// node's directory has a "cpulist" file listing its processors (e.g.,
+// "0-7,16-23").  Nodes with no processors (memory only) are left out,
+// since no thread can run on them.  Where that information isn't
+// available, the whole machine is treated as a single node, on which
+// threads are never pinned and there is only ever one replica.
+//
+// Memory is placed on the node of the thread that first writes to it, so
+// a replica is built by a thread pinned to its node, and the replicas
+// need nothing more than pinning to end up where they belong.
+
+#ifndef NUMATOPOLOGY_HPP
+#define NUMATOPOLOGY_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+
+class NumaTopology
+{
+public:
+    // The default constructor initializes a NumaTopology with a single
+    // node holding every hardware thread.
+    NumaTopology();
+
+    // Initializes a NumaTopology with the given processors (by number) in
+    // each node.  If no node has any processors, it is treated as a single
+    // node, as with the default constructor.
+    explicit NumaTopology(std::vector<std::vector<int>> cpusOfNodes);
+
+    // detect() reads the topology from the given directory, in the format
+    // of /sys/devices/system/node, or returns a single node if it can't.
+    static NumaTopology detect(const std::string& path = "/sys/devices/system/node");
+
+    // nodeCount() returns the number of nodes.
+    int nodeCount() const noexcept;
+
+    // cpusOf() returns the processors in the given node.
+    const std::vector<int>& cpusOf(int node) const;
+
+    // nodeOf() returns the node of the given processor, or 0 if it isn't
+    // in any of them.
+    int nodeOf(int cpu) const noexcept;
+
+    // currentNode() returns the node of the processor that the calling
+    // thread is running on.  Unless the thread is pinned, it can change at
+    // any time, but every node's memory is still reachable from anywhere.
+    int currentNode() const noexcept;
+
+    // pinCurrentThread() restricts the calling thread to the processors of
+    // the given node, returning false if it couldn't be (or, with a single
+    // node, didn't need to be).
+    bool pinCurrentThread(int node) const;
+
+    // parseCpuList() parses a list of processors in the format of the
+    // "cpulist" files, which is a comma-separated list of processor
+    // numbers and ranges, such as "0-3,8,10-11".
+    static std::vector<int> parseCpuList(const std::string& list);
+
+private:
+    std::vector<std::vector<int>> cpusOfNodes_;
+    std::vector<int> nodeOfCpus_;
+};
+
+
+
+// A NumaReplicas<T> holds one replica of a T for each node of a
+// NumaTopology, each built on (and so stored in the memory of) its node.
+// Replicas are only ever read, so any thread can use any of them, but
+// each thread should use the one for its own node, which local() finds.
+
+template <typename T>
+class NumaReplicas
+{
+public:
+    // Builds a replica for each node of the given topology, which must
+    // outlive the NumaReplicas, by calling the given function, which
+    // returns a std::unique_ptr<T>, on a thread pinned to that node.  The
+    // first replica is built before the rest, so that anything building it
+    // saves (e.g., an artifact file) is there for the others, which are
+    // built at the same time.  If topology is null, a single replica is
+    // built on the calling thread.  If building any replica throws an
+    // exception, it is rethrown once they have all finished.
+    template <typename Build>
+    NumaReplicas(const NumaTopology* topology, Build build);
+
+    // replicaCount() returns the number of replicas, which is the number
+    // of nodes.
+    int replicaCount() const noexcept;
+
+    // replica() returns the replica on the given node, and local() the one
+    // on the node the calling thread is running on.
+    const T& replica(int node) const;
+    const T& local() const noexcept;
+
+private:
+    const NumaTopology* topology_;
+    std::vector<std::unique_ptr<const T>> replicas_;
+};
+
+
+
+inline NumaTopology::NumaTopology()
+    : NumaTopology{std::vector<std::vector<int>>{}}
+{
+}
+
+
+inline NumaTopology::NumaTopology(std::vector<std::vector<int>> cpusOfNodes)
+{
+    for (std::vector<int>& cpus : cpusOfNodes)
+    {
+        if (!cpus.empty())
+        {
+            std::sort(cpus.begin(), cpus.end());
+            cpusOfNodes_.push_back(std::move(cpus));
+        }
+    }
+
+    if (cpusOfNodes_.empty())
+    {
+        std::vector<int> cpus;
+
+        for (unsigned int cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+
+        cpusOfNodes_.push_back(std::move(cpus));
+    }
+
+    for (int node = 0; node < nodeCount(); ++node)
+    {
+        int last = cpusOfNodes_[node].back();
+
+        if (static_cast<int>(nodeOfCpus_.size()) <= last)
+        {
+            nodeOfCpus_.resize(last + 1, 0);
+        }
+
+        for (int cpu : cpusOfNodes_[node])
+        {
+            nodeOfCpus_[cpu] = node;
+        }
+    }
+}
+
+
+inline NumaTopology NumaTopology::detect(const std::string& path)
+{
+    std::vector<std::pair<int, std::vector<int>>> nodes;
+
+    try
+    {
+        for (const auto& entry : std::filesystem::directory_iterator{path})
+        {
+            std::string name = entry.path().filename().string();
+
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0
+                || !std::all_of(
+                       name.begin() + 4, name.end(),
+                       [](unsigned char c) { return std::isdigit(c) != 0; }))
+            {
+                continue;
+            }
+
+            std::ifstream cpulist{entry.path() / "cpulist"};
+            std::string list;
+
+            if (std::getline(cpulist, list))
+            {
+                nodes.emplace_back(std::stoi(name.substr(4)), parseCpuList(list));
+            }
+        }
+    }
+    catch (std::exception&)
+    {
+        // Whatever went wrong, the machine is treated as a single node.
+        return NumaTopology{};
+    }
+
+    std::sort(nodes.begin(), nodes.end());
+
+    std::vector<std::vector<int>> cpusOfNodes;
+
+    for (auto& node : nodes)
+    {
+        cpusOfNodes.push_back(std::move(node.second));
+    }
+
+    return NumaTopology{std::move(cpusOfNodes)};
+}
+
+
+inline int NumaTopology::nodeCount() const noexcept
+{
+    return static_cast<int>(cpusOfNodes_.size());
+}
+
+
+inline const std::vector<int>& NumaTopology::cpusOf(int node) const
+{
+    return cpusOfNodes_.at(node);
+}
+
+
+inline int NumaTopology::nodeOf(int cpu) const noexcept
+{
+    return cpu >= 0 && cpu < static_cast<int>(nodeOfCpus_.size()) ? nodeOfCpus_[cpu] : 0;
+}
+
+
+inline int NumaTopology::currentNode() const noexcept
+{
+#ifdef __linux__
+    if (nodeCount() > 1)
+    {
+        return nodeOf(sched_getcpu());
+    }
+#endif
+
+    return 0;
+}
+
+
+inline bool NumaTopology::pinCurrentThread(int node) const
+{
+#ifdef __linux__
+    if (nodeCount() > 1)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+
+        for (int cpu : cpusOf(node))
+        {
+            if (cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+    }
+#endif
+
+    return false;
+}
+
+
+inline std::vector<int> NumaTopology::parseCpuList(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::size_t position = 0;
+
+    while (position < list.size())
+    {
+        std::size_t end = list.find(',', position);
+
+        if (end == std::string::npos)
+        {
+            end = list.size();
+        }
+
+        std::string range = list.substr(position, end - position);
+        std::size_t dash = range.find('-');
+
+        if (range.find_first_of("0123456789") != std::string::npos)
+        {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+
+            for (int cpu = first; cpu <= last; ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+
+        position = end + 1;
+    }
+
+    return cpus;
+}
+
+
+
+template <typename T>
+template <typename Build>
+NumaReplicas<T>::NumaReplicas(const NumaTopology* topology, Build build)
+    : topology_{topology}
+{
+    if (topology_ == nullptr || topology_->nodeCount() == 1)
+    {
+        replicas_.push_back(build());
+        return;
+    }
+
+    replicas_.resize(topology_->nodeCount());
+    std::vector<std::exception_ptr> errors(replicas_.size());
+
+    auto buildOn = [&](int node)
+    {
+        try
+        {
+            topology_->pinCurrentThread(node);
+            replicas_[node] = build();
+        }
+        catch (...)
+        {
+            errors[node] = std::current_exception();
+        }
+    };
+
+    std::thread{buildOn, 0}.join();
+
+    std::vector<std::thread> builders;
+
+    for (int node = 1; node < topology_->nodeCount() && !errors[0]; ++node)
+    {
+        builders.emplace_back(buildOn, node);
+    }
+
+    for (std::thread& builder : builders)
+    {
+        builder.join();
+    }
+
+    for (std::exception_ptr& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+
+template <typename T>
+int NumaReplicas<T>::replicaCount() const noexcept
+{
+    return static_cast<int>(replicas_.size());
+}
+
+
+template <typename T>
+const T& NumaReplicas<T>::replica(int node) const
+{
+    return *replicas_.at(node);
+}
+
+
+template <typename T>
+const T& NumaReplicas<T>::local() const noexcept
+{
+    if (replicas_.size() == 1)
+    {
+        return *replicas_.front();
+    }
+
+    return *replicas_[topology_->currentNode()];
+}
+
+
+
+#endif // NUMATOPOLOGY_HPP
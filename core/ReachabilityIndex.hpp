@@ -0,0 +1,426 @@
+// ReachabilityIndex.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class called ReachabilityIndex, which
+// answers whether one vertex of a graph can be reached from another
+// without searching the graph for a path.
+//
+// Every vertex can reach every other in its own strongly connected
+// component, and in a road network nearly every vertex is in the same
+// one, so most questions are answered by comparing two component numbers.
+// The rest are answered using the "condensation" of the graph: the graph
+// whose vertices are the components, with an edge from one component to
+// another wherever an edge of the graph leads from the first to the
+// second.  It has no cycles, so each component can be given an interval
+// by a depth-first search of it: the last component the search finished
+// below it (its "low"), up to itself (its "post-order number").  Any
+// component reachable from another is finished below it, so its interval
+// is contained in the other's; if it isn't, there is no path.  A few
+// searches, taking each component's edges in different orders, rule out
+// nearly every path that doesn't exist ("GRAIL" labeling).  When every
+// interval contains the other, a search of the condensation settles it,
+// going only into components whose intervals still contain the end's.
+//
+// Built from a Digraph, a ReachabilityIndex keeps the Digraph's version,
+// and is only valid while the Digraph still has that version; any change
+// to the Digraph's vertices or edges makes it stale.
+
+#ifndef REACHABILITYINDEX_HPP
+#define REACHABILITYINDEX_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "CompactDigraph.hpp"
+#include "Digraph.hpp"
+#include "MemoryUsage.hpp"
+#include "StronglyConnectedComponents.hpp"
+
+
+
+class ReachabilityIndex
+{
+public:
+    // Builds the index for the given graph, finding its components with
+    // the given number of threads (by default, one per hardware thread).
+    explicit ReachabilityIndex(
+        const CompactDigraph& graph,
+        unsigned int threads = std::thread::hardware_concurrency());
+
+    // Builds the index for the given Digraph, which is valid until the
+    // Digraph is next changed.
+    template <typename VertexInfo, typename EdgeInfo>
+    explicit ReachabilityIndex(
+        const Digraph<VertexInfo, EdgeInfo>& digraph,
+        unsigned int threads = std::thread::hardware_concurrency());
+
+    // isCurrent() returns true if the index was built from the given
+    // Digraph (or a copy of it) and it hasn't been changed since.  An
+    // index built from a CompactDigraph is never current for a Digraph.
+    template <typename VertexInfo, typename EdgeInfo>
+    bool isCurrent(const Digraph<VertexInfo, EdgeInfo>& digraph) const noexcept;
+
+    // reachable() returns true if there is a path from the vertex with
+    // the first given vertex number to the one with the second (which
+    // there always is from a vertex to itself).  If either vertex does
+    // not exist, a DigraphException is thrown.
+    bool reachable(int fromVertex, int toVertex) const;
+
+    // componentCount() returns the number of strongly connected
+    // components, i.e., the number of vertices in the condensation.
+    int componentCount() const noexcept;
+
+    // memoryUsage() returns the memory allocated for the index, all of
+    // which counts as indexes.
+    MemoryUsage memoryUsage() const noexcept;
+
+private:
+    // The number of depth-first searches that label the condensation.
+    static constexpr int traversals = 3;
+
+    // An Interval is the label one search gives one component.
+    struct Interval
+    {
+        int low;
+        int post;
+    };
+
+    // label() labels the condensation, using the given random number
+    // generator to choose the order in which components' edges are taken.
+    void label(int traversal, std::mt19937& random);
+
+    // contains() returns true if every interval of the first component
+    // contains the corresponding interval of the second.
+    bool contains(int outer, int inner) const noexcept;
+
+    // componentOfVertex() returns the component of the vertex with the
+    // given vertex number.
+    int componentOfVertex(int vertex) const;
+
+    // A SearchScratch holds the arrays that reachable() searches the
+    // condensation with.  A component has been visited by the current
+    // search if its stamp is the current one, so a new search only has
+    // to change the current stamp rather than clear every component's.
+    struct SearchScratch
+    {
+        std::vector<std::uint32_t> stamps;
+        std::uint32_t current = 0;
+        std::vector<int> stack;
+    };
+
+    // scratchSearch() returns a SearchScratch belonging to the calling
+    // thread, sized for this index's condensation and ready for a new
+    // search, so that searching allocates nothing unless the thread last
+    // searched an index with a different number of components.
+    SearchScratch& scratchSearch() const;
+
+    // The component of each vertex, as (vertex number, component) pairs
+    // sorted by vertex number.
+    std::vector<std::pair<int, int>> components_;
+
+    // The edges of the condensation: the components that component c has
+    // edges to are edges_[offsets_[c]] up to (but not including)
+    // edges_[offsets_[c + 1]].
+    std::vector<int> offsets_;
+    std::vector<int> edges_;
+
+    // The intervals of component c are intervals_[c * traversals] up to
+    // (but not including) intervals_[(c + 1) * traversals].
+    std::vector<Interval> intervals_;
+
+    bool hasVersion_;
+    std::uint64_t version_;
+};
+
+
+
+inline ReachabilityIndex::ReachabilityIndex(const CompactDigraph& graph, unsigned int threads)
+    : hasVersion_{false}, version_{0}
+{
+    StronglyConnectedComponents components{graph, threads};
+    int count = components.componentCount();
+
+    components_.reserve(graph.vertexCount());
+
+    for (int v = 0; v < graph.vertexCount(); ++v)
+    {
+        components_.emplace_back(graph.vertexNumber(v), components.componentOf(v));
+    }
+
+    std::sort(components_.begin(), components_.end());
+
+    // Edges within a component, and repeated edges between the same two
+    // components, are left out of the condensation.
+    std::vector<std::pair<int, int>> condensed;
+
+    for (int v = 0; v < graph.vertexCount(); ++v)
+    {
+        int from = components.componentOf(v);
+
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            int to = components.componentOf(graph.target(e));
+
+            if (from != to)
+            {
+                condensed.emplace_back(from, to);
+            }
+        }
+    }
+
+    std::sort(condensed.begin(), condensed.end());
+    condensed.erase(std::unique(condensed.begin(), condensed.end()), condensed.end());
+
+    offsets_.assign(count + 1, 0);
+    edges_.reserve(condensed.size());
+
+    for (const auto& edge : condensed)
+    {
+        ++offsets_[edge.first + 1];
+        edges_.push_back(edge.second);
+    }
+
+    for (int c = 0; c < count; ++c)
+    {
+        offsets_[c + 1] += offsets_[c];
+    }
+
+    intervals_.resize(static_cast<std::size_t>(count) * traversals);
+    std::mt19937 random{46};
+
+    for (int traversal = 0; traversal < traversals; ++traversal)
+    {
+        label(traversal, random);
+    }
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+ReachabilityIndex::ReachabilityIndex(
+    const Digraph<VertexInfo, EdgeInfo>& digraph, unsigned int threads)
+    : ReachabilityIndex{CompactDigraph{digraph, [](int, const EdgeInfo&) { }}, threads}
+{
+    hasVersion_ = true;
+    version_ = digraph.version();
+}
+
+
+template <typename VertexInfo, typename EdgeInfo>
+bool ReachabilityIndex::isCurrent(const Digraph<VertexInfo, EdgeInfo>& digraph) const noexcept
+{
+    return hasVersion_ && digraph.version() == version_;
+}
+
+
+inline bool ReachabilityIndex::reachable(int fromVertex, int toVertex) const
+{
+    int from = componentOfVertex(fromVertex);
+    int to = componentOfVertex(toVertex);
+
+    if (from == to)
+    {
+        return true;
+    }
+    else if (!contains(from, to))
+    {
+        return false;
+    }
+
+    // Only components whose intervals contain the end's can lead to it,
+    // so the search goes no further than those.
+    SearchScratch& search = scratchSearch();
+    std::vector<std::uint32_t>& stamps = search.stamps;
+    std::vector<int>& stack = search.stack;
+    std::uint32_t current = search.current;
+
+    stack.clear();
+    stack.push_back(from);
+    stamps[from] = current;
+
+    while (!stack.empty())
+    {
+        int c = stack.back();
+        stack.pop_back();
+
+        for (int i = offsets_[c]; i < offsets_[c + 1]; ++i)
+        {
+            int next = edges_[i];
+
+            if (next == to)
+            {
+                return true;
+            }
+            else if (stamps[next] != current && contains(next, to))
+            {
+                stamps[next] = current;
+                stack.push_back(next);
+            }
+        }
+    }
+
+    return false;
+}
+
+
+inline int ReachabilityIndex::componentCount() const noexcept
+{
+    return static_cast<int>(offsets_.size()) - 1;
+}
+
+
+inline MemoryUsage ReachabilityIndex::memoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.indexes =
+        bytesAllocated(components_) + bytesAllocated(offsets_)
+        + bytesAllocated(edges_) + bytesAllocated(intervals_);
+    return usage;
+}
+
+
+inline void ReachabilityIndex::label(int traversal, std::mt19937& random)
+{
+    int count = componentCount();
+
+    // The searches start from the components with no edges into them, in
+    // a different order each time, and take each component's edges
+    // starting from a different one each time.
+    std::vector<bool> hasEdgesIn(count, false);
+
+    for (int next : edges_)
+    {
+        hasEdgesIn[next] = true;
+    }
+
+    std::vector<int> roots;
+
+    for (int c = 0; c < count; ++c)
+    {
+        if (!hasEdgesIn[c])
+        {
+            roots.push_back(c);
+        }
+    }
+
+    std::shuffle(roots.begin(), roots.end(), random);
+
+    std::vector<int> firstEdge(count, 0);
+
+    for (int c = 0; c < count; ++c)
+    {
+        int degree = offsets_[c + 1] - offsets_[c];
+
+        if (degree > 1)
+        {
+            firstEdge[c] = std::uniform_int_distribution<int>{0, degree - 1}(random);
+        }
+    }
+
+    std::vector<bool> visited(count, false);
+    std::vector<std::pair<int, int>> stack;
+    int post = 0;
+
+    for (int root : roots)
+    {
+        visited[root] = true;
+        stack.emplace_back(root, 0);
+
+        while (!stack.empty())
+        {
+            auto& [c, taken] = stack.back();
+            int degree = offsets_[c + 1] - offsets_[c];
+
+            if (taken < degree)
+            {
+                int next = edges_[offsets_[c] + (firstEdge[c] + taken) % degree];
+                ++taken;
+
+                if (!visited[next])
+                {
+                    visited[next] = true;
+                    stack.emplace_back(next, 0);
+                }
+
+                continue;
+            }
+
+            // There are no cycles, so every component below this one has
+            // already been finished.
+            Interval interval{post, post};
+
+            for (int i = offsets_[c]; i < offsets_[c + 1]; ++i)
+            {
+                interval.low = std::min(
+                    interval.low, intervals_[edges_[i] * traversals + traversal].low);
+            }
+
+            intervals_[c * traversals + traversal] = interval;
+            ++post;
+            stack.pop_back();
+        }
+    }
+}
+
+
+inline bool ReachabilityIndex::contains(int outer, int inner) const noexcept
+{
+    const Interval* o = &intervals_[outer * traversals];
+    const Interval* i = &intervals_[inner * traversals];
+
+    for (int t = 0; t < traversals; ++t)
+    {
+        if (i[t].low < o[t].low || i[t].post > o[t].post)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+inline int ReachabilityIndex::componentOfVertex(int vertex) const
+{
+    auto found = std::lower_bound(
+        components_.begin(), components_.end(), std::make_pair(vertex, 0));
+
+    if (found == components_.end() || found->first != vertex)
+    {
+        throw DigraphException("Vertex does not exist!\n");
+    }
+
+    return found->second;
+}
+
+
+inline ReachabilityIndex::SearchScratch& ReachabilityIndex::scratchSearch() const
+{
+    thread_local SearchScratch search;
+
+    std::size_t count = componentCount();
+
+    // The arrays are sized for this index alone, rather than for the
+    // largest index the thread has ever searched.  When the stamp wraps
+    // around, every component's is cleared, so that none is left equal
+    // to a later search's.
+    if (search.stamps.size() != count || search.current == std::numeric_limits<std::uint32_t>::max())
+    {
+        std::vector<std::uint32_t>(count, 0).swap(search.stamps);
+        std::vector<int>{}.swap(search.stack);
+        search.current = 0;
+    }
+
+    ++search.current;
+    return search;
+}
+
+
+
+#endif // REACHABILITYINDEX_HPP
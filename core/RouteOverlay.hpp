@@ -0,0 +1,877 @@
+// RouteOverlay.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class called RouteOverlay, which speeds up
+// shortest path searches of a CompactDigraph in a way that doesn't depend
+// on the edge weights ("customizable route planning").  The work is split
+// into three phases:
+//
+// * Building a RouteOverlay partitions the vertices into "cells" of
+//   connected vertices, at several levels, each cell at one level being
+//   made up of whole cells of the level below.  This depends only on the
+//   structure of the graph, so it is done once.
+//
+// * customize() takes a set of edge weights and, for every cell at every
+//   level, works out the weight of the shortest path within the cell from
+//   each vertex where an edge enters the cell to each vertex where an
+//   edge leaves it.  The result is an OverlayMetric.  Each cell only
+//   depends on the cells within it, so the cells of each level are
+//   customized in parallel, and a new set of weights can be applied far
+//   more quickly than building the RouteOverlay again.
+//
+// * findShortestPath() runs Dijkstra's algorithm that, away from the
+//   start and end vertices, crosses whole cells in a single step using
+//   the paths found by customize(), so it visits only a small fraction of
+//   the vertices a plain search would.
+//
+// A RouteOverlay refers to the CompactDigraph it was built from, which
+// must outlive it.  Since the paths through cells are added up separately
+// from the paths that use them, a path found by findShortestPath() has the
+// same weight as a shortest path, but where two paths are (almost
+// exactly) tied, it can be a different one than a plain search finds.
+
+#ifndef ROUTEOVERLAY_HPP
+#define ROUTEOVERLAY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "CompactDigraph.hpp"
+#include "DigraphStats.hpp"
+#include "MemoryUsage.hpp"
+
+
+
+// An OverlayMetric is the result of customizing a RouteOverlay with one
+// set of edge weights.  It can only be used with the RouteOverlay that
+// made it.
+
+struct OverlayMetric
+{
+    // The edge weights, indexed by edge index.
+    std::vector<double> weights;
+
+    // For each level, the weights of the paths through every cell of that
+    // level, stored as described in RouteOverlay::Cell.  Cells with no
+    // path between a pair of vertices store infinity.
+    std::vector<std::vector<double>> cellWeights;
+};
+
+
+
+// An OverlayPath is the result of RouteOverlay::findShortestPath(): the
+// weight of the path and the edge indexes along it, in order.  If there
+// is no path, reached is false.
+
+struct OverlayPath
+{
+    bool reached;
+    double weight;
+    std::vector<int> edges;
+};
+
+
+
+class RouteOverlay
+{
+public:
+    // Builds a RouteOverlay for the given graph.  cellSizes gives the
+    // largest number of vertices in a cell at each level, from the lowest
+    // level up, and should be increasing.
+    explicit RouteOverlay(
+        const CompactDigraph& graph,
+        const std::vector<int>& cellSizes = std::vector<int>{256, 4096});
+
+    // Builds a RouteOverlay for the given graph with the given partition,
+    // as returned by partition() (e.g., of a RouteOverlay built earlier
+    // and saved).  If it isn't a nested partition of the graph's vertices,
+    // a DigraphException is thrown.
+    RouteOverlay(
+        const CompactDigraph& graph, const std::vector<std::vector<int>>& partition);
+
+    // levelCount() returns the number of levels, and cellCount() returns
+    // the number of cells at the given level.
+    int levelCount() const noexcept;
+    int cellCount(int level) const;
+
+    // cellOf() returns the cell at the given level containing the vertex
+    // with the given index.
+    int cellOf(int level, int index) const;
+
+    // partition() returns the cell containing each vertex at the given
+    // level, indexed by vertex index.
+    const std::vector<int>& partition(int level) const;
+
+    // weightCount() returns the number of path weights an OverlayMetric
+    // stores for the given level.
+    int weightCount(int level) const;
+
+    // memoryUsage() returns the memory allocated for the partition, which
+    // could be built again from the graph, so it counts as caches.  The
+    // OverlayMetrics it makes are separate, as is each thread's scratch
+    // space for searching.
+    MemoryUsage memoryUsage() const noexcept;
+
+    // This overload returns the memory allocated for an OverlayMetric.
+    static MemoryUsage memoryUsage(const OverlayMetric& metric) noexcept;
+
+    // customize() works out the paths through every cell given the weight
+    // of each edge, indexed by edge index, which must not be negative.
+    // The cells of each level are divided among the given number of
+    // threads (by default, one per hardware thread).
+    OverlayMetric customize(
+        std::vector<double> weights,
+        unsigned int threads = std::thread::hardware_concurrency()) const;
+
+    // findShortestPath() finds a shortest path between the vertices with
+    // the given indexes, using the weights in the given OverlayMetric.
+    OverlayPath findShortestPath(
+        const OverlayMetric& metric, int startIndex, int endIndex) const;
+
+private:
+    // A Cell describes one cell at one level.  Its "entries" are the
+    // vertices in the cell with an edge coming in from outside it, and its
+    // "exits" those with an edge going out of it.  The weight of the path
+    // within the cell from entries[i] to exits[j] is stored in the level's
+    // weights at weightOffset + i * exits.size() + j.
+    struct Cell
+    {
+        std::vector<int> entries;
+        std::vector<int> exits;
+        int weightOffset;
+    };
+
+    // A Level is one level of the partition.
+    struct Level
+    {
+        // The cell containing each vertex, indexed by vertex index.
+        std::vector<int> cellOf;
+
+        // The position of each vertex in its cell's entries or exits, or
+        // -1 if it is not one.
+        std::vector<int> entryPosition;
+        std::vector<int> exitPosition;
+
+        std::vector<Cell> cells;
+        int weightCount;
+    };
+
+    // A LocalSearch holds the per-vertex arrays of a search, which are
+    // reused from one search to the next, so that each search costs time
+    // in proportion to the part of the graph it visits rather than the
+    // size of the whole graph.  Each vertex's previousEdge is the edge by
+    // which it was reached or, if the search crossed a cell at some level
+    // to reach it, -1 - that level.
+    struct LocalSearch
+    {
+        explicit LocalSearch(int vertexCount);
+
+        void reset();
+        bool improve(int v, double weight, int previousVertex, int previousEdge);
+
+        std::vector<double> distance;
+        std::vector<int> previousVertex;
+        std::vector<int> previousEdge;
+        std::vector<int> visited;
+    };
+
+    // A SearchReset resets the given LocalSearch when it's destroyed, so
+    // that a search borrowing the calling thread's LocalSearch leaves it
+    // with nothing visited however the search ends, even by an exception.
+    struct SearchReset
+    {
+        ~SearchReset();
+
+        LocalSearch& search;
+    };
+
+    // partitionNodes() assigns the nodes of a graph, each with a size, to
+    // cells of connected nodes whose sizes add up to no more than the
+    // given limit.  The graph is given as lists of neighbors.
+    static std::vector<int> partitionNodes(
+        const std::vector<std::vector<int>>& neighbors,
+        const std::vector<int>& sizes, int cellSize);
+
+    // scratchSearch() returns a LocalSearch belonging to the calling
+    // thread, sized for this graph, in which nothing is visited.  Its
+    // arrays are replaced whenever the thread searches a graph with a
+    // different number of vertices, so that the thread holds on to arrays
+    // only as large as the last graph it searched, rather than the largest.
+    LocalSearch& scratchSearch() const;
+
+    // addLevel() adds a level above the others, with the given cell
+    // containing each vertex, and finds its cells' entries and exits.
+    void addLevel(std::vector<int> cellOf);
+
+    // highestDifferentLevel() returns the highest level at which the
+    // vertices with the given indexes are in different cells, or -1 if
+    // they're in the same cell at every level.
+    int highestDifferentLevel(int v, int w) const;
+
+    // customizeCell() finds the paths through the given cell at the given
+    // level, storing their weights in the metric.
+    void customizeCell(
+        OverlayMetric& metric, int level, int cell, LocalSearch& search) const;
+
+    // searchCell() runs Dijkstra's algorithm from the given vertex within
+    // its cell at the given level, using the paths through the cells one
+    // level lower (or, at level 0, the edges), until the given target
+    // vertex is known or, if the target is -1, every exit of the cell is.
+    void searchCell(
+        const OverlayMetric& metric, int level, int start, int target,
+        LocalSearch& search) const;
+
+    // appendPath() appends to the given path the edges of the path from
+    // one vertex to another found by the given search, replacing each step
+    // that crossed a cell with the edges of the path through it, and
+    // resets the search.
+    void appendPath(
+        const OverlayMetric& metric, LocalSearch& search, int from, int to,
+        std::vector<int>& path) const;
+
+    const CompactDigraph* graph_;
+    std::vector<Level> levels_;
+};
+
+
+
+inline RouteOverlay::LocalSearch::LocalSearch(int vertexCount)
+    : distance(vertexCount, std::numeric_limits<double>::infinity()),
+      previousVertex(vertexCount, -1),
+      previousEdge(vertexCount, -1)
+{
+}
+
+
+inline void RouteOverlay::LocalSearch::reset()
+{
+    for (int v : visited)
+    {
+        distance[v] = std::numeric_limits<double>::infinity();
+        previousVertex[v] = -1;
+        previousEdge[v] = -1;
+    }
+
+    visited.clear();
+}
+
+
+inline RouteOverlay::SearchReset::~SearchReset()
+{
+    search.reset();
+}
+
+
+inline bool RouteOverlay::LocalSearch::improve(
+    int v, double weight, int previous, int edge)
+{
+    if (weight >= distance[v])
+    {
+        return false;
+    }
+
+    if (distance[v] == std::numeric_limits<double>::infinity())
+    {
+        visited.push_back(v);
+    }
+
+    distance[v] = weight;
+    previousVertex[v] = previous;
+    previousEdge[v] = edge;
+    return true;
+}
+
+
+inline RouteOverlay::RouteOverlay(
+    const CompactDigraph& graph, const std::vector<int>& cellSizes)
+    : graph_{&graph}
+{
+    int n = graph.vertexCount();
+
+    // Cells are grown along edges in either direction, so the lowest level
+    // is partitioned using each vertex's neighbors on both sides.
+    std::vector<std::vector<int>> neighbors(n);
+
+    for (int v = 0; v < n; ++v)
+    {
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            int w = graph.target(e);
+
+            if (w != v)
+            {
+                neighbors[v].push_back(w);
+                neighbors[w].push_back(v);
+            }
+        }
+    }
+
+    std::vector<int> sizes(n, 1);
+
+    for (int cellSize : cellSizes)
+    {
+        std::vector<int> cellOfNode = partitionNodes(neighbors, sizes, cellSize);
+        int cells = 0;
+
+        for (int cell : cellOfNode)
+        {
+            cells = std::max(cells, cell + 1);
+        }
+
+        std::vector<int> cellOf(n);
+
+        // Each level after the first partitions the cells of the one below
+        // it, so it is nested within it.
+        for (int v = 0; v < n; ++v)
+        {
+            cellOf[v] = cellOfNode[levels_.empty() ? v : levels_.back().cellOf[v]];
+        }
+
+        addLevel(std::move(cellOf));
+        const Level& level = levels_.back();
+
+        // The next level partitions this level's cells, each of which is
+        // as big as the vertices in it and a neighbor of the cells it
+        // shares edges with.
+        std::vector<std::vector<int>> cellNeighbors(cells);
+        std::vector<int> cellSizesSoFar(cells, 0);
+
+        for (int v = 0; v < n; ++v)
+        {
+            ++cellSizesSoFar[level.cellOf[v]];
+
+            for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+            {
+                int w = graph.target(e);
+
+                if (level.cellOf[v] != level.cellOf[w])
+                {
+                    cellNeighbors[level.cellOf[v]].push_back(level.cellOf[w]);
+                    cellNeighbors[level.cellOf[w]].push_back(level.cellOf[v]);
+                }
+            }
+        }
+
+        for (std::vector<int>& adjacent : cellNeighbors)
+        {
+            std::sort(adjacent.begin(), adjacent.end());
+            adjacent.erase(std::unique(adjacent.begin(), adjacent.end()), adjacent.end());
+        }
+
+        neighbors = std::move(cellNeighbors);
+        sizes = std::move(cellSizesSoFar);
+
+        if (cells <= 1)
+        {
+            break;
+        }
+    }
+}
+
+
+inline RouteOverlay::RouteOverlay(
+    const CompactDigraph& graph, const std::vector<std::vector<int>>& partition)
+    : graph_{&graph}
+{
+    std::size_t n = graph.vertexCount();
+
+    for (std::size_t level = 0; level < partition.size(); ++level)
+    {
+        const std::vector<int>& cellOf = partition[level];
+
+        if (cellOf.size() != n)
+        {
+            throw DigraphException("Partition does not match graph!\n");
+        }
+
+        // Every cell below this level must lie within a single cell of
+        // this level.
+        std::vector<int> enclosing(
+            level == 0 ? n : levels_.back().cells.size(), -1);
+
+        for (std::size_t v = 0; v < n; ++v)
+        {
+            int below = level == 0 ? static_cast<int>(v) : levels_.back().cellOf[v];
+
+            if (cellOf[v] < 0 || cellOf[v] >= static_cast<int>(n)
+                || (enclosing[below] != -1 && enclosing[below] != cellOf[v]))
+            {
+                throw DigraphException("Partition does not match graph!\n");
+            }
+
+            enclosing[below] = cellOf[v];
+        }
+
+        addLevel(cellOf);
+    }
+}
+
+
+inline void RouteOverlay::addLevel(std::vector<int> cellOf)
+{
+    const CompactDigraph& graph = *graph_;
+    int n = graph.vertexCount();
+    int cells = 0;
+
+    for (int cell : cellOf)
+    {
+        cells = std::max(cells, cell + 1);
+    }
+
+    Level level;
+    level.cellOf = std::move(cellOf);
+    level.entryPosition.assign(n, -1);
+    level.exitPosition.assign(n, -1);
+    level.cells.resize(cells);
+
+    for (int v = 0; v < n; ++v)
+    {
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            int w = graph.target(e);
+
+            if (level.cellOf[v] == level.cellOf[w])
+            {
+                continue;
+            }
+
+            if (level.exitPosition[v] == -1)
+            {
+                Cell& cell = level.cells[level.cellOf[v]];
+                level.exitPosition[v] = static_cast<int>(cell.exits.size());
+                cell.exits.push_back(v);
+            }
+
+            if (level.entryPosition[w] == -1)
+            {
+                Cell& cell = level.cells[level.cellOf[w]];
+                level.entryPosition[w] = static_cast<int>(cell.entries.size());
+                cell.entries.push_back(w);
+            }
+        }
+    }
+
+    level.weightCount = 0;
+
+    for (Cell& cell : level.cells)
+    {
+        cell.weightOffset = level.weightCount;
+        level.weightCount += static_cast<int>(cell.entries.size() * cell.exits.size());
+    }
+
+    levels_.push_back(std::move(level));
+}
+
+
+inline int RouteOverlay::levelCount() const noexcept
+{
+    return static_cast<int>(levels_.size());
+}
+
+
+inline int RouteOverlay::cellCount(int level) const
+{
+    return static_cast<int>(levels_.at(level).cells.size());
+}
+
+
+inline int RouteOverlay::cellOf(int level, int index) const
+{
+    return levels_.at(level).cellOf.at(index);
+}
+
+
+inline const std::vector<int>& RouteOverlay::partition(int level) const
+{
+    return levels_.at(level).cellOf;
+}
+
+
+inline int RouteOverlay::weightCount(int level) const
+{
+    return levels_.at(level).weightCount;
+}
+
+
+inline MemoryUsage RouteOverlay::memoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.caches = bytesAllocated(levels_);
+
+    for (const Level& level : levels_)
+    {
+        usage.caches +=
+            bytesAllocated(level.cellOf) + bytesAllocated(level.entryPosition)
+            + bytesAllocated(level.exitPosition) + bytesAllocated(level.cells);
+
+        for (const Cell& cell : level.cells)
+        {
+            usage.caches += bytesAllocated(cell.entries) + bytesAllocated(cell.exits);
+        }
+    }
+
+    return usage;
+}
+
+
+inline MemoryUsage RouteOverlay::memoryUsage(const OverlayMetric& metric) noexcept
+{
+    MemoryUsage usage;
+    usage.caches = bytesAllocated(metric.weights) + bytesAllocated(metric.cellWeights);
+
+    for (const std::vector<double>& weights : metric.cellWeights)
+    {
+        usage.caches += bytesAllocated(weights);
+    }
+
+    return usage;
+}
+
+
+inline OverlayMetric RouteOverlay::customize(
+    std::vector<double> weights, unsigned int threads) const
+{
+    OverlayMetric metric;
+    metric.weights = std::move(weights);
+
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+
+    for (int level = 0; level < levelCount(); ++level)
+    {
+        metric.cellWeights.emplace_back(levels_[level].weightCount);
+
+        std::atomic<int> nextCell{0};
+
+        auto worker = [&]
+        {
+            LocalSearch search{graph_->vertexCount()};
+
+            for (int cell = nextCell++; cell < cellCount(level); cell = nextCell++)
+            {
+                customizeCell(metric, level, cell, search);
+            }
+        };
+
+        std::vector<std::thread> workers;
+
+        for (unsigned int i = 1; i < threads; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+
+        worker();
+
+        for (std::thread& t : workers)
+        {
+            t.join();
+        }
+    }
+
+    return metric;
+}
+
+
+inline OverlayPath RouteOverlay::findShortestPath(
+    const OverlayMetric& metric, int startIndex, int endIndex) const
+{
+    LocalSearch& search = scratchSearch();
+    SearchReset reset{search};
+
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+
+    search.improve(startIndex, 0.0, -1, -1);
+    pq.push(Entry{0.0, startIndex});
+    DIGRAPH_COUNT(heapPushes, 1);
+
+    // Each vertex is searched at its "query level": the highest level at
+    // which its cell contains neither the start nor the end vertex.  From
+    // there, only the paths through that cell and the edges leaving it
+    // need to be followed; vertices in the same lowest-level cell as the
+    // start or end vertex (query level -1) follow all of their edges.
+    while (!pq.empty())
+    {
+        Entry entry = pq.top();
+        pq.pop();
+        DIGRAPH_COUNT(heapPops, 1);
+
+        int v = entry.second;
+
+        if (entry.first > search.distance[v])
+        {
+            DIGRAPH_COUNT(stalePops, 1);
+            continue;
+        }
+
+        DIGRAPH_COUNT(verticesSettled, 1);
+
+        if (v == endIndex)
+        {
+            break;
+        }
+
+        int level = std::min(
+            highestDifferentLevel(v, startIndex), highestDifferentLevel(v, endIndex));
+
+        if (level >= 0 && levels_[level].entryPosition[v] != -1)
+        {
+            const Level& l = levels_[level];
+            const Cell& cell = l.cells[l.cellOf[v]];
+            const double* row =
+                metric.cellWeights[level].data() + cell.weightOffset
+                + l.entryPosition[v] * cell.exits.size();
+
+            for (std::size_t j = 0; j < cell.exits.size(); ++j)
+            {
+                if (search.improve(cell.exits[j], entry.first + row[j], v, -1 - level))
+                {
+                    pq.push(Entry{entry.first + row[j], cell.exits[j]});
+                    DIGRAPH_COUNT(heapPushes, 1);
+                }
+            }
+
+            DIGRAPH_COUNT(edgesRelaxed, cell.exits.size());
+        }
+
+        for (int e = graph_->edgeBegin(v); e < graph_->edgeEnd(v); ++e)
+        {
+            int w = graph_->target(e);
+
+            if (highestDifferentLevel(v, w) >= level
+                && search.improve(w, entry.first + metric.weights[e], v, e))
+            {
+                pq.push(Entry{entry.first + metric.weights[e], w});
+                DIGRAPH_COUNT(heapPushes, 1);
+            }
+        }
+
+        DIGRAPH_COUNT(edgesRelaxed, graph_->edgeEnd(v) - graph_->edgeBegin(v));
+    }
+
+    OverlayPath path{false, 0.0, {}};
+
+    if (search.distance[endIndex] != std::numeric_limits<double>::infinity())
+    {
+        path.reached = true;
+        path.weight = search.distance[endIndex];
+        appendPath(metric, search, startIndex, endIndex, path.edges);
+    }
+
+    return path;
+}
+
+
+inline std::vector<int> RouteOverlay::partitionNodes(
+    const std::vector<std::vector<int>>& neighbors,
+    const std::vector<int>& sizes, int cellSize)
+{
+    // Cells are grown breadth-first from the first node not yet in one,
+    // until they reach the size limit or run out of neighbors.  Growing
+    // them breadth-first keeps them compact, so that few edges cross
+    // between cells.
+    int n = static_cast<int>(neighbors.size());
+    std::vector<int> cellOf(n, -1);
+    std::vector<int> queue;
+    int cells = 0;
+
+    for (int seed = 0; seed < n; ++seed)
+    {
+        if (cellOf[seed] != -1)
+        {
+            continue;
+        }
+
+        int size = sizes[seed];
+        cellOf[seed] = cells;
+        queue.assign(1, seed);
+
+        for (std::size_t next = 0; next < queue.size(); ++next)
+        {
+            for (int w : neighbors[queue[next]])
+            {
+                if (cellOf[w] == -1 && size + sizes[w] <= cellSize)
+                {
+                    cellOf[w] = cells;
+                    size += sizes[w];
+                    queue.push_back(w);
+                }
+            }
+        }
+
+        ++cells;
+    }
+
+    return cellOf;
+}
+
+
+inline int RouteOverlay::highestDifferentLevel(int v, int w) const
+{
+    int level = levelCount() - 1;
+
+    while (level >= 0 && levels_[level].cellOf[v] == levels_[level].cellOf[w])
+    {
+        --level;
+    }
+
+    return level;
+}
+
+
+inline void RouteOverlay::customizeCell(
+    OverlayMetric& metric, int level, int cell, LocalSearch& search) const
+{
+    const Cell& c = levels_[level].cells[cell];
+    double* weights = metric.cellWeights[level].data() + c.weightOffset;
+
+    for (std::size_t i = 0; i < c.entries.size(); ++i)
+    {
+        searchCell(metric, level, c.entries[i], -1, search);
+
+        for (std::size_t j = 0; j < c.exits.size(); ++j)
+        {
+            weights[i * c.exits.size() + j] = search.distance[c.exits[j]];
+        }
+
+        search.reset();
+    }
+}
+
+
+inline void RouteOverlay::searchCell(
+    const OverlayMetric& metric, int level, int start, int target,
+    LocalSearch& search) const
+{
+    const Level& l = levels_[level];
+    int cell = l.cellOf[start];
+    std::size_t remaining = target == -1 ? l.cells[cell].exits.size() : 1;
+
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+
+    search.improve(start, 0.0, -1, -1);
+    pq.push(Entry{0.0, start});
+
+    while (!pq.empty() && remaining > 0)
+    {
+        Entry entry = pq.top();
+        pq.pop();
+
+        int v = entry.second;
+
+        if (entry.first > search.distance[v])
+        {
+            continue;
+        }
+
+        if (target == -1 ? l.exitPosition[v] != -1 : v == target)
+        {
+            --remaining;
+        }
+
+        // Above the lowest level, the paths through the cells one level
+        // down are used in place of the edges within them.
+        if (level > 0)
+        {
+            const Level& below = levels_[level - 1];
+
+            if (below.entryPosition[v] != -1)
+            {
+                const Cell& sub = below.cells[below.cellOf[v]];
+                const double* row =
+                    metric.cellWeights[level - 1].data() + sub.weightOffset
+                    + below.entryPosition[v] * sub.exits.size();
+
+                for (std::size_t j = 0; j < sub.exits.size(); ++j)
+                {
+                    if (search.improve(sub.exits[j], entry.first + row[j], v, -level))
+                    {
+                        pq.push(Entry{entry.first + row[j], sub.exits[j]});
+                    }
+                }
+            }
+        }
+
+        for (int e = graph_->edgeBegin(v); e < graph_->edgeEnd(v); ++e)
+        {
+            int w = graph_->target(e);
+
+            if (l.cellOf[w] != cell
+                || (level > 0 && levels_[level - 1].cellOf[v] == levels_[level - 1].cellOf[w]))
+            {
+                continue;
+            }
+
+            if (search.improve(w, entry.first + metric.weights[e], v, e))
+            {
+                pq.push(Entry{entry.first + metric.weights[e], w});
+            }
+        }
+    }
+}
+
+
+inline void RouteOverlay::appendPath(
+    const OverlayMetric& metric, LocalSearch& search, int from, int to,
+    std::vector<int>& path) const
+{
+    struct Step
+    {
+        int from;
+        int to;
+        int edge;
+    };
+
+    std::vector<Step> steps;
+
+    for (int v = to; v != from; v = search.previousVertex[v])
+    {
+        steps.push_back(Step{search.previousVertex[v], v, search.previousEdge[v]});
+    }
+
+    // The search is reset before any cells are unpacked, since unpacking
+    // them needs searches of its own.
+    search.reset();
+
+    for (auto step = steps.rbegin(); step != steps.rend(); ++step)
+    {
+        if (step->edge >= 0)
+        {
+            path.push_back(step->edge);
+        }
+        else
+        {
+            LocalSearch& cellSearch = scratchSearch();
+            searchCell(metric, -1 - step->edge, step->from, step->to, cellSearch);
+            appendPath(metric, cellSearch, step->from, step->to, path);
+        }
+    }
+}
+
+
+inline RouteOverlay::LocalSearch& RouteOverlay::scratchSearch() const
+{
+    thread_local LocalSearch search{0};
+
+    if (static_cast<int>(search.distance.size()) != graph_->vertexCount())
+    {
+        search = LocalSearch{graph_->vertexCount()};
+    }
+
+    return search;
+}
+
+
+
+#endif // ROUTEOVERLAY_HPP
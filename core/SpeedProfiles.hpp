@@ -0,0 +1,379 @@
+// SpeedProfiles.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares the classes that describe travel times that
+// depend on the time of day, so that one graph can be searched at any
+// departure time rather than building a copy of it for every time slice.
+//
+// A SpeedProfile gives, for each time of day, a "speed factor": the
+// fraction of its usual speed at which traffic on a road segment moves (1
+// in free-flowing traffic, less in congestion).  The factors are given at
+// a few times of day and change linearly between them, and the profile
+// repeats every day.  Rather than taking the speed when a trip sets out
+// along a segment for the whole segment, the trip is followed as the
+// speed changes along the way, so that setting out later can never mean
+// arriving earlier (the "FIFO" property that time-dependent searches rely
+// on).
+//
+// Many road segments slow down in the same way (e.g., every segment of a
+// highway at rush hour), so a SpeedProfiles table stores each different
+// profile once, and TimeDependentWeights stores, for each edge of a
+// CompactDigraph, the time it takes in free-flowing traffic and which
+// profile it follows: one table and two numbers per edge, instead of one
+// weight per edge per time slice.
+//
+// Times are in hours; a time of day is a number of hours since midnight,
+// and later times (e.g., 30 for 6am the next day) continue the same
+// profile.
+
+#ifndef SPEEDPROFILES_HPP
+#define SPEEDPROFILES_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "Digraph.hpp"
+#include "MemoryUsage.hpp"
+
+
+
+class SpeedProfile
+{
+public:
+    static constexpr double hoursPerDay = 24.0;
+
+    // Initializes a SpeedProfile from (time of day, speed factor) pairs,
+    // in increasing order of time, each time at least 0 and less than 24,
+    // and each factor greater than 0.  Between the last time and the
+    // first time the next day, the factor changes linearly, too.  If there
+    // are no pairs, or any is out of order or out of range, a
+    // DigraphException is thrown.
+    explicit SpeedProfile(const std::vector<std::pair<double, double>>& points);
+
+    // factorAt() returns the speed factor at the given time.
+    double factorAt(double time) const;
+
+    // arrivalTime() returns the time at which a trip along a road segment
+    // following this profile, which takes the given number of hours in
+    // free-flowing traffic, arrives if it sets out at the given time.
+    double arrivalTime(double departure, double freeFlowHours) const;
+
+    // points() returns the pairs the profile was built from.
+    const std::vector<std::pair<double, double>>& points() const noexcept;
+
+    // memoryUsage() returns the memory allocated for the profile.
+    std::size_t memoryUsage() const noexcept;
+
+private:
+    // progressAt() returns the progress, in free-flowing hours, that
+    // traffic makes between midnight and the given time of day.
+    double progressAt(double timeOfDay) const;
+
+    // segmentOf() returns the knot at which the linear piece holding the
+    // given time of day begins.
+    std::size_t segmentOf(double timeOfDay) const;
+
+    std::vector<std::pair<double, double>> points_;
+
+    // The times and factors at which the factor's slope changes, from
+    // midnight to midnight the next day, and the progress traffic has made
+    // since midnight at each.
+    std::vector<double> knotTimes_;
+    std::vector<double> knotFactors_;
+    std::vector<double> knotProgress_;
+};
+
+
+
+// A SpeedProfiles is a table of distinct SpeedProfiles, each identified by
+// a number, so that road segments that slow down in the same way can share
+// one.
+
+class SpeedProfiles
+{
+public:
+    // add() adds the given profile to the table, unless an identical one
+    // is already there, and returns its number.
+    int add(const SpeedProfile& profile);
+
+    // profile() returns the profile with the given number.
+    const SpeedProfile& profile(int number) const;
+
+    // profileCount() returns the number of distinct profiles.
+    int profileCount() const noexcept;
+
+    // memoryUsage() returns the memory allocated for the table's profiles
+    // (counted as EdgeInfo) and the index used to find identical ones.
+    MemoryUsage memoryUsage() const noexcept;
+
+private:
+    std::vector<SpeedProfile> profiles_;
+
+    // The numbers of the profiles, in order of their points, so that an
+    // identical profile can be found by binary search.
+    std::vector<int> sorted_;
+};
+
+
+
+// TimeDependentWeights gives the time-dependent weights of the edges of
+// a CompactDigraph (indexed by edge index), for use with its
+// findEarliestArrivals() member function.
+
+class TimeDependentWeights
+{
+public:
+    // Initializes TimeDependentWeights in which edge e takes
+    // freeFlowHours[e] in free-flowing traffic and follows the profile
+    // with number profileOfEdge[e] in the given table.  If the vectors
+    // differ in size, or any number isn't in the table, a DigraphException
+    // is thrown.
+    TimeDependentWeights(
+        std::vector<double> freeFlowHours, std::vector<int> profileOfEdge,
+        SpeedProfiles profiles);
+
+    // arrivalTime() returns the time at which a trip along the given edge
+    // that sets out at the given time arrives.
+    double arrivalTime(int edge, double departure) const;
+
+    // profiles() returns the table of profiles.
+    const SpeedProfiles& profiles() const noexcept;
+
+    // memoryUsage() returns the memory allocated for the weights and the
+    // table of profiles.
+    MemoryUsage memoryUsage() const noexcept;
+
+private:
+    std::vector<double> freeFlowHours_;
+    std::vector<int> profileOfEdge_;
+    SpeedProfiles profiles_;
+};
+
+
+
+inline SpeedProfile::SpeedProfile(const std::vector<std::pair<double, double>>& points)
+    : points_{points}
+{
+    if (points_.empty())
+    {
+        throw DigraphException("Speed profile has no points!\n");
+    }
+
+    for (std::size_t i = 0; i < points_.size(); ++i)
+    {
+        if (!(points_[i].first >= 0.0 && points_[i].first < hoursPerDay)
+            || (i > 0 && !(points_[i - 1].first < points_[i].first))
+            || !(points_[i].second > 0.0))
+        {
+            throw DigraphException("Speed profile point is out of order or out of range!\n");
+        }
+    }
+
+    // The factor at midnight is found from the points on either side of
+    // it, the last one today and the first one tomorrow.
+    const auto& first = points_.front();
+    const auto& last = points_.back();
+    double span = first.first + hoursPerDay - last.first;
+    double midnight =
+        last.second + (first.second - last.second) * (hoursPerDay - last.first) / span;
+
+    knotTimes_.push_back(0.0);
+    knotFactors_.push_back(midnight);
+
+    for (const auto& point : points_)
+    {
+        if (point.first > 0.0)
+        {
+            knotTimes_.push_back(point.first);
+            knotFactors_.push_back(point.second);
+        }
+        else
+        {
+            knotFactors_.front() = point.second;
+        }
+    }
+
+    knotTimes_.push_back(hoursPerDay);
+    knotFactors_.push_back(knotFactors_.front());
+
+    knotProgress_.push_back(0.0);
+
+    for (std::size_t k = 0; k + 1 < knotTimes_.size(); ++k)
+    {
+        double hours = knotTimes_[k + 1] - knotTimes_[k];
+        knotProgress_.push_back(
+            knotProgress_.back() + hours * (knotFactors_[k] + knotFactors_[k + 1]) / 2.0);
+    }
+}
+
+
+inline double SpeedProfile::factorAt(double time) const
+{
+    double timeOfDay = time - hoursPerDay * std::floor(time / hoursPerDay);
+    std::size_t k = segmentOf(timeOfDay);
+    double slope =
+        (knotFactors_[k + 1] - knotFactors_[k]) / (knotTimes_[k + 1] - knotTimes_[k]);
+
+    return knotFactors_[k] + slope * (timeOfDay - knotTimes_[k]);
+}
+
+
+inline double SpeedProfile::arrivalTime(double departure, double freeFlowHours) const
+{
+    double day = std::floor(departure / hoursPerDay);
+    double dailyProgress = knotProgress_.back();
+
+    // The progress needed is counted from midnight on the day of departure,
+    // and whole days of it are skipped at once.
+    double target = progressAt(departure - day * hoursPerDay) + freeFlowHours;
+    double days = std::floor(target / dailyProgress);
+    target -= days * dailyProgress;
+
+    std::size_t k = std::upper_bound(knotProgress_.begin(), knotProgress_.end(), target)
+        - knotProgress_.begin();
+    k = std::min(k == 0 ? 0 : k - 1, knotTimes_.size() - 2);
+
+    // Within a piece, the factor is f + s * x after x hours, so the
+    // progress is f * x + s * x * x / 2; this solves for x in a way that
+    // stays accurate when s is (nearly) 0.
+    double f = knotFactors_[k];
+    double s = (knotFactors_[k + 1] - f) / (knotTimes_[k + 1] - knotTimes_[k]);
+    double remaining = target - knotProgress_[k];
+    double x = 2.0 * remaining / (f + std::sqrt(std::max(0.0, f * f + 2.0 * s * remaining)));
+
+    return (day + days) * hoursPerDay + knotTimes_[k] + x;
+}
+
+
+inline const std::vector<std::pair<double, double>>& SpeedProfile::points() const noexcept
+{
+    return points_;
+}
+
+
+inline std::size_t SpeedProfile::memoryUsage() const noexcept
+{
+    return bytesAllocated(points_) + bytesAllocated(knotTimes_)
+        + bytesAllocated(knotFactors_) + bytesAllocated(knotProgress_);
+}
+
+
+inline double SpeedProfile::progressAt(double timeOfDay) const
+{
+    std::size_t k = segmentOf(timeOfDay);
+    double f = knotFactors_[k];
+    double s = (knotFactors_[k + 1] - f) / (knotTimes_[k + 1] - knotTimes_[k]);
+    double x = timeOfDay - knotTimes_[k];
+
+    return knotProgress_[k] + f * x + s * x * x / 2.0;
+}
+
+
+inline std::size_t SpeedProfile::segmentOf(double timeOfDay) const
+{
+    std::size_t k = std::upper_bound(knotTimes_.begin(), knotTimes_.end(), timeOfDay)
+        - knotTimes_.begin();
+
+    return std::min(k == 0 ? 0 : k - 1, knotTimes_.size() - 2);
+}
+
+
+
+inline int SpeedProfiles::add(const SpeedProfile& profile)
+{
+    auto found = std::lower_bound(
+        sorted_.begin(), sorted_.end(), profile.points(),
+        [this](int number, const std::vector<std::pair<double, double>>& points)
+        {
+            return profiles_[number].points() < points;
+        });
+
+    if (found != sorted_.end() && profiles_[*found].points() == profile.points())
+    {
+        return *found;
+    }
+
+    int number = profileCount();
+    sorted_.insert(found, number);
+    profiles_.push_back(profile);
+    return number;
+}
+
+
+inline const SpeedProfile& SpeedProfiles::profile(int number) const
+{
+    return profiles_.at(number);
+}
+
+
+inline int SpeedProfiles::profileCount() const noexcept
+{
+    return static_cast<int>(profiles_.size());
+}
+
+
+inline MemoryUsage SpeedProfiles::memoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.edgeInfo = bytesAllocated(profiles_);
+
+    usage.indexes = bytesAllocated(sorted_);
+
+    for (const SpeedProfile& profile : profiles_)
+    {
+        usage.edgeInfo += profile.memoryUsage();
+    }
+
+    return usage;
+}
+
+
+
+inline TimeDependentWeights::TimeDependentWeights(
+    std::vector<double> freeFlowHours, std::vector<int> profileOfEdge,
+    SpeedProfiles profiles)
+    : freeFlowHours_{std::move(freeFlowHours)},
+      profileOfEdge_{std::move(profileOfEdge)},
+      profiles_{std::move(profiles)}
+{
+    if (freeFlowHours_.size() != profileOfEdge_.size())
+    {
+        throw DigraphException("Every edge must have a speed profile!\n");
+    }
+
+    for (int number : profileOfEdge_)
+    {
+        if (number < 0 || number >= profiles_.profileCount())
+        {
+            throw DigraphException("Speed profile does not exist!\n");
+        }
+    }
+}
+
+
+inline double TimeDependentWeights::arrivalTime(int edge, double departure) const
+{
+    return profiles_.profile(profileOfEdge_[edge]).arrivalTime(departure, freeFlowHours_[edge]);
+}
+
+
+inline const SpeedProfiles& TimeDependentWeights::profiles() const noexcept
+{
+    return profiles_;
+}
+
+
+inline MemoryUsage TimeDependentWeights::memoryUsage() const noexcept
+{
+    MemoryUsage usage = profiles_.memoryUsage();
+    usage.edgeInfo += bytesAllocated(freeFlowHours_) + bytesAllocated(profileOfEdge_);
+    return usage;
+}
+
+
+
+#endif // SPEEDPROFILES_HPP
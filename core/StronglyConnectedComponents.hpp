@@ -0,0 +1,689 @@
+// StronglyConnectedComponents.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class called StronglyConnectedComponents,
+// which finds the strongly connected components of a CompactDigraph (the
+// largest sets of vertices in which every vertex can be reached from every
+// other) using several threads.  A depth-first search such as Tarjan's
+// algorithm can't be split between threads, so the work is done in three
+// steps, each of which can:
+//
+// * "Trimming" repeatedly finds the vertices that have no incoming edges
+//   or no outgoing edges from the vertices that are left, each of which is
+//   a component by itself.  Dead ends and one-way spurs are trimmed away.
+//
+// * "Forward-backward" search picks a vertex that is likely to be in the
+//   largest component (one with many neighbors) and searches forward and
+//   backward from it, breadth-first, one level at a time, splitting each
+//   level between the threads.  The vertices reached both ways are its
+//   component, which, in a road network, is nearly all of the graph.
+//
+// * "Coloring" finds the rest.  Every vertex starts with its own index as
+//   its color, and the largest colors are spread forward along the edges
+//   until they stop changing.  Each vertex that keeps its own color is then
+//   in the same component as exactly the vertices of its color that can
+//   reach it, which a backward search finds.  The vertices that are left
+//   are colored again, until there are few enough that one thread can
+//   finish them with Tarjan's algorithm.
+//
+// Components are numbered in order of the lowest vertex index in each, so
+// the result doesn't depend on the number of threads.  Nothing refers to
+// the CompactDigraph once the components are found.
+
+#ifndef STRONGLYCONNECTEDCOMPONENTS_HPP
+#define STRONGLYCONNECTEDCOMPONENTS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "CompactDigraph.hpp"
+
+
+
+class StronglyConnectedComponents
+{
+public:
+    // The default constructor initializes a StronglyConnectedComponents
+    // with no vertices and no components.
+    StronglyConnectedComponents();
+
+    // Finds the strongly connected components of the given graph, using
+    // the given number of threads (by default, one per hardware thread).
+    explicit StronglyConnectedComponents(
+        const CompactDigraph& graph,
+        unsigned int threads = std::thread::hardware_concurrency());
+
+    // componentCount() returns the number of components.
+    int componentCount() const noexcept;
+
+    // componentOf() returns the component that the vertex with the given
+    // index is in, and componentSize() the number of vertices in the given
+    // component.
+    int componentOf(int index) const;
+    int componentSize(int component) const;
+
+    // largestComponent() returns the component with the most vertices (the
+    // lowest-numbered one, if there's a tie), or -1 if there are none.
+    int largestComponent() const noexcept;
+
+    // verticesOf() returns the indexes of the vertices in the given
+    // component, in ascending order.
+    std::vector<int> verticesOf(int component) const;
+
+private:
+    // A Solver holds what's needed while the components are being found.
+    class Solver;
+
+    std::vector<int> components_;
+    std::vector<int> sizes_;
+    int largest_;
+};
+
+
+
+class StronglyConnectedComponents::Solver
+{
+public:
+    Solver(const CompactDigraph& graph, unsigned int threads);
+
+    // run() finds the components, returning the component of each vertex,
+    // numbered in the order they were found.
+    std::vector<int> run();
+
+private:
+    // Trimming stops after this many rounds, since a long enough one-way
+    // path could otherwise take one round per vertex; coloring finds
+    // whatever is left.
+    static constexpr int maxTrimRounds = 16;
+
+    // Once no more than this many vertices are left, Tarjan's algorithm
+    // finishes them more quickly than another round of coloring.
+    static constexpr std::size_t serialThreshold = 4096;
+
+    // The vertices of each level of a breadth-first search, and the live
+    // vertices, are split between the threads in chunks of this size.
+    static constexpr std::size_t chunkSize = 1024;
+
+    // parallelChunks() splits the numbers from 0 to count - 1 into chunks
+    // of the given size, and calls func(begin, end, out) for each, on one
+    // of the threads.  Each thread has its own out vector, in which func
+    // can store vertex indexes; all of them are returned, one after the
+    // other.
+    template <typename Func>
+    std::vector<int> parallelChunks(std::size_t count, std::size_t size, Func func);
+
+    bool isLive(int v) const;
+
+    // assign() gives the vertex the given component; removeDead() removes
+    // the vertices that have one from the list of live vertices.
+    void assign(int v, int component);
+    void removeDead();
+
+    void trim();
+    void forwardBackward();
+    void color();
+    void tarjan();
+
+    // search() marks every live vertex that can be reached from the given
+    // start vertex, following edges forward or backward, with the given
+    // bit in marks_.
+    void search(int start, bool forward, unsigned char bit);
+
+    const CompactDigraph& graph_;
+    unsigned int threads_;
+
+    // The edges in reverse, stored the same way as CompactDigraph's: the
+    // edges into the vertex with index i come from sources_[j], for j from
+    // reverseOffsets_[i] up to (but not including) reverseOffsets_[i + 1].
+    std::vector<int> reverseOffsets_;
+    std::vector<int> sources_;
+
+    // Each vertex's component, or -1 while it is "live" (has none yet).
+    std::unique_ptr<std::atomic<int>[]> components_;
+    std::atomic<int> nextComponent_;
+
+    std::unique_ptr<std::atomic<int>[]> colors_;
+    std::unique_ptr<std::atomic<unsigned char>[]> marks_;
+
+    std::vector<int> live_;
+};
+
+
+
+inline StronglyConnectedComponents::StronglyConnectedComponents()
+    : largest_{-1}
+{
+}
+
+
+inline StronglyConnectedComponents::StronglyConnectedComponents(
+    const CompactDigraph& graph, unsigned int threads)
+    : largest_{-1}
+{
+    std::vector<int> found = Solver{graph, threads == 0 ? 1 : threads}.run();
+
+    // The components are renumbered in order of their lowest vertex index.
+    std::vector<int> numbers(graph.vertexCount(), -1);
+    components_.reserve(found.size());
+
+    for (int component : found)
+    {
+        if (numbers[component] == -1)
+        {
+            numbers[component] = static_cast<int>(sizes_.size());
+            sizes_.push_back(0);
+        }
+
+        components_.push_back(numbers[component]);
+        ++sizes_[numbers[component]];
+    }
+
+    for (int c = 0; c < componentCount(); ++c)
+    {
+        if (largest_ == -1 || sizes_[c] > sizes_[largest_])
+        {
+            largest_ = c;
+        }
+    }
+}
+
+
+inline int StronglyConnectedComponents::componentCount() const noexcept
+{
+    return static_cast<int>(sizes_.size());
+}
+
+
+inline int StronglyConnectedComponents::componentOf(int index) const
+{
+    return components_.at(index);
+}
+
+
+inline int StronglyConnectedComponents::componentSize(int component) const
+{
+    return sizes_.at(component);
+}
+
+
+inline int StronglyConnectedComponents::largestComponent() const noexcept
+{
+    return largest_;
+}
+
+
+inline std::vector<int> StronglyConnectedComponents::verticesOf(int component) const
+{
+    std::vector<int> vertices;
+    vertices.reserve(componentSize(component));
+
+    for (int v = 0; v < static_cast<int>(components_.size()); ++v)
+    {
+        if (components_[v] == component)
+        {
+            vertices.push_back(v);
+        }
+    }
+
+    return vertices;
+}
+
+
+
+inline StronglyConnectedComponents::Solver::Solver(
+    const CompactDigraph& graph, unsigned int threads)
+    : graph_{graph}, threads_{threads},
+      components_{new std::atomic<int>[graph.vertexCount()]},
+      nextComponent_{0},
+      colors_{new std::atomic<int>[graph.vertexCount()]},
+      marks_{new std::atomic<unsigned char>[graph.vertexCount()]}
+{
+    int vertexCount = graph.vertexCount();
+
+    reverseOffsets_.assign(vertexCount + 1, 0);
+
+    for (int e = 0; e < graph.edgeCount(); ++e)
+    {
+        ++reverseOffsets_[graph.target(e) + 1];
+    }
+
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        reverseOffsets_[v + 1] += reverseOffsets_[v];
+    }
+
+    std::vector<int> next{reverseOffsets_.begin(), reverseOffsets_.end() - 1};
+    sources_.resize(graph.edgeCount());
+
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            sources_[next[graph.target(e)]++] = v;
+        }
+    }
+
+    live_.reserve(vertexCount);
+
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        components_[v].store(-1, std::memory_order_relaxed);
+        colors_[v].store(v, std::memory_order_relaxed);
+        marks_[v].store(0, std::memory_order_relaxed);
+        live_.push_back(v);
+    }
+}
+
+
+inline std::vector<int> StronglyConnectedComponents::Solver::run()
+{
+    trim();
+    forwardBackward();
+    color();
+    tarjan();
+
+    std::vector<int> components(graph_.vertexCount());
+
+    for (int v = 0; v < graph_.vertexCount(); ++v)
+    {
+        components[v] = components_[v].load(std::memory_order_relaxed);
+    }
+
+    return components;
+}
+
+
+template <typename Func>
+std::vector<int> StronglyConnectedComponents::Solver::parallelChunks(
+    std::size_t count, std::size_t size, Func func)
+{
+    std::size_t chunks = (count + size - 1) / size;
+    unsigned int threads = std::min<std::size_t>(threads_, std::max<std::size_t>(chunks, 1));
+
+    std::vector<std::vector<int>> outs(threads);
+    std::atomic<std::size_t> nextChunk{0};
+
+    auto worker = [&](std::vector<int>& out)
+    {
+        for (std::size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++)
+        {
+            func(chunk * size, std::min(count, (chunk + 1) * size), out);
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(worker, std::ref(outs[i]));
+    }
+
+    worker(outs[0]);
+
+    for (std::thread& t : workers)
+    {
+        t.join();
+    }
+
+    for (unsigned int i = 1; i < threads; ++i)
+    {
+        outs[0].insert(outs[0].end(), outs[i].begin(), outs[i].end());
+    }
+
+    return std::move(outs[0]);
+}
+
+
+inline bool StronglyConnectedComponents::Solver::isLive(int v) const
+{
+    return components_[v].load(std::memory_order_relaxed) == -1;
+}
+
+
+inline void StronglyConnectedComponents::Solver::assign(int v, int component)
+{
+    components_[v].store(component, std::memory_order_relaxed);
+}
+
+
+inline void StronglyConnectedComponents::Solver::removeDead()
+{
+    live_.erase(
+        std::remove_if(
+            live_.begin(), live_.end(),
+            [&](int v) { return !isLive(v); }),
+        live_.end());
+}
+
+
+inline void StronglyConnectedComponents::Solver::trim()
+{
+    for (int round = 0; round < maxTrimRounds; ++round)
+    {
+        std::vector<int> trimmed = parallelChunks(
+            live_.size(), chunkSize,
+            [&](std::size_t begin, std::size_t end, std::vector<int>& out)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    int v = live_[i];
+                    bool hasOut = false;
+                    bool hasIn = false;
+
+                    for (int e = graph_.edgeBegin(v); !hasOut && e < graph_.edgeEnd(v); ++e)
+                    {
+                        int w = graph_.target(e);
+                        hasOut = w != v && isLive(w);
+                    }
+
+                    for (int e = reverseOffsets_[v]; !hasIn && e < reverseOffsets_[v + 1]; ++e)
+                    {
+                        int u = sources_[e];
+                        hasIn = u != v && isLive(u);
+                    }
+
+                    if (!hasOut || !hasIn)
+                    {
+                        out.push_back(v);
+                    }
+                }
+            });
+
+        if (trimmed.empty())
+        {
+            return;
+        }
+
+        for (int v : trimmed)
+        {
+            assign(v, nextComponent_++);
+        }
+
+        removeDead();
+    }
+}
+
+
+inline void StronglyConnectedComponents::Solver::forwardBackward()
+{
+    if (live_.empty())
+    {
+        return;
+    }
+
+    // The vertex with the most edges both ways is the most likely to be
+    // in the largest component.
+    int pivot = live_[0];
+    long long best = -1;
+
+    for (int v : live_)
+    {
+        long long degree =
+            static_cast<long long>(graph_.edgeEnd(v) - graph_.edgeBegin(v))
+            * (reverseOffsets_[v + 1] - reverseOffsets_[v]);
+
+        if (degree > best)
+        {
+            pivot = v;
+            best = degree;
+        }
+    }
+
+    search(pivot, true, 1);
+    search(pivot, false, 2);
+
+    int component = nextComponent_++;
+
+    for (int v : live_)
+    {
+        if (marks_[v].load(std::memory_order_relaxed) == 3)
+        {
+            assign(v, component);
+        }
+
+        marks_[v].store(0, std::memory_order_relaxed);
+    }
+
+    removeDead();
+}
+
+
+inline void StronglyConnectedComponents::Solver::search(int start, bool forward, unsigned char bit)
+{
+    marks_[start].fetch_or(bit, std::memory_order_relaxed);
+    std::vector<int> level{start};
+
+    while (!level.empty())
+    {
+        level = parallelChunks(
+            level.size(), chunkSize,
+            [&](std::size_t begin, std::size_t end, std::vector<int>& out)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    int v = level[i];
+                    int first = forward ? graph_.edgeBegin(v) : reverseOffsets_[v];
+                    int last = forward ? graph_.edgeEnd(v) : reverseOffsets_[v + 1];
+
+                    for (int e = first; e < last; ++e)
+                    {
+                        int w = forward ? graph_.target(e) : sources_[e];
+
+                        // Whichever thread sets the bit first visits w.
+                        if (isLive(w)
+                            && (marks_[w].load(std::memory_order_relaxed) & bit) == 0
+                            && (marks_[w].fetch_or(bit, std::memory_order_relaxed) & bit) == 0)
+                        {
+                            out.push_back(w);
+                        }
+                    }
+                }
+            });
+    }
+}
+
+
+inline void StronglyConnectedComponents::Solver::color()
+{
+    while (live_.size() > serialThreshold)
+    {
+        for (int v : live_)
+        {
+            colors_[v].store(v, std::memory_order_relaxed);
+        }
+
+        std::atomic<bool> changed{true};
+
+        while (changed)
+        {
+            changed = false;
+
+            parallelChunks(
+                live_.size(), chunkSize,
+                [&](std::size_t begin, std::size_t end, std::vector<int>&)
+                {
+                    for (std::size_t i = begin; i < end; ++i)
+                    {
+                        int v = live_[i];
+                        int c = colors_[v].load(std::memory_order_relaxed);
+
+                        for (int e = graph_.edgeBegin(v); e < graph_.edgeEnd(v); ++e)
+                        {
+                            int w = graph_.target(e);
+
+                            if (!isLive(w))
+                            {
+                                continue;
+                            }
+
+                            int old = colors_[w].load(std::memory_order_relaxed);
+
+                            while (old < c
+                                   && !colors_[w].compare_exchange_weak(
+                                       old, c, std::memory_order_relaxed))
+                            {
+                            }
+
+                            if (old < c)
+                            {
+                                changed = true;
+                            }
+                        }
+                    }
+                });
+        }
+
+        std::vector<int> roots = parallelChunks(
+            live_.size(), chunkSize,
+            [&](std::size_t begin, std::size_t end, std::vector<int>& out)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    if (colors_[live_[i]].load(std::memory_order_relaxed) == live_[i])
+                    {
+                        out.push_back(live_[i]);
+                    }
+                }
+            });
+
+        // The vertices of different colors are separate, so each root's
+        // backward search can be done on any thread without interfering
+        // with the others.
+        parallelChunks(
+            roots.size(), 1,
+            [&](std::size_t begin, std::size_t, std::vector<int>& queue)
+            {
+                int root = roots[begin];
+                int component = nextComponent_++;
+
+                assign(root, component);
+                queue.assign(1, root);
+
+                while (!queue.empty())
+                {
+                    int v = queue.back();
+                    queue.pop_back();
+
+                    for (int e = reverseOffsets_[v]; e < reverseOffsets_[v + 1]; ++e)
+                    {
+                        int u = sources_[e];
+
+                        if (isLive(u) && colors_[u].load(std::memory_order_relaxed) == root)
+                        {
+                            assign(u, component);
+                            queue.push_back(u);
+                        }
+                    }
+                }
+            });
+
+        removeDead();
+    }
+}
+
+
+inline void StronglyConnectedComponents::Solver::tarjan()
+{
+    // This is Tarjan's algorithm, with the depth-first search's stack kept
+    // explicitly.  The order in which each vertex was found is stored in
+    // colors_, since coloring is finished.
+    const int unvisited = -1;
+
+    for (int v : live_)
+    {
+        colors_[v].store(unvisited, std::memory_order_relaxed);
+    }
+
+    std::vector<int> lowLinks(graph_.vertexCount());
+    std::vector<int> stack;
+    std::vector<std::pair<int, int>> path;
+    int found = 0;
+
+    for (int start : live_)
+    {
+        if (colors_[start].load(std::memory_order_relaxed) != unvisited)
+        {
+            continue;
+        }
+
+        path.emplace_back(start, graph_.edgeBegin(start));
+        colors_[start].store(found, std::memory_order_relaxed);
+        lowLinks[start] = found++;
+        stack.push_back(start);
+
+        while (!path.empty())
+        {
+            int v = path.back().first;
+            int& e = path.back().second;
+
+            if (e < graph_.edgeEnd(v))
+            {
+                int w = graph_.target(e++);
+
+                if (!isLive(w))
+                {
+                    continue;
+                }
+
+                int order = colors_[w].load(std::memory_order_relaxed);
+
+                if (order == unvisited)
+                {
+                    colors_[w].store(found, std::memory_order_relaxed);
+                    lowLinks[w] = found++;
+                    stack.push_back(w);
+                    path.emplace_back(w, graph_.edgeBegin(w));
+                }
+                else if (order >= 0)
+                {
+                    lowLinks[v] = std::min(lowLinks[v], order);
+                }
+
+                continue;
+            }
+
+            path.pop_back();
+
+            if (!path.empty())
+            {
+                int parent = path.back().first;
+                lowLinks[parent] = std::min(lowLinks[parent], lowLinks[v]);
+            }
+
+            if (lowLinks[v] == colors_[v].load(std::memory_order_relaxed))
+            {
+                int component = nextComponent_++;
+                int w;
+
+                // A vertex whose component is found is no longer on the
+                // stack; its order is marked negative so that it isn't
+                // mistaken for one that is.
+                do
+                {
+                    w = stack.back();
+                    stack.pop_back();
+                    colors_[w].store(-2, std::memory_order_relaxed);
+                    lowLinks[w] = component;
+                }
+                while (w != v);
+            }
+        }
+    }
+
+    for (int v : live_)
+    {
+        assign(v, lowLinks[v]);
+    }
+
+    live_.clear();
+}
+
+
+
+#endif // STRONGLYCONNECTEDCOMPONENTS_HPP
@@ -0,0 +1,212 @@
+// TileCache.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class template called TileCache, which keeps
+// the pieces ("tiles") of a structure too large to keep in memory that
+// have been used most recently, loading the others only when they're
+// needed.
+//
+// Each tile is identified by a number and loaded by a function that the
+// TileCache is given, the first time it's asked for.  The cache has a
+// budget, in bytes: whenever the tiles it holds add up to more than that,
+// the one used least recently is evicted (and loaded again if it's ever
+// needed again), until they fit.  The tile just loaded is never evicted,
+// so a single tile larger than the budget is still kept until another is
+// loaded.
+//
+// Tiles are handed out as std::shared_ptrs, so a tile that is evicted
+// while it's being used stays valid until its user lets go of it; the
+// budget counts only the tiles in the cache, not those still held once
+// they've been evicted.  A TileCache can be used from any number of
+// threads at once, and tiles are loaded without holding its lock, so
+// that loading one tile doesn't hold up threads using others.
+
+#ifndef TILECACHE_HPP
+#define TILECACHE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "MemoryUsage.hpp"
+
+
+
+// The Tile type must have a member function memoryUsage() that returns a
+// MemoryUsage describing the memory the tile has allocated.
+
+template <typename Tile>
+class TileCache
+{
+public:
+    typedef std::function<std::shared_ptr<const Tile>(int)> LoadFunc;
+
+    // Initializes an empty TileCache with the given budget, in bytes,
+    // which loads the tile with number n by calling load(n).
+    TileCache(std::size_t budget, LoadFunc load);
+
+    TileCache(const TileCache&) = delete;
+    TileCache& operator=(const TileCache&) = delete;
+
+    // get() returns the tile with the given number, loading it if it
+    // isn't in the cache, and makes it the most recently used.  If
+    // loading it throws an exception, the exception is passed on and the
+    // cache is left unchanged.
+    std::shared_ptr<const Tile> get(int tile);
+
+    // budget() returns the budget, in bytes.
+    std::size_t budget() const noexcept;
+
+    // residentTiles() returns the number of tiles in the cache, and
+    // residentBytes() the memory they're using.
+    std::size_t residentTiles() const;
+    std::size_t residentBytes() const;
+
+    // loadCount() returns the number of times a tile has been loaded, and
+    // evictionCount() the number of times one has been evicted.
+    std::size_t loadCount() const;
+    std::size_t evictionCount() const;
+
+    // memoryUsage() returns the memory used by the tiles in the cache, by
+    // category.
+    MemoryUsage memoryUsage() const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const Tile> tile;
+        std::size_t bytes;
+        typename std::list<int>::iterator recent;
+    };
+
+    std::size_t budget_;
+    LoadFunc load_;
+
+    // The numbers of the tiles in the cache, most recently used first.
+    std::list<int> recent_;
+    std::unordered_map<int, Entry> entries_;
+
+    std::size_t residentBytes_;
+    std::size_t loads_;
+    std::size_t evictions_;
+
+    mutable std::mutex mutex_;
+};
+
+
+
+template <typename Tile>
+TileCache<Tile>::TileCache(std::size_t budget, LoadFunc load)
+    : budget_{budget}, load_{std::move(load)}, residentBytes_{0}, loads_{0}, evictions_{0}
+{
+}
+
+
+template <typename Tile>
+std::shared_ptr<const Tile> TileCache<Tile>::get(int tile)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        auto found = entries_.find(tile);
+
+        if (found != entries_.end())
+        {
+            recent_.splice(recent_.begin(), recent_, found->second.recent);
+            return found->second.tile;
+        }
+    }
+
+    std::shared_ptr<const Tile> loaded = load_(tile);
+    std::size_t bytes = loaded->memoryUsage().total();
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++loads_;
+
+    // Another thread may have loaded the same tile in the meantime, in
+    // which case its copy is the one kept.
+    auto found = entries_.find(tile);
+
+    if (found != entries_.end())
+    {
+        recent_.splice(recent_.begin(), recent_, found->second.recent);
+        return found->second.tile;
+    }
+
+    recent_.push_front(tile);
+    entries_.emplace(tile, Entry{loaded, bytes, recent_.begin()});
+    residentBytes_ += bytes;
+
+    while (residentBytes_ > budget_ && recent_.size() > 1)
+    {
+        auto evicted = entries_.find(recent_.back());
+        residentBytes_ -= evicted->second.bytes;
+        entries_.erase(evicted);
+        recent_.pop_back();
+        ++evictions_;
+    }
+
+    return loaded;
+}
+
+
+template <typename Tile>
+std::size_t TileCache<Tile>::budget() const noexcept
+{
+    return budget_;
+}
+
+
+template <typename Tile>
+std::size_t TileCache<Tile>::residentTiles() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return entries_.size();
+}
+
+
+template <typename Tile>
+std::size_t TileCache<Tile>::residentBytes() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return residentBytes_;
+}
+
+
+template <typename Tile>
+std::size_t TileCache<Tile>::loadCount() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return loads_;
+}
+
+
+template <typename Tile>
+std::size_t TileCache<Tile>::evictionCount() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    return evictions_;
+}
+
+
+template <typename Tile>
+MemoryUsage TileCache<Tile>::memoryUsage() const
+{
+    std::lock_guard<std::mutex> lock{mutex_};
+    MemoryUsage usage;
+
+    for (const auto& entry : entries_)
+    {
+        usage += entry.second.tile->memoryUsage();
+    }
+
+    return usage;
+}
+
+
+
+#endif // TILECACHE_HPP
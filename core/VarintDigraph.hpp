@@ -0,0 +1,404 @@
+// VarintDigraph.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// This header file declares a class template called VarintDigraph, which
+// is a read-only copy of a CompactDigraph stored in as little memory as is
+// practical, for graphs that are kept around but rarely searched.  Each
+// vertex's outgoing edges are sorted by the index of the vertex they point
+// to and stored in one array of bytes, back to back:
+//
+// * the first edge's "to" index is stored as its difference from the
+//   vertex's own index (which, in a graph whose vertices are in a
+//   breadth-first order, is usually small), and each later edge's as its
+//   difference from the one before, which is never negative
+// * each edge also carries a fixed number of unsigned integer Fields (the
+//   "payload"), which is how the EdgeInfo is stored, once it has been
+//   quantized into integers by the code that builds the VarintDigraph
+//
+// Every one of these numbers is stored as a variable-length integer, seven
+// bits to a byte, so that small numbers take only a byte or two.  The
+// edges are decoded one at a time, as they're traversed, by an EdgeReader.
+//
+// Vertices have indexes and vertex numbers, as in the CompactDigraph it
+// was built from.
+
+#ifndef VARINTDIGRAPH_HPP
+#define VARINTDIGRAPH_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "CompactDigraph.hpp"
+#include "DigraphStats.hpp"
+#include "MemoryUsage.hpp"
+
+
+
+template <int Fields>
+class VarintDigraph
+{
+public:
+    typedef std::array<std::uint32_t, Fields> Payload;
+
+    // An EdgeReader decodes the outgoing edges of one vertex, in order.
+    class EdgeReader
+    {
+    public:
+        EdgeReader(const std::uint8_t* begin, const std::uint8_t* end, int index);
+
+        // next() decodes the next edge, storing the index of the vertex it
+        // points to and its payload, and returns true, or returns false if
+        // there are no more edges.
+        bool next(int& target, Payload& payload);
+
+    private:
+        std::uint32_t readVarint();
+
+        const std::uint8_t* position_;
+        const std::uint8_t* end_;
+        int previous_;
+        bool first_;
+    };
+
+    // The default constructor initializes an empty VarintDigraph.
+    VarintDigraph();
+
+    // This constructor copies the given graph, calling payloadFunc(edge)
+    // with the edge index of every edge, which returns that edge's payload.
+    template <typename PayloadFunc>
+    VarintDigraph(const CompactDigraph& graph, PayloadFunc payloadFunc);
+
+    // vertexCount() and edgeCount() return the number of vertices and
+    // edges, respectively.
+    int vertexCount() const noexcept;
+    int edgeCount() const noexcept;
+
+    // vertexNumber() and indexOf() convert between vertex numbers and
+    // indexes, exactly as CompactDigraph's do.
+    int vertexNumber(int index) const;
+    int indexOf(int vertex) const;
+
+    // edges() returns an EdgeReader for the outgoing edges of the vertex
+    // with the given index.
+    EdgeReader edges(int index) const;
+
+    // findShortestPaths() runs Dijkstra's algorithm from the vertex with
+    // the given start index, decoding each edge as it goes and calling
+    // weightFunc(payload) to find its weight.  If an end index is given,
+    // the search stops once the shortest path to that vertex is known.
+    // In the result, each vertex's previousEdge is the position (counting
+    // from 0) of the edge used to reach it among the previous vertex's
+    // edges, since edges have no indexes of their own.
+    template <typename Distance, typename WeightFunc>
+    CompactSearchResult<Distance> findShortestPaths(
+        int startIndex, WeightFunc weightFunc, int endIndex = -1) const;
+
+    // bytes() returns the number of bytes used to store the graph.
+    std::size_t bytes() const noexcept;
+
+    // memoryUsage() returns the same bytes by category.  The payloads are
+    // stored among the edges, so they're counted as adjacency.
+    MemoryUsage memoryUsage() const noexcept;
+
+private:
+    // zigzag() encodes a number that may be negative as one that isn't,
+    // as described in EdgeReader::next(), and writeVarint() appends a
+    // number to the given bytes as a variable-length integer.
+    static std::uint32_t zigzag(int value);
+    static void writeVarint(std::vector<std::uint8_t>& out, std::uint32_t value);
+
+    // The edges of the vertex with index i are stored in bytes_, from
+    // offsets_[i] up to (but not including) offsets_[i + 1].
+    std::vector<std::uint8_t> bytes_;
+    std::vector<std::uint32_t> offsets_;
+    int edgeCount_;
+
+    std::vector<int> vertexNumbers_;
+    std::vector<std::pair<int, int>> indexes_;
+};
+
+
+
+template <int Fields>
+VarintDigraph<Fields>::EdgeReader::EdgeReader(
+    const std::uint8_t* begin, const std::uint8_t* end, int index)
+    : position_{begin}, end_{end}, previous_{index}, first_{true}
+{
+}
+
+
+template <int Fields>
+bool VarintDigraph<Fields>::EdgeReader::next(int& target, Payload& payload)
+{
+    if (position_ == end_)
+    {
+        return false;
+    }
+
+    std::uint32_t delta = readVarint();
+
+    if (first_)
+    {
+        // The first difference can be negative, so it's stored "zigzag"
+        // encoded: 0, -1, 1, -2, 2, ... as 0, 1, 2, 3, 4, ...
+        target = previous_ + static_cast<int>((delta >> 1) ^ (0u - (delta & 1)));
+        first_ = false;
+    }
+    else
+    {
+        target = previous_ + static_cast<int>(delta);
+    }
+
+    previous_ = target;
+
+    for (std::uint32_t& field : payload)
+    {
+        field = readVarint();
+    }
+
+    return true;
+}
+
+
+template <int Fields>
+std::uint32_t VarintDigraph<Fields>::EdgeReader::readVarint()
+{
+    std::uint32_t value = 0;
+    int shift = 0;
+
+    while (*position_ & 0x80)
+    {
+        value |= static_cast<std::uint32_t>(*position_++ & 0x7f) << shift;
+        shift += 7;
+    }
+
+    return value | static_cast<std::uint32_t>(*position_++) << shift;
+}
+
+
+template <int Fields>
+VarintDigraph<Fields>::VarintDigraph()
+    : offsets_{0}, edgeCount_{0}
+{
+}
+
+
+template <int Fields>
+template <typename PayloadFunc>
+VarintDigraph<Fields>::VarintDigraph(const CompactDigraph& graph, PayloadFunc payloadFunc)
+    : edgeCount_{graph.edgeCount()}
+{
+    offsets_.reserve(graph.vertexCount() + 1);
+    offsets_.push_back(0);
+    vertexNumbers_.reserve(graph.vertexCount());
+    indexes_.reserve(graph.vertexCount());
+
+    std::vector<std::pair<int, int>> edges;
+
+    for (int v = 0; v < graph.vertexCount(); ++v)
+    {
+        vertexNumbers_.push_back(graph.vertexNumber(v));
+        indexes_.emplace_back(graph.vertexNumber(v), v);
+
+        // Edges to the same vertex are kept in their original order.
+        edges.clear();
+
+        for (int e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e)
+        {
+            edges.emplace_back(graph.target(e), e);
+        }
+
+        std::sort(edges.begin(), edges.end());
+
+        int previous = v;
+        bool first = true;
+
+        for (const std::pair<int, int>& edge : edges)
+        {
+            int delta = edge.first - previous;
+
+            writeVarint(bytes_, first ? zigzag(delta) : static_cast<std::uint32_t>(delta));
+
+            for (std::uint32_t field : static_cast<Payload>(payloadFunc(edge.second)))
+            {
+                writeVarint(bytes_, field);
+            }
+
+            previous = edge.first;
+            first = false;
+        }
+
+        offsets_.push_back(static_cast<std::uint32_t>(bytes_.size()));
+    }
+
+    std::sort(indexes_.begin(), indexes_.end());
+    bytes_.shrink_to_fit();
+}
+
+
+template <int Fields>
+int VarintDigraph<Fields>::vertexCount() const noexcept
+{
+    return static_cast<int>(vertexNumbers_.size());
+}
+
+
+template <int Fields>
+int VarintDigraph<Fields>::edgeCount() const noexcept
+{
+    return edgeCount_;
+}
+
+
+template <int Fields>
+int VarintDigraph<Fields>::vertexNumber(int index) const
+{
+    return vertexNumbers_.at(index);
+}
+
+
+template <int Fields>
+int VarintDigraph<Fields>::indexOf(int vertex) const
+{
+    auto found = std::lower_bound(
+        indexes_.begin(), indexes_.end(), std::make_pair(vertex, 0));
+
+    if (found == indexes_.end() || found->first != vertex)
+    {
+        throw DigraphException("Vertex does not exist!\n");
+    }
+
+    return found->second;
+}
+
+
+template <int Fields>
+typename VarintDigraph<Fields>::EdgeReader VarintDigraph<Fields>::edges(int index) const
+{
+    return EdgeReader{
+        bytes_.data() + offsets_[index], bytes_.data() + offsets_[index + 1], index};
+}
+
+
+template <int Fields>
+template <typename Distance, typename WeightFunc>
+CompactSearchResult<Distance> VarintDigraph<Fields>::findShortestPaths(
+    int startIndex, WeightFunc weightFunc, int endIndex) const
+{
+    CompactSearchResult<Distance> result{
+        std::vector<Distance>(vertexCount(), std::numeric_limits<Distance>::max()),
+        std::vector<int>(vertexCount(), -1),
+        std::vector<int>(vertexCount(), -1)};
+
+    std::vector<bool> known(vertexCount(), false);
+    DIGRAPH_COUNT(allocations, 4);
+
+    typedef std::pair<Distance, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+
+    result.distance[startIndex] = 0;
+    pq.push(Entry{0, startIndex});
+    DIGRAPH_COUNT(heapPushes, 1);
+
+    while (!pq.empty())
+    {
+        int v = pq.top().second;
+        pq.pop();
+        DIGRAPH_COUNT(heapPops, 1);
+
+        if (known[v])
+        {
+            DIGRAPH_COUNT(stalePops, 1);
+            continue;
+        }
+
+        known[v] = true;
+        DIGRAPH_COUNT(verticesSettled, 1);
+        DIGRAPH_COUNT(bytesTouched, offsets_[v + 1] - offsets_[v]);
+
+        if (v == endIndex)
+        {
+            break;
+        }
+
+        EdgeReader reader = edges(v);
+        int w;
+        Payload payload;
+
+        for (int position = 0; reader.next(w, payload); ++position)
+        {
+            DIGRAPH_COUNT(edgesRelaxed, 1);
+
+            if (known[w])
+            {
+                continue;
+            }
+
+            Distance weight = result.distance[v] + weightFunc(payload);
+
+            if (weight < result.distance[w])
+            {
+                result.distance[w] = weight;
+                result.previousVertex[w] = v;
+                result.previousEdge[w] = position;
+                pq.push(Entry{weight, w});
+                DIGRAPH_COUNT(heapPushes, 1);
+            }
+        }
+    }
+
+    return result;
+}
+
+
+template <int Fields>
+std::size_t VarintDigraph<Fields>::bytes() const noexcept
+{
+    return bytes_.capacity() * sizeof(std::uint8_t)
+        + offsets_.capacity() * sizeof(std::uint32_t)
+        + vertexNumbers_.capacity() * sizeof(int)
+        + indexes_.capacity() * sizeof(std::pair<int, int>);
+}
+
+
+template <int Fields>
+MemoryUsage VarintDigraph<Fields>::memoryUsage() const noexcept
+{
+    MemoryUsage usage;
+    usage.vertexTable = bytesAllocated(vertexNumbers_);
+    usage.adjacency = bytesAllocated(bytes_) + bytesAllocated(offsets_);
+    usage.indexes = bytesAllocated(indexes_);
+    return usage;
+}
+
+
+template <int Fields>
+std::uint32_t VarintDigraph<Fields>::zigzag(int value)
+{
+    return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+}
+
+
+template <int Fields>
+void VarintDigraph<Fields>::writeVarint(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+
+
+#endif // VARINTDIGRAPH_HPP
@@ -0,0 +1,71 @@
+// Benchmarks.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Declares the benchmarks that expmain can run, each of which writes its
+// results to the given output stream, along with a small timing helper
+// they share.
+
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include <chrono>
+#include <ostream>
+
+
+
+// secondsSince() returns the number of seconds since the given time.
+inline double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+
+// runReorderBenchmark() compares the speed of Dijkstra's algorithm on
+// CompactDigraphs whose vertices are stored in each VertexOrder.
+void runReorderBenchmark(std::ostream& out);
+
+
+// runOverlayBenchmark() measures how long it takes to build and customize
+// a RouteOverlay, and compares its queries to Dijkstra's algorithm.
+void runOverlayBenchmark(std::ostream& out);
+
+
+// runCompressionBenchmark() compares the memory used by a VarintDigraph
+// with a Digraph and a CompactDigraph, and the speed of searching it.
+void runCompressionBenchmark(std::ostream& out);
+
+
+// runComponentsBenchmark() measures how long it takes to find the strongly
+// connected components of a large graph with different numbers of threads.
+void runComponentsBenchmark(std::ostream& out);
+
+
+// runClosureBenchmark() measures how long it takes to remove thousands of
+// vertices from a Digraph, as a burst of road closures would.
+void runClosureBenchmark(std::ostream& out);
+
+
+// runLabelsBenchmark() measures how long it takes to build HubLabels, on
+// one thread and on all of them, and compares their queries to Dijkstra's
+// algorithm.
+void runLabelsBenchmark(std::ostream& out);
+
+
+// runNumaBenchmark() compares the number of searches per second from
+// every hardware thread when they share one copy of a graph with when
+// each searches a copy in its own NUMA node's memory.
+void runNumaBenchmark(std::ostream& out);
+
+
+// runProfilesBenchmark() compares the memory used by time-dependent
+// weights with a copy of the weights per time slice, and measures how
+// long a time-dependent search takes at different departure times.
+void runProfilesBenchmark(std::ostream& out);
+
+
+
+#endif // BENCHMARKS_HPP
+
@@ -0,0 +1,67 @@
+// ClosureBenchmark.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "SyntheticRoadNetwork.hpp"
+
+
+namespace
+{
+    const int networkWidth = 500;
+    const int closures = 5000;
+
+    // Removing vertices the old way, by searching every edge list each
+    // time, is measured on only this many closures, and scaled up.
+    const int eagerClosures = 50;
+}
+
+
+void runClosureBenchmark(std::ostream& out)
+{
+    SyntheticRoadNetwork network = makeSyntheticRoadNetwork(networkWidth, 42);
+
+    std::vector<int> vertices = network.vertices();
+    std::shuffle(vertices.begin(), vertices.end(), std::mt19937{2018});
+    vertices.resize(closures);
+
+    out << "Removing " << closures << " vertices from a " << network.vertexCount()
+        << "-vertex, " << network.edgeCount() << "-edge synthetic road network" << std::endl;
+
+    out << std::fixed << std::setprecision(3);
+
+    SyntheticRoadNetwork eager = network;
+    auto eagerStart = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < eagerClosures; ++i)
+    {
+        eager.removeVertex(vertices[i]);
+        eager.compact();
+    }
+
+    double eagerSeconds = secondsSince(eagerStart) * closures / eagerClosures;
+
+    SyntheticRoadNetwork lazy = network;
+    auto lazyStart = std::chrono::steady_clock::now();
+
+    for (int vertex : vertices)
+    {
+        lazy.removeVertex(vertex);
+    }
+
+    double lazySeconds = secondsSince(lazyStart);
+
+    auto compactStart = std::chrono::steady_clock::now();
+    lazy.compact();
+    double compactSeconds = secondsSince(compactStart);
+
+    out << "  compacting after every removal ~" << eagerSeconds << "s (estimated from "
+        << eagerClosures << ")" << std::endl
+        << "  tombstones " << lazySeconds << "s, then compact() " << compactSeconds
+        << "s, " << lazy.edgeCount() << " edges left" << std::endl;
+}
@@ -0,0 +1,49 @@
+// ComponentsBenchmark.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+#include "Benchmarks.hpp"
+#include "StronglyConnectedComponents.hpp"
+#include "SyntheticRoadNetwork.hpp"
+
+
+namespace
+{
+    const int networkWidth = 700;
+}
+
+
+void runComponentsBenchmark(std::ostream& out)
+{
+    SyntheticRoadNetwork network = makeSyntheticRoadNetwork(networkWidth, 39);
+    CompactDigraph graph{network, [](int, const SyntheticSegment&) { }, VertexOrder::BreadthFirst};
+
+    out << "Strongly connected components of a " << graph.vertexCount() << "-vertex, "
+        << graph.edgeCount() << "-edge synthetic road network" << std::endl;
+
+    out << std::fixed << std::setprecision(3);
+
+    unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (unsigned int threads = 1; ; threads = std::min(threads * 2, hardwareThreads))
+    {
+        auto start = std::chrono::steady_clock::now();
+        StronglyConnectedComponents components{graph, threads};
+        double seconds = secondsSince(start);
+
+        int largest = components.largestComponent();
+
+        out << "  " << std::setw(3) << threads << " threads " << seconds << "s, "
+            << components.componentCount() << " components, largest "
+            << components.componentSize(largest) << " vertices" << std::endl;
+
+        if (threads == hardwareThreads)
+        {
+            break;
+        }
+    }
+}
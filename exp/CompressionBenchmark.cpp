@@ -0,0 +1,159 @@
+// CompressionBenchmark.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "SyntheticRoadNetwork.hpp"
+#include "VarintDigraph.hpp"
+
+
+namespace
+{
+    const int networkWidth = 500;
+    const int queries = 100;
+
+    // These match the quantization that CompressedRoadMap uses.
+    const double milesScale = 1000.0;
+    const double milesPerHourScale = 10.0;
+
+
+    // The memory used by a Digraph can only be estimated, from the sizes
+    // of the nodes it allocates; each allocation is assumed to cost two
+    // words more than its size.
+    std::size_t estimateDigraphBytes(int vertexCount, int edgeCount)
+    {
+        const std::size_t overhead = 2 * sizeof(void*);
+
+        std::size_t edgeNode = sizeof(DigraphEdge<SyntheticSegment>) + 2 * sizeof(void*) + overhead;
+        std::size_t vertex = sizeof(DigraphVertex<int, SyntheticSegment>)
+            + 2 * sizeof(std::shared_ptr<int>) + overhead;
+        std::size_t mapNode = sizeof(std::pair<const int, std::shared_ptr<int>>)
+            + 4 * sizeof(void*) + overhead;
+
+        return vertexCount * (vertex + mapNode) + edgeCount * edgeNode;
+    }
+
+
+    // A CompactDigraph with one weight array per EdgeInfo field stores an
+    // offset per vertex, a target per edge, and the vertex numbers both
+    // ways round.
+    std::size_t compactDigraphBytes(const CompactDigraph& graph, int fields)
+    {
+        return (graph.vertexCount() + 1) * sizeof(int)
+            + graph.edgeCount() * (sizeof(int) + fields * sizeof(double))
+            + graph.vertexCount() * (sizeof(int) + sizeof(std::pair<int, int>));
+    }
+}
+
+
+void runCompressionBenchmark(std::ostream& out)
+{
+    SyntheticRoadNetwork network = makeSyntheticRoadNetwork(networkWidth, 38);
+
+    std::vector<double> miles;
+    std::vector<double> milesPerHour;
+
+    CompactDigraph graph{
+        network,
+        [&](int, const SyntheticSegment& segment)
+        {
+            miles.push_back(segment.miles);
+            milesPerHour.push_back(segment.milesPerHour);
+        },
+        VertexOrder::BreadthFirst};
+
+    typedef VarintDigraph<2> Graph;
+
+    auto encodeStart = std::chrono::steady_clock::now();
+
+    Graph compressed{
+        graph,
+        [&](int edge)
+        {
+            return Graph::Payload{
+                static_cast<std::uint32_t>(std::lround(miles[edge] * milesScale)),
+                static_cast<std::uint32_t>(std::lround(milesPerHour[edge] * milesPerHourScale))};
+        }};
+
+    double encodeSeconds = secondsSince(encodeStart);
+
+    out << "Compressed adjacency on a " << graph.vertexCount() << "-vertex, "
+        << graph.edgeCount() << "-edge synthetic road network, "
+        << queries << " queries" << std::endl;
+
+    out << std::fixed << std::setprecision(1);
+
+    double edges = graph.edgeCount();
+    std::size_t digraphBytes = estimateDigraphBytes(graph.vertexCount(), graph.edgeCount());
+    std::size_t compactBytes = compactDigraphBytes(graph, 2);
+
+    out << "  bytes per edge:  Digraph ~" << digraphBytes / edges
+        << "  CompactDigraph " << compactBytes / edges
+        << "  VarintDigraph " << compressed.bytes() / edges
+        << " (encoded in " << std::setprecision(3) << encodeSeconds << "s)" << std::endl;
+
+    std::vector<double> hours;
+
+    for (std::size_t e = 0; e < miles.size(); ++e)
+    {
+        hours.push_back(miles[e] / milesPerHour[e]);
+    }
+
+    std::mt19937 random{2018};
+    std::uniform_int_distribution<int> vertex{0, graph.vertexCount() - 1};
+    std::vector<std::pair<int, int>> trips;
+
+    for (int i = 0; i < queries; ++i)
+    {
+        trips.emplace_back(vertex(random), vertex(random));
+    }
+
+    auto compactStart = std::chrono::steady_clock::now();
+    std::vector<double> expected;
+
+    for (const auto& trip : trips)
+    {
+        expected.push_back(
+            graph.findShortestPaths<double>(
+                trip.first, hours.data(), trip.second).distance[trip.second]);
+    }
+
+    double compactSeconds = secondsSince(compactStart);
+
+    auto varintStart = std::chrono::steady_clock::now();
+    double worstError = 0.0;
+
+    for (std::size_t i = 0; i < trips.size(); ++i)
+    {
+        double distance = compressed.findShortestPaths<double>(
+            trips[i].first,
+            [](const Graph::Payload& payload)
+            {
+                return (payload[0] / milesScale) / (payload[1] / milesPerHourScale);
+            },
+            trips[i].second).distance[trips[i].second];
+
+        if (expected[i] > 0.0)
+        {
+            worstError = std::max(worstError, std::abs(distance - expected[i]) / expected[i]);
+        }
+    }
+
+    double varintSeconds = secondsSince(varintStart);
+
+    out << "  fastest routes:  CompactDigraph " << compactSeconds << "s"
+        << "  VarintDigraph " << varintSeconds << "s"
+        << "  slowdown " << std::setprecision(2) << varintSeconds / compactSeconds << "x"
+        << "  worst relative error " << std::scientific << worstError
+        << std::defaultfloat << std::endl;
+}
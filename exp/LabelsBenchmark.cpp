@@ -0,0 +1,120 @@
+// LabelsBenchmark.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "HubLabels.hpp"
+#include "SyntheticRoadNetwork.hpp"
+
+
+namespace
+{
+    const int networkWidth = 150;
+    const int queries = 10000;
+}
+
+
+void runLabelsBenchmark(std::ostream& out)
+{
+    SyntheticRoadNetwork network = makeSyntheticRoadNetwork(networkWidth, 46);
+
+    std::vector<double> hours;
+
+    CompactDigraph graph{
+        network,
+        [&](int, const SyntheticSegment& segment)
+        {
+            hours.push_back(segment.miles / segment.milesPerHour);
+        },
+        VertexOrder::BreadthFirst};
+
+    out << "HubLabels on a " << graph.vertexCount() << "-vertex, "
+        << graph.edgeCount() << "-edge synthetic road network, "
+        << queries << " queries" << std::endl;
+
+    out << std::fixed << std::setprecision(3);
+
+    auto buildStart = std::chrono::steady_clock::now();
+    HubLabels<double> labels{graph, hours.data()};
+    double buildSeconds = secondsSince(buildStart);
+
+    auto singleStart = std::chrono::steady_clock::now();
+    HubLabels<double> singleLabels{graph, hours.data(), 1};
+    double singleSeconds = secondsSince(singleStart);
+
+    out << "  build " << buildSeconds << "s (" << singleSeconds
+        << "s on one thread of " << std::thread::hardware_concurrency() << ")"
+        << ", entries per vertex "
+        << std::setprecision(1)
+        << static_cast<double>(labels.entryCount()) / graph.vertexCount()
+        << " (" << static_cast<double>(singleLabels.entryCount()) / graph.vertexCount()
+        << " on one thread)" << std::setprecision(3) << std::endl;
+
+    std::mt19937 random{2018};
+    std::uniform_int_distribution<int> vertex{0, graph.vertexCount() - 1};
+    std::vector<std::pair<int, int>> trips;
+
+    for (int i = 0; i < queries; ++i)
+    {
+        trips.emplace_back(vertex(random), vertex(random));
+    }
+
+    // Dijkstra's algorithm is far slower, so it's only run for some of the
+    // trips, and its time scaled up.
+    const int dijkstraQueries = queries / 50;
+    auto dijkstraStart = std::chrono::steady_clock::now();
+    std::vector<double> expected;
+
+    for (int i = 0; i < dijkstraQueries; ++i)
+    {
+        expected.push_back(
+            graph.findShortestPaths<double>(
+                trips[i].first, hours.data(), trips[i].second).distance[trips[i].second]);
+    }
+
+    double dijkstraSeconds = secondsSince(dijkstraStart) * queries / dijkstraQueries;
+
+    auto distanceStart = std::chrono::steady_clock::now();
+    int unreachable = 0;
+
+    for (const auto& trip : trips)
+    {
+        if (labels.distance(trip.first, trip.second) == std::numeric_limits<double>::max())
+        {
+            ++unreachable;
+        }
+    }
+
+    double distanceSeconds = secondsSince(distanceStart);
+
+    auto pathStart = std::chrono::steady_clock::now();
+    int mismatches = 0;
+
+    for (int i = 0; i < queries; ++i)
+    {
+        HubLabelPath<double> path = labels.findShortestPath(trips[i].first, trips[i].second);
+
+        if (i < dijkstraQueries && std::abs(path.distance - expected[i]) > 1e-9 * expected[i])
+        {
+            ++mismatches;
+        }
+    }
+
+    double pathSeconds = secondsSince(pathStart);
+
+    out << std::setprecision(2)
+        << "  per query: dijkstra " << dijkstraSeconds / queries * 1e6 << "us"
+        << "  distance " << distanceSeconds / queries * 1e6 << "us"
+        << "  path " << pathSeconds / queries * 1e6 << "us"
+        << "  speedup " << std::setprecision(0) << dijkstraSeconds / distanceSeconds << "x"
+        << "  mismatches " << mismatches
+        << "  unreachable " << unreachable << std::endl;
+}
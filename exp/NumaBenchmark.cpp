@@ -0,0 +1,128 @@
+// NumaBenchmark.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "CompactDigraph.hpp"
+#include "NumaTopology.hpp"
+#include "SyntheticRoadNetwork.hpp"
+
+
+namespace
+{
+    const int networkWidth = 500;
+    const double secondsPerRun = 3.0;
+
+
+    // A Replica is what's searched: a graph and its driving times.
+    struct Replica
+    {
+        CompactDigraph graph;
+        std::vector<double> hours;
+    };
+
+
+    std::unique_ptr<Replica> buildReplica(const SyntheticRoadNetwork& network)
+    {
+        auto replica = std::make_unique<Replica>();
+
+        replica->graph = CompactDigraph{
+            network,
+            [&](int, const SyntheticSegment& segment)
+            {
+                replica->hours.push_back(segment.miles / segment.milesPerHour);
+            },
+            VertexOrder::BreadthFirst};
+
+        return replica;
+    }
+
+
+    // queriesPerSecond() runs searches between random vertices on one
+    // pinned thread per hardware thread for a fixed time, each searching
+    // the replica chosen by the given function, and returns how many
+    // searches were finished per second.
+    template <typename Choose>
+    double queriesPerSecond(const NumaTopology& topology, Choose choose)
+    {
+        std::atomic<bool> stop{false};
+        std::atomic<long long> finished{0};
+        std::vector<std::thread> threads;
+        int threadCount = 0;
+
+        for (int node = 0; node < topology.nodeCount(); ++node)
+        {
+            threadCount += static_cast<int>(topology.cpusOf(node).size());
+        }
+
+        for (int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    int node = t % topology.nodeCount();
+                    topology.pinCurrentThread(node);
+
+                    const Replica& replica = choose(node);
+                    std::mt19937 random(t);
+                    std::uniform_int_distribution<int> vertex{0, replica.graph.vertexCount() - 1};
+
+                    while (!stop)
+                    {
+                        int start = vertex(random);
+                        int end = vertex(random);
+                        replica.graph.findShortestPaths<double>(start, replica.hours.data(), end);
+                        ++finished;
+                    }
+                });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(secondsPerRun));
+        stop = true;
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        return finished / secondsSince(start);
+    }
+}
+
+
+void runNumaBenchmark(std::ostream& out)
+{
+    NumaTopology topology = NumaTopology::detect();
+    SyntheticRoadNetwork network = makeSyntheticRoadNetwork(networkWidth, 46);
+    NumaReplicas<Replica> replicas{&topology, [&] { return buildReplica(network); }};
+
+    out << "Searches of a " << replicas.replica(0).graph.vertexCount()
+        << "-vertex synthetic road network from every hardware thread, on "
+        << topology.nodeCount() << " NUMA node(s)" << std::endl;
+
+    if (topology.nodeCount() == 1)
+    {
+        out << "  (with one node, both runs search the same replica)" << std::endl;
+    }
+
+    out << std::fixed << std::setprecision(1);
+
+    double shared = queriesPerSecond(
+        topology, [&](int) -> const Replica& { return replicas.replica(0); });
+
+    double local = queriesPerSecond(
+        topology, [&](int node) -> const Replica& { return replicas.replica(node); });
+
+    out << "  one replica on node 0     " << shared << " searches/s" << std::endl;
+    out << "  one replica on each node  " << local << " searches/s ("
+        << std::setprecision(2) << local / shared << "x)" << std::endl;
+}
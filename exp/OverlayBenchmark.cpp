@@ -0,0 +1,115 @@
+// OverlayBenchmark.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "RouteOverlay.hpp"
+#include "SyntheticRoadNetwork.hpp"
+
+
+namespace
+{
+    const int networkWidth = 500;
+    const int queries = 200;
+}
+
+
+void runOverlayBenchmark(std::ostream& out)
+{
+    SyntheticRoadNetwork network = makeSyntheticRoadNetwork(networkWidth, 46);
+
+    std::vector<double> miles;
+    std::vector<double> hours;
+
+    CompactDigraph graph{
+        network,
+        [&](int, const SyntheticSegment& segment)
+        {
+            miles.push_back(segment.miles);
+            hours.push_back(segment.miles / segment.milesPerHour);
+        },
+        VertexOrder::BreadthFirst};
+
+    out << "RouteOverlay on a " << graph.vertexCount() << "-vertex, "
+        << graph.edgeCount() << "-edge synthetic road network, "
+        << queries << " queries per metric" << std::endl;
+
+    out << std::fixed << std::setprecision(3);
+
+    auto buildStart = std::chrono::steady_clock::now();
+    RouteOverlay overlay{graph};
+    out << "  build " << secondsSince(buildStart) << "s, cells per level:";
+
+    for (int level = 0; level < overlay.levelCount(); ++level)
+    {
+        out << " " << overlay.cellCount(level);
+    }
+
+    out << std::endl;
+
+    std::mt19937 random{2018};
+    std::uniform_int_distribution<int> vertex{0, graph.vertexCount() - 1};
+    std::vector<std::pair<int, int>> trips;
+
+    for (int i = 0; i < queries; ++i)
+    {
+        trips.emplace_back(vertex(random), vertex(random));
+    }
+
+    for (const auto& named : std::vector<std::pair<const char*, std::vector<double>*>>{
+             {"miles", &miles}, {"hours", &hours}})
+    {
+        auto customizeStart = std::chrono::steady_clock::now();
+        OverlayMetric metric = overlay.customize(*named.second);
+        double customizeSeconds = secondsSince(customizeStart);
+
+        auto singleStart = std::chrono::steady_clock::now();
+        overlay.customize(*named.second, 1);
+        double singleSeconds = secondsSince(singleStart);
+
+        auto dijkstraStart = std::chrono::steady_clock::now();
+        std::vector<double> expected;
+
+        for (const auto& trip : trips)
+        {
+            expected.push_back(
+                graph.findShortestPaths<double>(
+                    trip.first, named.second->data(), trip.second).distance[trip.second]);
+        }
+
+        double dijkstraSeconds = secondsSince(dijkstraStart);
+
+        auto overlayStart = std::chrono::steady_clock::now();
+        int mismatches = 0;
+
+        for (std::size_t i = 0; i < trips.size(); ++i)
+        {
+            OverlayPath path = overlay.findShortestPath(metric, trips[i].first, trips[i].second);
+
+            if (std::abs(path.weight - expected[i]) > 1e-9 * expected[i])
+            {
+                ++mismatches;
+            }
+        }
+
+        double overlaySeconds = secondsSince(overlayStart);
+
+        out << "  " << std::setw(5) << named.first
+            << "  customize " << customizeSeconds << "s ("
+            << singleSeconds << "s on one thread of "
+            << std::thread::hardware_concurrency() << ")"
+            << "  dijkstra " << dijkstraSeconds << "s"
+            << "  overlay " << overlaySeconds << "s"
+            << "  speedup " << std::setprecision(1) << dijkstraSeconds / overlaySeconds << "x"
+            << std::setprecision(3)
+            << "  mismatches " << mismatches << std::endl;
+    }
+}
+
@@ -0,0 +1,111 @@
+// ProfilesBenchmark.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "CompactDigraph.hpp"
+#include "SpeedProfiles.hpp"
+#include "SyntheticRoadNetwork.hpp"
+
+
+namespace
+{
+    const int networkWidth = 300;
+    const int queries = 50;
+
+    // The alternative to time-dependent weights: a copy of every edge's
+    // weight for each 15-minute slice of the day.
+    const int slicesPerDay = 96;
+
+
+    // profileFor() returns the profile for a segment with the given usual
+    // speed: the faster the road, the more rush hour slows it down.
+    SpeedProfile profileFor(double milesPerHour)
+    {
+        double slowest = milesPerHour >= 55.0 ? 0.35 : milesPerHour >= 35.0 ? 0.6 : 0.85;
+
+        return SpeedProfile{{
+            {6.0, 1.0}, {8.0, slowest}, {10.0, 1.0},
+            {15.5, 1.0}, {17.5, slowest}, {19.5, 1.0}}};
+    }
+}
+
+
+void runProfilesBenchmark(std::ostream& out)
+{
+    SyntheticRoadNetwork network = makeSyntheticRoadNetwork(networkWidth, 46);
+
+    std::vector<double> freeFlowHours;
+    std::vector<int> profileOfEdge;
+    SpeedProfiles profiles;
+
+    CompactDigraph graph{
+        network,
+        [&](int, const SyntheticSegment& segment)
+        {
+            freeFlowHours.push_back(segment.miles / segment.milesPerHour);
+            profileOfEdge.push_back(profiles.add(profileFor(segment.milesPerHour)));
+        },
+        VertexOrder::BreadthFirst};
+
+    TimeDependentWeights weights{freeFlowHours, profileOfEdge, profiles};
+
+    std::size_t slicedBytes =
+        static_cast<std::size_t>(slicesPerDay) * graph.edgeCount() * sizeof(double);
+
+    out << "Time-dependent weights on a " << graph.vertexCount() << "-vertex, "
+        << graph.edgeCount() << "-edge synthetic road network, "
+        << profiles.profileCount() << " distinct profiles" << std::endl;
+
+    out << "  memory: " << weights.memoryUsage().total() << " bytes, against "
+        << slicedBytes << " for " << slicesPerDay << " time slices" << std::endl;
+
+    out << std::fixed << std::setprecision(2);
+
+    std::mt19937 random{2018};
+    std::uniform_int_distribution<int> vertex{0, graph.vertexCount() - 1};
+    std::vector<int> starts;
+
+    for (int i = 0; i < queries; ++i)
+    {
+        starts.push_back(vertex(random));
+    }
+
+    auto staticStart = std::chrono::steady_clock::now();
+
+    for (int start : starts)
+    {
+        graph.findShortestPaths<double>(start, freeFlowHours.data());
+    }
+
+    double staticSeconds = secondsSince(staticStart);
+
+    for (double departure : {3.0, 8.0, 17.5})
+    {
+        auto start = std::chrono::steady_clock::now();
+        double latest = 0.0;
+
+        for (int s : starts)
+        {
+            CompactSearchResult<double> result = graph.findEarliestArrivals(
+                s, departure, [&weights](int e, double t) { return weights.arrivalTime(e, t); });
+
+            for (int v = 0; v < graph.vertexCount(); ++v)
+            {
+                latest = std::max(latest, result.distance[v] - departure);
+            }
+        }
+
+        double seconds = secondsSince(start);
+
+        out << "  leaving at " << std::setw(5) << departure << "h: "
+            << seconds / queries * 1000.0 << "ms per search ("
+            << staticSeconds / queries * 1000.0 << "ms free-flowing, without profiles)"
+            << ", longest trip " << latest << "h" << std::endl;
+    }
+}
@@ -0,0 +1,94 @@
+// ReorderBenchmark.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmarks.hpp"
+#include "CompactDigraph.hpp"
+#include "SyntheticRoadNetwork.hpp"
+
+
+namespace
+{
+    const int networkWidth = 500;
+    const int queries = 20;
+
+
+    struct NamedOrder
+    {
+        std::string name;
+        VertexOrder order;
+    };
+}
+
+
+void runReorderBenchmark(std::ostream& out)
+{
+    SyntheticRoadNetwork network = makeSyntheticRoadNetwork(networkWidth, 46);
+
+    out << "Dijkstra on a " << network.vertexCount() << "-vertex, "
+        << network.edgeCount() << "-edge synthetic road network, "
+        << queries << " full searches per order" << std::endl;
+
+    // Every order is searched from the same vertex numbers.
+    std::vector<int> starts;
+    std::mt19937 random{2018};
+    std::uniform_int_distribution<int> vertex{0, network.vertexCount() - 1};
+
+    for (int i = 0; i < queries; ++i)
+    {
+        starts.push_back(vertex(random));
+    }
+
+    double baseline = 0;
+
+    for (const NamedOrder& named : std::vector<NamedOrder>{
+             {"number", VertexOrder::Number},
+             {"bfs", VertexOrder::BreadthFirst},
+             {"rcm", VertexOrder::ReverseCuthillMcKee},
+             {"degree", VertexOrder::Degree}})
+    {
+        std::vector<double> hours;
+
+        auto buildStart = std::chrono::steady_clock::now();
+
+        CompactDigraph graph{
+            network,
+            [&](int, const SyntheticSegment& segment)
+            {
+                hours.push_back(segment.miles / segment.milesPerHour);
+            },
+            named.order};
+
+        double buildSeconds = secondsSince(buildStart);
+
+        auto searchStart = std::chrono::steady_clock::now();
+        double checksum = 0;
+
+        for (int start : starts)
+        {
+            CompactSearchResult<double> result =
+                graph.findShortestPaths<double>(graph.indexOf(start), hours.data());
+            checksum += result.distance[graph.indexOf(starts[0])];
+        }
+
+        double searchSeconds = secondsSince(searchStart);
+
+        if (named.order == VertexOrder::Number)
+        {
+            baseline = searchSeconds;
+        }
+
+        out << std::fixed << std::setprecision(3)
+            << "  " << std::setw(7) << named.name
+            << "  build " << buildSeconds << "s"
+            << "  search " << searchSeconds << "s"
+            << "  speedup " << std::setprecision(2) << baseline / searchSeconds << "x"
+            << "  (checksum " << std::setprecision(3) << checksum << ")" << std::endl;
+    }
+}
+
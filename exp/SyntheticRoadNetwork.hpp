@@ -0,0 +1,87 @@
+// SyntheticRoadNetwork.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Generates Digraphs that look, structurally, like road networks, for use
+// in the benchmarks: a square grid of intersections, most of them joined to
+// their neighbors by two-way roads, with the vertex numbers shuffled so that
+// (as with real map data) they say nothing about where a vertex is.
+
+#ifndef SYNTHETICROADNETWORK_HPP
+#define SYNTHETICROADNETWORK_HPP
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Digraph.hpp"
+
+
+
+// A SyntheticSegment is the EdgeInfo of a synthetic road network, shaped
+// like the application's RoadSegment.
+struct SyntheticSegment
+{
+    double miles;
+    double milesPerHour;
+};
+
+
+typedef Digraph<int, SyntheticSegment> SyntheticRoadNetwork;
+
+
+
+inline SyntheticRoadNetwork makeSyntheticRoadNetwork(int width, unsigned int seed)
+{
+    std::mt19937 random{seed};
+    std::uniform_real_distribution<double> miles{0.1, 3.0};
+    std::uniform_int_distribution<int> speed{0, 4};
+    std::bernoulli_distribution present{0.97};
+
+    std::vector<int> numbers(width * width);
+
+    for (int i = 0; i < width * width; ++i)
+    {
+        numbers[i] = i;
+    }
+
+    std::shuffle(numbers.begin(), numbers.end(), random);
+
+    SyntheticRoadNetwork network;
+
+    for (int i = 0; i < width * width; ++i)
+    {
+        network.addVertex(numbers[i], i);
+    }
+
+    for (int row = 0; row < width; ++row)
+    {
+        for (int column = 0; column < width; ++column)
+        {
+            int v = numbers[row * width + column];
+
+            if (column + 1 < width && present(random))
+            {
+                int w = numbers[row * width + column + 1];
+                SyntheticSegment segment{miles(random), 25.0 + 10 * speed(random)};
+                network.addEdge(v, w, segment);
+                network.addEdge(w, v, segment);
+            }
+
+            if (row + 1 < width && present(random))
+            {
+                int w = numbers[(row + 1) * width + column];
+                SyntheticSegment segment{miles(random), 25.0 + 10 * speed(random)};
+                network.addEdge(v, w, segment);
+                network.addEdge(w, v, segment);
+            }
+        }
+    }
+
+    return network;
+}
+
+
+
+#endif // SYNTHETICROADNETWORK_HPP
+
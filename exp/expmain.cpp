@@ -6,11 +6,43 @@
 // Do whatever you'd like here.  This is intended to allow you to experiment
 // with your code, outside of the context of the broader program or Google
 // Test.
+//
+// Run with the name of a benchmark (see Benchmarks.hpp) as its argument to
+// run that benchmark, or with no arguments to list them.
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include "Benchmarks.hpp"
 
 
-int main()
+int main(int argc, char** argv)
 {
+    const std::map<std::string, std::function<void(std::ostream&)>> benchmarks{
+        {"reorder", runReorderBenchmark},
+        {"overlay", runOverlayBenchmark},
+        {"compression", runCompressionBenchmark},
+        {"components", runComponentsBenchmark},
+        {"closures", runClosureBenchmark},
+        {"labels", runLabelsBenchmark},
+        {"numa", runNumaBenchmark},
+        {"profiles", runProfilesBenchmark}
+    };
+
+    if (argc < 2 || benchmarks.count(argv[1]) == 0)
+    {
+        std::cout << "Benchmarks:" << std::endl;
+
+        for (const auto& benchmark : benchmarks)
+        {
+            std::cout << "    " << benchmark.first << std::endl;
+        }
+
+        return 0;
+    }
 
+    benchmarks.at(argv[1])(std::cout);
 
     return 0;
 }
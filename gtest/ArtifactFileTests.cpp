@@ -0,0 +1,148 @@
+// ArtifactFileTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that an ArtifactFile reads back what an
+// ArtifactWriter wrote, and that stale or damaged files are rejected.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ArtifactFile.hpp"
+
+
+namespace
+{
+    std::string temporaryPath(const std::string& name)
+    {
+        return testing::TempDir() + "ArtifactFileTests." + name;
+    }
+
+
+    std::uint64_t hashOf(const std::vector<int>& values)
+    {
+        ContentHash hash;
+        hash.add(values);
+        return hash.value();
+    }
+
+
+    void writeSample(const std::string& path, std::uint64_t contentHash)
+    {
+        ArtifactWriter writer;
+        writer.addSection("order", std::vector<int>{3, 1, 2, 0});
+        writer.addSection("weights", std::vector<double>{1.5, 2.25, 0.125});
+        writer.addSection("flags", std::vector<char>{'a', 'b', 'c'});
+        writer.addSection("empty", std::vector<long>{});
+        writer.write(path, contentHash);
+    }
+}
+
+
+TEST(ArtifactFileTests, contentHashDependsOnContent)
+{
+    ASSERT_EQ(hashOf({1, 2, 3}), hashOf({1, 2, 3}));
+    ASSERT_NE(hashOf({1, 2, 3}), hashOf({1, 2, 4}));
+    ASSERT_NE(hashOf({1, 2, 3}), hashOf({3, 2, 1}));
+    ASSERT_NE(hashOf({1, 2}), hashOf({1, 2, 0}));
+}
+
+
+TEST(ArtifactFileTests, readsBackWhatWasWritten)
+{
+    std::string path = temporaryPath("roundTrip");
+    writeSample(path, 46);
+
+    {
+        ArtifactFile file{path, 46};
+
+        ASSERT_TRUE(file.hasSection("order"));
+        ASSERT_FALSE(file.hasSection("missing"));
+
+        ASSERT_EQ((std::vector<int>{3, 1, 2, 0}), file.copySection<int>("order"));
+        ASSERT_EQ((std::vector<char>{'a', 'b', 'c'}), file.copySection<char>("flags"));
+        ASSERT_TRUE(file.copySection<long>("empty").empty());
+
+        ArtifactSection<double> weights = file.section<double>("weights");
+        ASSERT_EQ(3u, weights.size);
+        ASSERT_EQ(2.25, weights[1]);
+        ASSERT_EQ(0, reinterpret_cast<std::uintptr_t>(weights.data) % alignof(double));
+
+        ASSERT_THROW(file.section<double>("order"), DigraphException);
+        ASSERT_THROW(file.section<int>("missing"), DigraphException);
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(ArtifactFileTests, rangesOfSectionsCanBeCopied)
+{
+    std::string path = temporaryPath("ranges");
+    writeSample(path, 46);
+
+    {
+        ArtifactFile file{path, 46};
+
+        ASSERT_EQ((std::vector<int>{1, 2}), file.copySection<int>("order", 1, 2));
+        ASSERT_EQ((std::vector<double>{0.125}), file.copySection<double>("weights", 2, 1));
+        ASSERT_TRUE(file.copySection<int>("order", 4, 0).empty());
+
+        // The pages a range was copied from can be read again afterward.
+        ASSERT_EQ((std::vector<int>{3, 1, 2, 0}), file.copySection<int>("order"));
+
+        ASSERT_THROW(file.copySection<int>("order", 3, 2), DigraphException);
+        ASSERT_THROW(file.copySection<int>("order", 5, 0), DigraphException);
+    }
+
+    std::remove(path.c_str());
+}
+
+
+TEST(ArtifactFileTests, staleFileIsRejected)
+{
+    std::string path = temporaryPath("stale");
+    writeSample(path, 46);
+
+    ASSERT_THROW((ArtifactFile{path, 47}), DigraphException);
+
+    std::remove(path.c_str());
+}
+
+
+TEST(ArtifactFileTests, missingOrDamagedFileIsRejected)
+{
+    std::string path = temporaryPath("damaged");
+    std::remove(path.c_str());
+
+    ASSERT_THROW((ArtifactFile{path, 46}), DigraphException);
+
+    {
+        std::ofstream out{path, std::ios::binary};
+        out << "This is not an artifact file, but it is long enough to be one.";
+    }
+
+    ASSERT_THROW((ArtifactFile{path, 46}), DigraphException);
+
+    // A file that was cut short is rejected, too.
+    writeSample(path, 46);
+    std::string contents;
+
+    {
+        std::ifstream in{path, std::ios::binary};
+        contents.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    }
+
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(contents.data(), contents.size() - 8);
+    }
+
+    ASSERT_THROW((ArtifactFile{path, 46}), DigraphException);
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,186 @@
+// AsyncSearchTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests for AsyncSearch, checking that its searches find the same
+// results as CompactDigraph's and that they can be stopped.
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AsyncSearch.hpp"
+
+
+namespace
+{
+    // makeLine() returns a graph in which each vertex has an edge to the
+    // next one, with weight 1, and the last one has an edge to the first.
+    Digraph<int, int> makeLine(int length)
+    {
+        Digraph<int, int> d;
+
+        for (int v = 0; v < length; ++v)
+        {
+            d.addVertex(v, v);
+        }
+
+        for (int v = 0; v < length; ++v)
+        {
+            d.addEdge(v, (v + 1) % length, 1);
+        }
+
+        return d;
+    }
+
+
+    std::vector<int> unitWeights(const CompactDigraph& c)
+    {
+        return std::vector<int>(c.edgeCount(), 1);
+    }
+}
+
+
+TEST(AsyncSearchTests, findsSameResultsAsCompactDigraph)
+{
+    Digraph<int, int> d = makeLine(1000);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> weights = unitWeights(c);
+
+    SearchExecutor executor{2};
+    AsyncSearch search{c, executor};
+
+    std::future<CompactSearchResult<long>> all = search.findShortestPaths<long>(10, weights.data());
+    std::future<SearchPath<long>> path = search.findShortestPath<long>(990, 5, weights.data());
+
+    ASSERT_EQ(c.findShortestPaths<long>(10, weights.data()).distance, all.get().distance);
+
+    SearchPath<long> result = path.get();
+    ASSERT_TRUE(result.reached);
+    ASSERT_EQ(15, result.distance);
+    ASSERT_EQ(15u, result.edges.size());
+}
+
+
+TEST(AsyncSearchTests, callsOnReadyOnceResultIsReady)
+{
+    Digraph<int, int> d = makeLine(100);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> weights = unitWeights(c);
+
+    SearchExecutor executor{1};
+    AsyncSearch search{c, executor};
+
+    std::promise<void> ready;
+    std::future<SearchPath<int>> path = search.findShortestPath<int>(
+        0, 50, weights.data(), nullptr, [&] { ready.set_value(); });
+
+    ready.get_future().wait();
+    ASSERT_EQ(std::future_status::ready, path.wait_for(std::chrono::seconds{0}));
+    ASSERT_EQ(50, path.get().distance);
+}
+
+
+TEST(AsyncSearchTests, exceptionFromOnReadyIsDiscarded)
+{
+    Digraph<int, int> d = makeLine(100);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> weights = unitWeights(c);
+
+    SearchExecutor executor{1};
+    AsyncSearch search{c, executor};
+
+    std::future<SearchPath<int>> first = search.findShortestPath<int>(
+        0, 50, weights.data(), nullptr, [] { throw std::runtime_error{"onReady"}; });
+
+    ASSERT_EQ(50, first.get().distance);
+
+    // The executor's only thread is still there to run another search.
+    std::future<SearchPath<int>> second = search.findShortestPath<int>(0, 20, weights.data());
+    ASSERT_EQ(20, second.get().distance);
+}
+
+
+TEST(AsyncSearchTests, indexOutOfRangeThrowsIntoFuture)
+{
+    Digraph<int, int> d = makeLine(100);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> weights = unitWeights(c);
+
+    SearchExecutor executor{1};
+    AsyncSearch search{c, executor};
+
+    std::future<CompactSearchResult<int>> all =
+        search.findShortestPaths<int>(100, weights.data());
+    ASSERT_THROW(all.get(), DigraphException);
+
+    std::future<SearchPath<int>> fromMissing =
+        search.findShortestPath<int>(-1, 50, weights.data());
+    ASSERT_THROW(fromMissing.get(), DigraphException);
+
+    std::future<SearchPath<int>> toMissing =
+        search.findShortestPath<int>(0, -1, weights.data());
+    ASSERT_THROW(toMissing.get(), DigraphException);
+
+    std::future<SearchPath<int>> toTooHigh =
+        search.findShortestPath<int>(0, 100, weights.data());
+    ASSERT_THROW(toTooHigh.get(), DigraphException);
+}
+
+
+TEST(AsyncSearchTests, cancelledSearchThrows)
+{
+    Digraph<int, int> d = makeLine(100);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> weights = unitWeights(c);
+
+    SearchExecutor executor{1};
+    AsyncSearch search{c, executor};
+
+    auto control = std::make_shared<SearchControl>();
+    control->cancel();
+
+    std::future<SearchPath<int>> path = search.findShortestPath<int>(0, 50, weights.data(), control);
+    ASSERT_THROW(path.get(), DigraphSearchStopped);
+}
+
+
+TEST(AsyncSearchTests, searchPastDeadlineThrows)
+{
+    Digraph<int, int> d = makeLine(100);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> weights = unitWeights(c);
+
+    SearchExecutor executor{1};
+    AsyncSearch search{c, executor};
+
+    auto control = std::make_shared<SearchControl>(SearchControl::Clock::now());
+
+    std::future<CompactSearchResult<int>> all =
+        search.findShortestPaths<int>(0, weights.data(), control);
+    ASSERT_THROW(all.get(), DigraphSearchStopped);
+}
+
+
+TEST(AsyncSearchTests, searchStopsPartWay)
+{
+    Digraph<int, int> d = makeLine(10000);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> weights = unitWeights(c);
+
+    int checks = 0;
+
+    ASSERT_THROW(
+        c.findShortestPaths<int>(0, weights.data(), -1, [&] { return ++checks == 3; }),
+        DigraphSearchStopped);
+
+    ASSERT_EQ(3, checks);
+
+    CompactSearchResult<int> result =
+        c.findShortestPaths<int>(0, weights.data(), -1, [] { return false; });
+    ASSERT_EQ(9999, result.distance[9999]);
+}
@@ -0,0 +1,214 @@
+// BoundedQueueTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that a BoundedQueue hands its elements over in
+// order, that push() and pop() wait while the queue is full and empty,
+// and that closing it lets consumers drain what's left.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+#include "BoundedQueue.hpp"
+
+
+namespace
+{
+    // Long enough that a thread that isn't waiting will have finished,
+    // so that one that hasn't finished can be taken to be waiting.  The
+    // checks made while another thread is running are EXPECTs, so that
+    // a failure still lets the thread be joined.
+    const std::chrono::milliseconds settle{50};
+}
+
+
+TEST(BoundedQueueTests, popsElementsInOrderPushed)
+{
+    BoundedQueue<int> queue{4};
+
+    for (int i = 1; i <= 4; ++i)
+    {
+        ASSERT_TRUE(queue.push(i));
+    }
+
+    for (int i = 1; i <= 4; ++i)
+    {
+        int element = 0;
+        ASSERT_TRUE(queue.pop(element));
+        ASSERT_EQ(i, element);
+    }
+}
+
+
+TEST(BoundedQueueTests, pushWaitsWhileQueueIsFull)
+{
+    BoundedQueue<int> queue{2};
+    queue.push(1);
+    queue.push(2);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer{[&] { pushed = queue.push(3); }};
+
+    std::this_thread::sleep_for(settle);
+    EXPECT_FALSE(pushed);
+
+    int element = 0;
+    EXPECT_TRUE(queue.pop(element));
+    producer.join();
+
+    ASSERT_TRUE(pushed);
+    ASSERT_EQ(1, element);
+
+    ASSERT_TRUE(queue.pop(element));
+    ASSERT_EQ(2, element);
+    ASSERT_TRUE(queue.pop(element));
+    ASSERT_EQ(3, element);
+}
+
+
+TEST(BoundedQueueTests, popWaitsUntilElementIsPushed)
+{
+    BoundedQueue<int> queue{2};
+
+    std::atomic<bool> popped{false};
+    int element = 0;
+    std::thread consumer{[&] { popped = queue.pop(element); }};
+
+    std::this_thread::sleep_for(settle);
+    EXPECT_FALSE(popped);
+
+    queue.push(7);
+    consumer.join();
+
+    ASSERT_TRUE(popped);
+    ASSERT_EQ(7, element);
+}
+
+
+TEST(BoundedQueueTests, popWaitsUntilQueueIsClosed)
+{
+    BoundedQueue<int> queue{2};
+
+    std::atomic<bool> finished{false};
+    std::atomic<bool> popped{true};
+    std::thread consumer{
+        [&]
+        {
+            int element;
+            popped = queue.pop(element);
+            finished = true;
+        }};
+
+    std::this_thread::sleep_for(settle);
+    EXPECT_FALSE(finished);
+
+    queue.close();
+    consumer.join();
+
+    ASSERT_FALSE(popped);
+}
+
+
+TEST(BoundedQueueTests, popDrainsRemainingElementsAfterClose)
+{
+    BoundedQueue<int> queue{4};
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+
+    int element = 0;
+    ASSERT_TRUE(queue.pop(element));
+    ASSERT_EQ(1, element);
+    ASSERT_TRUE(queue.pop(element));
+    ASSERT_EQ(2, element);
+
+    ASSERT_FALSE(queue.pop(element));
+    ASSERT_FALSE(queue.pop(element));
+}
+
+
+TEST(BoundedQueueTests, pushAfterCloseIsRefused)
+{
+    BoundedQueue<int> queue{4};
+    queue.close();
+
+    ASSERT_FALSE(queue.push(1));
+
+    int element = 0;
+    ASSERT_FALSE(queue.pop(element));
+}
+
+
+TEST(BoundedQueueTests, closeWakesPushWaitingOnFullQueue)
+{
+    BoundedQueue<int> queue{1};
+    queue.push(1);
+
+    std::atomic<bool> finished{false};
+    std::atomic<bool> pushed{true};
+    std::thread producer{
+        [&]
+        {
+            pushed = queue.push(2);
+            finished = true;
+        }};
+
+    std::this_thread::sleep_for(settle);
+    EXPECT_FALSE(finished);
+
+    queue.close();
+    producer.join();
+
+    ASSERT_FALSE(pushed);
+
+    // The element pushed before the queue was closed is still there.
+    int element = 0;
+    ASSERT_TRUE(queue.pop(element));
+    ASSERT_EQ(1, element);
+    ASSERT_FALSE(queue.pop(element));
+}
+
+
+TEST(BoundedQueueTests, everyElementReachesExactlyOneConsumer)
+{
+    BoundedQueue<int> queue{3};
+    std::atomic<long long> sum{0};
+    std::atomic<int> count{0};
+
+    std::thread consumers[4];
+
+    for (std::thread& consumer : consumers)
+    {
+        consumer = std::thread{
+            [&]
+            {
+                int element;
+
+                while (queue.pop(element))
+                {
+                    sum += element;
+                    ++count;
+                }
+            }};
+    }
+
+    bool pushed = true;
+
+    for (int i = 1; i <= 10000; ++i)
+    {
+        pushed = queue.push(i) && pushed;
+    }
+
+    queue.close();
+
+    for (std::thread& consumer : consumers)
+    {
+        consumer.join();
+    }
+
+    ASSERT_TRUE(pushed);
+    ASSERT_EQ(10000, count);
+    ASSERT_EQ(10000LL * 10001 / 2, sum);
+}
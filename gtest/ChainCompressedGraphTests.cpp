@@ -0,0 +1,136 @@
+// ChainCompressedGraphTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that a ChainCompressedGraph removes pass-through
+// vertices and still finds the same paths as a CompactDigraph.
+
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ChainCompressedGraph.hpp"
+
+
+namespace
+{
+    // makeSubdividedGrid() returns a grid of intersections whose roads
+    // (mostly two-way, some one-way) pass through a few shape points each,
+    // along with a separate cycle of one-way roads.
+    Digraph<int, double> makeSubdividedGrid(int width)
+    {
+        std::mt19937 random{37};
+        std::uniform_int_distribution<int> kind{0, 9};
+        std::uniform_int_distribution<int> shapePoints{0, 3};
+        std::uniform_real_distribution<double> weight{0.5, 10.0};
+
+        Digraph<int, double> d;
+        int next = width * width;
+
+        for (int v = 0; v < width * width; ++v)
+        {
+            d.addVertex(v, v);
+        }
+
+        auto addRoad = [&](int v, int w, bool twoWay)
+        {
+            int previous = v;
+
+            for (int i = shapePoints(random); i > 0; --i)
+            {
+                d.addVertex(next, next);
+                d.addEdge(previous, next, weight(random));
+
+                if (twoWay)
+                {
+                    d.addEdge(next, previous, weight(random));
+                }
+
+                previous = next++;
+            }
+
+            d.addEdge(previous, w, weight(random));
+
+            if (twoWay)
+            {
+                d.addEdge(w, previous, weight(random));
+            }
+        };
+
+        for (int v = 0; v < width * width; ++v)
+        {
+            if ((v + 1) % width != 0)
+            {
+                addRoad(v, v + 1, kind(random) != 0);
+            }
+
+            if (v + width < width * width)
+            {
+                addRoad(v + width, v, kind(random) != 0);
+            }
+        }
+
+        for (int i = 0; i < 5; ++i)
+        {
+            d.addVertex(next + i, next + i);
+        }
+
+        for (int i = 0; i < 5; ++i)
+        {
+            d.addEdge(next + i, next + (i + 1) % 5, weight(random));
+        }
+
+        return d;
+    }
+}
+
+
+TEST(ChainCompressedGraphTests, removesPassThroughVertices)
+{
+    Digraph<int, double> d = makeSubdividedGrid(8);
+    CompactDigraph c{d, [](int, double) { }};
+    ChainCompressedGraph chains{c};
+
+    // Every grid intersection other than the corners (which have only two
+    // roads) stays, as does one vertex of the cycle, and every shape point
+    // is removed.
+    for (int v = 0; v < 64; ++v)
+    {
+        if (v != 0 && v != 7 && v != 56 && v != 63)
+        {
+            ASSERT_TRUE(chains.isCore(c.indexOf(v)));
+        }
+    }
+
+    ASSERT_LT(chains.coreVertexCount(), c.vertexCount() / 2);
+    ASSERT_GE(chains.coreVertexCount(), 60 + 1);
+}
+
+
+TEST(ChainCompressedGraphTests, findsSamePathsAsCompactDigraph)
+{
+    Digraph<int, double> d = makeSubdividedGrid(8);
+
+    std::vector<double> weights;
+    CompactDigraph c{d, [&](int, double einfo) { weights.push_back(einfo); }};
+    ChainCompressedGraph chains{c};
+    std::vector<double> chainWeights = chains.chainWeights<double>(weights.data());
+
+    for (int start = 0; start < c.vertexCount(); start += 3)
+    {
+        CompactSearchResult<double> result = c.findShortestPaths<double>(start, weights.data());
+
+        for (int end = 0; end < c.vertexCount(); ++end)
+        {
+            ChainPath path = chains.findShortestPath<double>(
+                start, end, chainWeights.data(), weights.data());
+
+            ASSERT_EQ(result.reached(end), path.reached);
+
+            if (path.reached)
+            {
+                ASSERT_EQ(CompactDigraph::pathEdges(result, end), path.edges);
+            }
+        }
+    }
+}
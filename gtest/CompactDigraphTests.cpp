@@ -0,0 +1,164 @@
+// CompactDigraphTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests for CompactDigraph, the read-only, compressed sparse row copy
+// of a Digraph's structure.
+
+#include <map>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CompactDigraph.hpp"
+
+
+namespace
+{
+    Digraph<std::string, double> makeGraph()
+    {
+        Digraph<std::string, double> d;
+        d.addVertex(30, "Thirty");
+        d.addVertex(10, "Ten");
+        d.addVertex(20, "Twenty");
+        d.addVertex(40, "Forty");
+
+        d.addEdge(10, 20, 3.0);
+        d.addEdge(10, 30, 1.0);
+        d.addEdge(30, 20, 1.0);
+        d.addEdge(20, 40, 2.0);
+
+        return d;
+    }
+}
+
+
+TEST(CompactDigraphTests, mapsVertexNumbersToIndexesAndBack)
+{
+    CompactDigraph c{makeGraph(), [](int, double) { }};
+
+    ASSERT_EQ(4, c.vertexCount());
+    ASSERT_EQ(4, c.edgeCount());
+
+    for (int vertex : {10, 20, 30, 40})
+    {
+        ASSERT_EQ(vertex, c.vertexNumber(c.indexOf(vertex)));
+    }
+
+    ASSERT_THROW({ c.indexOf(25); }, DigraphException);
+}
+
+
+TEST(CompactDigraphTests, keepsEveryEdgeWithItsInfo)
+{
+    Digraph<std::string, double> d = makeGraph();
+
+    std::vector<double> weights;
+    CompactDigraph c{d, [&](int edge, double einfo)
+    {
+        ASSERT_EQ(static_cast<int>(weights.size()), edge);
+        weights.push_back(einfo);
+    }};
+
+    for (int i = 0; i < c.vertexCount(); ++i)
+    {
+        ASSERT_EQ(d.edgeCount(c.vertexNumber(i)), c.edgeEnd(i) - c.edgeBegin(i));
+
+        for (int e = c.edgeBegin(i); e < c.edgeEnd(i); ++e)
+        {
+            ASSERT_EQ(
+                d.edgeInfo(c.vertexNumber(i), c.vertexNumber(c.target(e))),
+                weights[e]);
+        }
+    }
+}
+
+
+TEST(CompactDigraphTests, findsTheSameShortestPathsAsDigraph)
+{
+    Digraph<std::string, double> d = makeGraph();
+
+    std::vector<double> weights;
+    CompactDigraph c{d, [&](int, double einfo) { weights.push_back(einfo); }};
+
+    std::map<int, int> expected = d.findShortestPaths(10, [](double w) { return w; });
+    CompactSearchResult<double> result =
+        c.findShortestPaths<double>(c.indexOf(10), weights.data());
+
+    for (int i = 0; i < c.vertexCount(); ++i)
+    {
+        int previous = result.previousVertex[i] == -1
+            ? c.vertexNumber(i) : c.vertexNumber(result.previousVertex[i]);
+
+        ASSERT_EQ(expected[c.vertexNumber(i)], previous);
+    }
+
+    ASSERT_EQ(4.0, result.distance[c.indexOf(40)]);
+    ASSERT_EQ(3, CompactDigraph::pathEdges(result, c.indexOf(40)).size());
+}
+
+
+TEST(CompactDigraphTests, reorderingKeepsVertexNumbersAndDistances)
+{
+    Digraph<std::string, double> d = makeGraph();
+
+    std::vector<double> byNumberWeights;
+    CompactDigraph byNumber{d, [&](int, double einfo) { byNumberWeights.push_back(einfo); }};
+
+    for (VertexOrder order : {VertexOrder::BreadthFirst,
+                              VertexOrder::ReverseCuthillMcKee,
+                              VertexOrder::Degree})
+    {
+        std::vector<double> weights;
+        CompactDigraph c{d, [&](int, double einfo) { weights.push_back(einfo); }, order};
+
+        ASSERT_EQ(byNumber.vertexCount(), c.vertexCount());
+        ASSERT_EQ(byNumber.edgeCount(), c.edgeCount());
+
+        CompactSearchResult<double> expected =
+            byNumber.findShortestPaths<double>(byNumber.indexOf(10), byNumberWeights.data());
+        CompactSearchResult<double> result =
+            c.findShortestPaths<double>(c.indexOf(10), weights.data());
+
+        for (int vertex : {10, 20, 30, 40})
+        {
+            ASSERT_EQ(vertex, c.vertexNumber(c.indexOf(vertex)));
+            ASSERT_EQ(
+                expected.distance[byNumber.indexOf(vertex)],
+                result.distance[c.indexOf(vertex)]);
+        }
+    }
+}
+
+
+TEST(CompactDigraphTests, findReachableWithinStopsAtBudget)
+{
+    Digraph<std::string, double> d = makeGraph();
+
+    std::vector<double> weights;
+    CompactDigraph c{d, [&](int, double einfo) { weights.push_back(einfo); }};
+
+    std::vector<std::pair<int, double>> reached =
+        c.findReachableWithin(std::vector<int>{c.indexOf(10)}, weights.data(), 2.0);
+
+    ASSERT_EQ(3, reached.size());
+    ASSERT_EQ(c.indexOf(10), reached[0].first);
+    ASSERT_EQ(c.indexOf(30), reached[1].first);
+    ASSERT_EQ(1.0, reached[1].second);
+    ASSERT_EQ(c.indexOf(20), reached[2].first);
+    ASSERT_EQ(2.0, reached[2].second);
+}
+
+
+TEST(CompactDigraphTests, findReachableWithinNegativeBudgetReachesNothing)
+{
+    Digraph<std::string, double> d = makeGraph();
+
+    std::vector<double> weights;
+    CompactDigraph c{d, [&](int, double einfo) { weights.push_back(einfo); }};
+
+    ASSERT_TRUE(
+        c.findReachableWithin(std::vector<int>{c.indexOf(10)}, weights.data(), -1.0).empty());
+    ASSERT_EQ(
+        1, c.findReachableWithin(std::vector<int>{c.indexOf(10)}, weights.data(), 0.0).size());
+}
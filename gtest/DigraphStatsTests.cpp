@@ -0,0 +1,50 @@
+// DigraphStatsTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that, in a program compiled without DIGRAPH_STATS
+// (as this file is), searches count nothing.  DigraphStats_CountingTests
+// checks what they count when it's defined.
+//
+// The Digraph searched has an EdgeInfo type of this file's own, so that
+// its member functions are instantiated here, without counting, rather
+// than shared with another file's.
+
+#include <gtest/gtest.h>
+#include "Digraph.hpp"
+#include "DigraphStats.hpp"
+
+
+namespace
+{
+    struct UncountedRoad
+    {
+        double miles;
+    };
+}
+
+
+TEST(DigraphStatsTests, searchesCountNothingWithoutDigraphStats)
+{
+    Digraph<int, UncountedRoad> d;
+
+    for (int v = 0; v < 10; ++v)
+    {
+        d.addVertex(v, v);
+    }
+
+    for (int v = 0; v + 1 < 10; ++v)
+    {
+        d.addEdge(v, v + 1, UncountedRoad{1.0});
+    }
+
+    resetDigraphStats();
+    d.findShortestPaths(0, [](const UncountedRoad& road) { return road.miles; });
+
+    DigraphStats stats = collectDigraphStats();
+    ASSERT_EQ(0u, stats.verticesSettled);
+    ASSERT_EQ(0u, stats.edgesRelaxed);
+    ASSERT_EQ(0u, stats.heapPushes);
+    ASSERT_EQ(0u, stats.heapPops);
+}
@@ -0,0 +1,139 @@
+// DigraphStats_CountingTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that, in a program compiled with DIGRAPH_STATS
+// defined (as this file is, before anything else), searches count their
+// work, that each thread's counts are added to the total when it ends,
+// and that resetting the counts clears them.
+//
+// The Digraph searched has an EdgeInfo type of this file's own, so that
+// its member functions are instantiated here, with counting, rather than
+// shared with another file's.
+
+#define DIGRAPH_STATS
+
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Digraph.hpp"
+#include "DigraphStats.hpp"
+
+
+namespace
+{
+    struct CountedRoad
+    {
+        double miles;
+    };
+
+
+    // makeLadder() returns two rows of vertices joined along each row and
+    // across at every position, so that a search pushes some vertices
+    // more than once.
+    Digraph<int, CountedRoad> makeLadder(int length)
+    {
+        Digraph<int, CountedRoad> d;
+
+        for (int v = 0; v < 2 * length; ++v)
+        {
+            d.addVertex(v, v);
+        }
+
+        for (int v = 0; v + 1 < length; ++v)
+        {
+            d.addEdge(v, v + 1, CountedRoad{1.0});
+            d.addEdge(length + v, length + v + 1, CountedRoad{3.0});
+        }
+
+        for (int v = 0; v < length; ++v)
+        {
+            d.addEdge(v, length + v, CountedRoad{5.0});
+            d.addEdge(length + v, v, CountedRoad{0.5});
+        }
+
+        return d;
+    }
+
+
+    void search(const Digraph<int, CountedRoad>& d)
+    {
+        d.findShortestPaths(0, [](const CountedRoad& road) { return road.miles; });
+    }
+}
+
+
+TEST(DigraphStats_CountingTests, searchCountsItsWork)
+{
+    Digraph<int, CountedRoad> d = makeLadder(20);
+
+    resetDigraphStats();
+    search(d);
+
+    DigraphStats stats = collectDigraphStats();
+    ASSERT_EQ(40u, stats.verticesSettled);
+    ASSERT_GE(stats.heapPushes, stats.verticesSettled);
+    ASSERT_EQ(stats.heapPushes, stats.heapPops);
+    ASSERT_EQ(stats.heapPops - stats.verticesSettled, stats.stalePops);
+}
+
+
+TEST(DigraphStats_CountingTests, countsOfEndedThreadsAreAddedToTotal)
+{
+    Digraph<int, CountedRoad> d = makeLadder(20);
+
+    resetDigraphStats();
+    search(d);
+    DigraphStats one = collectDigraphStats();
+
+    resetDigraphStats();
+
+    std::vector<DigraphStats> threadStats(2);
+    std::vector<std::thread> threads;
+
+    for (DigraphStats& stats : threadStats)
+    {
+        threads.emplace_back(
+            [&d, &stats]
+            {
+                search(d);
+                stats = threadDigraphStats();
+            });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    DigraphStats total = collectDigraphStats();
+
+    ASSERT_EQ(one.verticesSettled, threadStats[0].verticesSettled);
+    ASSERT_EQ(one.heapPushes, threadStats[1].heapPushes);
+    ASSERT_EQ(threadStats[0].verticesSettled + threadStats[1].verticesSettled,
+              total.verticesSettled);
+    ASSERT_EQ(threadStats[0].heapPushes + threadStats[1].heapPushes, total.heapPushes);
+    ASSERT_EQ(2 * one.edgesRelaxed, total.edgesRelaxed);
+}
+
+
+TEST(DigraphStats_CountingTests, resetClearsEveryCount)
+{
+    Digraph<int, CountedRoad> d = makeLadder(10);
+
+    search(d);
+    std::thread{[&d] { search(d); }}.join();
+    ASSERT_GT(collectDigraphStats().verticesSettled, 0u);
+
+    resetDigraphStats();
+
+    DigraphStats stats = collectDigraphStats();
+    ASSERT_EQ(0u, stats.verticesSettled);
+    ASSERT_EQ(0u, stats.edgesRelaxed);
+    ASSERT_EQ(0u, stats.heapPushes);
+    ASSERT_EQ(0u, stats.heapPops);
+    ASSERT_EQ(0u, stats.stalePops);
+    ASSERT_EQ(0u, stats.allocations);
+    ASSERT_EQ(0u, stats.bytesTouched);
+}
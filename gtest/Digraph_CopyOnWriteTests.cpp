@@ -0,0 +1,115 @@
+// Digraph_CopyOnWriteTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that copies of a Digraph, which share storage until
+// one of them is modified, still behave exactly like deep copies.
+
+#include <string>
+#include <utility>
+#include <gtest/gtest.h>
+#include "Digraph.hpp"
+
+
+namespace
+{
+    Digraph<std::string, int> makeTriangle()
+    {
+        Digraph<std::string, int> d;
+        d.addVertex(1, "One");
+        d.addVertex(2, "Two");
+        d.addVertex(3, "Three");
+
+        d.addEdge(1, 2, 12);
+        d.addEdge(2, 3, 23);
+        d.addEdge(3, 1, 31);
+
+        return d;
+    }
+}
+
+
+TEST(Digraph_CopyOnWriteTests, modifyingCopyDoesNotAffectOriginal)
+{
+    Digraph<std::string, int> d1 = makeTriangle();
+    Digraph<std::string, int> d2{d1};
+
+    d2.addVertex(4, "Four");
+    d2.addEdge(3, 4, 34);
+    d2.removeEdge(1, 2);
+
+    ASSERT_EQ(3, d1.vertexCount());
+    ASSERT_EQ(3, d1.edgeCount());
+    ASSERT_EQ(12, d1.edgeInfo(1, 2));
+    ASSERT_THROW({ d1.edgeInfo(3, 4); }, DigraphException);
+
+    ASSERT_EQ(4, d2.vertexCount());
+    ASSERT_EQ(3, d2.edgeCount());
+    ASSERT_EQ(34, d2.edgeInfo(3, 4));
+    ASSERT_THROW({ d2.edgeInfo(1, 2); }, DigraphException);
+}
+
+
+TEST(Digraph_CopyOnWriteTests, modifyingOriginalDoesNotAffectCopy)
+{
+    Digraph<std::string, int> d1 = makeTriangle();
+    Digraph<std::string, int> d2;
+    d2 = d1;
+
+    d1.removeVertex(2);
+
+    ASSERT_EQ(2, d1.vertexCount());
+    ASSERT_EQ(1, d1.edgeCount());
+
+    ASSERT_EQ(3, d2.vertexCount());
+    ASSERT_EQ(3, d2.edgeCount());
+    ASSERT_EQ("Two", d2.vertexInfo(2));
+    ASSERT_EQ(12, d2.edgeInfo(1, 2));
+}
+
+
+TEST(Digraph_CopyOnWriteTests, settingEdgeInfoOnCopyDoesNotAffectOriginal)
+{
+    Digraph<std::string, int> d1 = makeTriangle();
+    Digraph<std::string, int> d2{d1};
+
+    d2.setEdgeInfo(2, 3, 32);
+
+    ASSERT_EQ(23, d1.edgeInfo(2, 3));
+    ASSERT_EQ(32, d2.edgeInfo(2, 3));
+    ASSERT_EQ(d1.edges(), d2.edges());
+    ASSERT_EQ(d1.version(), d2.version());
+
+    ASSERT_THROW({ d2.setEdgeInfo(1, 3, 13); }, DigraphException);
+    ASSERT_THROW({ d2.setEdgeInfo(1, 4, 14); }, DigraphException);
+}
+
+
+TEST(Digraph_CopyOnWriteTests, settingVertexInfoOnCopyDoesNotAffectOriginal)
+{
+    Digraph<std::string, int> d1 = makeTriangle();
+    Digraph<std::string, int> d2{d1};
+
+    d2.setVertexInfo(2, "Deux");
+
+    ASSERT_EQ("Two", d1.vertexInfo(2));
+    ASSERT_EQ("Deux", d2.vertexInfo(2));
+    ASSERT_EQ(d1.version(), d2.version());
+
+    ASSERT_THROW({ d2.setVertexInfo(4, "Four"); }, DigraphException);
+}
+
+
+TEST(Digraph_CopyOnWriteTests, movedFromDigraphIsEmptyAndUsable)
+{
+    Digraph<std::string, int> d1 = makeTriangle();
+    Digraph<std::string, int> d2 = std::move(d1);
+
+    ASSERT_EQ(3, d2.vertexCount());
+    ASSERT_EQ(0, d1.vertexCount());
+
+    d1.addVertex(7, "Seven");
+    ASSERT_EQ(1, d1.vertexCount());
+    ASSERT_EQ(3, d2.vertexCount());
+}
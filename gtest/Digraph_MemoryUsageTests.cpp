@@ -0,0 +1,157 @@
+// Digraph_MemoryUsageTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that a Digraph's memoryUsage() follows what it
+// allocates and frees, including when copies share storage.
+
+#include <vector>
+#include <gtest/gtest.h>
+#include "Digraph.hpp"
+
+
+namespace
+{
+    struct Payload
+    {
+        double values[4];
+    };
+
+
+    Digraph<int, Payload> makeStar(int spokes)
+    {
+        Digraph<int, Payload> d;
+        d.addVertex(0, 0);
+
+        for (int v = 1; v <= spokes; ++v)
+        {
+            d.addVertex(v, v);
+            d.addEdge(0, v, Payload{});
+            d.addEdge(v, 0, Payload{});
+        }
+
+        return d;
+    }
+}
+
+
+TEST(Digraph_MemoryUsageTests, emptyGraphUsesNoMemory)
+{
+    Digraph<int, int> d;
+    ASSERT_EQ(0u, d.memoryUsage().total());
+}
+
+
+TEST(Digraph_MemoryUsageTests, countsEachVertexAndEdge)
+{
+    Digraph<int, Payload> d = makeStar(100);
+    MemoryUsage usage = d.memoryUsage();
+
+    ASSERT_EQ(101 * sizeof(int), usage.vertexInfo);
+    ASSERT_EQ(200 * sizeof(Payload), usage.edgeInfo);
+
+    // Each edge and each vertex takes more than its payload, for the
+    // links between nodes.
+    ASSERT_GE(usage.adjacency, 200 * 2 * sizeof(void*));
+    ASSERT_GE(usage.vertexTable, 101 * 2 * sizeof(void*));
+    ASSERT_EQ(0u, usage.indexes);
+    ASSERT_EQ(0u, usage.caches);
+}
+
+
+TEST(Digraph_MemoryUsageTests, freedMemoryIsNoLongerCounted)
+{
+    Digraph<int, Payload> d = makeStar(10);
+    MemoryUsage before = d.memoryUsage();
+
+    d.addVertex(11, 11);
+    d.addEdge(0, 11, Payload{});
+    ASSERT_GT(d.memoryUsage().total(), before.total());
+
+    d.removeEdge(0, 11);
+    d.removeVertex(11);
+    d.compact();
+
+    MemoryUsage after = d.memoryUsage();
+    ASSERT_EQ(before.vertexTable, after.vertexTable);
+    ASSERT_EQ(before.adjacency, after.adjacency);
+    ASSERT_EQ(before.edgeInfo, after.edgeInfo);
+    ASSERT_EQ(before.vertexInfo, after.vertexInfo);
+}
+
+
+TEST(Digraph_MemoryUsageTests, tombstonesAreCountedAsIndexes)
+{
+    Digraph<int, Payload> d = makeStar(10);
+    d.removeVertex(5);
+
+    ASSERT_GT(d.memoryUsage().indexes, 0u);
+
+    d.compact();
+    ASSERT_EQ(0u, d.memoryUsage().indexes);
+}
+
+
+TEST(Digraph_MemoryUsageTests, copiesShareTheirUsage)
+{
+    Digraph<int, Payload> d = makeStar(50);
+    std::size_t original = d.memoryUsage().total();
+
+    Digraph<int, Payload> copy = d;
+    ASSERT_EQ(original, copy.memoryUsage().total());
+
+    // Changing the copy duplicates only the table and the vertex that
+    // changed, which both of them count.
+    copy.addEdge(1, 2, Payload{});
+    ASSERT_GT(copy.memoryUsage().total(), original);
+    ASSERT_EQ(copy.memoryUsage().total(), d.memoryUsage().total());
+
+    // Once the copy is gone, so is what it allocated.
+    copy = Digraph<int, Payload>{};
+    ASSERT_EQ(original, d.memoryUsage().total());
+    ASSERT_EQ(0u, copy.memoryUsage().total());
+}
+
+
+TEST(Digraph_MemoryUsageTests, copiesOwnOnlyWhatTheyDontShare)
+{
+    Digraph<int, Payload> d = makeStar(50);
+    ASSERT_EQ(d.memoryUsage().total(), d.ownedMemoryUsage().total());
+
+    Digraph<int, Payload> copy = d;
+    ASSERT_EQ(0u, d.ownedMemoryUsage().total());
+    ASSERT_EQ(0u, copy.ownedMemoryUsage().total());
+
+    // The copy owns its own table and the vertex that changed, while the
+    // original owns its table and the vertex as it was.
+    copy.addEdge(1, 2, Payload{});
+    MemoryUsage owned = copy.ownedMemoryUsage();
+    ASSERT_GT(owned.vertexTable, 0u);
+    ASSERT_EQ(2 * sizeof(Payload), owned.edgeInfo);
+    ASSERT_GT(d.ownedMemoryUsage().total(), 0u);
+    ASSERT_LT(owned.total(), copy.memoryUsage().total());
+
+    // Destroying the copy frees exactly what it owned.
+    std::size_t family = d.memoryUsage().total();
+    copy = Digraph<int, Payload>{};
+    ASSERT_EQ(family - owned.total(), d.memoryUsage().total());
+    ASSERT_EQ(d.memoryUsage().total(), d.ownedMemoryUsage().total());
+}
+
+
+TEST(Digraph_MemoryUsageTests, countingAllocatorCountsWhatVectorsAllocate)
+{
+    MemoryCounter counter;
+
+    {
+        std::vector<double, CountingAllocator<double>> v{CountingAllocator<double>{&counter}};
+        v.reserve(100);
+
+        ASSERT_EQ(100 * sizeof(double), counter.bytes());
+        ASSERT_EQ(1u, counter.allocations());
+    }
+
+    ASSERT_EQ(0u, counter.bytes());
+    ASSERT_EQ(0u, counter.allocations());
+}
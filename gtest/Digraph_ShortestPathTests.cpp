@@ -0,0 +1,228 @@
+// Digraph_ShortestPathTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests for the shortest path searches in Digraph beyond the basic
+// findShortestPaths() checks in the sanity checking tests.
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Digraph.hpp"
+
+
+namespace
+{
+    // A small graph with two ways from 1 to 4: 1 -> 2 -> 4 (weight 7)
+    // and 1 -> 3 -> 4 (weight 5), plus a vertex 5 that nothing reaches.
+    Digraph<std::string, double> makeDiamond()
+    {
+        Digraph<std::string, double> d;
+
+        for (int i = 1; i <= 5; ++i)
+        {
+            d.addVertex(i, "V" + std::to_string(i));
+        }
+
+        d.addEdge(1, 2, 3.0);
+        d.addEdge(2, 4, 4.0);
+        d.addEdge(1, 3, 1.0);
+        d.addEdge(3, 4, 4.0);
+        d.addEdge(5, 1, 1.0);
+
+        return d;
+    }
+
+
+    double identity(double weight)
+    {
+        return weight;
+    }
+}
+
+
+TEST(Digraph_ShortestPathTests, findShortestPathReturnsEdgesInOrder)
+{
+    Digraph<std::string, double> d = makeDiamond();
+
+    std::vector<DigraphPathStep<double>> path = d.findShortestPath(1, 4, identity);
+
+    ASSERT_EQ(2, path.size());
+
+    ASSERT_EQ(1, path[0].fromVertex);
+    ASSERT_EQ(3, path[0].toVertex);
+    ASSERT_EQ(1.0, *path[0].einfo);
+    ASSERT_EQ(1.0, path[0].pathWeight);
+
+    ASSERT_EQ(3, path[1].fromVertex);
+    ASSERT_EQ(4, path[1].toVertex);
+    ASSERT_EQ(4.0, *path[1].einfo);
+    ASSERT_EQ(5.0, path[1].pathWeight);
+}
+
+
+TEST(Digraph_ShortestPathTests, findShortestPathAgreesWithFindShortestPaths)
+{
+    Digraph<std::string, double> d = makeDiamond();
+
+    std::map<int, int> paths = d.findShortestPaths(1, identity);
+
+    for (int end : {2, 3, 4})
+    {
+        std::vector<DigraphPathStep<double>> path = d.findShortestPath(1, end, identity);
+
+        int v = end;
+
+        for (auto i = path.rbegin(); i != path.rend(); ++i)
+        {
+            ASSERT_EQ(v, i->toVertex);
+            ASSERT_EQ(paths[v], i->fromVertex);
+            v = i->fromVertex;
+        }
+
+        ASSERT_EQ(1, v);
+    }
+}
+
+
+TEST(Digraph_ShortestPathTests, findShortestPathToStartIsEmpty)
+{
+    Digraph<std::string, double> d = makeDiamond();
+
+    ASSERT_TRUE(d.findShortestPath(2, 2, identity).empty());
+}
+
+
+TEST(Digraph_ShortestPathTests, cannotFindShortestPathToUnreachableVertex)
+{
+    Digraph<std::string, double> d = makeDiamond();
+
+    ASSERT_THROW({ d.findShortestPath(1, 5, identity); }, DigraphException);
+    ASSERT_THROW({ d.findShortestPath(1, 6, identity); }, DigraphException);
+}
+
+
+TEST(Digraph_ShortestPathTests, multipleWeightFunctionsGiveSameResultsAsSeparateSearches)
+{
+    Digraph<std::string, double> d = makeDiamond();
+
+    // Under the second function, the path through 2 becomes the shorter.
+    std::vector<std::function<double(const double&)>> funcs{
+        identity,
+        [](double weight) { return weight == 1.0 ? 10.0 : weight; }};
+
+    std::vector<std::map<int, int>> trees = d.findShortestPaths(1, funcs);
+    std::vector<std::optional<std::vector<DigraphPathStep<double>>>> paths =
+        d.findShortestPath(1, 4, funcs);
+
+    ASSERT_EQ(2, trees.size());
+    ASSERT_EQ(2, paths.size());
+
+    for (std::size_t i = 0; i < funcs.size(); ++i)
+    {
+        ASSERT_EQ(d.findShortestPaths(1, funcs[i]), trees[i]);
+
+        std::vector<DigraphPathStep<double>> path = d.findShortestPath(1, 4, funcs[i]);
+        ASSERT_TRUE(paths[i].has_value());
+        ASSERT_EQ(path.size(), paths[i]->size());
+
+        for (std::size_t j = 0; j < path.size(); ++j)
+        {
+            ASSERT_EQ(path[j].toVertex, (*paths[i])[j].toVertex);
+            ASSERT_EQ(path[j].pathWeight, (*paths[i])[j].pathWeight);
+        }
+    }
+
+    ASSERT_EQ(3, trees[0][4]);
+    ASSERT_EQ(2, trees[1][4]);
+}
+
+
+TEST(Digraph_ShortestPathTests, multipleWeightFunctionsDecideReachabilityEach)
+{
+    // The edge from 2 to 3 can't be crossed under the second function
+    // (as with a road whose speed limit is zero, timed in hours).
+    Digraph<std::string, double> d;
+
+    for (int i = 1; i <= 3; ++i)
+    {
+        d.addVertex(i, "V" + std::to_string(i));
+    }
+
+    d.addEdge(1, 2, 3.0);
+    d.addEdge(2, 3, 0.0);
+
+    std::vector<std::function<double(const double&)>> funcs{
+        [](double weight) { return weight + 5.0; },
+        [](double weight) { return 30.0 / weight; }};
+
+    std::vector<std::optional<std::vector<DigraphPathStep<double>>>> paths =
+        d.findShortestPath(1, 3, funcs);
+
+    ASSERT_EQ(2, paths.size());
+    ASSERT_TRUE(paths[0].has_value());
+    ASSERT_EQ(2, paths[0]->size());
+    ASSERT_EQ(13.0, paths[0]->back().pathWeight);
+    ASSERT_FALSE(paths[1].has_value());
+
+    ASSERT_EQ(2, d.findShortestPath(1, 3, funcs[0]).size());
+    ASSERT_THROW({ d.findShortestPath(1, 3, funcs[1]); }, DigraphException);
+    ASSERT_THROW({ d.findShortestPath(1, 4, funcs); }, DigraphException);
+}
+
+
+TEST(Digraph_ShortestPathTests, findReachableWithinStopsAtBudget)
+{
+    Digraph<std::string, double> d = makeDiamond();
+
+    std::vector<DigraphReachedVertex> reached = d.findReachableWithin(1, identity, 3.0);
+
+    ASSERT_EQ(3, reached.size());
+
+    ASSERT_EQ(1, reached[0].vertex);
+    ASSERT_EQ(0.0, reached[0].weight);
+
+    ASSERT_EQ(3, reached[1].vertex);
+    ASSERT_EQ(1.0, reached[1].weight);
+
+    ASSERT_EQ(2, reached[2].vertex);
+    ASSERT_EQ(3.0, reached[2].weight);
+
+    ASSERT_EQ(4, d.findReachableWithin(1, identity, 5.0).size());
+}
+
+
+TEST(Digraph_ShortestPathTests, findReachableWithinNegativeBudgetReachesNothing)
+{
+    Digraph<std::string, double> d = makeDiamond();
+
+    ASSERT_TRUE(d.findReachableWithin(1, identity, -1.0).empty());
+    ASSERT_TRUE(d.findReachableWithin(std::vector<int>{5, 2}, identity, -1.0).empty());
+    ASSERT_EQ(1, d.findReachableWithin(1, identity, 0.0).size());
+    ASSERT_THROW({ d.findReachableWithin(6, identity, -1.0); }, DigraphException);
+}
+
+
+TEST(Digraph_ShortestPathTests, findReachableWithinFromSeveralStartsUsesNearest)
+{
+    Digraph<std::string, double> d = makeDiamond();
+
+    std::vector<DigraphReachedVertex> reached =
+        d.findReachableWithin(std::vector<int>{5, 2}, identity, 4.0);
+
+    std::map<int, double> weights;
+
+    for (const DigraphReachedVertex& r : reached)
+    {
+        weights[r.vertex] = r.weight;
+    }
+
+    ASSERT_EQ(5, weights.size());
+    ASSERT_EQ(0.0, weights[5]);
+    ASSERT_EQ(0.0, weights[2]);
+    ASSERT_EQ(1.0, weights[1]);
+    ASSERT_EQ(2.0, weights[3]);
+    ASSERT_EQ(4.0, weights[4]);
+}
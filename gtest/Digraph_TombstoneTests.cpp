@@ -0,0 +1,156 @@
+// Digraph_TombstoneTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that the edges left dangling when a vertex is removed
+// are invisible, before and after compact().
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Digraph.hpp"
+
+
+namespace
+{
+    // makeStar() returns a graph in which every vertex has edges to and
+    // from vertex 0.
+    Digraph<std::string, int> makeStar(int points)
+    {
+        Digraph<std::string, int> d;
+        d.addVertex(0, "Center");
+
+        for (int v = 1; v <= points; ++v)
+        {
+            d.addVertex(v, "Point");
+            d.addEdge(0, v, v);
+            d.addEdge(v, 0, v);
+        }
+
+        return d;
+    }
+}
+
+
+TEST(Digraph_TombstoneTests, removedVertexLeavesNoVisibleEdges)
+{
+    Digraph<std::string, int> d = makeStar(3);
+    d.removeVertex(2);
+
+    ASSERT_EQ(1, d.tombstoneCount());
+    ASSERT_EQ(3, d.vertexCount());
+    ASSERT_EQ(4, d.edgeCount());
+    ASSERT_EQ(2, d.edgeCount(0));
+
+    std::vector<std::pair<int, int>> expected{{0, 1}, {0, 3}};
+    ASSERT_EQ(expected, d.edges(0));
+
+    int visited = 0;
+    d.forEachEdge(0, [&](const DigraphEdge<int>& edge) { ASSERT_NE(2, edge.toVertex); ++visited; });
+    ASSERT_EQ(2, visited);
+
+    ASSERT_THROW(d.edgeInfo(0, 2), DigraphException);
+    ASSERT_EQ(2u, d.findShortestPath(1, 3, [](int) { return 1.0; }).size());
+    ASSERT_EQ(3u, d.findReachableWithin(1, [](int) { return 1.0; }, 10.0).size());
+    ASSERT_TRUE(d.isStronglyConnected());
+
+    d.compact();
+
+    ASSERT_EQ(0, d.tombstoneCount());
+    ASSERT_EQ(4, d.edgeCount());
+    ASSERT_EQ(expected, d.edges(0));
+}
+
+
+TEST(Digraph_TombstoneTests, readdedVertexDoesNotGetOldEdgesBack)
+{
+    Digraph<std::string, int> d = makeStar(3);
+    d.removeVertex(2);
+    d.addVertex(2, "New point");
+
+    ASSERT_EQ(0, d.edgeCount(2));
+    ASSERT_EQ(2, d.edgeCount(0));
+    ASSERT_THROW(d.edgeInfo(0, 2), DigraphException);
+
+    d.addEdge(0, 2, 99);
+    ASSERT_EQ(99, d.edgeInfo(0, 2));
+}
+
+
+TEST(Digraph_TombstoneTests, removingVertexFromCopyDoesNotAffectOriginal)
+{
+    Digraph<std::string, int> d1 = makeStar(3);
+    Digraph<std::string, int> d2 = d1;
+
+    d2.removeVertex(1);
+    ASSERT_EQ(0, d1.tombstoneCount());
+    ASSERT_EQ(6, d1.edgeCount());
+    ASSERT_EQ(4, d2.edgeCount());
+
+    d2.compact();
+    ASSERT_EQ(6, d1.edgeCount());
+    ASSERT_EQ(1, d1.edgeInfo(0, 1));
+}
+
+
+TEST(Digraph_TombstoneTests, manyRemovalsAreCompactedAutomatically)
+{
+    Digraph<std::string, int> d = makeStar(3000);
+
+    for (int v = 1; v <= 2000; ++v)
+    {
+        d.removeVertex(v);
+        ASSERT_LE(d.tombstoneCount(), 1024);
+    }
+
+    ASSERT_EQ(1001, d.vertexCount());
+    ASSERT_EQ(2000, d.edgeCount());
+    ASSERT_EQ(1000, d.edgeCount(0));
+}
+
+
+TEST(Digraph_TombstoneTests, edgesToEveryTombstoneStayHiddenAsTombstonesGrow)
+{
+    Digraph<std::string, int> d = makeStar(3000);
+    Digraph<std::string, int> copy;
+
+    for (int removed = 1; removed <= 1000; ++removed)
+    {
+        d.removeVertex(removed * 3);
+        ASSERT_EQ(removed, d.tombstoneCount());
+        ASSERT_EQ(3000 - removed, d.edgeCount(0));
+
+        if (removed == 100)
+        {
+            copy = d;
+        }
+    }
+
+    for (const auto& edge : d.edges(0))
+    {
+        ASSERT_NE(0, edge.second % 3);
+    }
+
+    ASSERT_EQ(100, copy.tombstoneCount());
+    ASSERT_EQ(2900, copy.edgeCount(0));
+
+    d.addVertex(3, "Point");
+    ASSERT_EQ(0, d.tombstoneCount());
+    ASSERT_EQ(2000, d.edgeCount(0));
+    ASSERT_EQ(0, d.edgeCount(3));
+}
+
+
+TEST(Digraph_TombstoneTests, removingMissingEdgeThrowsAndChangesNothing)
+{
+    Digraph<std::string, int> d = makeStar(3);
+
+    ASSERT_THROW(d.removeEdge(1, 2), DigraphException);
+    ASSERT_THROW(d.removeEdge(1, 7), DigraphException);
+
+    d.removeEdge(0, 2);
+    ASSERT_EQ(5, d.edgeCount());
+    ASSERT_THROW(d.removeEdge(0, 2), DigraphException);
+}
@@ -0,0 +1,114 @@
+// HubLabelsTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that HubLabels find paths with the same weights
+// that Dijkstra's algorithm finds, however many threads build them.
+
+#include <limits>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "HubLabels.hpp"
+#include "TestGraphs.hpp"
+
+
+namespace
+{
+    std::vector<double> randomWeights(int edgeCount, unsigned int seed)
+    {
+        std::mt19937 random{seed};
+        std::uniform_real_distribution<double> weight{0.5, 10.0};
+
+        std::vector<double> weights;
+
+        for (int e = 0; e < edgeCount; ++e)
+        {
+            weights.push_back(weight(random));
+        }
+
+        return weights;
+    }
+
+
+    void expectSameAsDijkstra(
+        const CompactDigraph& c, const HubLabels<double>& labels,
+        const std::vector<double>& weights)
+    {
+        for (int start = 0; start < c.vertexCount(); start += 5)
+        {
+            CompactSearchResult<double> result =
+                c.findShortestPaths<double>(start, weights.data());
+
+            for (int end = 0; end < c.vertexCount(); ++end)
+            {
+                HubLabelPath<double> path = labels.findShortestPath(start, end);
+
+                ASSERT_EQ(result.reached(end), path.reached);
+
+                if (!path.reached)
+                {
+                    ASSERT_EQ(
+                        std::numeric_limits<double>::max(), labels.distance(start, end));
+                    continue;
+                }
+
+                ASSERT_NEAR(result.distance[end], labels.distance(start, end), 1e-9);
+                ASSERT_NEAR(result.distance[end], path.distance, 1e-9);
+
+                // The path's edges must join up, lead from the start to
+                // the end, and add up to its weight.
+                int v = start;
+                double weight = 0.0;
+
+                for (int e : path.edges)
+                {
+                    ASSERT_TRUE(e >= c.edgeBegin(v) && e < c.edgeEnd(v));
+                    weight += weights[e];
+                    v = c.target(e);
+                }
+
+                ASSERT_EQ(end, v);
+                ASSERT_NEAR(path.distance, weight, 1e-9);
+            }
+        }
+    }
+}
+
+
+TEST(HubLabelsTests, findShortestPathsWithOneThread)
+{
+    Digraph<int, int> d = makeGrid(15, 20, true);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<double> weights = randomWeights(c.edgeCount(), 1);
+
+    expectSameAsDijkstra(c, HubLabels<double>{c, weights.data(), 1}, weights);
+}
+
+
+TEST(HubLabelsTests, findShortestPathsWithManyThreads)
+{
+    Digraph<int, int> d = makeGrid(15, 20, true);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<double> weights = randomWeights(c.edgeCount(), 2);
+
+    expectSameAsDijkstra(c, HubLabels<double>{c, weights.data(), 4}, weights);
+}
+
+
+TEST(HubLabelsTests, pathFromVertexToItselfIsEmpty)
+{
+    Digraph<int, int> d = makeGrid(4, 20, true);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<double> weights = randomWeights(c.edgeCount(), 3);
+    HubLabels<double> labels{c, weights.data(), 2};
+
+    for (int v = 0; v < c.vertexCount(); ++v)
+    {
+        HubLabelPath<double> path = labels.findShortestPath(v, v);
+        ASSERT_TRUE(path.reached);
+        ASSERT_EQ(0.0, path.distance);
+        ASSERT_TRUE(path.edges.empty());
+    }
+}
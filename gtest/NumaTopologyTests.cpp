@@ -0,0 +1,117 @@
+// NumaTopologyTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that a NumaTopology is read correctly from a
+// directory laid out like /sys/devices/system/node (or falls back to a
+// single node), and that NumaReplicas builds a replica for each node.
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "NumaTopology.hpp"
+
+
+namespace
+{
+    // makeNodeDirectory() makes a directory holding a node directory, with
+    // a cpulist file, for each of the given lists.
+    std::string makeNodeDirectory(const std::string& name, const std::vector<std::string>& lists)
+    {
+        std::filesystem::path path = testing::TempDir() + "NumaTopologyTests." + name;
+        std::filesystem::remove_all(path);
+
+        for (std::size_t node = 0; node < lists.size(); ++node)
+        {
+            std::filesystem::path nodePath = path / ("node" + std::to_string(node));
+            std::filesystem::create_directories(nodePath);
+            std::ofstream{nodePath / "cpulist"} << lists[node] << "\n";
+        }
+
+        // Other files in the directory, like "online", are ignored.
+        std::filesystem::create_directories(path);
+        std::ofstream{path / "online"} << "0-" << lists.size() << "\n";
+
+        return path.string();
+    }
+}
+
+
+TEST(NumaTopologyTests, cpuListsAreParsed)
+{
+    ASSERT_EQ((std::vector<int>{0, 1, 2, 3, 8, 10, 11}), NumaTopology::parseCpuList("0-3,8,10-11"));
+    ASSERT_EQ((std::vector<int>{5}), NumaTopology::parseCpuList("5"));
+    ASSERT_EQ(std::vector<int>{}, NumaTopology::parseCpuList(""));
+}
+
+
+TEST(NumaTopologyTests, nodesAreReadFromDirectory)
+{
+    NumaTopology topology = NumaTopology::detect(
+        makeNodeDirectory("twoNodes", {"0-1,4-5", "2-3,6-7"}));
+
+    ASSERT_EQ(2, topology.nodeCount());
+    ASSERT_EQ((std::vector<int>{0, 1, 4, 5}), topology.cpusOf(0));
+    ASSERT_EQ((std::vector<int>{2, 3, 6, 7}), topology.cpusOf(1));
+    ASSERT_EQ(0, topology.nodeOf(5));
+    ASSERT_EQ(1, topology.nodeOf(6));
+    ASSERT_EQ(0, topology.nodeOf(100));
+}
+
+
+TEST(NumaTopologyTests, nodesWithoutProcessorsAreLeftOut)
+{
+    NumaTopology topology = NumaTopology::detect(
+        makeNodeDirectory("memoryOnly", {"0-3", "", "4-7"}));
+
+    ASSERT_EQ(2, topology.nodeCount());
+    ASSERT_EQ(1, topology.nodeOf(4));
+}
+
+
+TEST(NumaTopologyTests, missingDirectoryMeansOneNode)
+{
+    NumaTopology topology = NumaTopology::detect(
+        testing::TempDir() + "NumaTopologyTests.doesNotExist");
+
+    ASSERT_EQ(1, topology.nodeCount());
+    ASSERT_EQ(0, topology.currentNode());
+    ASSERT_FALSE(topology.pinCurrentThread(0));
+}
+
+
+TEST(NumaTopologyTests, replicasAreBuiltForEachNode)
+{
+    NumaTopology topology{{{0}, {1}, {2}}};
+    std::atomic<int> built{0};
+
+    NumaReplicas<int> replicas{&topology, [&] { return std::make_unique<int>(++built); }};
+
+    ASSERT_EQ(3, replicas.replicaCount());
+    ASSERT_EQ(3, built);
+
+    std::vector<int> values;
+
+    for (int node = 0; node < replicas.replicaCount(); ++node)
+    {
+        values.push_back(replicas.replica(node));
+    }
+
+    // The first replica is built before the others.
+    ASSERT_EQ(1, values[0]);
+    ASSERT_NE(values[1], values[2]);
+}
+
+
+TEST(NumaTopologyTests, withoutTopologyThereIsOneReplica)
+{
+    NumaReplicas<int> replicas{nullptr, [] { return std::make_unique<int>(46); }};
+
+    ASSERT_EQ(1, replicas.replicaCount());
+    ASSERT_EQ(46, replicas.local());
+}
@@ -0,0 +1,186 @@
+// ReachabilityIndexTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that a ReachabilityIndex agrees with a search of
+// the graph, and that it becomes stale when the Digraph changes.
+
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ReachabilityIndex.hpp"
+#include "TestGraphs.hpp"
+
+
+namespace
+{
+    // reachableFrom() returns the vertex numbers that a depth-first search
+    // from the given vertex reaches, as a set of flags.
+    std::vector<bool> reachableFrom(const Digraph<int, int>& d, int start, int vertexCount)
+    {
+        std::vector<bool> reached(vertexCount * 3, false);
+        std::vector<int> stack{start};
+        reached[start] = true;
+
+        while (!stack.empty())
+        {
+            int v = stack.back();
+            stack.pop_back();
+
+            for (const auto& edge : d.edges(v))
+            {
+                if (!reached[edge.second])
+                {
+                    reached[edge.second] = true;
+                    stack.push_back(edge.second);
+                }
+            }
+        }
+
+        return reached;
+    }
+
+
+    void expectSameAsSearch(
+        const Digraph<int, int>& d, const ReachabilityIndex& index, int vertexCount)
+    {
+        for (int v = 0; v < vertexCount; ++v)
+        {
+            std::vector<bool> reached = reachableFrom(d, v * 3, vertexCount);
+
+            for (int w = 0; w < vertexCount; ++w)
+            {
+                ASSERT_EQ(reached[w * 3], index.reachable(v * 3, w * 3));
+            }
+        }
+    }
+}
+
+
+TEST(ReachabilityIndexTests, agreesWithSearchOnSparseGraph)
+{
+    Digraph<int, int> d = makeRandomGraph(300, 330, 1, 3);
+    ReachabilityIndex index{d, 2};
+
+    ASSERT_GT(index.componentCount(), 10);
+    expectSameAsSearch(d, index, 300);
+}
+
+
+TEST(ReachabilityIndexTests, agreesWithSearchOnDenserGraph)
+{
+    Digraph<int, int> d = makeRandomGraph(300, 450, 2, 3);
+    ReachabilityIndex index{d, 1};
+
+    expectSameAsSearch(d, index, 300);
+}
+
+
+TEST(ReachabilityIndexTests, agreesWithSearchOnGraphWithManyComponents)
+{
+    Digraph<int, int> d = makeRandomGraph(1000, 1100, 8, 3);
+    ReachabilityIndex index{d, 2};
+
+    Digraph<int, int> small = makeRandomGraph(50, 60, 9, 3);
+    ReachabilityIndex smallIndex{small, 1};
+
+    ASSERT_GT(index.componentCount(), 100);
+
+    // The searches of the two condensations, which aren't the same size,
+    // take turns, so neither can be helped or misled by what the other
+    // left behind.
+    for (int v = 0; v < 1000; ++v)
+    {
+        std::vector<bool> reached = reachableFrom(d, v * 3, 1000);
+
+        for (int w = 0; w < 1000; ++w)
+        {
+            ASSERT_EQ(reached[w * 3], index.reachable(v * 3, w * 3));
+        }
+
+        if (v < 50)
+        {
+            std::vector<bool> smallReached = reachableFrom(small, v * 3, 50);
+
+            for (int w = 0; w < 50; ++w)
+            {
+                ASSERT_EQ(smallReached[w * 3], smallIndex.reachable(v * 3, w * 3));
+            }
+        }
+    }
+}
+
+
+TEST(ReachabilityIndexTests, vertexCanAlwaysReachItself)
+{
+    Digraph<int, int> d = makeRandomGraph(50, 0, 3, 3);
+    ReachabilityIndex index{d};
+
+    ASSERT_EQ(50, index.componentCount());
+
+    for (int v = 0; v < 50; ++v)
+    {
+        ASSERT_TRUE(index.reachable(v * 3, v * 3));
+        ASSERT_FALSE(index.reachable(v * 3, ((v + 1) % 50) * 3));
+    }
+}
+
+
+TEST(ReachabilityIndexTests, nonexistentVertexThrows)
+{
+    Digraph<int, int> d = makeRandomGraph(10, 20, 4, 3);
+    ReachabilityIndex index{d};
+
+    ASSERT_THROW(index.reachable(1, 0), DigraphException);
+    ASSERT_THROW(index.reachable(0, 1), DigraphException);
+}
+
+
+TEST(ReachabilityIndexTests, becomesStaleWhenDigraphChanges)
+{
+    Digraph<int, int> d = makeRandomGraph(10, 0, 5, 3);
+    ReachabilityIndex index{d};
+    Digraph<int, int> copy = d;
+
+    ASSERT_TRUE(index.isCurrent(d));
+    ASSERT_TRUE(index.isCurrent(copy));
+
+    d.addEdge(0, 3, 0);
+    ASSERT_FALSE(index.isCurrent(d));
+    ASSERT_TRUE(index.isCurrent(copy));
+
+    copy.addEdge(0, 3, 0);
+    ASSERT_FALSE(index.isCurrent(copy));
+    ASSERT_NE(d.version(), copy.version());
+
+    ReachabilityIndex rebuilt{d};
+    ASSERT_TRUE(rebuilt.isCurrent(d));
+    ASSERT_TRUE(rebuilt.reachable(0, 3));
+
+    d.removeEdge(0, 3);
+    ASSERT_FALSE(rebuilt.isCurrent(d));
+}
+
+
+TEST(ReachabilityIndexTests, staysCurrentWhenOnlyEdgeInfoChanges)
+{
+    Digraph<int, int> d = makeRandomGraph(10, 20, 7, 3);
+    ReachabilityIndex index{d};
+
+    std::pair<int, int> edge = d.edges().front();
+    d.setEdgeInfo(edge.first, edge.second, 46);
+
+    ASSERT_EQ(46, d.edgeInfo(edge.first, edge.second));
+    ASSERT_TRUE(index.isCurrent(d));
+}
+
+
+TEST(ReachabilityIndexTests, indexBuiltFromCompactDigraphIsNeverCurrent)
+{
+    Digraph<int, int> d = makeRandomGraph(10, 20, 6, 3);
+    CompactDigraph c{d, [](int, int) { }};
+    ReachabilityIndex index{c};
+
+    ASSERT_FALSE(index.isCurrent(d));
+}
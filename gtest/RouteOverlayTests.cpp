@@ -0,0 +1,201 @@
+// RouteOverlayTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that a customized RouteOverlay finds paths with the
+// same weights that Dijkstra's algorithm finds, whatever the weights are.
+
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include "RouteOverlay.hpp"
+#include "TestGraphs.hpp"
+
+
+namespace
+{
+    std::vector<double> randomWeights(int edgeCount, unsigned int seed)
+    {
+        std::mt19937 random{seed};
+        std::uniform_real_distribution<double> weight{0.5, 10.0};
+
+        std::vector<double> weights;
+
+        for (int e = 0; e < edgeCount; ++e)
+        {
+            weights.push_back(weight(random));
+        }
+
+        return weights;
+    }
+
+
+    void expectSameAsDijkstra(
+        const CompactDigraph& c, const RouteOverlay& overlay,
+        const OverlayMetric& metric)
+    {
+        for (int start = 0; start < c.vertexCount(); start += 7)
+        {
+            CompactSearchResult<double> result =
+                c.findShortestPaths<double>(start, metric.weights.data());
+
+            for (int end = 0; end < c.vertexCount(); ++end)
+            {
+                OverlayPath path = overlay.findShortestPath(metric, start, end);
+
+                ASSERT_EQ(result.reached(end), path.reached);
+
+                if (!path.reached)
+                {
+                    continue;
+                }
+
+                ASSERT_NEAR(result.distance[end], path.weight, 1e-9);
+
+                // The path's edges must join up, lead from the start to
+                // the end, and add up to its weight.
+                int v = start;
+                double weight = 0.0;
+
+                for (int e : path.edges)
+                {
+                    ASSERT_TRUE(e >= c.edgeBegin(v) && e < c.edgeEnd(v));
+                    weight += metric.weights[e];
+                    v = c.target(e);
+                }
+
+                ASSERT_EQ(end, v);
+                ASSERT_NEAR(path.weight, weight, 1e-9);
+            }
+        }
+    }
+}
+
+
+TEST(RouteOverlayTests, cellsAreNestedAndNoBiggerThanAsked)
+{
+    Digraph<int, int> d = makeGrid(12, 10);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> cellSizes{5, 20, 60};
+    RouteOverlay overlay{c, cellSizes};
+
+    ASSERT_EQ(3, overlay.levelCount());
+
+    for (int level = 0; level < overlay.levelCount(); ++level)
+    {
+        std::vector<int> sizes(overlay.cellCount(level), 0);
+
+        for (int v = 0; v < c.vertexCount(); ++v)
+        {
+            ++sizes[overlay.cellOf(level, v)];
+
+            for (int w = 0; level > 0 && w < c.vertexCount(); ++w)
+            {
+                if (overlay.cellOf(level - 1, v) == overlay.cellOf(level - 1, w))
+                {
+                    ASSERT_EQ(overlay.cellOf(level, v), overlay.cellOf(level, w));
+                }
+            }
+        }
+
+        for (int size : sizes)
+        {
+            ASSERT_LE(size, cellSizes[level]);
+        }
+    }
+}
+
+
+TEST(RouteOverlayTests, findsShortestPaths)
+{
+    Digraph<int, int> d = makeGrid(12, 10);
+    CompactDigraph c{d, [](int, int) { }};
+    RouteOverlay overlay{c, {5, 20, 60}};
+
+    expectSameAsDijkstra(c, overlay, overlay.customize(randomWeights(c.edgeCount(), 1), 3));
+}
+
+
+TEST(RouteOverlayTests, canBeCustomizedAgainWithNewWeights)
+{
+    Digraph<int, int> d = makeGrid(12, 10);
+    CompactDigraph c{d, [](int, int) { }};
+    RouteOverlay overlay{c, {8, 40}};
+
+    OverlayMetric first = overlay.customize(randomWeights(c.edgeCount(), 1), 2);
+    OverlayMetric second = overlay.customize(randomWeights(c.edgeCount(), 2), 1);
+
+    expectSameAsDijkstra(c, overlay, second);
+    expectSameAsDijkstra(c, overlay, first);
+}
+
+
+TEST(RouteOverlayTests, overlaysOfDifferentSizesCanBeSearchedInTurn)
+{
+    Digraph<int, int> big = makeGrid(12, 10);
+    CompactDigraph bigGraph{big, [](int, int) { }};
+    RouteOverlay bigOverlay{bigGraph, {5, 20, 60}};
+    OverlayMetric bigMetric = bigOverlay.customize(randomWeights(bigGraph.edgeCount(), 1), 1);
+
+    Digraph<int, int> small = makeGrid(5, 4);
+    CompactDigraph smallGraph{small, [](int, int) { }};
+    RouteOverlay smallOverlay{smallGraph, {4, 12}};
+    OverlayMetric smallMetric =
+        smallOverlay.customize(randomWeights(smallGraph.edgeCount(), 2), 1);
+
+    // Each search on this thread shares one LocalSearch, which must be
+    // resized, and left with nothing visited, in between.
+    for (int i = 0; i < 3; ++i)
+    {
+        expectSameAsDijkstra(smallGraph, smallOverlay, smallMetric);
+        expectSameAsDijkstra(bigGraph, bigOverlay, bigMetric);
+    }
+}
+
+
+TEST(RouteOverlayTests, canBeBuiltFromSavedPartition)
+{
+    Digraph<int, int> d = makeGrid(12, 10);
+    CompactDigraph c{d, [](int, int) { }};
+    RouteOverlay original{c, {8, 40}};
+
+    std::vector<std::vector<int>> partition;
+
+    for (int level = 0; level < original.levelCount(); ++level)
+    {
+        partition.push_back(original.partition(level));
+    }
+
+    RouteOverlay overlay{c, partition};
+    ASSERT_EQ(original.levelCount(), overlay.levelCount());
+
+    for (int level = 0; level < overlay.levelCount(); ++level)
+    {
+        ASSERT_EQ(original.partition(level), overlay.partition(level));
+        ASSERT_EQ(original.weightCount(level), overlay.weightCount(level));
+    }
+
+    expectSameAsDijkstra(c, overlay, overlay.customize(randomWeights(c.edgeCount(), 3), 2));
+}
+
+
+TEST(RouteOverlayTests, partitionThatIsNotNestedIsRejected)
+{
+    Digraph<int, int> d = makeGrid(4, 10);
+    CompactDigraph c{d, [](int, int) { }};
+
+    std::vector<int> halves(c.vertexCount()), alternating(c.vertexCount());
+
+    for (int v = 0; v < c.vertexCount(); ++v)
+    {
+        halves[v] = v < c.vertexCount() / 2 ? 0 : 1;
+        alternating[v] = v % 2;
+    }
+
+    std::vector<std::vector<int>> notNested{alternating, halves};
+    std::vector<std::vector<int>> tooSmall{std::vector<int>(3, 0)};
+
+    ASSERT_THROW((RouteOverlay{c, notNested}), DigraphException);
+    ASSERT_THROW((RouteOverlay{c, tooSmall}), DigraphException);
+}
@@ -0,0 +1,247 @@
+// SpeedProfilesTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that SpeedProfiles give the travel times found by
+// following a trip as the speed changes, that identical profiles are
+// shared, and that CompactDigraph::findEarliestArrivals() finds the
+// earliest arrival times at every vertex.
+
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "CompactDigraph.hpp"
+#include "SpeedProfiles.hpp"
+#include "TestGraphs.hpp"
+
+
+namespace
+{
+    // rushHour() returns a profile that slows to the given factor at 8am
+    // and 5pm.
+    SpeedProfile rushHour(double slowest)
+    {
+        return SpeedProfile{{
+            {6.0, 1.0}, {8.0, slowest}, {10.0, 1.0},
+            {15.0, 1.0}, {17.0, slowest}, {19.0, 1.0}}};
+    }
+
+
+    // simulatedArrival() follows a trip along a segment in small steps,
+    // as a check on SpeedProfile::arrivalTime().
+    double simulatedArrival(const SpeedProfile& profile, double departure, double freeFlowHours)
+    {
+        const double step = 1e-5;
+        double time = departure;
+        double progress = 0.0;
+
+        while (true)
+        {
+            double gained = step * profile.factorAt(time + step / 2.0);
+
+            if (progress + gained >= freeFlowHours)
+            {
+                return time + step * (freeFlowHours - progress) / gained;
+            }
+
+            progress += gained;
+            time += step;
+        }
+    }
+}
+
+
+TEST(SpeedProfilesTests, constantProfileScalesTravelTime)
+{
+    SpeedProfile profile{{{12.0, 0.5}}};
+
+    ASSERT_NEAR(0.5, profile.factorAt(3.0), 1e-12);
+    ASSERT_NEAR(3.0 + 2.0, profile.arrivalTime(3.0, 1.0), 1e-12);
+    ASSERT_NEAR(23.0 + 4.0, profile.arrivalTime(23.0, 2.0), 1e-12);
+}
+
+
+TEST(SpeedProfilesTests, factorChangesLinearlyAndWrapsAroundMidnight)
+{
+    SpeedProfile profile{{{6.0, 1.0}, {18.0, 0.5}}};
+
+    ASSERT_NEAR(0.75, profile.factorAt(12.0), 1e-12);
+    ASSERT_NEAR(0.75, profile.factorAt(0.0), 1e-12);
+    ASSERT_NEAR(0.75, profile.factorAt(24.0), 1e-12);
+    ASSERT_NEAR(0.625, profile.factorAt(21.0), 1e-12);
+    ASSERT_NEAR(0.875, profile.factorAt(27.0), 1e-12);
+}
+
+
+TEST(SpeedProfilesTests, arrivalFollowsChangingSpeed)
+{
+    SpeedProfile profile = rushHour(0.3);
+
+    for (double departure : {0.0, 5.5, 7.9, 8.0, 16.0, 18.5, 23.75, 31.0})
+    {
+        for (double hours : {0.01, 0.25, 1.0, 5.0, 30.0})
+        {
+            ASSERT_NEAR(
+                simulatedArrival(profile, departure, hours),
+                profile.arrivalTime(departure, hours), 1e-4);
+        }
+    }
+}
+
+
+TEST(SpeedProfilesTests, settingOutLaterNeverArrivesEarlier)
+{
+    SpeedProfile profile = rushHour(0.1);
+    double previous = profile.arrivalTime(0.0, 0.5);
+
+    for (double departure = 0.01; departure < 48.0; departure += 0.01)
+    {
+        double arrival = profile.arrivalTime(departure, 0.5);
+        ASSERT_GE(arrival, previous);
+        previous = arrival;
+    }
+}
+
+
+TEST(SpeedProfilesTests, badProfilesAreRejected)
+{
+    ASSERT_THROW(SpeedProfile{{}}, DigraphException);
+    ASSERT_THROW((SpeedProfile{{{8.0, 1.0}, {6.0, 0.5}}}), DigraphException);
+    ASSERT_THROW((SpeedProfile{{{8.0, 1.0}, {8.0, 0.5}}}), DigraphException);
+    ASSERT_THROW((SpeedProfile{{{24.0, 1.0}}}), DigraphException);
+    ASSERT_THROW((SpeedProfile{{{-1.0, 1.0}}}), DigraphException);
+    ASSERT_THROW((SpeedProfile{{{8.0, 0.0}}}), DigraphException);
+}
+
+
+TEST(SpeedProfilesTests, identicalProfilesAreShared)
+{
+    SpeedProfiles profiles;
+
+    int a = profiles.add(rushHour(0.5));
+    int b = profiles.add(rushHour(0.3));
+    int c = profiles.add(rushHour(0.5));
+    int d = profiles.add(SpeedProfile{{{0.0, 1.0}}});
+
+    ASSERT_EQ(a, c);
+    ASSERT_NE(a, b);
+    ASSERT_NE(b, d);
+    ASSERT_EQ(3, profiles.profileCount());
+    ASSERT_EQ(rushHour(0.3).points(), profiles.profile(b).points());
+}
+
+
+TEST(SpeedProfilesTests, weightsRequireAProfileForEveryEdge)
+{
+    SpeedProfiles profiles;
+    profiles.add(rushHour(0.5));
+
+    ASSERT_THROW(TimeDependentWeights({1.0, 2.0}, {0}, profiles), DigraphException);
+    ASSERT_THROW(TimeDependentWeights({1.0, 2.0}, {0, 1}, profiles), DigraphException);
+}
+
+
+TEST(SpeedProfilesTests, earliestArrivalsMatchStaticSearchWhenTrafficFlows)
+{
+    Digraph<int, int> d = makeGrid(8);
+    CompactDigraph c{d, [](int, int) { }};
+
+    std::mt19937 random{46};
+    std::uniform_real_distribution<double> hours{0.05, 0.5};
+    std::vector<double> freeFlowHours;
+
+    for (int e = 0; e < c.edgeCount(); ++e)
+    {
+        freeFlowHours.push_back(hours(random));
+    }
+
+    SpeedProfiles profiles;
+    profiles.add(SpeedProfile{{{0.0, 1.0}}});
+    TimeDependentWeights weights{
+        freeFlowHours, std::vector<int>(c.edgeCount(), 0), profiles};
+
+    CompactSearchResult<double> expected = c.findShortestPaths<double>(0, freeFlowHours.data());
+    CompactSearchResult<double> result = c.findEarliestArrivals(
+        0, 7.0, [&weights](int e, double t) { return weights.arrivalTime(e, t); });
+
+    for (int v = 0; v < c.vertexCount(); ++v)
+    {
+        ASSERT_NEAR(7.0 + expected.distance[v], result.distance[v], 1e-9);
+    }
+}
+
+
+TEST(SpeedProfilesTests, earliestArrivalsAreEarliestAtEveryDeparture)
+{
+    Digraph<int, int> d = makeGrid(8);
+    CompactDigraph c{d, [](int, int) { }};
+
+    std::mt19937 random{39};
+    std::uniform_real_distribution<double> hours{0.05, 0.5};
+    std::uniform_int_distribution<int> kind{0, 3};
+
+    SpeedProfiles profiles;
+    std::vector<int> kinds{
+        profiles.add(SpeedProfile{{{0.0, 1.0}}}), profiles.add(rushHour(0.2)),
+        profiles.add(rushHour(0.6)), profiles.add(SpeedProfile{{{3.0, 1.0}, {12.0, 0.4}}})};
+
+    std::vector<double> freeFlowHours;
+    std::vector<int> profileOfEdge;
+
+    for (int e = 0; e < c.edgeCount(); ++e)
+    {
+        freeFlowHours.push_back(hours(random));
+        profileOfEdge.push_back(kinds[kind(random)]);
+    }
+
+    TimeDependentWeights weights{freeFlowHours, profileOfEdge, profiles};
+    auto arrivalTime = [&weights](int e, double t) { return weights.arrivalTime(e, t); };
+
+    for (double departure : {0.0, 7.5, 16.25})
+    {
+        CompactSearchResult<double> result = c.findEarliestArrivals(5, departure, arrivalTime);
+
+        // Relaxing every edge until nothing changes finds the earliest
+        // arrivals without depending on the order vertices are settled.
+        std::vector<double> earliest(c.vertexCount(), 1e300);
+        earliest[5] = departure;
+
+        for (bool changed = true; changed; )
+        {
+            changed = false;
+
+            for (int v = 0; v < c.vertexCount(); ++v)
+            {
+                for (int e = c.edgeBegin(v); e < c.edgeEnd(v); ++e)
+                {
+                    double arrival = arrivalTime(e, earliest[v]);
+
+                    if (earliest[v] < 1e300 && arrival < earliest[c.target(e)] - 1e-12)
+                    {
+                        earliest[c.target(e)] = arrival;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        for (int v = 0; v < c.vertexCount(); ++v)
+        {
+            ASSERT_NEAR(earliest[v], result.distance[v], 1e-9);
+        }
+
+        // The path to each vertex arrives when the search says it does.
+        int end = c.vertexCount() - 1;
+        double time = departure;
+
+        for (int e : CompactDigraph::pathEdges(result, end))
+        {
+            time = arrivalTime(e, time);
+        }
+
+        ASSERT_NEAR(result.distance[end], time, 1e-9);
+    }
+}
@@ -0,0 +1,249 @@
+// StronglyConnectedComponentsTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that StronglyConnectedComponents finds the same
+// components that a simple depth-first algorithm does.
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "StronglyConnectedComponents.hpp"
+#include "TestGraphs.hpp"
+
+
+namespace
+{
+    // makeComponentGraph() returns a sparse random graph (see
+    // TestGraphs.hpp) with a long one-way path, a long cycle, and many
+    // short cycles joined by one-way edges added to it, so that there are
+    // components of many sizes, too many for trimming and forward-backward
+    // search to find.
+    Digraph<int, int> makeComponentGraph(int vertexCount, int edgeCount)
+    {
+        Digraph<int, int> d = makeRandomGraph(vertexCount, edgeCount, 39);
+        std::mt19937 random{39};
+
+        auto addEdge = [&](int v, int w)
+        {
+            try
+            {
+                d.addEdge(v, w, 0);
+            }
+            catch (DigraphException&)
+            {
+                // The edge was already there.
+            }
+        };
+
+        for (int v = 0; v < 1000; ++v)
+        {
+            addEdge(v, v + 1);
+            addEdge(vertexCount - 1 - v, vertexCount - 2 - v);
+        }
+
+        addEdge(vertexCount - 1001, vertexCount - 1);
+
+        const int cycleLength = 8;
+        const int cycles = 1000;
+
+        for (int cycle = 0; cycle < cycles; ++cycle)
+        {
+            int first = 2000 + cycle * cycleLength;
+
+            for (int i = 0; i < cycleLength; ++i)
+            {
+                addEdge(first + i, first + (i + 1) % cycleLength);
+            }
+
+            if (cycle > 0)
+            {
+                std::uniform_int_distribution<int> earlier{2000, first - 1};
+                addEdge(earlier(random), first + cycle % cycleLength);
+            }
+        }
+
+        return d;
+    }
+
+
+    // kosaraju() returns the component of each vertex index, as found by
+    // Kosaraju's algorithm, with the components numbered in order of the
+    // lowest vertex index in each.
+    std::vector<int> kosaraju(const CompactDigraph& c)
+    {
+        int n = c.vertexCount();
+        std::vector<std::vector<int>> reverse(n);
+
+        for (int v = 0; v < n; ++v)
+        {
+            for (int e = c.edgeBegin(v); e < c.edgeEnd(v); ++e)
+            {
+                reverse[c.target(e)].push_back(v);
+            }
+        }
+
+        std::vector<bool> visited(n, false);
+        std::vector<int> finished;
+
+        for (int start = 0; start < n; ++start)
+        {
+            if (visited[start])
+            {
+                continue;
+            }
+
+            std::vector<std::pair<int, int>> path{{start, c.edgeBegin(start)}};
+            visited[start] = true;
+
+            while (!path.empty())
+            {
+                int v = path.back().first;
+
+                if (path.back().second < c.edgeEnd(v))
+                {
+                    int w = c.target(path.back().second++);
+
+                    if (!visited[w])
+                    {
+                        visited[w] = true;
+                        path.emplace_back(w, c.edgeBegin(w));
+                    }
+                }
+                else
+                {
+                    finished.push_back(v);
+                    path.pop_back();
+                }
+            }
+        }
+
+        std::vector<int> components(n, -1);
+        int count = 0;
+
+        for (auto i = finished.rbegin(); i != finished.rend(); ++i)
+        {
+            if (components[*i] != -1)
+            {
+                continue;
+            }
+
+            std::vector<int> stack{*i};
+            components[*i] = count;
+
+            while (!stack.empty())
+            {
+                int v = stack.back();
+                stack.pop_back();
+
+                for (int u : reverse[v])
+                {
+                    if (components[u] == -1)
+                    {
+                        components[u] = count;
+                        stack.push_back(u);
+                    }
+                }
+            }
+
+            ++count;
+        }
+
+        std::map<int, int> numbers;
+
+        for (int& component : components)
+        {
+            component = numbers.emplace(component, numbers.size()).first->second;
+        }
+
+        return components;
+    }
+}
+
+
+TEST(StronglyConnectedComponentsTests, findsSameComponentsAsKosaraju)
+{
+    Digraph<int, int> d = makeComponentGraph(20000, 12000);
+    CompactDigraph c{d, [](int, int) { }};
+    std::vector<int> expected = kosaraju(c);
+
+    for (unsigned int threads : {1, 4})
+    {
+        StronglyConnectedComponents components{c, threads};
+
+        ASSERT_EQ(*std::max_element(expected.begin(), expected.end()) + 1,
+                  components.componentCount());
+
+        for (int v = 0; v < c.vertexCount(); ++v)
+        {
+            ASSERT_EQ(expected[v], components.componentOf(v));
+        }
+    }
+}
+
+
+TEST(StronglyConnectedComponentsTests, findsComponentsOfSmallGraph)
+{
+    // Two cycles, the second of them bigger, joined one way, along with a
+    // vertex with an edge to itself and one joined to nothing.
+    Digraph<int, int> d;
+
+    for (int v = 0; v < 9; ++v)
+    {
+        d.addVertex(v, v);
+    }
+
+    for (std::pair<int, int> edge : std::vector<std::pair<int, int>>{
+             {0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 4}, {4, 5}, {5, 6}, {6, 3},
+             {7, 7}, {7, 0}})
+    {
+        d.addEdge(edge.first, edge.second, 0);
+    }
+
+    CompactDigraph c{d, [](int, int) { }};
+    StronglyConnectedComponents components{c, 2};
+
+    ASSERT_EQ(4, components.componentCount());
+    ASSERT_EQ(1, components.largestComponent());
+    ASSERT_EQ((std::vector<int>{0, 1, 2}), components.verticesOf(0));
+    ASSERT_EQ((std::vector<int>{3, 4, 5, 6}), components.verticesOf(1));
+    ASSERT_EQ((std::vector<int>{7}), components.verticesOf(2));
+    ASSERT_EQ((std::vector<int>{8}), components.verticesOf(3));
+}
+
+
+TEST(StronglyConnectedComponentsTests, reportsLargestComponent)
+{
+    Digraph<int, int> d = makeComponentGraph(20000, 12000);
+    CompactDigraph c{d, [](int, int) { }};
+    StronglyConnectedComponents components{c, 2};
+
+    int largest = components.largestComponent();
+    std::vector<int> vertices = components.verticesOf(largest);
+
+    ASSERT_EQ(components.componentSize(largest), static_cast<int>(vertices.size()));
+    ASSERT_TRUE(std::is_sorted(vertices.begin(), vertices.end()));
+
+    for (int component = 0; component < components.componentCount(); ++component)
+    {
+        ASSERT_LE(components.componentSize(component), static_cast<int>(vertices.size()));
+    }
+
+    for (int v : vertices)
+    {
+        ASSERT_EQ(largest, components.componentOf(v));
+    }
+}
+
+
+TEST(StronglyConnectedComponentsTests, emptyGraphHasNoComponents)
+{
+    StronglyConnectedComponents components{CompactDigraph{}, 2};
+
+    ASSERT_EQ(0, components.componentCount());
+    ASSERT_EQ(-1, components.largestComponent());
+}
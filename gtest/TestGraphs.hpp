@@ -0,0 +1,112 @@
+// TestGraphs.hpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Generates the Digraphs that the unit tests search: grids, which look
+// like small road networks, and sparse graphs with edges between random
+// vertices.  The same arguments always generate the same graph.
+
+#ifndef TESTGRAPHS_HPP
+#define TESTGRAPHS_HPP
+
+#include <random>
+#include "Digraph.hpp"
+
+
+
+// makeGrid() returns a square grid of vertices, the given number wide,
+// numbered row by row, in which neighbors are joined in both directions.
+// If oneWayOdds is given, about one pair of neighbors in that many is
+// joined only from the lower-numbered vertex to the higher, and as many
+// only the other way; if missing is also true, as many again aren't
+// joined at all, so that not every vertex can reach every other.
+
+inline Digraph<int, int> makeGrid(int width, int oneWayOdds = 0, bool missing = false)
+{
+    std::mt19937 random{46};
+    std::uniform_int_distribution<int> kind{0, oneWayOdds > 0 ? oneWayOdds - 1 : 0};
+
+    Digraph<int, int> d;
+
+    for (int v = 0; v < width * width; ++v)
+    {
+        d.addVertex(v, v);
+    }
+
+    for (int v = 0; v < width * width; ++v)
+    {
+        for (int w : {v + 1, v + width})
+        {
+            if ((w == v + 1 && w % width == 0) || w >= width * width)
+            {
+                continue;
+            }
+
+            int k = oneWayOdds > 0 ? kind(random) : -1;
+
+            if (k != 0 && !(missing && k == 2))
+            {
+                d.addEdge(v, w, 0);
+            }
+
+            if (k != 1 && !(missing && k == 2))
+            {
+                d.addEdge(w, v, 0);
+            }
+        }
+    }
+
+    return d;
+}
+
+
+
+// makeRandomGraph() returns a graph with the given number of vertices,
+// numbered 0, spacing, 2 * spacing, and so on, and up to the given number
+// of edges, each between two different vertices chosen at random (an
+// edge chosen again is only added once).  Each edge's EdgeInfo is chosen
+// at random between 0 and maxEdgeInfo.  Most edges go in one direction
+// only, so there are many components, of many sizes.
+
+template <typename EdgeInfo = int>
+Digraph<int, EdgeInfo> makeRandomGraph(
+    int vertexCount, int edgeCount, unsigned int seed, int spacing = 1,
+    EdgeInfo maxEdgeInfo = 0)
+{
+    std::mt19937 random{seed};
+    std::uniform_int_distribution<int> vertex{0, vertexCount - 1};
+    std::uniform_int_distribution<EdgeInfo> edgeInfo{0, maxEdgeInfo};
+
+    Digraph<int, EdgeInfo> d;
+
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        d.addVertex(v * spacing, v);
+    }
+
+    for (int i = 0; i < edgeCount; ++i)
+    {
+        int v = vertex(random) * spacing;
+        int w = vertex(random) * spacing;
+        EdgeInfo einfo = edgeInfo(random);
+
+        if (v != w)
+        {
+            try
+            {
+                d.addEdge(v, w, einfo);
+            }
+            catch (DigraphException&)
+            {
+                // The edge was already there.
+            }
+        }
+    }
+
+    return d;
+}
+
+
+
+#endif // TESTGRAPHS_HPP
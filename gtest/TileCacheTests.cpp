@@ -0,0 +1,142 @@
+// TileCacheTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests checking that a TileCache loads each tile only when it's
+// needed and evicts the tiles used least recently once they exceed its
+// budget.
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "TileCache.hpp"
+
+
+namespace
+{
+    // A SampleTile reports the given number of bytes as its memory usage.
+    struct SampleTile
+    {
+        int number;
+        std::size_t bytes;
+
+        MemoryUsage memoryUsage() const noexcept
+        {
+            MemoryUsage usage;
+            usage.adjacency = bytes;
+            return usage;
+        }
+    };
+
+
+    // makeLoader() returns a function that loads tiles of the given size,
+    // recording the number of each tile it loads.
+    TileCache<SampleTile>::LoadFunc makeLoader(std::size_t bytes, std::vector<int>& loaded)
+    {
+        return [bytes, &loaded](int tile)
+        {
+            loaded.push_back(tile);
+            return std::make_shared<const SampleTile>(SampleTile{tile, bytes});
+        };
+    }
+}
+
+
+TEST(TileCacheTests, tilesAreLoadedOnlyOnce)
+{
+    std::vector<int> loaded;
+    TileCache<SampleTile> cache{1000, makeLoader(100, loaded)};
+
+    ASSERT_EQ(3, cache.get(3)->number);
+    ASSERT_EQ(5, cache.get(5)->number);
+    ASSERT_EQ(3, cache.get(3)->number);
+
+    ASSERT_EQ((std::vector<int>{3, 5}), loaded);
+    ASSERT_EQ(2u, cache.residentTiles());
+    ASSERT_EQ(200u, cache.residentBytes());
+    ASSERT_EQ(200u, cache.memoryUsage().adjacency);
+    ASSERT_EQ(2u, cache.loadCount());
+    ASSERT_EQ(0u, cache.evictionCount());
+}
+
+
+TEST(TileCacheTests, leastRecentlyUsedTilesAreEvicted)
+{
+    std::vector<int> loaded;
+    TileCache<SampleTile> cache{300, makeLoader(100, loaded)};
+
+    cache.get(0);
+    cache.get(1);
+    cache.get(2);
+
+    // Using tile 0 makes tile 1 the least recently used, so it's the one
+    // evicted to make room for tile 3.
+    cache.get(0);
+    cache.get(3);
+
+    ASSERT_EQ(3u, cache.residentTiles());
+    ASSERT_EQ(1u, cache.evictionCount());
+
+    cache.get(0);
+    cache.get(2);
+    ASSERT_EQ((std::vector<int>{0, 1, 2, 3}), loaded);
+
+    cache.get(1);
+    ASSERT_EQ((std::vector<int>{0, 1, 2, 3, 1}), loaded);
+    ASSERT_EQ(300u, cache.residentBytes());
+}
+
+
+TEST(TileCacheTests, tileJustLoadedIsKeptEvenOverBudget)
+{
+    std::vector<int> loaded;
+    TileCache<SampleTile> cache{50, makeLoader(100, loaded)};
+
+    cache.get(0);
+    ASSERT_EQ(1u, cache.residentTiles());
+
+    cache.get(0);
+    ASSERT_EQ(1u, cache.loadCount());
+
+    cache.get(1);
+    ASSERT_EQ(1u, cache.residentTiles());
+    ASSERT_EQ(1u, cache.evictionCount());
+}
+
+
+TEST(TileCacheTests, evictedTilesStayValidWhileHeld)
+{
+    std::vector<int> loaded;
+    TileCache<SampleTile> cache{100, makeLoader(100, loaded)};
+
+    std::shared_ptr<const SampleTile> held = cache.get(7);
+    cache.get(8);
+
+    ASSERT_EQ(1u, cache.evictionCount());
+    ASSERT_EQ(7, held->number);
+    ASSERT_EQ(100u, cache.residentBytes());
+}
+
+
+TEST(TileCacheTests, failedLoadsLeaveCacheUnchanged)
+{
+    TileCache<SampleTile> cache{
+        1000,
+        [](int tile) -> std::shared_ptr<const SampleTile>
+        {
+            if (tile < 0)
+            {
+                throw std::out_of_range{"no such tile"};
+            }
+
+            return std::make_shared<const SampleTile>(SampleTile{tile, 10});
+        }};
+
+    cache.get(1);
+
+    ASSERT_THROW(cache.get(-1), std::out_of_range);
+    ASSERT_EQ(1u, cache.residentTiles());
+    ASSERT_EQ(1u, cache.loadCount());
+}
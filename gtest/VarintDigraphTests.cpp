@@ -0,0 +1,85 @@
+// VarintDigraphTests.cpp
+//
+// ICS 46 Spring 2018
+// Project #5: Rock and Roll Stops the Traffic
+//
+// Unit tests for VarintDigraph, the variable-length integer encoding of a
+// CompactDigraph's structure.
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "TestGraphs.hpp"
+#include "VarintDigraph.hpp"
+
+
+namespace
+{
+    typedef VarintDigraph<1> Graph;
+}
+
+
+TEST(VarintDigraphTests, decodesEveryEdgeWithItsPayload)
+{
+    Digraph<int, unsigned int> d = makeRandomGraph<unsigned int>(200, 800, 38, 1000, 100000);
+    std::vector<unsigned int> weights;
+    CompactDigraph c{
+        d, [&](int, unsigned int einfo) { weights.push_back(einfo); },
+        VertexOrder::BreadthFirst};
+
+    Graph g{c, [&](int edge) { return Graph::Payload{weights[edge]}; }};
+
+    ASSERT_EQ(c.vertexCount(), g.vertexCount());
+    ASSERT_EQ(c.edgeCount(), g.edgeCount());
+
+    for (int v = 0; v < c.vertexCount(); ++v)
+    {
+        ASSERT_EQ(c.vertexNumber(v), g.vertexNumber(v));
+        ASSERT_EQ(v, g.indexOf(c.vertexNumber(v)));
+
+        std::map<int, unsigned int> expected;
+
+        for (int e = c.edgeBegin(v); e < c.edgeEnd(v); ++e)
+        {
+            expected[c.target(e)] = weights[e];
+        }
+
+        std::map<int, unsigned int> decoded;
+        Graph::EdgeReader reader = g.edges(v);
+        int target;
+        Graph::Payload payload;
+        int previous = -1;
+
+        while (reader.next(target, payload))
+        {
+            ASSERT_LT(previous, target);
+            decoded[target] = payload[0];
+            previous = target;
+        }
+
+        ASSERT_EQ(expected, decoded);
+    }
+
+    ASSERT_LT(g.bytes(), c.edgeCount() * (sizeof(int) + sizeof(unsigned int)) + 16 * c.vertexCount());
+}
+
+
+TEST(VarintDigraphTests, findsSameDistancesAsCompactDigraph)
+{
+    Digraph<int, unsigned int> d = makeRandomGraph<unsigned int>(200, 800, 38, 1000, 100000);
+    std::vector<unsigned int> weights;
+    CompactDigraph c{d, [&](int, unsigned int einfo) { weights.push_back(einfo); }};
+
+    Graph g{c, [&](int edge) { return Graph::Payload{weights[edge]}; }};
+
+    for (int start = 0; start < c.vertexCount(); start += 13)
+    {
+        CompactSearchResult<long long> expected =
+            c.findShortestPaths<long long>(start, weights.data());
+        CompactSearchResult<long long> result = g.findShortestPaths<long long>(
+            start, [](const Graph::Payload& payload) { return payload[0]; });
+
+        ASSERT_EQ(expected.distance, result.distance);
+    }
+}